@@ -11,18 +11,51 @@
 #include <stdio.h>
 #include <string.h>
 #include <math.h>	//	for floor()
+#ifdef __WIN32__
+#include <windows.h>	//	for InterlockedIncrement()
+#else
+#include <pthread.h>	//	for gMemCountMutex
+#endif
 
 
 //	Test for memory leaks.
 signed int		gMemCount		= 0;
-#ifdef THREADSAFE_MEM_COUNT
-pthread_mutex_t	gMemCountMutex	= PTHREAD_MUTEX_INITIALIZER;
+#ifndef __WIN32__
+static pthread_mutex_t	gMemCountMutex	= PTHREAD_MUTEX_INITIALIZER;
 #endif
 
 
 static char	*CharacterAsUTF8String(Char16 aCharacter, char aBuffer[5]);
 
 
+void IncrementMemCount(void)
+{
+	//	GET_MEMORY() may get called on any thread,
+	//	so update gMemCount atomically.
+#ifdef __WIN32__
+	//	A Win32 LONG, like a signed int, is 32 bits wide.
+	InterlockedIncrement((volatile LONG *) &gMemCount);
+#else
+	pthread_mutex_lock(&gMemCountMutex);
+	gMemCount++;
+	pthread_mutex_unlock(&gMemCountMutex);
+#endif
+}
+
+void DecrementMemCount(void)
+{
+	//	FREE_MEMORY() may get called on any thread,
+	//	so update gMemCount atomically.
+#ifdef __WIN32__
+	InterlockedDecrement((volatile LONG *) &gMemCount);
+#else
+	pthread_mutex_lock(&gMemCountMutex);
+	gMemCount--;
+	pthread_mutex_unlock(&gMemCountMutex);
+#endif
+}
+
+
 bool IsPowerOfTwo(unsigned int n)
 {
 	if (n == 0)
@@ -609,7 +642,7 @@ void InvertRawImage(
 //	Package up information for the new-thread wrapper function.
 
 #ifdef __WIN32__
-#include <process.h>	//	use _beginthread() on Windows
+#include <process.h>	//	use _beginthreadex() on Windows
 #else
 #include <pthread.h>	//	use pthread_create() on all other platforms
 #endif
@@ -618,13 +651,26 @@ typedef struct
 {
 	ModelData	*md;
 	void		(*itsStartFuction)(ModelData *);
+	void		*itsThreadData;							//	used only if itsStartFuction is NULL
+	void		(*itsStartFuctionWithData)(void *);		//	used only if itsStartFuction is NULL
 	bool		itsArgumentsHaveBeenCopied;
 } ThreadStartData;
 
+//	A JoinableThread keeps a thread's platform-dependent handle
+//	until somebody either waits for the thread or lets it go.
+struct JoinableThread
+{
+#ifdef __WIN32__
+	HANDLE		itsHandle;
+#else
+	pthread_t	itsThreadID;
+#endif
+};
+
 #ifdef __WIN32__
-static void __cdecl	StartFunctionWrapper(void *aParam);
+static unsigned __stdcall	StartFunctionWrapper(void *aParam);
 #else
-static void			*StartFunctionWrapper(void *aParam);
+static void					*StartFunctionWrapper(void *aParam);
 #endif
 
 void StartNewThread(
@@ -636,28 +682,126 @@ void StartNewThread(
 	
 	ThreadStartData	theThreadStartData;
 #ifdef __WIN32__
+	HANDLE			theNewThread;	//	We'll ignore the new thread's handle.
 #else
 	pthread_t		theNewThreadID;	//	We'll ignore the new thread's ID.
 #endif
+	bool			theThreadStarted;
 	
 	theThreadStartData.md							= md;
 	theThreadStartData.itsStartFuction				= aStartFuction;
+	theThreadStartData.itsThreadData				= NULL;
+	theThreadStartData.itsStartFuctionWithData		= NULL;
 	theThreadStartData.itsArgumentsHaveBeenCopied	= false;
 
 #ifdef __WIN32__
-	_beginthread(StartFunctionWrapper, 0, (void *)&theThreadStartData);
+	theNewThread = (HANDLE) _beginthreadex(NULL, 0, StartFunctionWrapper, (void *)&theThreadStartData, 0, NULL);
+	theThreadStarted = (theNewThread != 0);
+	if (theThreadStarted)
+		CloseHandle(theNewThread);
 #else
-	pthread_create(&theNewThreadID, NULL, StartFunctionWrapper, (void *)&theThreadStartData);
+	theThreadStarted = (pthread_create(&theNewThreadID, NULL, StartFunctionWrapper, (void *)&theThreadStartData) == 0);
+	if (theThreadStarted)
+		pthread_detach(theNewThreadID);
 #endif
 	
+	//	A thread that never started will never copy its arguments.
+	while (theThreadStarted && ! theThreadStartData.itsArgumentsHaveBeenCopied )
+		SleepBriefly();
+}
+
+ErrorText StartNewThreadWithData(
+	void			(*aStartFuction)(void *),
+	void			*aThreadData,
+	JoinableThread	**aThread)	//	output;  pass it to WaitForThread() or DetachThread()
+{
+	//	Same as StartNewThread(), but for a thread that works
+	//	on private data of its own rather than on the ModelData.
+	//	The new thread owns aThreadData, or at least shares it
+	//	on whatever terms the caller has arranged.
+	//
+	//	Unlike StartNewThread(), report a thread that couldn't start,
+	//	and give the caller a handle, so that it may later wait
+	//	for the thread to finish, for example when the app quits.
+	
+	ThreadStartData	theThreadStartData;
+	JoinableThread	*theThread;
+	bool			theThreadStarted;
+
+	if (*aThread != NULL)
+		return u"StartNewThreadWithData() received a non-NULL output location.";
+	
+	theThread = (JoinableThread *) GET_MEMORY(sizeof(JoinableThread));
+	if (theThread == NULL)
+		return u"Couldn't allocate memory for a JoinableThread.";
+	
+	theThreadStartData.md							= NULL;
+	theThreadStartData.itsStartFuction				= NULL;
+	theThreadStartData.itsThreadData				= aThreadData;
+	theThreadStartData.itsStartFuctionWithData		= aStartFuction;
+	theThreadStartData.itsArgumentsHaveBeenCopied	= false;
+
+#ifdef __WIN32__
+	theThread->itsHandle = (HANDLE) _beginthreadex(NULL, 0, StartFunctionWrapper, (void *)&theThreadStartData, 0, NULL);
+	theThreadStarted = (theThread->itsHandle != 0);
+#else
+	theThreadStarted = (pthread_create(&theThread->itsThreadID, NULL, StartFunctionWrapper, (void *)&theThreadStartData) == 0);
+#endif
+
+	if ( ! theThreadStarted )
+	{
+		FREE_MEMORY(theThread);
+		return u"Couldn't start a new thread.";
+	}
+	
 	while ( ! theThreadStartData.itsArgumentsHaveBeenCopied )
 		SleepBriefly();
+
+	*aThread = theThread;
+
+	return NULL;
+}
+
+void WaitForThread(
+	JoinableThread	**aThread)
+{
+	//	Wait for *aThread to finish, then free the handle.
+
+	if (*aThread == NULL)
+		return;
+
+#ifdef __WIN32__
+	WaitForSingleObject((*aThread)->itsHandle, INFINITE);
+	CloseHandle((*aThread)->itsHandle);
+#else
+	pthread_join((*aThread)->itsThreadID, NULL);
+#endif
+
+	FREE_MEMORY_SAFELY(*aThread);
 }
 
-#ifdef __WIN32__	//	for _beginthread() on Windows
-static void __cdecl	StartFunctionWrapper(void *aParam)
+void DetachThread(
+	JoinableThread	**aThread)
+{
+	//	Let *aThread run to completion on its own, and free the handle.
+	//	The thread's resources go away when the thread does.
+
+	if (*aThread == NULL)
+		return;
+
+#ifdef __WIN32__
+	CloseHandle((*aThread)->itsHandle);
+#else
+	pthread_detach((*aThread)->itsThreadID);
+#endif
+
+	FREE_MEMORY_SAFELY(*aThread);
+}
+
+#ifdef __WIN32__	//	for _beginthreadex() on Windows
+static unsigned __stdcall	StartFunctionWrapper(void *aParam)
 #else				//	for pthread_create() on all platforms except Windows
-static void			*StartFunctionWrapper(void *aParam)
+static void					*StartFunctionWrapper(void *aParam)
 #endif
 {
 	ThreadStartData	theThreadStartData;
@@ -670,10 +814,13 @@ static void			*StartFunctionWrapper(void *aParam)
 	
 	//	Call itsStartFunction.
 	//	Whatever calling convention the compiler prefers is fine by us.
-	(*theThreadStartData.itsStartFuction)(theThreadStartData.md);
+	if (theThreadStartData.itsStartFuction != NULL)
+		(*theThreadStartData.itsStartFuction)(theThreadStartData.md);
+	else
+		(*theThreadStartData.itsStartFuctionWithData)(theThreadStartData.itsThreadData);
 
 #ifdef __WIN32__
-	return;
+	return 0;
 #else
 	return NULL;
 #endif
@@ -706,6 +853,513 @@ void SleepBriefly(void)
 }
 
 
+unsigned int GetNumProcessors(void)
+{
+	//	How many processor cores may we reasonably keep busy?
+
+#ifdef __WIN32__
+	SYSTEM_INFO	theSystemInfo;
+
+	GetSystemInfo(&theSystemInfo);
+	return theSystemInfo.dwNumberOfProcessors > 0 ?
+			(unsigned int) theSystemInfo.dwNumberOfProcessors : 1;
+#else
+	long	theNumProcessors;
+
+	theNumProcessors = sysconf(_SC_NPROCESSORS_ONLN);
+	return theNumProcessors > 0 ? (unsigned int) theNumProcessors : 1;
+#endif
+}
+
+
+//	Package up information for the parallel-job wrapper function.
+typedef struct
+{
+	void	(*itsJobFunction)(void *);
+	void	*itsJobData;
+} ParallelJob;
+
+#ifdef __WIN32__
+static unsigned __stdcall	ParallelJobWrapper(void *aParam);
+#else
+static void					*ParallelJobWrapper(void *aParam);
+#endif
+
+void RunJobsInParallel(
+	unsigned int	aNumJobs,
+	void			(*aJobFunction)(void *),
+	void			**someJobData)	//	aNumJobs pointers, one per job
+{
+	//	Run aJobFunction once for each element of someJobData,
+	//	with each job on its own thread, and wait for all jobs
+	//	to finish before returning.  The calling thread runs the first job
+	//	itself, so a single job costs no thread creation at all.
+	//
+	//	Unlike StartNewThread(), which launches a long-lived thread
+	//	and forgets about it, RunJobsInParallel() is for brief
+	//	compute-bound work that the caller wants done before it proceeds.
+	//
+	//	aJobFunction may call GET_MEMORY() and FREE_MEMORY(),
+	//	which keep gMemCount consistent across threads,
+	//	but brief compute-bound jobs will typically run faster if they don't.
+
+	ParallelJob		theJobs[MAX_PARALLEL_JOBS];
+#ifdef __WIN32__
+	HANDLE			theThreads[MAX_PARALLEL_JOBS];
+#else
+	pthread_t		theThreads[MAX_PARALLEL_JOBS];
+#endif
+	bool			theThreadStarted[MAX_PARALLEL_JOBS];
+	unsigned int	i;
+
+	//	Each caller sizes its job arrays by MAX_PARALLEL_JOBS
+	//	and expects every one of its jobs to run, so a larger aNumJobs
+	//	is a bug in the caller, not something to quietly clamp.
+	GEOMETRY_GAMES_ASSERT(	aNumJobs <= MAX_PARALLEL_JOBS,
+							"RunJobsInParallel() received more than MAX_PARALLEL_JOBS jobs");
+
+	for (i = 0; i < aNumJobs; i++)
+	{
+		theJobs[i].itsJobFunction	= aJobFunction;
+		theJobs[i].itsJobData		= someJobData[i];
+		theThreadStarted[i]			= false;
+	}
+
+	//	Start jobs 1 through aNumJobs - 1 on secondary threads.
+	//	If a thread can't be created, we'll simply run its job
+	//	on the calling thread below.
+	for (i = 1; i < aNumJobs; i++)
+	{
+#ifdef __WIN32__
+		theThreads[i] = (HANDLE) _beginthreadex(NULL, 0, ParallelJobWrapper, &theJobs[i], 0, NULL);
+		theThreadStarted[i] = (theThreads[i] != 0);
+#else
+		theThreadStarted[i] = (pthread_create(&theThreads[i], NULL, ParallelJobWrapper, &theJobs[i]) == 0);
+#endif
+	}
+
+	//	Run job 0, along with any jobs whose threads failed to start,
+	//	on the calling thread.
+	for (i = 0; i < aNumJobs; i++)
+		if ( ! theThreadStarted[i] )
+			(*aJobFunction)(someJobData[i]);
+
+	//	Wait for the secondary threads to finish.
+	for (i = 1; i < aNumJobs; i++)
+	{
+		if (theThreadStarted[i])
+		{
+#ifdef __WIN32__
+			WaitForSingleObject(theThreads[i], INFINITE);
+			CloseHandle(theThreads[i]);
+#else
+			pthread_join(theThreads[i], NULL);
+#endif
+		}
+	}
+}
+
+#ifdef __WIN32__	//	for _beginthreadex() on Windows
+static unsigned __stdcall	ParallelJobWrapper(void *aParam)
+#else				//	for pthread_create() on all platforms except Windows
+static void					*ParallelJobWrapper(void *aParam)
+#endif
+{
+	(*((ParallelJob *)aParam)->itsJobFunction)(((ParallelJob *)aParam)->itsJobData);
+
+#ifdef __WIN32__
+	return 0;
+#else
+	return NULL;
+#endif
+}
+
+
+//	A MutexLock lets two threads take turns with shared data.
+//	The ModelData is protected by the platform-dependent code,
+//	but the platform-independent code occasionally hands data
+//	back and forth with a thread of its own.
+struct MutexLock
+{
+#ifdef __WIN32__
+	CRITICAL_SECTION	itsCriticalSection;
+#else
+	pthread_mutex_t		itsMutex;
+#endif
+};
+
+MutexLock *CreateMutexLock(void)
+{
+	MutexLock	*theMutexLock;
+	
+	theMutexLock = (MutexLock *) GET_MEMORY(sizeof(MutexLock));
+	if (theMutexLock == NULL)
+		return NULL;
+
+#ifdef __WIN32__
+	InitializeCriticalSection(&theMutexLock->itsCriticalSection);
+#else
+	if (pthread_mutex_init(&theMutexLock->itsMutex, NULL) != 0)
+	{
+		FREE_MEMORY(theMutexLock);
+		return NULL;
+	}
+#endif
+
+	return theMutexLock;
+}
+
+void FreeMutexLock(MutexLock **aMutexLock)
+{
+	if (*aMutexLock != NULL)
+	{
+#ifdef __WIN32__
+		DeleteCriticalSection(&(*aMutexLock)->itsCriticalSection);
+#else
+		pthread_mutex_destroy(&(*aMutexLock)->itsMutex);
+#endif
+		FREE_MEMORY_SAFELY(*aMutexLock);
+	}
+}
+
+void LockMutex(MutexLock *aMutexLock)
+{
+#ifdef __WIN32__
+	EnterCriticalSection(&aMutexLock->itsCriticalSection);
+#else
+	pthread_mutex_lock(&aMutexLock->itsMutex);
+#endif
+}
+
+bool TryLockMutex(MutexLock *aMutexLock)
+{
+	//	Acquire the lock only if nobody else holds it.
+	//	The main thread uses TryLockMutex() so that it never waits
+	//	while a secondary thread is busy.
+	
+#ifdef __WIN32__
+	return TryEnterCriticalSection(&aMutexLock->itsCriticalSection) ? true : false;
+#else
+	return pthread_mutex_trylock(&aMutexLock->itsMutex) == 0;
+#endif
+}
+
+void UnlockMutex(MutexLock *aMutexLock)
+{
+#ifdef __WIN32__
+	LeaveCriticalSection(&aMutexLock->itsCriticalSection);
+#else
+	pthread_mutex_unlock(&aMutexLock->itsMutex);
+#endif
+}
+
+
+#ifdef __WIN32__
+#else
+#include <fcntl.h>		//	for open()
+#include <stdio.h>		//	for rename()
+#include <sys/mman.h>	//	for mmap()
+#include <sys/stat.h>	//	for fstat() and fchmod()
+#include <unistd.h>		//	for write(), close() and unlink()
+#endif
+
+ErrorText MapFileContents(
+	const Char16	*aPathName,		//	input,  zero-terminated UTF-16 absolute path
+	size_t			*aNumBytes,		//	output, the file size in bytes
+	const Byte		**someBytes,	//	output, the file's contents, read-only
+	void			**aMapping)		//	output, private to MapFileContents() and UnmapFileContents()
+{
+	//	Map a file into memory read-only, so the caller may read
+	//	its contents directly without first copying them.
+	//	The operating system pages in only the parts that get read.
+	//	Call UnmapFileContents() when done.
+	//
+	//	Unlike GetFileContents(), which reads the application's
+	//	own resources, MapFileContents() takes an absolute path.
+	
+	ErrorText		theErrorMessage	= NULL;
+#ifdef __WIN32__
+	HANDLE			theFile			= INVALID_HANDLE_VALUE,
+					theMapping		= NULL;
+	LARGE_INTEGER	theFileSize;
+#else
+	char			thePathUTF8[4096];
+	int				theFile			= -1;
+	struct stat		theFileStatus;
+	void			*theBytes		= MAP_FAILED;
+#endif
+
+	*aNumBytes	= 0;
+	*someBytes	= NULL;
+	*aMapping	= NULL;
+
+#ifdef __WIN32__
+
+	theFile = CreateFileW(aPathName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (theFile == INVALID_HANDLE_VALUE)
+	{
+		theErrorMessage = u"Couldn't open file in MapFileContents().";
+		goto CleanUpMapFileContents;
+	}
+	
+	if ( ! GetFileSizeEx(theFile, &theFileSize)
+	 || theFileSize.QuadPart == 0
+	 || (unsigned long long) theFileSize.QuadPart > (size_t)(-1))
+	{
+		theErrorMessage = u"File is empty or too large in MapFileContents().";
+		goto CleanUpMapFileContents;
+	}
+
+	theMapping = CreateFileMappingW(theFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (theMapping == NULL)
+	{
+		theErrorMessage = u"Couldn't create file mapping in MapFileContents().";
+		goto CleanUpMapFileContents;
+	}
+	
+	*someBytes = (const Byte *) MapViewOfFile(theMapping, FILE_MAP_READ, 0, 0, 0);
+	if (*someBytes == NULL)
+	{
+		theErrorMessage = u"Couldn't map view of file in MapFileContents().";
+		goto CleanUpMapFileContents;
+	}
+	
+	*aNumBytes	= (size_t) theFileSize.QuadPart;
+	*aMapping	= (void *) theMapping;
+	theMapping	= NULL;
+
+CleanUpMapFileContents:
+
+	//	The view keeps the file open as long as it needs it.
+	if (theMapping != NULL)
+		CloseHandle(theMapping);
+	if (theFile != INVALID_HANDLE_VALUE)
+		CloseHandle(theFile);
+
+#else
+
+	if ( ! UTF16toUTF8(aPathName, thePathUTF8, BUFFER_LENGTH(thePathUTF8)) )
+	{
+		theErrorMessage = u"Path name too long in MapFileContents().";
+		goto CleanUpMapFileContents;
+	}
+
+	theFile = open(thePathUTF8, O_RDONLY);
+	if (theFile == -1)
+	{
+		theErrorMessage = u"Couldn't open file in MapFileContents().";
+		goto CleanUpMapFileContents;
+	}
+
+	if (fstat(theFile, &theFileStatus) != 0
+	 || theFileStatus.st_size <= 0)
+	{
+		theErrorMessage = u"File is empty or unreadable in MapFileContents().";
+		goto CleanUpMapFileContents;
+	}
+	
+	theBytes = mmap(NULL, (size_t) theFileStatus.st_size, PROT_READ, MAP_PRIVATE, theFile, 0);
+	if (theBytes == MAP_FAILED)
+	{
+		theErrorMessage = u"Couldn't map file in MapFileContents().";
+		goto CleanUpMapFileContents;
+	}
+
+	*aNumBytes	= (size_t) theFileStatus.st_size;
+	*someBytes	= (const Byte *) theBytes;
+
+CleanUpMapFileContents:
+
+	//	The mapping remains valid after the file is closed.
+	if (theFile != -1)
+		close(theFile);
+
+#endif
+
+	return theErrorMessage;
+}
+
+void UnmapFileContents(
+	size_t			*aNumBytes,
+	const Byte		**someBytes,
+	void			**aMapping)
+{
+	if (*someBytes != NULL)
+	{
+#ifdef __WIN32__
+		UnmapViewOfFile(*someBytes);
+		CloseHandle((HANDLE) *aMapping);
+#else
+		munmap((void *) *someBytes, *aNumBytes);
+#endif
+	}
+
+	*aNumBytes	= 0;
+	*someBytes	= NULL;
+	*aMapping	= NULL;
+}
+
+ErrorText WriteFileContents(
+	const Char16	*aPathName,		//	input, zero-terminated UTF-16 absolute path
+	size_t			aNumBytes,
+	const Byte		*someBytes)
+{
+	//	Write the file under a temporary name and then rename it,
+	//	so a reader never sees a partially written file.
+	//	If the file already exists, replace it.
+	//
+	//	Let the operating system choose a unique temporary name,
+	//	so two threads or processes writing the same file at once
+	//	never share a temporary file.  Keep the temporary file
+	//	in the destination's own directory, so the rename
+	//	never needs to move it to a different volume.
+
+	ErrorText	theErrorMessage	= NULL;
+	bool		theTemporaryFileExists	= false;
+#ifdef __WIN32__
+	Char16		theDirectory[MAX_PATH],
+				theTemporaryPath[MAX_PATH],
+				*theCharacter,
+				*theLastSeparator;
+	HANDLE		theFile					= INVALID_HANDLE_VALUE;
+	DWORD		theNumBytesWritten;
+	size_t		theNumBytesRemaining;
+#else
+	char		thePathUTF8[4096],
+				theTemporaryPathUTF8[4096];
+	int			theFile					= -1;
+	ssize_t		theNumBytesWritten;
+	size_t		theNumBytesRemaining;
+#endif
+
+#ifdef __WIN32__
+
+	if ( ! Strcpy16(theDirectory, BUFFER_LENGTH(theDirectory), aPathName) )
+	{
+		theErrorMessage = u"Path name too long in WriteFileContents().";
+		goto CleanUpWriteFileContents;
+	}
+	theLastSeparator = NULL;
+	for (theCharacter = theDirectory; *theCharacter != 0; theCharacter++)
+		if (*theCharacter == u'\\' || *theCharacter == u'/')
+			theLastSeparator = theCharacter;
+	if (theLastSeparator == NULL)
+	{
+		theErrorMessage = u"Path name isn't absolute in WriteFileContents().";
+		goto CleanUpWriteFileContents;
+	}
+	theLastSeparator[1] = 0;	//	keep the separator, so C:\x yields C:\ rather than C:
+
+	//	GetTempFileNameW() creates an empty file with a unique name.
+	if (GetTempFileNameW(theDirectory, u"ggw", 0, theTemporaryPath) == 0)
+	{
+		theErrorMessage = u"Couldn't create temporary file in WriteFileContents().";
+		goto CleanUpWriteFileContents;
+	}
+	theTemporaryFileExists = true;
+
+	theFile = CreateFileW(theTemporaryPath, GENERIC_WRITE, 0, NULL, TRUNCATE_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (theFile == INVALID_HANDLE_VALUE)
+	{
+		theErrorMessage = u"Couldn't create file in WriteFileContents().";
+		goto CleanUpWriteFileContents;
+	}
+
+	theNumBytesRemaining = aNumBytes;
+	while (theNumBytesRemaining > 0)
+	{
+		if ( ! WriteFile(	theFile,
+							someBytes + (aNumBytes - theNumBytesRemaining),
+							theNumBytesRemaining < 0x40000000 ? (DWORD) theNumBytesRemaining : 0x40000000,
+							&theNumBytesWritten,
+							NULL)
+		 || theNumBytesWritten == 0)
+		{
+			theErrorMessage = u"Couldn't write file in WriteFileContents().";
+			goto CleanUpWriteFileContents;
+		}
+		theNumBytesRemaining -= theNumBytesWritten;
+	}
+	
+	CloseHandle(theFile);
+	theFile = INVALID_HANDLE_VALUE;
+
+	if ( ! MoveFileExW(theTemporaryPath, aPathName, MOVEFILE_REPLACE_EXISTING) )
+	{
+		theErrorMessage = u"Couldn't rename file in WriteFileContents().";
+		goto CleanUpWriteFileContents;
+	}
+	theTemporaryFileExists = false;
+
+CleanUpWriteFileContents:
+
+	if (theFile != INVALID_HANDLE_VALUE)
+		CloseHandle(theFile);
+	if (theTemporaryFileExists)
+		DeleteFileW(theTemporaryPath);
+
+#else
+
+	if ( ! UTF16toUTF8(aPathName, thePathUTF8, BUFFER_LENGTH(thePathUTF8))
+	 || strlen(thePathUTF8) + strlen(".XXXXXX") >= BUFFER_LENGTH(theTemporaryPathUTF8) )
+	{
+		theErrorMessage = u"Path name too long in WriteFileContents().";
+		goto CleanUpWriteFileContents;
+	}
+	strcpy(theTemporaryPathUTF8, thePathUTF8);
+	strcat(theTemporaryPathUTF8, ".XXXXXX");
+
+	//	mkstemp() replaces the X's to create and open a file with a unique name.
+	theFile = mkstemp(theTemporaryPathUTF8);
+	if (theFile == -1)
+	{
+		theErrorMessage = u"Couldn't create file in WriteFileContents().";
+		goto CleanUpWriteFileContents;
+	}
+	theTemporaryFileExists = true;
+
+	//	mkstemp() lets only the file's owner read it.
+	if (fchmod(theFile, 0644) != 0)
+	{
+		theErrorMessage = u"Couldn't set file permissions in WriteFileContents().";
+		goto CleanUpWriteFileContents;
+	}
+
+	theNumBytesRemaining = aNumBytes;
+	while (theNumBytesRemaining > 0)
+	{
+		theNumBytesWritten = write(theFile, someBytes + (aNumBytes - theNumBytesRemaining), theNumBytesRemaining);
+		if (theNumBytesWritten <= 0)
+		{
+			theErrorMessage = u"Couldn't write file in WriteFileContents().";
+			goto CleanUpWriteFileContents;
+		}
+		theNumBytesRemaining -= (size_t) theNumBytesWritten;
+	}
+
+	close(theFile);
+	theFile = -1;
+
+	if (rename(theTemporaryPathUTF8, thePathUTF8) != 0)
+	{
+		theErrorMessage = u"Couldn't rename file in WriteFileContents().";
+		goto CleanUpWriteFileContents;
+	}
+	theTemporaryFileExists = false;
+
+CleanUpWriteFileContents:
+
+	if (theFile != -1)
+		close(theFile);
+	if (theTemporaryFileExists)
+		unlink(theTemporaryPathUTF8);
+
+#endif
+
+	return theErrorMessage;
+}
+
+
 void GetBevelBytes(
 	Byte			aBaseColor[3],		//	{R,G,B}
 	unsigned int	anImageWidthPx,		//	in pixels, not points
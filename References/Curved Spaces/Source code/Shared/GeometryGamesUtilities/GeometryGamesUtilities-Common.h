@@ -13,57 +13,23 @@
 
 #include "GeometryGames-Common.h"
 
-#if defined(__ANDROID__) || defined(__MAC_OS_X_VERSION_MIN_REQUIRED)
-//	The Android and Mac OS apps render in a separate thread,
-//	so we must ensure that their access to gMemCount is threadsafe.
-#define THREADSAFE_MEM_COUNT
-#elif defined(__WIN32__) || defined(__IPHONE_OS_VERSION_MIN_REQUIRED)
-//	The Windows and iOS apps render in the main thread,
-//	so they may access gMemCount with no mutex.
-#else
-#error When adding support for a new operating system,\
- please indicate whether gMemCount access must be threadsafe or not.
-#endif
-
-#ifdef THREADSAFE_MEM_COUNT
-#include <pthread.h>
-#endif
-
-
 //	Define GET_MEMORY and FREE_MEMORY macros to manage memory so
 //	that in future we can easily change memory allocation schemes.
 //	Use a variable gMemCount to test for memory leaks.
 //	Define FREE_MEMORY_SAFELY() to test for and set NULL pointers.
-#ifdef THREADSAFE_MEM_COUNT
-
-//	compiling for Android or Mac OS
-#define GET_MEMORY(n)			(											\
-									pthread_mutex_lock(&gMemCountMutex),	\
-									gMemCount++,							\
-									pthread_mutex_unlock(&gMemCountMutex),	\
-									malloc(n)								\
-								)
-#define FREE_MEMORY(p)			(											\
-									pthread_mutex_lock(&gMemCountMutex),	\
-									gMemCount--,							\
-									pthread_mutex_unlock(&gMemCountMutex),	\
-									free(p)									\
-								)
-extern pthread_mutex_t	gMemCountMutex;
-
-#else
-
-//	compiling for iOS or Win32
+//
+//	Secondary threads -- a space loader, say, or RunJobsInParallel()'s jobs --
+//	may allocate and free memory while the main thread does the same,
+//	so on every platform IncrementMemCount() and DecrementMemCount()
+//	update gMemCount atomically.
 #define GET_MEMORY(n)			(											\
-									gMemCount++,							\
+									IncrementMemCount(),					\
 									malloc(n)								\
 								)
 #define FREE_MEMORY(p)			(											\
-									gMemCount--,							\
+									DecrementMemCount(),					\
 									free(p)									\
 								)
-
-#endif
 #define RESIZE_MEMORY(p,n)		(realloc(p,n))
 #define FREE_MEMORY_SAFELY(p)	{if ((p) != NULL) {FREE_MEMORY(p); (p) = NULL;}}
 extern signed int		gMemCount;
@@ -107,10 +73,21 @@ typedef enum
 	TextureAlpha
 } TextureFormat;
 
+//	RunJobsInParallel() runs at most MAX_PARALLEL_JOBS jobs at once.
+#define MAX_PARALLEL_JOBS	16
+
+//	The MutexLock's contents are platform-dependent and private.
+typedef struct MutexLock	MutexLock;
+
+//	The JoinableThread's contents are platform-dependent and private.
+typedef struct JoinableThread	JoinableThread;
+
 
 //	Functions with platform-independent non-OpenGL implementations
 //	appear in GeometryGamesUtilities-Common.c.
 
+extern void			IncrementMemCount(void);
+extern void			DecrementMemCount(void);
 extern bool			IsPowerOfTwo(unsigned int n);
 extern bool			UTF8toUTF16(const char	*aInputStringUTF8, Char16 *anOutputBufferUTF16, unsigned int anOutputBufferLength);
 extern bool			UTF16toUTF8(const Char16 *anInputStringUTF16, char *anOutputBufferUTF8, unsigned int anOutputBufferLength);
@@ -124,6 +101,9 @@ extern void			FreeImageRGBA(ImageRGBA **anImage);
 
 extern ErrorText	GetFileContents(const Char16 *aDirectory, const Char16 *aFileName, unsigned int *aNumRawBytes, Byte **someRawBytes);
 extern void			FreeFileContents(unsigned int *aNumRawBytes, Byte **someRawBytes);
+extern ErrorText	MapFileContents(const Char16 *aPathName, size_t *aNumBytes, const Byte **someBytes, void **aMapping);
+extern void			UnmapFileContents(size_t *aNumBytes, const Byte **someBytes, void **aMapping);
+extern ErrorText	WriteFileContents(const Char16 *aPathName, size_t aNumBytes, const Byte *someBytes);
 
 extern void			InvertRawImage(unsigned int aWidth, unsigned int aHeight, PixelRGBA *aPixelBuffer);
 
@@ -143,7 +123,17 @@ extern unsigned int	RandomInteger(void);
 extern float		RandomFloat(void);
 
 extern void			StartNewThread(ModelData *md, void (*aStartFuction)(ModelData *));
+extern ErrorText	StartNewThreadWithData(void (*aStartFuction)(void *), void *aThreadData, JoinableThread **aThread);
+extern void			WaitForThread(JoinableThread **aThread);
+extern void			DetachThread(JoinableThread **aThread);
 extern void			SleepBriefly(void);
+extern unsigned int	GetNumProcessors(void);
+extern void			RunJobsInParallel(unsigned int aNumJobs, void (*aJobFunction)(void *), void **someJobData);
+extern MutexLock	*CreateMutexLock(void);
+extern void			FreeMutexLock(MutexLock **aMutexLock);
+extern void			LockMutex(MutexLock *aMutexLock);
+extern bool			TryLockMutex(MutexLock *aMutexLock);
+extern void			UnlockMutex(MutexLock *aMutexLock);
 
 extern void			GetBevelBytes(
 						Byte aBaseColor[3],
@@ -0,0 +1,1036 @@
+//	CurvedSpacesBatch.c
+//
+//	A headless command-line tool that computes the Dirichlet domain
+//	of every generator file (*.gen) in a directory tree.
+//	It opens no window and needs no OpenGL context, so it may run
+//	on a build server or over ssh.  It processes the files in parallel,
+//	one file per processor core, and then reports, for each file
+//	in alphabetical order,
+//
+//		- the space type and the tiling radius that sufficed,
+//		- the Dirichlet domain's vertex, edge and face counts,
+//		- each face's pairing matrix and mate face, and
+//		- the computation time.
+//
+//	On request it also reports how much work and memory
+//	the tiling took, and how much numerical error it accumulated.
+//
+//	On request it also spells each face-pairing matrix
+//	as a word in the generators.
+//
+//	On request it also constructs the Dirichlet domain centered
+//	at another basepoint, and checks ConstructDirichletDomainAtBasepoint()
+//	against ConstructDirichletDomain() along the way.
+//
+//	On request it also exports each Dirichlet domain's mesh,
+//	both as a Curved Spaces mesh image (.csmesh) and
+//	as a binary glTF file (.glb), into a parallel directory tree.
+//
+//	Usage:
+//
+//		CurvedSpacesBatch [-r max-tiling-radius] [-j max-jobs]
+//			[-o output-directory] [-a aperture] [-b x,y,z] [-s] [-w] directory
+//
+//	The exit status is 0 if every file succeeded, 1 if any file failed,
+//	or 2 if the command line itself was faulty.
+//
+//	This file also supplies console versions of the handful of
+//	platform-dependent functions that the platform-independent code
+//	expects, in place of the GeometryGamesUtilities-<platform> file
+//	that each app provides.  See "Read Me.txt" for build instructions.
+//
+//	© 2016 by Jeff Weeks
+//	See TermsOfUse.txt
+
+#include "CurvedSpaces-Common.h"
+#include "GeometryGamesUtilities-Common.h"
+#include "GeometryGamesLocalization.h"
+#include <stdio.h>
+#include <stdlib.h>	//	for qsort(), strtod(), strtoul()
+#include <string.h>
+#include <dirent.h>	//	for opendir(), readdir()
+#include <sys/stat.h>	//	for stat(), mkdir()
+#include <errno.h>
+#include <time.h>	//	for clock_gettime()
+
+//	__cdecl isn't defined or needed on MacOS X,
+//	so make it disappear from our callback function prototypes.
+#ifndef __cdecl
+#define __cdecl
+#endif
+
+
+//	Tile no deeper than this unless the user says otherwise.
+//	LoadGenerators() tiles the largest hyperbolic spaces to 5.5,
+//	so 6.0 leaves some room to spare.
+#define DEFAULT_MAX_TILING_RADIUS	6.0
+
+//	Path names may be long, but needn't be unlimited.
+#define BATCH_PATH_LENGTH			4096
+
+//	Export each face with no window unless the user says otherwise.
+#define DEFAULT_EXPORT_APERTURE		0.0
+
+//	Two Dirichlet domains agree if their face-pairing matrices
+//	agree to within this tolerance.  Conjugating a group element
+//	by a basepoint placement and back costs a few ulps at most,
+//	so genuinely different face pairings differ by far more.
+#define FACE_PAIRING_EPSILON		1e-8
+
+
+//	Each generator file gets a BatchFile.
+//	The worker thread that processes the file fills in the results,
+//	and the main thread reports them once all workers have finished.
+typedef struct
+{
+	char			itsPathName[BATCH_PATH_LENGTH];		//	UTF-8
+	char			*itsRelativePathName;				//	points into itsPathName
+
+	ErrorText		itsErrorMessage;
+	SpaceType		itsSpaceType;
+	double			itsTilingRadius;
+	DirichletDomain	*itsDirichletDomain;				//	NULL for the 3-sphere or an error
+	double			itsSeconds;
+
+	//	The statistics get filled in only if the user asks for them.
+	TilingStatistics	itsStatistics;
+
+	//	The group elements and their words get kept
+	//	only if the user asks for the words.
+	MatrixList		*itsHolonomyGroup;
+	TileWord		*itsWords;							//	indexed like itsHolonomyGroup
+
+	//	The following fields get filled in only
+	//	if the user asks for another basepoint.
+	ErrorText		itsBasepointErrorMessage;
+	DirichletDomain	*itsBasepointDomain;				//	NULL for the 3-sphere or an error
+	bool			itsOriginMatches,					//	matches itsDirichletDomain
+					itsWarmStartMatches;				//	matches itsBasepointDomain
+} BatchFile;
+
+//	The worker threads share a BatchQueue.
+//	Each worker repeatedly takes the next unclaimed file,
+//	so a slow file never holds up the others.
+typedef struct
+{
+	MutexLock		*itsLock;
+	unsigned int	itsNextFile;		//	protected by itsLock
+
+	unsigned int	itsNumFiles;
+	BatchFile		*itsFiles;
+	double			itsMaxTilingRadius;
+	bool			itsStatisticsFlag;
+	bool			itsWordsFlag;
+	bool			itsBasepointFlag;
+	double			itsBasepoint[3];	//	used only if itsBasepointFlag is true
+} BatchQueue;
+
+
+static bool			CollectGeneratorFiles(const char *aDirectory, BatchFile **someFiles, unsigned int *aNumFiles, unsigned int *anArraySize);
+static bool			HasGeneratorFileExtension(const char *aFileName);
+static __cdecl signed int	CompareBatchFiles(const void *p1, const void *p2);
+static void			ProcessFiles(void *aBatchQueue);
+static void			ProcessOneFile(BatchFile *aFile, double aMaxTilingRadius, bool aStatisticsFlag, bool aWordsFlag, const double *aBasepoint);
+static void			ProcessBasepoint(BatchFile *aFile, MatrixList *aHolonomyGroup, const double aBasepoint[3]);
+static bool			SameFacePairings(const DirichletDomain *aDirichletDomainA, const DirichletDomain *aDirichletDomainB);
+static bool			ParseBasepoint(const char *aString, double aBasepoint[3]);
+static ErrorText	ReadWholeFile(const char *aPathName, Byte **someBytes);
+static double		CurrentTime(void);
+static void			ReportFile(BatchFile *aFile, bool aStatisticsFlag, bool aWordsFlag, bool aBasepointFlag);
+static void			PrintFaceWord(BatchFile *aFile, Matrix *aFacePairing);
+static bool			FileSucceeded(BatchFile *aFile, bool aBasepointFlag);
+static bool			ExportFile(BatchFile *aFile, const char *anOutputDirectory, double anAperture);
+static bool			ExportImage(const char *aPathName, const char *anExtension, ErrorText (*anExporter)(const DirichletDomain *, double, bool, bool, size_t *, Byte **), const DirichletDomain *aDirichletDomain, double anAperture);
+static bool			MakeParentDirectories(char *aPathName, size_t aBaseLength);
+static const char	*SpaceTypeName(SpaceType aSpaceType);
+static void			PrintErrorText(FILE *aStream, ErrorText anErrorText);
+
+
+int main(
+	int		argc,
+	char	**argv)
+{
+	int				theExitStatus		= 2;
+	double			theMaxTilingRadius	= DEFAULT_MAX_TILING_RADIUS,
+					theAperture			= DEFAULT_EXPORT_APERTURE;
+	unsigned int	theMaxNumJobs		= MAX_PARALLEL_JOBS,
+					theNumJobs,
+					theNumFiles			= 0,
+					theArraySize		= 0,
+					theNumFailures,
+					i;
+	char			*theDirectory		= NULL,
+					*theOutputDirectory	= NULL;
+	size_t			theDirectoryLength;
+	char			*theStoppingPoint;
+	BatchFile		*theFiles			= NULL;
+	bool			theStatisticsFlag	= false,
+					theWordsFlag		= false,
+					theBasepointFlag	= false;
+	double			theBasepoint[3]		= {0.0, 0.0, 0.0};
+	BatchQueue		theQueue			= {NULL, 0, 0, NULL, 0.0, false, false, false, {0.0, 0.0, 0.0}};
+	void			*theJobData[MAX_PARALLEL_JOBS];
+
+	//	Parse the command line.
+	for (i = 1; i < (unsigned int) argc; i++)
+	{
+		if (strcmp(argv[i], "-r") == 0 && i + 1 < (unsigned int) argc)
+		{
+			theMaxTilingRadius = strtod(argv[++i], &theStoppingPoint);
+			if (*theStoppingPoint != 0 || theMaxTilingRadius <= 0.0)
+				goto UsageError;
+		}
+		else
+		if (strcmp(argv[i], "-j") == 0 && i + 1 < (unsigned int) argc)
+		{
+			theMaxNumJobs = (unsigned int) strtoul(argv[++i], &theStoppingPoint, 10);
+			if (*theStoppingPoint != 0 || theMaxNumJobs == 0)
+				goto UsageError;
+		}
+		else
+		if (strcmp(argv[i], "-o") == 0 && i + 1 < (unsigned int) argc)
+		{
+			theOutputDirectory = argv[++i];
+		}
+		else
+		if (strcmp(argv[i], "-a") == 0 && i + 1 < (unsigned int) argc)
+		{
+			theAperture = strtod(argv[++i], &theStoppingPoint);
+			if (*theStoppingPoint != 0 || theAperture < 0.0 || theAperture >= 1.0)
+				goto UsageError;
+		}
+		else
+		if (strcmp(argv[i], "-b") == 0 && i + 1 < (unsigned int) argc)
+		{
+			if ( ! ParseBasepoint(argv[++i], theBasepoint) )
+				goto UsageError;
+			theBasepointFlag = true;
+		}
+		else
+		if (strcmp(argv[i], "-s") == 0)
+		{
+			theStatisticsFlag = true;
+		}
+		else
+		if (strcmp(argv[i], "-w") == 0)
+		{
+			theWordsFlag = true;
+		}
+		else
+		if (argv[i][0] != '-' && theDirectory == NULL)
+		{
+			theDirectory = argv[i];
+		}
+		else
+			goto UsageError;
+	}
+	if (theDirectory == NULL)
+		goto UsageError;
+
+	//	Ignore any trailing slashes, so the relative path names come out clean.
+	theDirectoryLength = strlen(theDirectory);
+	while (theDirectoryLength > 1 && theDirectory[theDirectoryLength - 1] == '/')
+		theDirectory[--theDirectoryLength] = 0;
+
+	//	Find all generator files, and sort them
+	//	so the report comes out in a predictable order.
+	if ( ! CollectGeneratorFiles(theDirectory, &theFiles, &theNumFiles, &theArraySize) )
+	{
+		fprintf(stderr, "Couldn't read the directory tree %s\n", theDirectory);
+		goto CleanUpMain;
+	}
+	if (theNumFiles == 0)
+	{
+		fprintf(stderr, "Found no .gen files in %s\n", theDirectory);
+		goto CleanUpMain;
+	}
+	qsort(theFiles, theNumFiles, sizeof(BatchFile), CompareBatchFiles);
+
+	//	Now that the array won't move again -- neither reallocated
+	//	nor sorted -- it's safe to point each relative path name
+	//	into its own full path name.
+	for (i = 0; i < theNumFiles; i++)
+		theFiles[i].itsRelativePathName = theFiles[i].itsPathName + theDirectoryLength + 1;
+
+	//	Process the files on as many threads as there are processor cores,
+	//	within the limits of RunJobsInParallel() and the user's request.
+	theNumJobs = GetNumProcessors();
+	if (theNumJobs > MAX_PARALLEL_JOBS)
+		theNumJobs = MAX_PARALLEL_JOBS;
+	if (theNumJobs > theMaxNumJobs)
+		theNumJobs = theMaxNumJobs;
+	if (theNumJobs > theNumFiles)
+		theNumJobs = theNumFiles;
+
+	theQueue.itsLock = CreateMutexLock();
+	if (theQueue.itsLock == NULL)
+	{
+		fprintf(stderr, "Couldn't create a mutex lock\n");
+		goto CleanUpMain;
+	}
+	theQueue.itsNextFile		= 0;
+	theQueue.itsNumFiles		= theNumFiles;
+	theQueue.itsFiles			= theFiles;
+	theQueue.itsMaxTilingRadius	= theMaxTilingRadius;
+	theQueue.itsStatisticsFlag	= theStatisticsFlag;
+	theQueue.itsWordsFlag		= theWordsFlag;
+	theQueue.itsBasepointFlag	= theBasepointFlag;
+	for (i = 0; i < 3; i++)
+		theQueue.itsBasepoint[i] = theBasepoint[i];
+
+	for (i = 0; i < theNumJobs; i++)
+		theJobData[i] = &theQueue;
+	RunJobsInParallel(theNumJobs, ProcessFiles, theJobData);
+
+	//	Report the results, and export the meshes if requested.
+	theNumFailures = 0;
+	for (i = 0; i < theNumFiles; i++)
+	{
+		ReportFile(&theFiles[i], theStatisticsFlag, theWordsFlag, theBasepointFlag);
+		if ( ! FileSucceeded(&theFiles[i], theBasepointFlag) )
+			theNumFailures++;
+		else
+		if (theOutputDirectory != NULL
+		 && ! ExportFile(&theFiles[i], theOutputDirectory, theAperture))
+			theNumFailures++;
+	}
+	printf("%u files, %u failed\n", theNumFiles, theNumFailures);
+
+	theExitStatus = (theNumFailures == 0) ? 0 : 1;
+
+CleanUpMain:
+
+	if (theFiles != NULL)
+	{
+		for (i = 0; i < theNumFiles; i++)
+		{
+			FreeDirichletDomain(&theFiles[i].itsDirichletDomain);
+			FreeDirichletDomain(&theFiles[i].itsBasepointDomain);
+			FreeMatrixList(&theFiles[i].itsHolonomyGroup);
+			FREE_MEMORY_SAFELY(theFiles[i].itsWords);
+		}
+		FREE_MEMORY(theFiles);
+	}
+	FreeMutexLock(&theQueue.itsLock);
+
+	return theExitStatus;
+
+UsageError:
+
+	fprintf(stderr, "Usage:  %s [-r max-tiling-radius] [-j max-jobs] [-o output-directory] [-a aperture] [-b x,y,z] [-s] [-w] directory\n", argv[0]);
+	return 2;
+}
+
+
+static bool CollectGeneratorFiles(
+	const char		*aDirectory,	//	input,  UTF-8
+	BatchFile		**someFiles,	//	input and output, may be reallocated
+	unsigned int	*aNumFiles,		//	input and output
+	unsigned int	*anArraySize)	//	input and output
+{
+	DIR				*theDirectory;
+	struct dirent	*theEntry;
+	char			thePathName[BATCH_PATH_LENGTH];
+	struct stat		theStatus;
+	BatchFile		*theNewArray;
+	bool			theResult	= true;
+
+	//	Recursively add every generator file in aDirectory to someFiles,
+	//	growing the array as needed.
+
+	theDirectory = opendir(aDirectory);
+	if (theDirectory == NULL)
+		return false;
+
+	while ((theEntry = readdir(theDirectory)) != NULL)
+	{
+		//	Skip hidden files, along with "." and "..".
+		if (theEntry->d_name[0] == '.')
+			continue;
+
+		if (snprintf(thePathName, sizeof(thePathName), "%s/%s", aDirectory, theEntry->d_name)
+				>= (int) sizeof(thePathName))
+			continue;	//	path too long -- ignore it
+
+		if (stat(thePathName, &theStatus) != 0)
+			continue;
+
+		if (S_ISDIR(theStatus.st_mode))
+		{
+			if ( ! CollectGeneratorFiles(thePathName, someFiles, aNumFiles, anArraySize) )
+			{
+				theResult = false;
+				break;
+			}
+		}
+		else
+		if (S_ISREG(theStatus.st_mode) && HasGeneratorFileExtension(theEntry->d_name))
+		{
+			if (*aNumFiles == *anArraySize)
+			{
+				*anArraySize = (*anArraySize > 0) ? 2 * *anArraySize : 64;
+				theNewArray = (*someFiles == NULL) ?
+								GET_MEMORY(*anArraySize * sizeof(BatchFile)) :
+								RESIZE_MEMORY(*someFiles, *anArraySize * sizeof(BatchFile));
+				if (theNewArray == NULL)
+				{
+					theResult = false;
+					break;
+				}
+				*someFiles = theNewArray;
+			}
+
+			strcpy((*someFiles)[*aNumFiles].itsPathName, thePathName);
+			(*someFiles)[*aNumFiles].itsRelativePathName	= NULL;	//	set once the array stops moving
+			(*someFiles)[*aNumFiles].itsErrorMessage		= NULL;
+			(*someFiles)[*aNumFiles].itsSpaceType			= SpaceNone;
+			(*someFiles)[*aNumFiles].itsTilingRadius		= 0.0;
+			(*someFiles)[*aNumFiles].itsDirichletDomain		= NULL;
+			(*someFiles)[*aNumFiles].itsSeconds				= 0.0;
+			(*someFiles)[*aNumFiles].itsStatistics			= (TilingStatistics) {0, 0, 0, 0, 0.0};
+			(*someFiles)[*aNumFiles].itsHolonomyGroup		= NULL;
+			(*someFiles)[*aNumFiles].itsWords				= NULL;
+			(*someFiles)[*aNumFiles].itsBasepointErrorMessage	= NULL;
+			(*someFiles)[*aNumFiles].itsBasepointDomain			= NULL;
+			(*someFiles)[*aNumFiles].itsOriginMatches			= false;
+			(*someFiles)[*aNumFiles].itsWarmStartMatches		= false;
+			(*aNumFiles)++;
+		}
+	}
+
+	closedir(theDirectory);
+
+	return theResult;
+}
+
+static bool HasGeneratorFileExtension(const char *aFileName)
+{
+	size_t	theLength;
+
+	theLength = strlen(aFileName);
+
+	return theLength > 4 && strcmp(aFileName + theLength - 4, ".gen") == 0;
+}
+
+static __cdecl signed int CompareBatchFiles(
+	const void	*p1,
+	const void	*p2)
+{
+	return strcmp(((BatchFile *)p1)->itsPathName, ((BatchFile *)p2)->itsPathName);
+}
+
+
+static void ProcessFiles(void *aBatchQueue)
+{
+	BatchQueue		*theQueue;
+	unsigned int	theFile;
+
+	theQueue = (BatchQueue *) aBatchQueue;
+
+	while (true)
+	{
+		LockMutex(theQueue->itsLock);
+		theFile = theQueue->itsNextFile;
+		if (theFile < theQueue->itsNumFiles)
+			theQueue->itsNextFile++;
+		UnlockMutex(theQueue->itsLock);
+
+		if (theFile >= theQueue->itsNumFiles)
+			break;
+
+		ProcessOneFile(	&theQueue->itsFiles[theFile],
+						theQueue->itsMaxTilingRadius,
+						theQueue->itsStatisticsFlag,
+						theQueue->itsWordsFlag,
+						theQueue->itsBasepointFlag ? theQueue->itsBasepoint : NULL);
+	}
+}
+
+static void ProcessOneFile(
+	BatchFile		*aFile,
+	double			aMaxTilingRadius,
+	bool			aStatisticsFlag,
+	bool			aWordsFlag,
+	const double	*aBasepoint)		//	3 coordinates, or NULL
+{
+	Byte		*theBytes			= NULL;
+	double		theStartTime;
+
+	aFile->itsErrorMessage = ReadWholeFile(aFile->itsPathName, &theBytes);
+	if (aFile->itsErrorMessage != NULL)
+		goto CleanUpProcessOneFile;
+
+	theStartTime = CurrentTime();
+
+	aFile->itsErrorMessage = ComputeDirichletDomainFromFile(	theBytes,
+																aMaxTilingRadius,
+																&aFile->itsSpaceType,
+																&aFile->itsTilingRadius,
+																&aFile->itsDirichletDomain,
+																aWordsFlag || aBasepoint != NULL ? &aFile->itsHolonomyGroup : NULL,
+																aWordsFlag ? &aFile->itsWords : NULL,
+																aStatisticsFlag ? &aFile->itsStatistics : NULL);
+
+	aFile->itsSeconds = CurrentTime() - theStartTime;
+
+	if (aFile->itsErrorMessage == NULL
+	 && aBasepoint != NULL)
+		ProcessBasepoint(aFile, aFile->itsHolonomyGroup, aBasepoint);
+
+	//	Keep the group elements only if ReportFile() will need them
+	//	to look up the words.
+	if ( ! aWordsFlag )
+		FreeMatrixList(&aFile->itsHolonomyGroup);
+
+CleanUpProcessOneFile:
+
+	FREE_MEMORY_SAFELY(theBytes);
+}
+
+static void ProcessBasepoint(
+	BatchFile		*aFile,
+	MatrixList		*aHolonomyGroup,
+	const double	aBasepoint[3])
+{
+	Matrix			theIdentity,
+					theBasepointPlacement;
+	DirichletDomain	*theOriginDomain	= NULL,
+					*theWarmDomain		= NULL;
+
+	//	Construct the Dirichlet domain centered at the image of (0,0,0,1)
+	//	under a translation by aBasepoint, and check
+	//	ConstructDirichletDomainAtBasepoint() two ways:
+	//
+	//		- At the origin, given an explicit identity placement
+	//			so that it conjugates and re-sorts the group,
+	//			it should reproduce ConstructDirichletDomain()'s domain.
+	//
+	//		- Seeded with the domain at the origin,
+	//			it should reproduce the domain it constructs from scratch.
+	//
+	//	The 3-sphere has no Dirichlet domain, so there's nothing to check.
+
+	if (aFile->itsDirichletDomain == NULL)
+		return;
+
+	MatrixIdentity(&theIdentity);
+	aFile->itsBasepointErrorMessage = ConstructDirichletDomainAtBasepoint(	aHolonomyGroup,
+																			&theIdentity,
+																			NULL,
+																			&theOriginDomain);
+	if (aFile->itsBasepointErrorMessage != NULL)
+		goto CleanUpProcessBasepoint;
+	aFile->itsOriginMatches = SameFacePairings(aFile->itsDirichletDomain, theOriginDomain);
+
+	MatrixTranslation(&theBasepointPlacement, aFile->itsSpaceType, aBasepoint[0], aBasepoint[1], aBasepoint[2]);
+
+	aFile->itsBasepointErrorMessage = ConstructDirichletDomainAtBasepoint(	aHolonomyGroup,
+																			&theBasepointPlacement,
+																			NULL,
+																			&aFile->itsBasepointDomain);
+	if (aFile->itsBasepointErrorMessage != NULL)
+		goto CleanUpProcessBasepoint;
+
+	aFile->itsBasepointErrorMessage = ConstructDirichletDomainAtBasepoint(	aHolonomyGroup,
+																			&theBasepointPlacement,
+																			aFile->itsDirichletDomain,
+																			&theWarmDomain);
+	if (aFile->itsBasepointErrorMessage != NULL)
+		goto CleanUpProcessBasepoint;
+	aFile->itsWarmStartMatches = SameFacePairings(aFile->itsBasepointDomain, theWarmDomain);
+
+CleanUpProcessBasepoint:
+
+	if (aFile->itsBasepointErrorMessage != NULL)
+		FreeDirichletDomain(&aFile->itsBasepointDomain);
+
+	FreeDirichletDomain(&theOriginDomain);
+	FreeDirichletDomain(&theWarmDomain);
+}
+
+static bool SameFacePairings(
+	const DirichletDomain	*aDirichletDomainA,
+	const DirichletDomain	*aDirichletDomainB)
+{
+	unsigned int	theNumVerticesA,
+					theNumEdgesA,
+					theNumFacesA,
+					theNumVerticesB,
+					theNumEdgesB,
+					theNumFacesB,
+					theMateFace,
+					i,
+					j;
+	Matrix			theFacePairingA,
+					theFacePairingB;
+
+	//	Two constructions of the same Dirichlet domain may list
+	//	its faces in different orders, so match each face of A
+	//	with whichever face of B has the same face-pairing matrix.
+
+	GetDirichletDomainCounts(aDirichletDomainA, &theNumVerticesA, &theNumEdgesA, &theNumFacesA);
+	GetDirichletDomainCounts(aDirichletDomainB, &theNumVerticesB, &theNumEdgesB, &theNumFacesB);
+	if (theNumVerticesA	!= theNumVerticesB
+	 || theNumEdgesA	!= theNumEdgesB
+	 || theNumFacesA	!= theNumFacesB)
+		return false;
+
+	for (i = 0; i < theNumFacesA; i++)
+	{
+		if ( ! GetDirichletFacePairing(aDirichletDomainA, i, &theFacePairingA, &theMateFace) )
+			return false;
+
+		for (j = 0; j < theNumFacesB; j++)
+		{
+			if (GetDirichletFacePairing(aDirichletDomainB, j, &theFacePairingB, &theMateFace)
+			 && MatrixEquality(&theFacePairingA, &theFacePairingB, FACE_PAIRING_EPSILON))
+				break;
+		}
+		if (j == theNumFacesB)
+			return false;
+	}
+
+	return true;
+}
+
+static bool ParseBasepoint(
+	const char	*aString,		//	input, "x,y,z"
+	double		aBasepoint[3])	//	output
+{
+	const char		*theCursor;
+	char			*theStoppingPoint;
+	unsigned int	i;
+
+	theCursor = aString;
+	for (i = 0; i < 3; i++)
+	{
+		aBasepoint[i] = strtod(theCursor, &theStoppingPoint);
+		if (theStoppingPoint == theCursor
+		 || *theStoppingPoint != (i < 2 ? ',' : 0))
+			return false;
+		theCursor = theStoppingPoint + 1;
+	}
+
+	return true;
+}
+
+static ErrorText ReadWholeFile(
+	const char	*aPathName,	//	input,  UTF-8
+	Byte		**someBytes)	//	output, zero-terminated
+{
+	ErrorText	theErrorMessage	= NULL;
+	FILE		*theFile		= NULL;
+	long		theFileSize;
+
+	//	ComputeDirichletDomainFromFile() wants a zero-terminated,
+	//	writable copy of the file's contents.
+
+	theFile = fopen(aPathName, "rb");
+	if (theFile == NULL)
+	{
+		theErrorMessage = u"Couldn't open file.";
+		goto CleanUpReadWholeFile;
+	}
+
+	if (fseek(theFile, 0, SEEK_END) != 0
+	 || (theFileSize = ftell(theFile)) < 0
+	 || fseek(theFile, 0, SEEK_SET) != 0)
+	{
+		theErrorMessage = u"Couldn't get file size.";
+		goto CleanUpReadWholeFile;
+	}
+
+	*someBytes = GET_MEMORY(theFileSize + 1);
+	if (*someBytes == NULL)
+	{
+		theErrorMessage = u"Couldn't allocate memory for file contents.";
+		goto CleanUpReadWholeFile;
+	}
+
+	if (fread(*someBytes, 1, theFileSize, theFile) != (size_t) theFileSize)
+	{
+		theErrorMessage = u"Couldn't read file.";
+		goto CleanUpReadWholeFile;
+	}
+	(*someBytes)[theFileSize] = 0;
+
+CleanUpReadWholeFile:
+
+	if (theFile != NULL)
+		fclose(theFile);
+
+	if (theErrorMessage != NULL)
+		FREE_MEMORY_SAFELY(*someBytes);
+
+	return theErrorMessage;
+}
+
+static double CurrentTime(void)	//	in seconds
+{
+	struct timespec	theTime;
+
+	clock_gettime(CLOCK_MONOTONIC, &theTime);
+
+	return (double) theTime.tv_sec + 1e-9 * (double) theTime.tv_nsec;
+}
+
+
+static void ReportFile(
+	BatchFile	*aFile,
+	bool		aStatisticsFlag,
+	bool		aWordsFlag,
+	bool		aBasepointFlag)
+{
+	unsigned int	theNumVertices,
+					theNumEdges,
+					theNumFaces,
+					theMateFace,
+					i,
+					j,
+					k;
+	Matrix			theFacePairing;
+
+	//	Report one file's results in a simple line-oriented format:
+	//
+	//		file <relative path name>
+	//		error <message>
+	//	or
+	//		file <relative path name>
+	//		space <type>  radius <r>  vertices <v>  edges <e>  faces <f>  time <t>
+	//		tiling  tiles <n>  chunks <c>  allocations <a>  bytes <b>  deviation <d>
+	//		face <i>  mate <j>  matrix <16 entries, row by row>
+	//		word <generators>
+	//		...
+	//		basepoint  vertices <v>  edges <e>  faces <f>  origin <same|different>  warm <same|different>
+	//
+	//	with the tiling, word and basepoint lines only if the user asked for them,
+	//	and "basepoint error <message>" if the basepoint couldn't be computed.
+	//
+	printf("file %s\n", aFile->itsRelativePathName);
+
+	if (aFile->itsErrorMessage != NULL)
+	{
+		printf("error ");
+		PrintErrorText(stdout, aFile->itsErrorMessage);
+		printf("\n");
+		return;
+	}
+
+	GetDirichletDomainCounts(aFile->itsDirichletDomain, &theNumVertices, &theNumEdges, &theNumFaces);
+
+	printf("space %s  radius %.3f  vertices %u  edges %u  faces %u  time %.6f\n",
+		SpaceTypeName(aFile->itsSpaceType),
+		aFile->itsTilingRadius,
+		theNumVertices,
+		theNumEdges,
+		theNumFaces,
+		aFile->itsSeconds);
+
+	if (aStatisticsFlag)
+		printf("tiling  tiles %u  chunks %u  allocations %u  bytes %zu  deviation %.3g\n",
+			aFile->itsStatistics.itsNumTiles,
+			aFile->itsStatistics.itsNumChunks,
+			aFile->itsStatistics.itsNumAllocations,
+			aFile->itsStatistics.itsNumBytes,
+			aFile->itsStatistics.itsMaxDeviation);
+
+	for (i = 0; i < theNumFaces; i++)
+	{
+		if ( ! GetDirichletFacePairing(aFile->itsDirichletDomain, i, &theFacePairing, &theMateFace) )
+			break;
+
+		printf("face %u  mate %u  matrix", i, theMateFace);
+		for (j = 0; j < 4; j++)
+			for (k = 0; k < 4; k++)
+				printf(" %.17g", theFacePairing.m[j][k]);
+		printf("\n");
+
+		if (aWordsFlag)
+			PrintFaceWord(aFile, &theFacePairing);
+	}
+
+	if (aBasepointFlag && aFile->itsDirichletDomain != NULL)
+	{
+		if (aFile->itsBasepointErrorMessage != NULL)
+		{
+			printf("basepoint error ");
+			PrintErrorText(stdout, aFile->itsBasepointErrorMessage);
+			printf("\n");
+		}
+		else
+		{
+			GetDirichletDomainCounts(aFile->itsBasepointDomain, &theNumVertices, &theNumEdges, &theNumFaces);
+			printf("basepoint  vertices %u  edges %u  faces %u  origin %s  warm %s\n",
+				theNumVertices,
+				theNumEdges,
+				theNumFaces,
+				aFile->itsOriginMatches    ? "same" : "different",
+				aFile->itsWarmStartMatches ? "same" : "different");
+		}
+	}
+}
+
+static void PrintFaceWord(
+	BatchFile	*aFile,
+	Matrix		*aFacePairing)
+{
+	unsigned int	theElement,
+					i;
+
+	//	Print the face-pairing matrix as a word in the generators,
+	//	numbered from 0 in the order the generator file lists them,
+	//	with "g2^-1" standing for the inverse of generator 2:
+	//
+	//		word g0 g2^-1 g1
+	//
+	//	Each group element is its generator times its parent,
+	//	so following the parents back to the identity
+	//	spells the word from left to right.
+
+	for (theElement = 0; theElement < aFile->itsHolonomyGroup->itsNumMatrices; theElement++)
+		if (MatrixEquality(aFacePairing, &aFile->itsHolonomyGroup->itsMatrices[theElement], FACE_PAIRING_EPSILON))
+			break;
+
+	printf("word");
+
+	if (theElement == aFile->itsHolonomyGroup->itsNumMatrices)
+		printf(" unknown");
+	else
+	if (aFile->itsWords[theElement].itsParent == TILE_WORD_NO_PARENT)
+		printf(" 1");
+	else
+	{
+		for (i = theElement; aFile->itsWords[i].itsParent != TILE_WORD_NO_PARENT; i = aFile->itsWords[i].itsParent)
+			printf(" g%u%s", aFile->itsWords[i].itsGenerator, aFile->itsWords[i].itsInverseFlag ? "^-1" : "");
+	}
+
+	printf("\n");
+}
+
+static bool FileSucceeded(
+	BatchFile	*aFile,
+	bool		aBasepointFlag)
+{
+	//	A requested basepoint counts as part of the file's work,
+	//	so a failed check counts as a failure.
+
+	if (aFile->itsErrorMessage != NULL)
+		return false;
+
+	if (aBasepointFlag && aFile->itsDirichletDomain != NULL)
+		return aFile->itsBasepointErrorMessage == NULL
+			&& aFile->itsOriginMatches
+			&& aFile->itsWarmStartMatches;
+
+	return true;
+}
+
+static bool ExportFile(
+	BatchFile	*aFile,
+	const char	*anOutputDirectory,	//	UTF-8
+	double		anAperture)
+{
+	char	thePathName[BATCH_PATH_LENGTH];
+	size_t	theBaseLength,
+			theLength;
+
+	//	Write <output directory>/<relative path minus ".gen">.csmesh and .glb,
+	//	creating subdirectories as needed.
+	//	The 3-sphere has no Dirichlet domain, so there's nothing to export.
+
+	if (aFile->itsDirichletDomain == NULL)
+		return true;
+
+	theBaseLength = strlen(anOutputDirectory);
+	if (snprintf(thePathName, sizeof(thePathName), "%s/%s", anOutputDirectory, aFile->itsRelativePathName)
+			>= (int) sizeof(thePathName))
+	{
+		printf("export error path name too long\n");
+		return false;
+	}
+	theLength = strlen(thePathName);
+	thePathName[theLength - 4] = 0;	//	remove ".gen"
+
+	if ( ! MakeParentDirectories(thePathName, theBaseLength) )
+	{
+		printf("export error couldn't create directory for %s\n", thePathName);
+		return false;
+	}
+
+	return ExportImage(thePathName, ".csmesh", WriteDirichletMeshImage, aFile->itsDirichletDomain, anAperture)
+		&& ExportImage(thePathName, ".glb",    WriteDirichletGLB,       aFile->itsDirichletDomain, anAperture);
+}
+
+static bool ExportImage(
+	const char				*aPathName,		//	UTF-8, without extension
+	const char				*anExtension,
+	ErrorText				(*anExporter)(const DirichletDomain *, double, bool, bool, size_t *, Byte **),
+	const DirichletDomain	*aDirichletDomain,
+	double					anAperture)
+{
+	bool		theResult	= false;
+	char		theFileName[BATCH_PATH_LENGTH];
+	size_t		theNumBytes	= 0;
+	Byte		*theBytes	= NULL;
+	ErrorText	theErrorMessage;
+	FILE		*theFile	= NULL;
+
+	if (snprintf(theFileName, sizeof(theFileName), "%s%s", aPathName, anExtension)
+			>= (int) sizeof(theFileName))
+	{
+		printf("export error path name too long\n");
+		goto CleanUpExportImage;
+	}
+
+	//	Export with color coding, as the app shows by default.
+	theErrorMessage = (*anExporter)(aDirichletDomain, anAperture, true, false, &theNumBytes, &theBytes);
+	if (theErrorMessage != NULL)
+	{
+		printf("export error ");
+		PrintErrorText(stdout, theErrorMessage);
+		printf("\n");
+		goto CleanUpExportImage;
+	}
+
+	theFile = fopen(theFileName, "wb");
+	if (theFile == NULL
+	 || fwrite(theBytes, 1, theNumBytes, theFile) != theNumBytes)
+	{
+		printf("export error couldn't write %s\n", theFileName);
+		goto CleanUpExportImage;
+	}
+
+	theResult = true;
+
+CleanUpExportImage:
+
+	if (theFile != NULL)
+		fclose(theFile);
+	FREE_MEMORY_SAFELY(theBytes);
+
+	return theResult;
+}
+
+static bool MakeParentDirectories(
+	char	*aPathName,		//	UTF-8;  temporarily modified, but restored
+	size_t	aBaseLength)	//	the first aBaseLength bytes name the output directory
+{
+	size_t	i;
+	bool	theResult	= true;
+
+	//	Create the output directory itself along with every directory
+	//	in aPathName below it.  An existing directory is fine.
+
+	for (i = aBaseLength; aPathName[i] != 0 && theResult; i++)
+	{
+		if (aPathName[i] == '/')
+		{
+			aPathName[i] = 0;
+			if (mkdir(aPathName, 0777) != 0 && errno != EEXIST)
+				theResult = false;
+			aPathName[i] = '/';
+		}
+	}
+
+	return theResult;
+}
+
+static const char *SpaceTypeName(SpaceType aSpaceType)
+{
+	switch (aSpaceType)
+	{
+		case SpaceSpherical:	return "spherical";
+		case SpaceFlat:			return "flat";
+		case SpaceHyperbolic:	return "hyperbolic";
+		default:				return "none";
+	}
+}
+
+static void PrintErrorText(
+	FILE		*aStream,
+	ErrorText	anErrorText)
+{
+	char	theErrorTextUTF8[1024];
+	size_t	i;
+
+	if (UTF16toUTF8(anErrorText, theErrorTextUTF8, BUFFER_LENGTH(theErrorTextUTF8)))
+	{
+		//	Keep the report line-oriented.
+		for (i = 0; theErrorTextUTF8[i] != 0; i++)
+			if (theErrorTextUTF8[i] == '\n')
+				theErrorTextUTF8[i] = ' ';
+
+		fprintf(aStream, "%s", theErrorTextUTF8);
+	}
+	else
+		fprintf(aStream, "(error message too long)");
+}
+
+
+//	Console versions of platform-dependent functions.
+//	Each app supplies its own versions in GeometryGamesUtilities-<platform>,
+//	GeometryGamesLocalization.c and its OpenGL files,
+//	but the code that this tool uses needs only the following.
+
+ErrorText GetFileContents(
+	const Char16	*aDirectory,	//	input,  zero-terminated UTF-16 string, may be NULL
+	const Char16	*aFileName,		//	input,  zero-terminated UTF-16 string, may be NULL
+	unsigned int	*aNumRawBytes,	//	output, the file size in bytes
+	Byte			**someRawBytes)	//	output, the file's contents as raw bytes
+{
+	//	The tool has no application bundle, and thus no resources.
+
+	UNUSED_PARAMETER(aDirectory);
+	UNUSED_PARAMETER(aFileName);
+
+	*aNumRawBytes	= 0;
+	*someRawBytes	= NULL;
+
+	return u"CurvedSpacesBatch has no resource files.";
+}
+
+void FreeFileContents(
+	unsigned int	*aNumRawBytes,	//	may be NULL
+	Byte			**someRawBytes)
+{
+	if (aNumRawBytes != NULL)
+		*aNumRawBytes = 0;
+
+	FREE_MEMORY_SAFELY(*someRawBytes);
+}
+
+void FatalError(
+	ErrorText	aMessage,	//	UTF-16, may be NULL
+	ErrorText	aTitle)		//	UTF-16, may be NULL
+{
+	fprintf(stderr, "Fatal error:  ");
+	if (aTitle != NULL)
+	{
+		PrintErrorText(stderr, aTitle);
+		fprintf(stderr, ":  ");
+	}
+	if (aMessage != NULL)
+		PrintErrorText(stderr, aMessage);
+	fprintf(stderr, "\n");
+
+	exit(2);
+}
+
+bool IsCurrentLanguage(const Char16 aTwoLetterLanguageCode[3])
+{
+	//	The tool writes its reports in English only.
+	return SameString16(aTwoLetterLanguageCode, u"en");
+}
+
+ErrorText GetErrorString(void)
+{
+	//	The tool never creates an OpenGL context,
+	//	so OpenGL can't have reported any errors.
+	return NULL;
+}
+
+void SendModelViewMatrixToShader(double aModelViewMatrix[4][4])
+{
+	//	The tool draws nothing.
+	UNUSED_PARAMETER(aModelViewMatrix);
+}
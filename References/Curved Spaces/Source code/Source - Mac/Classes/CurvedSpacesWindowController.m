@@ -352,13 +352,10 @@ static bool					OpenContainingDirectoriesAndSelectItem(NSOutlineView *anOutlineV
 
 	[itsModel lockModelData:&md];
 
+	//	No need to request a VBO update:  SetUpGraphicsAsNeeded()
+	//	will notice the change and rebuild the Dirichlet domain's VBO alone.
 	SetShowColorCoding(md, ! md->itsShowColorCoding );
 
-	//	Request updates to OpenGL(ES) resources before unlocking the ModelData,
-	//	to ensure that the rendering code finds the ModelData and the GraphicsDataGL
-	//	in a consistent state.
-	[itsCurvedSpacesView requestVBOUpdate];
-
 	[itsModel unlockModelData:&md];
 }
 
@@ -915,6 +912,22 @@ static bool OpenContainingDirectoriesAndSelectItem(
 	unsigned int	theFileSize		= 0;
 	Byte			*theRawBytes	= NULL;
 	ModelData		*md				= NULL;
+	NSString		*theCacheDirectory;
+	Char16			theCacheDirectoryBuffer[CACHE_DIRECTORY_BUFFER_LENGTH];
+
+	//	Keep cached tilings in the user's Caches folder.
+	theCacheDirectory = [[NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES) firstObject]
+							stringByAppendingPathComponent:@"Curved Spaces"];
+	if (theCacheDirectory != nil
+	 && [theCacheDirectory length] < CACHE_DIRECTORY_BUFFER_LENGTH
+	 && [[NSFileManager defaultManager] createDirectoryAtPath:theCacheDirectory
+			withIntermediateDirectories:YES attributes:nil error:NULL])
+	{
+		[theCacheDirectory getCharacters:theCacheDirectoryBuffer range:(NSRange){0, [theCacheDirectory length]}];
+		theCacheDirectoryBuffer[[theCacheDirectory length]] = 0;
+	}
+	else
+		theCacheDirectoryBuffer[0] = 0;	//	disables the cache
 
 	//	Read the file's raw bytes.
 	theRawData = [NSData dataWithContentsOfFile:aFilePath];
@@ -937,6 +950,7 @@ static bool OpenContainingDirectoriesAndSelectItem(
 
 	//	Try to parse the file.
 	[itsModel lockModelData:&md];
+	SetCacheDirectory(md, theCacheDirectoryBuffer);
 	theError = LoadGeneratorFile(md, theRawBytes);
 		//	Test for theErrorMessage != NULL follows below.
 		//
@@ -11,6 +11,7 @@
 #include "GeometryGamesUtilities-Win.h"
 #include "GeometryGamesLocalization.h"
 #include <commdlg.h>
+#include <shlobj.h>		//	for SHGetFolderPath()
 
 
 //	Command IDs
@@ -346,6 +347,7 @@ static bool SetUpWindowData(
 	HWND	aWindow)
 {
 	WindowData	*wd;
+	Char16		theCacheDirectory[MAX_PATH];
 
 	//	Attempt to allocate the WindowData.
 	wd = GET_MEMORY(sizeof(WindowData));
@@ -388,6 +390,15 @@ static bool SetUpWindowData(
 	//	Initialize the model's internal data.
 	SetUpModelData(&wd->md);
 
+	//	Keep cached tilings in the user's local application data folder.
+	//	SHGetFolderPath() requires a buffer of length MAX_PATH.
+	if (SHGetFolderPath(NULL, CSIDL_LOCAL_APPDATA | CSIDL_FLAG_CREATE, NULL, 0 /* = SHGFP_TYPE_CURRENT */, theCacheDirectory) == S_OK
+	 && Strcat16(theCacheDirectory, BUFFER_LENGTH(theCacheDirectory), u"/Curved Spaces"))
+	{
+		CreateDirectory(theCacheDirectory, NULL);	//	fails harmlessly if the directory already exists
+		SetCacheDirectory(&wd->md, theCacheDirectory);
+	}
+
 #ifdef SUPPORT_OPENGL
 
 	//	Give the GeometryGamesWindowData
@@ -569,8 +580,9 @@ static void MenuCommand(
 			break;
 
 		case IDC_VIEW_COLOR_CODING:
+			//	SetUpGraphicsAsNeeded() will notice the change
+			//	and rebuild the Dirichlet domain's VBO alone.
 			SetShowColorCoding(&wd->md, ! wd->md.itsShowColorCoding );
-			wd->gd.itsPreparedVBOs		= false;
 			break;
 
 		case IDC_VIEW_CLIFFORD_NONE:
@@ -166,8 +166,15 @@ typedef enum
 #define USER_SPEED_INCREMENT	0.02
 
 
-//	Opaque typedef
-typedef struct HEPolyhedron	DirichletDomain;
+//	Space cache files live in a directory whose absolute path
+//	fits in a buffer of this many Char16s, including the terminating zero.
+#define CACHE_DIRECTORY_BUFFER_LENGTH	1024
+
+
+//	Opaque typedefs
+typedef struct HEPolyhedron		DirichletDomain;
+typedef struct TilingInProgress	TilingInProgress;
+typedef struct SpaceLoader		SpaceLoader;
 
 
 //	Transparent typedefs
@@ -203,20 +210,105 @@ typedef struct
 	Matrix			*itsMatrices;
 } MatrixList;
 
-//	Technical note:  Why does a Honeycell use a Dirichlet domain's
-//	full set of vertices instead of a bounding box?
+//	ConstructHolonomyGroup() may optionally report
+//	how much work and memory the construction required,
+//	and how far numerical error has pushed the group elements
+//	out of O(4), Isom(E³) or O(3,1).  Measuring that error is costly,
+//	so a tiling measures it only if BeginTiling() was asked to;
+//	otherwise itsMaxDeviation stays 0.0.
+typedef struct
+{
+	unsigned int	itsNumTiles,			//	number of group elements found
+					itsNumChunks,			//	number of large blocks holding the Tiles
+					itsNumAllocations;		//	total number of allocations (chunks, arrays and hash tables)
+	size_t			itsNumBytes;			//	bytes held at the end of the construction
+	double			itsMaxDeviation;		//	largest error in any inner product of two rows
+} TilingStatistics;
+
+//	A secondary thread running a long computation may let the computation
+//	poll a CancelTest, to learn whether the main thread has lost interest
+//	in the result.  itsTestFunction returns true to request cancellation,
+//	and must be safe to call from whatever thread runs the computation.
+typedef struct
+{
+	bool	(*itsTestFunction)(void *aTestData);
+	void	*itsTestData;
+} CancelTest;
+
+//	ConstructHolonomyGroup() and ExtendTiling() may optionally report,
+//	for each group element, how the breadth-first search first reached it:
+//	the element equals the generator (or its inverse) times the parent element.
+//	itsParent indexes the group elements in the order reported,
+//	counting from the start of the first ExtendTiling() call,
+//	so a parent always precedes its children.  The identity has
+//	itsParent = TILE_WORD_NO_PARENT and itsDepth = 0.
+//	itsDepth is the length of the word leading back to the identity.
+#define TILE_WORD_NO_PARENT	0xFFFFFFFF
+typedef struct
+{
+	unsigned int	itsParent,		//	index of parent element
+					itsDepth;		//	word length
+	unsigned short	itsGenerator;	//	index into the caller's generator list
+	bool			itsInverseFlag;	//	was it the generator's inverse?
+} TileWord;
+
+//	A space cache image records the Dirichlet domain and honeycomb
+//	that LoadGenerators() computed for a given set of generators
+//	and tiling radius.  itsKey identifies the generators and radius.
+typedef struct
+{
+	uint64_t	itsKey;
+	SpaceType	itsSpaceType;
+	bool		itsDrawBackHemisphere,
+				itsThreeSphereFlag;
+} SpaceCacheInfo;
+
+//	Technical note:  Why does the Honeycomb record each cell's images
+//	of a Dirichlet domain's full set of vertices instead of a bounding box?
 //	1.	For the most common manifolds, the number of vertices is fairly small.
 //	2.	Computing a bounding box is a small nuisance when the fundamental domain
 //		may extend as far as -- or even into -- the southern hemisphere of S³,
 //		as happens with lens spaces and slab spaces.
+//
+//	A Honeycell holds only what SortVisibleCells() reads for every cell,
+//	so that the culling pass streams through one compact array.
+//	The cell's matrix, needed only once the cell is known to be visible,
+//	and its vertex images, needed only for cells that straddle
+//	the view frustum's boundary, live in the Honeycomb's parallel arrays
+//	itsCellMatrices and itsCellVertices.  The Honeycell's itsMatrix
+//	points to its entry in itsCellMatrices; the cell owns no memory
+//	of its own.
 typedef struct
 {
-	Matrix			itsMatrix;
-	Vector			itsCenter,
-					*itsVertices;
-	unsigned int	itsNumVertices;
-	double			itsDistance;	//	distance from origin to cell center after applying view matrix
+	Vector			itsCenter;
+	double			itsClipMargin,	//	encodes the radius of a ball about itsCenter containing the cell
+									//		(see ClipMargin()), or INFINITY if unknown
+					itsDistance;	//	distance from origin to cell center after applying view matrix
+	Matrix			*itsMatrix;		//	points into the Honeycomb's itsCellMatrices
+	unsigned int	itsVisibleFrame;	//	last frame in which SortVisibleCells() found the cell visible
 } Honeycell;
+
+//	A HoneycombNode bounds a subtree of the honeycomb's
+//	bounding-ball hierarchy.  Its cells' centers all lie within
+//	itsCenterRadius of itsCenter, measured in the space's own geometry,
+//	so SortVisibleCells() may reject the whole subtree with one distance test.
+//	The cells themselves lie within a slightly larger ball, whose radius
+//	is encoded as itsClipMargin (see ClipMargin() in CurvedSpacesDirichlet.c)
+//	for a one-test-per-plane frustum check.
+//	The node's cells are itsNodeCells[itsFirstCell] through
+//	itsNodeCells[itsFirstCell + itsNumCells - 1].  An interior node's
+//	first child immediately follows it in the node array;
+//	itsSecondChild is 0 for a leaf.
+typedef struct
+{
+	Vector			itsCenter;
+	double			itsCenterRadius,
+					itsClipMargin;
+	unsigned int	itsFirstCell,
+					itsNumCells,
+					itsSecondChild;
+} HoneycombNode;
+
 typedef struct
 {
 	//	A fixed list of the cells, sorted relative
@@ -224,10 +316,37 @@ typedef struct
 	unsigned int	itsNumCells;
 	Honeycell		*itsCells;
 
-	//	At render time, make a temporary list of the visible cells
+	//	Each cell's matrix and vertex images, indexed like itsCells.
+	//	itsCellVertices holds itsNumCellVertices images per cell,
+	//	each as 4 floats (not doubles) normalized to unit length in R⁴.
+	//	Any positive multiple of a vertex would serve equally well
+	//	for clipping, and the normalization keeps the floats' rounding errors
+	//	uniformly small, so CellMayBeVisible() may absorb them
+	//	with a fixed CELL_VERTEX_TOLERANCE of 1e-6
+	//	(see CurvedSpacesDirichlet.c).
+	Matrix			*itsCellMatrices;
+	unsigned int	itsNumCellVertices;
+	float			*itsCellVertices;
+
+	//	A bounding-ball hierarchy over the cells, rooted at itsNodes[0].
+	//	itsNodeCells lists the cell indices, permuted so that
+	//	each node's cells are contiguous.  If itsNodes is NULL,
+	//	SortVisibleCells() simply tests every cell.
+	SpaceType		itsSpaceType;
+	unsigned int	itsNumNodes;
+	HoneycombNode	*itsNodes;
+	unsigned int	*itsNodeCells;
+
+	//	At render time, make a list of the visible cells
 	//	and sort them according to their distance from the observer.
+	//	The list persists from one frame to the next, so SortVisibleCells()
+	//	may start from the previous frame's order.
 	unsigned int	itsNumVisibleCells;
 	Honeycell		**itsVisibleCells;
+	unsigned int	itsFrameNumber;
+
+	//	Scratch space for SortVisibleCells(), as large as itsVisibleCells.
+	Honeycell		**itsScratchCells;
 } Honeycomb;
 
 typedef enum
@@ -373,6 +492,17 @@ struct ModelData
 	//	the whole finite group.  For all manifolds the list
 	//	is sorted near-to-far. 
 	Honeycomb		*itsHoneycomb;
+
+	//	While a secondary thread tiles the rest of a newly loaded space,
+	//	itsSpaceLoader lets us adopt each deeper honeycomb as it becomes
+	//	available.  Otherwise itsSpaceLoader is NULL.
+	SpaceLoader		*itsSpaceLoader;
+
+	//	If the platform-dependent code provides a writable directory,
+	//	LoadGenerators() keeps a cache file there for each space it computes,
+	//	so it may later reopen the same space without recomputing it.
+	//	An empty string disables the cache.
+	Char16			itsCacheDirectory[CACHE_DIRECTORY_BUFFER_LENGTH];
 	
 	//	The aperture in each face of the Dirichlet domain may be
 	//	fully closed (0.0), fully open (1.0), or anywhere in between.
@@ -485,6 +615,7 @@ extern void			SetShowHantzscheWendtAxes(ModelData *md, bool aShowHantzscheWendtA
 
 //	in CurvedSpacesSimulation.c
 extern void			ChangeAperture(ModelData *md, bool aDilationFlag);
+extern const double	*MetricCoefficients(SpaceType aSpaceType, bool aTimelikeFlag);
 extern void			FastGramSchmidt(Matrix *aMatrix, SpaceType aSpaceType);
 
 //	in CurvedSpacesMouse.c
@@ -492,9 +623,17 @@ extern void			MouseMoved(ModelData *md, DisplayPoint aMouseLocation, DisplayPoin
 
 //	in CurvedSpacesFileIO.c
 extern ErrorText	LoadGeneratorFile(ModelData *md, Byte *anInputText);
+extern ErrorText	ComputeDirichletDomainFromFile(Byte *anInputText, double aMaxTilingRadius, SpaceType *aSpaceType, double *aTilingRadius, DirichletDomain **aDirichletDomain, MatrixList **aHolonomyGroup, TileWord **someWords, TilingStatistics *aStatistics);
+extern void			AdoptLoadedSpace(ModelData *md);
+extern void			CancelSpaceLoader(SpaceLoader **aSpaceLoader, bool aWaitFlag);
+extern void			SetCacheDirectory(ModelData *md, const Char16 *aCacheDirectory);
 
 //	in CurvedSpacesTiling.c
-extern ErrorText	ConstructHolonomyGroup(MatrixList *aGeneratorList, double aTilingRadius, MatrixList **aHolonomyGroup);
+extern ErrorText	ConstructHolonomyGroup(MatrixList *aGeneratorList, double aTilingRadius, bool aRenormalizeFlag, MatrixList **aHolonomyGroup, TileWord **someWords, TilingStatistics *aStatistics);
+extern ErrorText	BeginTiling(MatrixList *aGeneratorList, bool aRenormalizeFlag, bool aDeviationFlag, TilingInProgress **aTiling);
+extern ErrorText	ExtendTiling(TilingInProgress *aTiling, double aTilingRadius, MatrixList **someNewElements, TileWord **someNewWords, TilingStatistics *aStatistics, const CancelTest *aCancelTest);
+extern ErrorText	CompleteFiniteTiling(TilingInProgress *aTiling);
+extern void			FreeTiling(TilingInProgress **aTiling);
 extern ErrorText	NeedsBackHemisphere(MatrixList *aHolonomyGroup, SpaceType aSpaceType, bool *aDrawBackHemisphereFlag);
 
 //	in CurvedSpacesGraphics-OpenGL.c
@@ -502,18 +641,29 @@ extern void			SendModelViewMatrixToShader(double aModelViewMatrix[4][4]);
 
 //	in CurvedSpacesDirichlet.c
 extern ErrorText	ConstructDirichletDomain(MatrixList *aHolonomyGroup, DirichletDomain **aDirichletDomain);
+extern ErrorText	ConstructDirichletDomainAtBasepoint(MatrixList *aHolonomyGroup, Matrix *aBasepointPlacement, const DirichletDomain *aNearbyDomain, DirichletDomain **aDirichletDomain);
+extern ErrorText	ConjugateHolonomyGroup(MatrixList *aHolonomyGroup, Matrix *aBasepointPlacement, MatrixList **aConjugatedGroup);
+extern DirichletDomain	*RetainDirichletDomain(DirichletDomain *aDirichletDomain);
 extern void			FreeDirichletDomain(DirichletDomain **aDirichletDomain);
-extern void			StayInDirichletDomain(DirichletDomain *aDirichletDomain, Matrix *aPlacement);
-extern ErrorText	ConstructHoneycomb(MatrixList *aHolonomyGroup, DirichletDomain *aDirichletDomain, Honeycomb **aHoneycomb);
+extern double		DirichletDomainCircumradius(const DirichletDomain *aDirichletDomain);
+extern void			GetDirichletDomainCounts(const DirichletDomain *aDirichletDomain, unsigned int *aNumVertices, unsigned int *aNumEdges, unsigned int *aNumFaces);
+extern bool			GetDirichletFacePairing(const DirichletDomain *aDirichletDomain, unsigned int aFace, Matrix *aFacePairing, unsigned int *aMateFace);
+extern void			StayInDirichletDomain(const DirichletDomain *aDirichletDomain, Matrix *aPlacement);
+extern ErrorText	ConstructHoneycomb(MatrixList *aHolonomyGroup, const DirichletDomain *aDirichletDomain, Honeycomb **aHoneycomb);
+extern ErrorText	ExtendHoneycomb(Honeycomb *aHoneycomb, MatrixList *someNewElements, const DirichletDomain *aDirichletDomain);
 extern void			FreeHoneycomb(Honeycomb **aHoneycomb);
-extern ErrorText	MakeDirichletVBO(GLuint aVertexBufferName, GLuint anIndexBufferName, DirichletDomain *aDirichletDomain, double anAperture, bool aColorCodingFlag, bool aGreyscaleFlag);
+extern ErrorText	WriteSpaceCacheImage(SpaceCacheInfo *aSpaceCacheInfo, const DirichletDomain *aDirichletDomain, Honeycomb *aHoneycomb, size_t *aNumBytes, Byte **someBytes);
+extern ErrorText	ReadSpaceCacheImage(const Byte *someBytes, size_t aNumBytes, SpaceCacheInfo *aSpaceCacheInfo, DirichletDomain **aDirichletDomain, Honeycomb **aHoneycomb);
+extern ErrorText	WriteDirichletMeshImage(const DirichletDomain *aDirichletDomain, double anAperture, bool aColorCodingFlag, bool aGreyscaleFlag, size_t *aNumBytes, Byte **someBytes);
+extern ErrorText	WriteDirichletGLB(const DirichletDomain *aDirichletDomain, double anAperture, bool aColorCodingFlag, bool aGreyscaleFlag, size_t *aNumBytes, Byte **someBytes);
+extern ErrorText	MakeDirichletVBO(GLuint aVertexBufferName, GLuint anIndexBufferName, const DirichletDomain *aDirichletDomain, double anAperture, bool aColorCodingFlag, bool aGreyscaleFlag);
 extern void			MakeDirichletVAO(GLuint aVertexArrayName, GLuint aVertexBufferName, GLuint anIndexBufferName);
 extern void			BindDirichletVAO(GLuint aVertexArrayName);
-extern void			DrawDirichletVAO(GLuint aDirichletTexture, DirichletDomain *aDirichletDomain, Honeycomb *aHoneycomb, Matrix *aWorldPlacement, double aCurrentAperture);
-extern void			MakeVertexFiguresVBO(GLuint aVertexBufferName, GLuint anIndexBufferName, DirichletDomain *aDirichletDomain);
+extern void			DrawDirichletVAO(GLuint aDirichletTexture, const DirichletDomain *aDirichletDomain, Honeycomb *aHoneycomb, Matrix *aWorldPlacement, double aCurrentAperture);
+extern void			MakeVertexFiguresVBO(GLuint aVertexBufferName, GLuint anIndexBufferName, const DirichletDomain *aDirichletDomain);
 extern void			MakeVertexFiguresVAO(GLuint aVertexArrayName, GLuint aVertexBufferName, GLuint anIndexBufferName);
 extern void			BindVertexFiguresVAO(GLuint aVertexArrayName);
-extern void			DrawVertexFiguresVAO(GLuint aVertexFigureTexture, DirichletDomain *aDirichletDomain, Honeycomb *aHoneycomb, Matrix *aWorldPlacement);
+extern void			DrawVertexFiguresVAO(GLuint aVertexFigureTexture, const DirichletDomain *aDirichletDomain, Honeycomb *aHoneycomb, Matrix *aWorldPlacement);
 extern void			SortVisibleCells(Honeycomb *aHoneycomb, Matrix *aViewProjectionMatrix, Matrix *aViewMatrix, double aDrawingRadius);
 
 //	in CurvedSpacesEarth.c
@@ -41,7 +41,11 @@
 #include "CurvedSpacesGraphics-OpenGL.h"
 #include <stddef.h>	//	for offsetof()
 #include <math.h>
+#include <float.h>	//	for DBL_EPSILON
 #include <stdlib.h>	//	for qsort()
+#include <string.h>	//	for memcpy()
+#include <stdio.h>	//	for vsnprintf()
+#include <stdarg.h>	//	for va_list
 
 
 //	Three vectors will be considered linearly independent iff their
@@ -61,11 +65,26 @@
 //	of a cyclic matrix?
 #define ORDER_EPSILON			1e-6
 
+//	How nearly must a tilted lens space's generators preserve the circle
+//	where the lens's two faces meet?  The generators' matrices are exact
+//	for a lens centered on the z-axis, but pick up roundoff error
+//	when ConstructDirichletDomainAtBasepoint() moves the basepoint.
+#define LENS_AXIS_EPSILON		1e-6
+
 //	How well must a vertex satisfy a halfspace equation
 //	to be considered lying on that halfspace's boundary?
 //	(I HAVEN'T THOUGHT CAREFULLY ABOUT THIS VALUE.)
 #define VERTEX_HALFSPACE_EPSILON	1e-6
 
+//	ClassifyVertices() evaluates each halfspace inequality in ordinary
+//	floating point, but if the result lands within roundoff error
+//	of ±VERTEX_HALFSPACE_EPSILON it re-evaluates the inequality exactly.
+//	A four-term dot product computed in double precision has relative
+//	error at most about 4 DBL_EPSILON/2 (relative to the sum of the terms'
+//	absolute values);  the bound used here is comfortably larger,
+//	to also absorb the roundoff in the comparison itself.
+#define DOT_PRODUCT_ERROR_BOUND	(8.0 * DBL_EPSILON)
+
 //	Matching faces should have equal matrices to pretty high precision.
 //	Nevertheless, we can safely choose a large value here, since *all*
 //	matrix entries must agree to that precision.
@@ -77,6 +96,88 @@
 //	we don't want to be flipping back and forth.
 #define RESTORING_EPSILON		1e-8
 
+//	StayInDirichletDomain() needn't test the object's position
+//	against every face.  Instead it looks up the object's direction
+//	from the basepoint in a cube map with FACE_LOOKUP_RESOLUTION²
+//	cells on each of the cube's six sides.  Each cell lists the faces
+//	that are visible from the basepoint in the cell's directions,
+//	with an angular margin of FACE_LOOKUP_MARGIN radians for safety.
+#define FACE_LOOKUP_RESOLUTION	4
+#define FACE_LOOKUP_NUM_CELLS	(6 * FACE_LOOKUP_RESOLUTION * FACE_LOOKUP_RESOLUTION)
+#define FACE_LOOKUP_MARGIN		1e-3
+
+//	Each restoration brings the object closer to the basepoint,
+//	so a handful of restorations always suffices in practice.
+//	The limit merely guards against an infinite loop.
+#define MAX_RESTORATIONS		32
+
+//	ConstructDirichletDomain() skips a group element without testing it
+//	against the provisional domain's vertices when the element's bisecting
+//	halfspace clears the domain's bounding ball by at least this margin.
+//	The margin need only absorb roundoff error, but it must comfortably
+//	exceed VERTEX_HALFSPACE_EPSILON's effect, so that a skipped element
+//	is one that IntersectWithHalfspace() would have left unchanged anyway.
+#define CULLING_EPSILON			1e-6
+
+//	A Dirichlet domain's basepoint must not be fixed by any group element
+//	other than the identity.  ConstructDirichletDomainAtBasepoint()
+//	rejects a basepoint whose image under some other element
+//	lies within this distance of (0,0,0,1) in R⁴.
+#define FIXED_BASEPOINT_EPSILON	1e-6
+
+//	ConstructDirichletDomain() splits a large holonomy group among
+//	several parallel jobs, but only when each job gets at least
+//	this many group elements.  Each extra job must re-discover
+//	the domain's nearby faces before it can skip the distant elements,
+//	and for some groups that costs far more than the distant elements
+//	themselves.  For example, with each space tiled to radius 6,
+//	the Mirrored Dodecahedron's 60137 elements took 1.7 ms as one job
+//	but 8 ms as four jobs, even counting only the slowest job,
+//	while Hyperbolic First's 271151 elements took 4.8 ms as one job
+//	but only 2.7 ms as eight.
+#define MIN_ELEMENTS_PER_CUTTING_JOB	32768
+
+//	ConstructDirichletDomain() uses one cutting job
+//	per MIN_ELEMENTS_PER_CUTTING_JOB group elements, up to this many,
+//	regardless of the number of processors, so that a given group
+//	yields the same domain -- with the same vertices, half edges and faces
+//	in the same order -- on every computer.  A computer with fewer cores
+//	simply runs some of the jobs one after another.
+#define NUM_CUTTING_JOBS	MAX_PARALLEL_JOBS
+
+//	SortVisibleCells() culls the honeycomb one subtree at a time.
+//	Each leaf of the bounding-ball hierarchy holds at most
+//	HONEYCOMB_LEAF_CELLS cells.  Splitting at the median keeps
+//	the hierarchy's depth well below HONEYCOMB_MAX_DEPTH.
+//	HONEYCOMB_BALL_EPSILON pads each bounding ball to absorb roundoff,
+//	so that the hierarchy never rejects a cell that the per-cell tests
+//	would have kept.
+#define HONEYCOMB_LEAF_CELLS		4
+#define HONEYCOMB_MAX_DEPTH			64
+#define HONEYCOMB_BALL_EPSILON		1e-6
+
+//	A honeycomb stores its cells' vertex images as unit-length floats,
+//	each of whose coordinates may be off by a relative 2^-24 ≈ 6e-8.
+//	CellMayBeVisible() lets a vertex sit up to CELL_VERTEX_TOLERANCE
+//	times a clipping plane's Euclidean normal length beyond the plane
+//	before excluding it, so the floats never make it reject a cell
+//	that exact vertex images would have kept.
+#define CELL_VERTEX_TOLERANCE		1e-6
+
+//	SortVisibleCells() re-sorts last frame's visible cells
+//	with an insertion sort, but switches to a radix sort if the
+//	insertion sort would need more than this many shifts per cell.
+#define MAX_VISIBLE_CELL_SHIFTS_PER_CELL	8
+
+//	SortVisibleCells() splits a large honeycomb among several
+//	parallel jobs, but only when each job gets at least this many cells,
+//	so that the work justifies the cost of starting a thread.
+//	The jobs share CULLING_ROOTS_PER_JOB subtrees apiece (on average),
+//	so that no single job gets stuck with all the visible cells.
+#define MIN_CELLS_PER_CULLING_JOB	4096
+#define CULLING_ROOTS_PER_JOB		8
+#define MAX_CULLING_ROOTS			(2 * CULLING_ROOTS_PER_JOB * MAX_PARALLEL_JOBS)
+
 //	How many times should the face texture repeat across a single quad?
 #define FACE_TEXTURE_MULTIPLE_PLAIN	6
 #define FACE_TEXTURE_MULTIPLE_WOOD	1
@@ -87,6 +188,66 @@
 //	How large a hole should get cut the face of a vertex figure?
 #define VERTEX_FIGURE_CUTOUT	0.7	//	as fraction of face size
 
+//	The Dirichlet domain's vertex, half edge and face arrays
+//	start with room for MIN_HE_ARRAY_SIZE components apiece,
+//	and double in size whenever they fill up.  A Dirichlet domain
+//	has at most a few hundred components, so MAX_HE_ARRAY_SIZE
+//	is merely a safeguard against runaway growth.
+#define MIN_HE_ARRAY_SIZE		64
+#define MAX_HE_ARRAY_SIZE		0x00FFFFFF
+
+//	An array index that refers to no component at all.
+#define HE_NO_INDEX				0xFFFFFFFF
+
+//	A space cache image begins with an 8-byte signature and a format version.
+//	Increment SPACE_CACHE_VERSION whenever the layout below changes,
+//	so older cache files get ignored rather than misread.
+#define SPACE_CACHE_SIGNATURE		"CrvSpace"
+#define SPACE_CACHE_VERSION			3
+
+//	Every record in a space cache image has a fixed size,
+//	a multiple of 8 bytes, so all doubles stay 8-byte aligned.
+#define SPACE_CACHE_HEADER_BYTES	64
+#define SPACE_CACHE_VECTOR_BYTES	(4 * 8)
+#define SPACE_CACHE_MATRIX_BYTES	(16 * 8 + 4 + 4)
+#define SPACE_CACHE_VERTEX_BYTES	(3 * SPACE_CACHE_VECTOR_BYTES + 4 + 4)
+#define SPACE_CACHE_HALFEDGE_BYTES	(4 * 4 + 2 * 8 + 2 * SPACE_CACHE_VECTOR_BYTES)
+#define SPACE_CACHE_FACE_BYTES		(4 + 4 + SPACE_CACHE_VECTOR_BYTES + SPACE_CACHE_MATRIX_BYTES + 4 * 8 + 8 + 2 * SPACE_CACHE_VECTOR_BYTES)
+#define SPACE_CACHE_CELL_BYTES		(SPACE_CACHE_MATRIX_BYTES + SPACE_CACHE_VECTOR_BYTES)
+#define SPACE_CACHE_CELL_VERTEX_BYTES	(4 * 4)
+
+//	Flags for the space cache header
+#define SPACE_CACHE_FLAG_BACK_HEMISPHERE	0x00000001
+#define SPACE_CACHE_FLAG_THREE_SPHERE		0x00000002
+#define SPACE_CACHE_FLAG_HAS_DOMAIN			0x00000004
+
+//	A Dirichlet mesh image (see WriteDirichletMeshImage()) follows
+//	the same conventions:  a signature, a format version,
+//	fixed-size little-endian records, and doubles at 8-byte aligned offsets.
+#define DIRICHLET_MESH_SIGNATURE		"CrvSMesh"
+#define DIRICHLET_MESH_VERSION			1
+#define DIRICHLET_MESH_HEADER_BYTES		48
+#define DIRICHLET_MESH_FACE_BYTES		(6 * 4 + SPACE_CACHE_MATRIX_BYTES)
+#define DIRICHLET_MESH_VERTEX_BYTES		((4 + 2 + 4) * 4)
+#define DIRICHLET_MESH_INDEX_BYTES		2
+
+//	Flags for the Dirichlet mesh header
+#define DIRICHLET_MESH_FLAG_COLOR_CODING	0x00000001
+#define DIRICHLET_MESH_FLAG_GREYSCALE		0x00000002
+
+//	A binary glTF file has a 12-byte header followed by
+//	a JSON chunk and a binary chunk, each with an 8-byte chunk header
+//	and each padded to a multiple of 4 bytes.
+#define GLB_MAGIC					0x46546C67	//	"glTF"
+#define GLB_VERSION					2
+#define GLB_CHUNK_TYPE_JSON			0x4E4F534A	//	"JSON"
+#define GLB_CHUNK_TYPE_BIN			0x004E4942	//	"BIN\0"
+
+//	The glTF JSON text needs a fixed amount of space
+//	plus a short description of each Dirichlet face.
+#define GLTF_JSON_BASE_BYTES		4096
+#define GLTF_JSON_BYTES_PER_FACE	128
+
 //	__cdecl isn't defined or needed on MacOS X,
 //	so make it disappear from our callback function prototypes.
 #ifndef __cdecl
@@ -94,13 +255,30 @@
 #endif
 
 
+//	ClassifyVertices() computes each status arithmetically,
+//	so it relies on these exact values.
 typedef enum
 {
-	VertexInsideHalfspace,
-	VertexOnBoundary,
-	VertexOutsideHalfspace
+	VertexInsideHalfspace	= 0,
+	VertexOnBoundary		= 1,
+	VertexOutsideHalfspace	= 2
 } VertexVsHalfspace;
 
+//	ClassifyVertices() reports which statuses occurred
+//	as a bitmask with bit (1 << status) set for each one.
+//	Internally it also flags vertices whose floating-point status
+//	is ambiguous and needs exact re-evaluation.
+#define VERTEX_STATUS_BIT(s)	(1u << (s))
+#define VERTEX_AMBIGUOUS_BIT	(1u << 3)
+
+//	Where does a bounding ball sit relative to the view frustum?
+typedef enum
+{
+	BallOutsideFrustum,		//	wholly outside some clipping plane
+	BallStraddlesFrustum,	//	can't tell
+	BallInsideFrustum		//	wholly inside all clipping planes
+} BallVsFrustum;
+
 
 //	The Dirichlet Vertex Buffer Object (VBO) will contain
 //	the following data for each of its vertices.
@@ -124,6 +302,24 @@ typedef struct
 //	The half-edge data structure is easier to work with than
 //	the winged-edge data structure used in Curved Spaces 1.0.
 //
+//	Storage
+//
+//	The polyhedron keeps its vertices, half edges and faces
+//	in three contiguous arrays, and the components refer to one another
+//	by 32-bit array indices rather than by pointers.  The whole polyhedron
+//	thus occupies a handful of memory blocks, which keeps the construction
+//	and the mesh generation cache-friendly, and which may be copied
+//	or written out as they stand.  New components get appended
+//	to the end of each array.  IntersectWithHalfspace() removes
+//	dead components by sliding the survivors down, so the survivors
+//	keep their relative order.
+//
+//	Wherever the order of traversal matters, visit components
+//	newest first.  The order matters only cosmetically -- it decides
+//	which pair of faces gets which color, and where on each face
+//	the wall texture starts -- but newest-first order gives each space
+//	the same appearance it has always had.
+//
 //	Orientation conventions
 //
 //	One may orient the faces all clockwise or all counterclockwise,
@@ -141,54 +337,51 @@ typedef struct
 //	the default GL_CCW on the off chance that it works more efficiently
 //	in some implementations (unlikely but you never know).
 
-typedef struct HEVertex
+typedef struct
 {
 	//	The projective approach (see comments at top of file)
 	//	represents a vertex as a ray from the origin.
 	//	For most purposes we need only its direction, not its length.
 	//	Eventually, though, we might need its length as well,
 	//	for example when determining suitable fog parameters.
-	Vector				itsRawPosition,			//	normalized to unit 3-sphere at end of algorithm
-						itsNormalizedPosition;	//	normalized relative to SpaceType
+	//	The vertex's raw position sits in the HEPolyhedron's
+	//	itsVertexRawPositions array (see below).
+	Vector				itsNormalizedPosition;	//	normalized relative to SpaceType
 
 	//	Knowing a single adjacent half edge gives easy access to them all.
 	//	The given half edge starts at this vertex and points away from it.
-	struct HEHalfEdge	*itsOutboundHalfEdge;
-
-	//	IntersectWithHalfspace() evaluates each halfspace inequality on each vertex
-	//	and stores the result temporarily in itsHalfspaceStatus.
-	//	Otherwise this field is unused and undefined.
-	VertexVsHalfspace	itsHalfspaceStatus;
+	uint32_t			itsOutboundHalfEdge;
 
 	//	The center of a face of the vertex figure.
 	//	Please see the explanation of vertex figures in HEHalfEdge below.
 	Vector				itsCenterPoint;
 
-	//	The Dirichlet domain keeps all vertices on a NULL-terminated linked list.
-	struct HEVertex		*itsNext;
-
 } HEVertex;
 
-typedef struct HEHalfEdge
+typedef struct
 {
 	//	The vertex this half edge points to.
-	struct HEVertex		*itsTip;
+	uint32_t			itsTip;
 
 	//	The other half of the given edge, pointing in the opposite direction.
 	//	As viewed from outside the polyhedron, with faces oriented
 	//	clockwise (resp. counterclockwise) the two half edges look like
 	//	traffic in Europe or the U.S. (resp. Australia or Japan),
 	//	assuming a left-handed {x,y,z} coordinate system.
-	struct HEHalfEdge	*itsMate;
+	uint32_t			itsMate;
 
 	//	Traverse the adjacent face clockwise (resp. counter-clockwise),
 	//	as viewed from outside the polyhedron.
-	struct HEHalfEdge	*itsCycle;
+	uint32_t			itsCycle;
 
 	//	The face that itsCycle traverses lies to the right (resp. left)
 	//	of the edge, as viewed from outside the polyhedron.
-	struct HEFace		*itsFace;
-	
+	uint32_t			itsFace;
+
+	//	IntersectWithHalfspace() uses a temporary flag to mark half edges
+	//	for deletion.	Thereafter itsDeletionFlag is unused and undefined.
+	bool				itsDeletionFlag;
+
 	//	When we draw a face with a window cut out from its center,
 	//	we'll need to compute texture coordinates for the window's vertices.
 	//	To do this, we'll need to know the dimensions of the triangle whose base 
@@ -196,10 +389,6 @@ typedef struct HEHalfEdge
 	double				itsBase,		//	normalized so largest base has length 1
 						itsAltitude;	//	normalized so largest base has length 1
 
-	//	IntersectWithHalfspace() uses a temporary flag to mark half edges
-	//	for deletion.	Thereafter itsDeletionFlag is unused and undefined.
-	bool				itsDeletionFlag;
-
 	//	Vertex figures are normally not shown, but if the user requests them,
 	//	draw them as a framework.  That is, at each vertex of the fundamental
 	//	polyhedron, draw the corresponding face of the vertex figure, but with
@@ -211,17 +400,14 @@ typedef struct HEHalfEdge
 	Vector				itsOuterPoint,
 						itsInnerPoint;
 
-	//	The Dirichlet domain keeps all half edges on a NULL-terminated linked list.
-	struct HEHalfEdge	*itsNext;
-
 } HEHalfEdge;
 
-typedef struct HEFace
+typedef struct
 {
 	//	Knowing a single adjacent half edge gives easy access to them all.
 	//	The adjacent half edges all point clockwise (resp. counter-clockwise)
 	//	around the face.
-	struct HEHalfEdge	*itsHalfEdge;
+	uint32_t			itsHalfEdge;
 
 	//	The Dirichlet domain is the intersection of halfspaces
 	//
@@ -247,59 +433,376 @@ typedef struct HEFace
 	//	for deletion.	Thereafter itsDeletionFlag is unused and undefined.
 	bool				itsDeletionFlag;
 
-	//	The Dirichlet domain keeps all faces on a NULL-terminated linked list.
-	struct HEFace		*itsNext;
-
 } HEFace;
 
 struct HEPolyhedron
 {
-	//	Keep vertices, half edges and faces on NULL-terminated linked lists.
-	HEVertex		*itsVertexList;
-	HEHalfEdge		*itsHalfEdgeList;
-	HEFace			*itsFaceList;
-	
+	//	Once ConstructDirichletDomain() or ReadSpaceCacheImage() returns it,
+	//	a Dirichlet domain never changes, so several owners -- for example
+	//	the main thread and a SpaceLoader's loading thread -- may share it.
+	//	Each owner holds one reference.  RetainDirichletDomain() adds
+	//	a reference, and FreeDirichletDomain() lets go of one,
+	//	freeing the Dirichlet domain when the last one goes.
+	MutexLock			*itsLock;				//	protects itsReferenceCount
+	unsigned int		itsReferenceCount;
+
+	//	Keep the vertices in parallel arrays, with room for itsVertexArraySize
+	//	of them.  IntersectWithHalfspace() sweeps through every vertex's
+	//	raw position and halfspace status for every halfspace it considers,
+	//	but seldom needs the rest of a vertex's data, so the raw positions
+	//	and the statuses get arrays of their own.
+	//
+	//	The raw positions get normalized to the unit 3-sphere
+	//	at the end of the algorithm.  IntersectWithHalfspace() evaluates
+	//	each halfspace inequality on each vertex and stores the result
+	//	temporarily in itsVertexHalfspaceStatus.  Otherwise the statuses
+	//	are unused and undefined.
+	unsigned int		itsNumVertices,
+						itsVertexArraySize;
+	Vector				*itsVertexRawPositions;
+	VertexVsHalfspace	*itsVertexHalfspaceStatus;
+	HEVertex			*itsVertices;
+
+	//	Keep the half edges and the faces in arrays of their own.
+	unsigned int		itsNumHalfEdges,
+						itsHalfEdgeArraySize;
+	HEHalfEdge			*itsHalfEdges;
+
+	unsigned int		itsNumFaces,
+						itsFaceArraySize;
+	HEFace				*itsFaces;
+
+	//	CompactDirichletDomain() needs scratch space
+	//	for one index per component of the largest array.
+	unsigned int		itsNewIndexArraySize;
+	uint32_t			*itsNewIndices;
+
+	//	StayInDirichletDomain() finds the faces visible in a given direction
+	//	from the basepoint in a small lookup table, stored compactly
+	//	with cell c's faces at itsFaceLookupFaces[itsFaceLookupStarts[c]]
+	//	through itsFaceLookupFaces[itsFaceLookupStarts[c+1] - 1].
+	//	When the domain doesn't lie within the hemisphere w > 0,
+	//	as for a lens space, both arrays are NULL and
+	//	StayInDirichletDomain() tests every face instead.
+	uint32_t			*itsFaceLookupStarts,	//	FACE_LOOKUP_NUM_CELLS + 1 entries
+						*itsFaceLookupFaces;
+
 	//	For convenience, record the space type.
-	SpaceType		itsSpaceType;
+	SpaceType			itsSpaceType;
+
+	//	ConstructDirichletDomainAtBasepoint() works in coordinates
+	//	in which the requested basepoint sits at (0,0,0,1).
+	//	Record the placement that takes (0,0,0,1) to the requested
+	//	basepoint in the original coordinates, so that a later call
+	//	may re-center from here.  For an ordinary Dirichlet domain
+	//	it's the identity.
+	Matrix				itsBasepointPlacement;
 	
 	//	Precompute some information for constructing...
-	unsigned int	itsDirichletNumMeshVertices,		//	...the Dirichlet domain mesh and
-					itsDirichletNumMeshFaces,
-					itsVertexFiguresNumMeshVertices,	//	...the vertex figure mesh.
-					itsVertexFiguresNumMeshFaces;
+	unsigned int		itsDirichletNumMeshVertices,		//	...the Dirichlet domain mesh and
+						itsDirichletNumMeshFaces,
+						itsVertexFiguresNumMeshVertices,	//	...the vertex figure mesh.
+						itsVertexFiguresNumMeshFaces;
 };
 
 
+//	CutWithGroupElements() gives each parallel job its own
+//	provisional domain to cut, along with every itsElementStride-th
+//	group element, starting at itsFirstElement.
+typedef struct
+{
+	DirichletDomain	*itsDirichletDomain;
+	MatrixList		*itsHolonomyGroup;
+	unsigned int	itsFirstElement,
+					itsElementStride;
+	double			itsBoundingRatio;
+	ErrorText		itsErrorMessage;
+} CuttingJob;
+
+//	SortVisibleCells() gives each parallel job every itsRootStride-th
+//	subtree of the bounding-ball hierarchy, starting at itsFirstRoot.
+//	Each job writes the newly visible cells it finds to its own
+//	portion of the honeycomb's itsScratchCells, beginning at itsFirstNewCell.
+typedef struct
+{
+	Honeycomb		*itsHoneycomb;
+	Matrix			*itsViewProjectionMatrix,
+					*itsViewMatrix;
+	const double	*itsClipNorms,
+					*itsVertexTolerances;
+	double			itsDrawingRadius;
+	const unsigned int
+					*itsRoots;
+	unsigned int	itsNumRoots,
+					itsFirstRoot,
+					itsRootStride,
+					itsFirstNewCell,
+					itsNumNewCells;
+} CullingJob;
+
+//	BuildHoneycombNode() sorts a node's cells along a single coordinate.
+typedef struct
+{
+	double			itsKey;
+	unsigned int	itsCell;
+} CellSortKey;
+
+
+static ErrorText			ConstructDirichletDomainFromSeeds(MatrixList *aHolonomyGroup, MatrixList *someRemainingElements, Matrix *aBasepointPlacement, DirichletDomain **aDirichletDomain);
+static ErrorText			MakeInitialDomain(MatrixList *aHolonomyGroup, DirichletDomain **aDirichletDomain);
+static ErrorText			CutWithGroupElements(MatrixList *aHolonomyGroup, DirichletDomain *aDirichletDomain, double *aBoundingRatio);
+static void					CutWithElementSubset(void *aCuttingJob);
+static ErrorText			CutWithRemainingElements(DirichletDomain *aDirichletDomain, MatrixList *someElements, Matrix *aBasepointPlacement, double *aBoundingRatio);
+static void					ConjugateMatrix(Matrix *aMatrix, Matrix *aConjugator, Matrix *aConjugatorInverse, Matrix *aConjugate);
+static DirichletDomain		*AllocateDirichletDomain(void);
+static ErrorText			ReserveDirichletSpace(DirichletDomain *aDirichletDomain, unsigned int aNumExtraVertices, unsigned int aNumExtraHalfEdges, unsigned int aNumExtraFaces);
+static unsigned int			ArraySizeFor(unsigned int aNumElements);
+static bool					ResizeArray(void **anArray, unsigned int aNumElements, size_t anElementSize);
+static void					CompactDirichletDomain(DirichletDomain *aDirichletDomain);
 static ErrorText			MakeBanana(Matrix *aMatrixA, Matrix *aMatrixB, Matrix *aMatrixC, DirichletDomain **aDirichletDomain);
-static ErrorText			MakeLens(Matrix *aMatrixA, Matrix *aMatrixB, DirichletDomain **aDirichletDomain);
+static ErrorText			MakeLens(Matrix *aMatrixA, Matrix *aMatrixB, unsigned int aGroupOrder, DirichletDomain **aDirichletDomain);
+static void					ChooseCircleVector(unsigned int aNumBasisVectors, Vector *someBasisVectors, Vector *aCircleVector);
 static void					MakeHalfspaceInequality(Matrix *aMatrix, Vector *anInequality);
 static ErrorText			IntersectWithHalfspace(DirichletDomain *aDirichletDomain, Matrix *aMatrix);
+static unsigned int			ClassifyVertices(unsigned int aNumVertices, const Vector *someRawPositions, const Vector *aHalfspace, VertexVsHalfspace *someStatuses);
+static VertexVsHalfspace	ExactVertexStatus(const Vector *aRawPosition, const Vector *aHalfspace);
+static signed int			ExactDotProductSign(const Vector *aVectorA, const Vector *aVectorB, double anOffset);
+static double				ProvisionalBoundingRatio(DirichletDomain *aDirichletDomain);
+static double				HalfTranslationRatio(const double aBasepointImage[4]);
+static __cdecl signed int	CompareHalfTranslationRatios(const void *p1, const void *p2);
+static bool					FixesBasepoint(const double aBasepointImage[4]);
 static void					AssignFaceColors(DirichletDomain *aDirichletDomain);
 static void					ComputeFaceCenters(DirichletDomain *aDirichletDomain);
 static void					ComputeWallDimensions(DirichletDomain *aDirichletDomain);
 static ErrorText			ComputeVertexFigures(DirichletDomain *aDirichletDomain);
 static void					PrepareForDirichletMesh(DirichletDomain *aDirichletDomain);
 static void					PrepareForVertexFiguresMesh(DirichletDomain *aDirichletDomain);
+static ErrorText			MakeFaceLookup(DirichletDomain *aDirichletDomain);
+static ErrorText			AllocateDirichletMesh(const DirichletDomain *aDirichletDomain, double anAperture, bool aColorCodingFlag, bool aGreyscaleFlag, DirichletVBOData **someVertices, unsigned short **someIndices, unsigned int **someFaceFirstVertices, unsigned int **someFaceNumVertices);
+static void					AppendJSON(char *aBuffer, size_t aBufferSize, size_t *aLength, const char *aFormat, ...);
+static ErrorText			MakeDirichletMesh(const DirichletDomain *aDirichletDomain, double anAperture, bool aColorCodingFlag, bool aGreyscaleFlag, DirichletVBOData *someVertices, unsigned short *someIndices, unsigned int *someFaceFirstVertices, unsigned int *someFaceNumVertices);
+static unsigned int			FaceLookupCell(const double aDirection[3]);
+static double				FaceLookupCellGeometry(unsigned int aCell, double aCenter[3]);
+static double				DirectionToFaceAngle(DirichletDomain *aDirichletDomain, unsigned int aFace, const double aDirection[3]);
 static Honeycomb			*AllocateHoneycomb(unsigned int aNumCells, unsigned int aNumVertices);
+static void					SetUpHoneycell(Honeycomb *aHoneycomb, unsigned int aCell, Matrix *aMatrix, const DirichletDomain *aDirichletDomain);
+static void					PutCellVertex(Honeycomb *aHoneycomb, unsigned int aCell, unsigned int aVertex, Vector *aVertexImage);
+static unsigned int			CountVertices(const DirichletDomain *aDirichletDomain);
+static ErrorText			BuildHoneycombHierarchy(Honeycomb *aHoneycomb, const DirichletDomain *aDirichletDomain);
+static void					BuildHoneycombNode(Honeycomb *aHoneycomb, unsigned int aFirstCell, unsigned int aNumCells, double aCellRadius, CellSortKey *someSortKeys);
+static __cdecl signed int	CompareCellSortKeys(const void *p1, const void *p2);
+static double				HoneycombDistance(SpaceType aSpaceType, Vector *aPointA, Vector *aPointB);
+static void					FreeHoneycombHierarchy(Honeycomb *aHoneycomb);
+static double				ClipMargin(SpaceType aSpaceType, double aBallRadius);
+static unsigned int			GatherCullingRoots(Honeycomb *aHoneycomb, unsigned int aMinNumRoots, unsigned int someRoots[MAX_CULLING_ROOTS]);
+static void					CullHoneycombSubtrees(void *aCullingJob);
+static void					CullHoneycombSubtree(CullingJob *aCullingJob, unsigned int aRoot);
+static void					AddCellIfVisible(CullingJob *aCullingJob, Honeycell *aCell, bool aCellIsInsideFrustum);
+static void					SortVisibleCellList(Honeycell **someCells, unsigned int aNumCells, Honeycell **aScratchBuffer);
+static bool					InsertionSortCells(Honeycell **someCells, unsigned int aNumCells, bool aMayGiveUpFlag);
+static void					RadixSortCells(Honeycell **someCells, unsigned int aNumCells, Honeycell **aScratchBuffer);
+static void					ComputeClipNorms(SpaceType aSpaceType, Matrix *aViewProjectionMatrix, double someClipNorms[6], double someVertexTolerances[6]);
+static BallVsFrustum		BallVersusFrustum(Vector *aCenter, double aClipMargin, Matrix *aViewProjectionMatrix, const double someClipNorms[6]);
 static double				CellCenterDistance(Honeycell *aCell, Matrix *aViewMatrix);
-static bool					CellMayBeVisible(Honeycell *aCell, Matrix *aViewProjectionMatrix);
+static bool					CellMayBeVisible(CullingJob *aCullingJob, Honeycell *aCell);
 static __cdecl signed int	CompareCellCenterDistances(const void *p1, const void *p2);
+static bool					HalfEdgeStructureIsValid(DirichletDomain *aDirichletDomain);
+static void					PutUInt32(Byte **aCursor, uint32_t aValue);
+static void					PutUInt64(Byte **aCursor, uint64_t aValue);
+static void					PutDouble(Byte **aCursor, double aValue);
+static void					PutVector(Byte **aCursor, Vector *aVector);
+static void					PutMatrix(Byte **aCursor, Matrix *aMatrix);
+static void					PutFloat(Byte **aCursor, float aValue);
+static uint32_t				GetUInt32(const Byte **aCursor);
+static uint64_t				GetUInt64(const Byte **aCursor);
+static double				GetDouble(const Byte **aCursor);
+static float				GetFloat(const Byte **aCursor);
+static void					GetVector(const Byte **aCursor, Vector *aVector);
+static void					GetMatrix(const Byte **aCursor, Matrix *aMatrix);
 
 
 ErrorText ConstructDirichletDomain(
 	MatrixList		*aHolonomyGroup,
 	DirichletDomain	**aDirichletDomain)
+{
+	return ConstructDirichletDomainFromSeeds(aHolonomyGroup, NULL, NULL, aDirichletDomain);
+}
+
+
+ErrorText ConstructDirichletDomainAtBasepoint(
+	MatrixList				*aHolonomyGroup,		//	input, identity first
+	Matrix					*aBasepointPlacement,	//	input, may be NULL
+	const DirichletDomain	*aNearbyDomain,			//	input, may be NULL
+	DirichletDomain			**aDirichletDomain)		//	output
+{
+	ErrorText		theErrorMessage		= NULL;
+	Matrix			theBasepointPlacement,
+					theOldPlacement,
+					theOldPlacementInverse,
+					theConjugator,
+					theConjugatorInverse,
+					theFacePairing;
+	MatrixList		*theSeedElements	= NULL,
+					*theConjugatedGroup	= NULL;
+	unsigned int	i;
+
+	//	Construct the Dirichlet domain centered at the image of (0,0,0,1)
+	//	under aBasepointPlacement, or at (0,0,0,1) itself if it's NULL.
+	//
+	//	If P takes (0,0,0,1) to the new basepoint, then the Dirichlet domain
+	//	centered there is the image under P of the ordinary Dirichlet domain
+	//	of the conjugate group { P g P⁻¹ }.  (Matrices act on row vectors,
+	//	on the right.)  So work in coordinates in which the new basepoint
+	//	sits at (0,0,0,1), and the rest of this file may carry on as usual.
+	//	The Dirichlet domain comes back in those coordinates, so to tile it
+	//	the caller should pass ConjugateHolonomyGroup()'s output
+	//	to ConstructHoneycomb().
+	//
+	//	To animate the domain's shape as the basepoint moves, pass
+	//	the previous frame's Dirichlet domain as aNearbyDomain.
+	//	Its face pairings, carried over to the new coordinates,
+	//	cut out a provisional domain that's typically the final one already.
+	//	The remaining group elements then need only the bounding test
+	//	from ConstructDirichletDomain(), and only an element that passes it
+	//	gets conjugated and cut.  So each frame costs one cut per face
+	//	plus a cheap test per group element, rather than a full construction.
+
+	if (aBasepointPlacement == NULL && aNearbyDomain == NULL)
+		return ConstructDirichletDomainFromSeeds(aHolonomyGroup, NULL, NULL, aDirichletDomain);
+
+	if (aHolonomyGroup == NULL)
+		return u"ConstructDirichletDomainAtBasepoint() received a NULL holonomy group.";
+
+	if (aBasepointPlacement != NULL)
+		theBasepointPlacement = *aBasepointPlacement;
+	else
+		MatrixIdentity(&theBasepointPlacement);
+
+	//	A bounded Dirichlet domain has at least four faces,
+	//	enough to seed the new one.  A lens space or a slab space
+	//	(with only two faces) gets constructed from scratch.
+	if (aNearbyDomain != NULL
+	 && aNearbyDomain->itsNumFaces >= 4
+	 && aHolonomyGroup->itsNumMatrices >= 3)
+	{
+		if ( ! MatrixIsIdentity(&aHolonomyGroup->itsMatrices[0]) )
+		{
+			theErrorMessage = u"ConstructDirichletDomainAtBasepoint() expects the first matrix to be the identity.";
+			goto CleanUpConstructDirichletDomainAtBasepoint;
+		}
+
+		//	If P₀ is aNearbyDomain's basepoint placement, then its face pairing
+		//	P₀ g P₀⁻¹ becomes C (P₀ g P₀⁻¹) C⁻¹ = P g P⁻¹, with C = P P₀⁻¹.
+		theOldPlacement = aNearbyDomain->itsBasepointPlacement;
+		MatrixGeometricInverse(&theOldPlacement, &theOldPlacementInverse);
+		MatrixProduct(&theBasepointPlacement, &theOldPlacementInverse, &theConjugator);
+		MatrixGeometricInverse(&theConjugator, &theConjugatorInverse);
+
+		theSeedElements = AllocateMatrixList(1 + aNearbyDomain->itsNumFaces);
+		if (theSeedElements == NULL)
+		{
+			theErrorMessage = u"Couldn't allocate memory for the seed elements in ConstructDirichletDomainAtBasepoint().";
+			goto CleanUpConstructDirichletDomainAtBasepoint;
+		}
+
+		MatrixIdentity(&theSeedElements->itsMatrices[0]);
+		for (i = 0; i < aNearbyDomain->itsNumFaces; i++)
+		{
+			theFacePairing = aNearbyDomain->itsFaces[i].itsMatrix;
+			ConjugateMatrix(&theFacePairing, &theConjugator, &theConjugatorInverse, &theSeedElements->itsMatrices[1 + i]);
+			if (FixesBasepoint(theSeedElements->itsMatrices[1 + i].m[3]))
+			{
+				theErrorMessage = u"A group element fixes the requested basepoint.";
+				goto CleanUpConstructDirichletDomainAtBasepoint;
+			}
+		}
+
+		theErrorMessage = ConstructDirichletDomainFromSeeds(	theSeedElements,
+																aHolonomyGroup,
+																&theBasepointPlacement,
+																aDirichletDomain);
+	}
+	else
+	{
+		theErrorMessage = ConjugateHolonomyGroup(aHolonomyGroup, &theBasepointPlacement, &theConjugatedGroup);
+		if (theErrorMessage != NULL)
+			goto CleanUpConstructDirichletDomainAtBasepoint;
+
+		theErrorMessage = ConstructDirichletDomainFromSeeds(	theConjugatedGroup,
+																NULL,
+																&theBasepointPlacement,
+																aDirichletDomain);
+	}
+
+CleanUpConstructDirichletDomainAtBasepoint:
+
+	FreeMatrixList(&theSeedElements);
+	FreeMatrixList(&theConjugatedGroup);
+
+	return theErrorMessage;
+}
+
+
+ErrorText ConjugateHolonomyGroup(
+	MatrixList	*aHolonomyGroup,		//	input
+	Matrix		*aBasepointPlacement,	//	input
+	MatrixList	**aConjugatedGroup)		//	output
+{
+	Matrix			theInverse;
+	unsigned int	i;
+
+	//	Replace each group element g with P g P⁻¹, where P takes (0,0,0,1)
+	//	to the requested basepoint, and sort the results by translation
+	//	distance, nearest first, as ConstructDirichletDomain() prefers.
+	//	The identity stays exactly the identity, and sorts to the front.
+
+	if (aHolonomyGroup == NULL)
+		return u"ConjugateHolonomyGroup() received a NULL holonomy group.";
+
+	if (*aConjugatedGroup != NULL)
+		return u"ConjugateHolonomyGroup() received a non-NULL output location.";
+
+	*aConjugatedGroup = AllocateMatrixList(aHolonomyGroup->itsNumMatrices);
+	if (*aConjugatedGroup == NULL)
+		return u"Couldn't allocate memory for the conjugated holonomy group.";
+
+	MatrixGeometricInverse(aBasepointPlacement, &theInverse);
+
+	for (i = 0; i < aHolonomyGroup->itsNumMatrices; i++)
+	{
+		if (MatrixIsIdentity(&aHolonomyGroup->itsMatrices[i]))
+		{
+			MatrixIdentity(&(*aConjugatedGroup)->itsMatrices[i]);
+			continue;
+		}
+
+		ConjugateMatrix(&aHolonomyGroup->itsMatrices[i], aBasepointPlacement, &theInverse, &(*aConjugatedGroup)->itsMatrices[i]);
+
+		if (FixesBasepoint((*aConjugatedGroup)->itsMatrices[i].m[3]))
+		{
+			FreeMatrixList(aConjugatedGroup);
+			return u"A group element fixes the requested basepoint.";
+		}
+	}
+
+	qsort(	(*aConjugatedGroup)->itsMatrices,
+			(*aConjugatedGroup)->itsNumMatrices,
+			sizeof(Matrix),
+			CompareHalfTranslationRatios);
+
+	return NULL;
+}
+
+
+static ErrorText ConstructDirichletDomainFromSeeds(
+	MatrixList		*aHolonomyGroup,		//	input, identity first;  the whole group or just some seed elements
+	MatrixList		*someRemainingElements,	//	input, may be NULL
+	Matrix			*aBasepointPlacement,	//	input, may be NULL
+	DirichletDomain	**aDirichletDomain)		//	output
 {
 	ErrorText		theErrorMessage	= NULL;
-	Vector			theHalfspaceA,
-					theHalfspaceB,
-					theHalfspaceC,
-					theHalfspaceD,
-					theCrossProduct;
-	unsigned int	theThirdIndex,
-					theFourthIndex,
-					i;
-	HEVertex		*theVertex;
+	unsigned int	i;
+	double			theBoundingRatio;
 
 	if (aHolonomyGroup == NULL)
 		return u"ConstructDirichletDomain() received a NULL holonomy group.";
@@ -325,6 +828,150 @@ ErrorText ConstructDirichletDomain(
 	if ( ! MatrixIsIdentity(&aHolonomyGroup->itsMatrices[0]) )
 		return u"ConstructDirichletDomain() expects the first matrix to be the identity.";
 
+	//	Construct an initial polyhedron from the first few
+	//	independent group elements.
+	theErrorMessage = MakeInitialDomain(aHolonomyGroup, aDirichletDomain);
+	if (theErrorMessage != NULL)
+		goto CleanUpConstructDirichletDomain;
+
+	//	Intersect the initial banana with the halfspace determined
+	//	by each matrix in aHolonomyGroup.  For best numerical accuracy
+	//	(and least work!) start with the nearest group elements and work
+	//	towards the more distance ones.
+	//
+	//	For large tilings all but the first handful of group elements
+	//	will be irrelevant.  An element whose translation distance
+	//	exceeds twice the provisional domain's circumradius can't cut
+	//	the domain, because its bisecting plane lies wholly beyond
+	//	the domain's bounding ball.  ProvisionalBoundingRatio() and
+	//	HalfTranslationRatio() express both radii in the same
+	//	trig-free units, so we may skip such an element at the cost
+	//	of a single comparison, without evaluating its halfspace
+	//	on every vertex.  The domain only shrinks, so the bound
+	//	stays valid until the next cut, when we recompute it.
+	//
+	//	Technical note:  The holonomy group arrives sorted by translation
+	//	distance, but only stage-by-stage (see TileSpace()), so a nearby
+	//	element may occasionally follow a more distant one.  We therefore
+	//	skip the distant elements individually rather than breaking
+	//	out of the loop at the first one.
+	//
+	//	A large group is split among several jobs running in parallel
+	//	(see CutWithGroupElements() for details).
+	theErrorMessage = CutWithGroupElements(aHolonomyGroup, *aDirichletDomain, &theBoundingRatio);
+	if (theErrorMessage != NULL)
+		goto CleanUpConstructDirichletDomain;
+
+	//	When re-centering from a nearby Dirichlet domain, the seed elements
+	//	are that domain's face pairings, which typically cut out
+	//	the new domain already.  The remaining group elements need only
+	//	confirm it, and most of them fail the bounding test at once.
+	if (someRemainingElements != NULL)
+	{
+		theErrorMessage = CutWithRemainingElements(	*aDirichletDomain,
+													someRemainingElements,
+													aBasepointPlacement,
+													&theBoundingRatio);
+		if (theErrorMessage != NULL)
+			goto CleanUpConstructDirichletDomain;
+	}
+
+	//	Record the space type.
+	if (aHolonomyGroup->itsMatrices[1].m[3][3] <  1.0)
+		(*aDirichletDomain)->itsSpaceType = SpaceSpherical;
+	else
+	if (aHolonomyGroup->itsMatrices[1].m[3][3] == 1.0)
+		(*aDirichletDomain)->itsSpaceType = SpaceFlat;
+	else
+		(*aDirichletDomain)->itsSpaceType = SpaceHyperbolic;
+
+	//	Record the basepoint.
+	if (aBasepointPlacement != NULL)
+		(*aDirichletDomain)->itsBasepointPlacement = *aBasepointPlacement;
+
+	//	Normalize each vertex's position relative to the geometry.
+//WILL NEED TO THINK ABOUT THIS STEP WITH VERTICES AT INFINITY.
+	for (i = 0; i < (*aDirichletDomain)->itsNumVertices; i++)
+	{
+		theErrorMessage = VectorNormalize(	&(*aDirichletDomain)->itsVertexRawPositions[i],
+											(*aDirichletDomain)->itsSpaceType,
+											&(*aDirichletDomain)->itsVertices[i].itsNormalizedPosition);
+		if (theErrorMessage != NULL)
+			goto CleanUpConstructDirichletDomain;
+	}
+
+
+	//	Normalize each vertex's raw position to sit on the unit 3-sphere.
+	//	This ignores the space's intrinsic geometry (spherical, flat or
+	//	hyperbolic) but provides reasonable interpolation between
+	//	finite vertices and vertices at infinity.  In addition, it serves
+	//	the more prosaic purpose or making it easy to sum vertex positions
+	//	to get face centers.
+	//
+	//	Note:  Unlike (I think) the rest of the algorithm, this step
+	//	requires a division.  Consider this if moving to exact arithmetic.
+	//	At any rate, the normalization isn't needed for the main algorithm.
+	for (i = 0; i < (*aDirichletDomain)->itsNumVertices; i++)
+	{
+		theErrorMessage = VectorNormalize(	&(*aDirichletDomain)->itsVertexRawPositions[i],
+											SpaceSpherical,	//	regardless of true SpaceType
+											&(*aDirichletDomain)->itsVertexRawPositions[i]);
+		if (theErrorMessage != NULL)
+			goto CleanUpConstructDirichletDomain;
+	}
+
+	//	Assign colors to the Dirichlet domain's faces
+	//	so that matching faces have the same color.
+	AssignFaceColors(*aDirichletDomain);
+
+	//	Compute the center of each face,
+	//	normalized to the unit 3-sphere and to the SpaceType.
+	ComputeFaceCenters(*aDirichletDomain);
+	
+	//	Compute the dimensions of the triangular wedges comprising each face.
+	ComputeWallDimensions(*aDirichletDomain);
+
+	//	Compute the faces of the vertex figure(s).
+	//	One face of the vertex figure(s) sits at each vertex
+	//	of the fundamental polyhedron.
+	//	This code relies on the fact that for each vertex,
+	//	itsRawPosition has already been normalized to sit on the 3-sphere.
+	theErrorMessage = ComputeVertexFigures(*aDirichletDomain);
+	if (theErrorMessage != NULL)
+		goto CleanUpConstructDirichletDomain;
+	
+	//	Precompute some information in preparation for constructing
+	//	the Dirichlet domain mesh and the vertex figures mesh.
+	PrepareForDirichletMesh(*aDirichletDomain);
+	PrepareForVertexFiguresMesh(*aDirichletDomain);
+
+	//	Prepare to locate the user's position quickly.
+	theErrorMessage = MakeFaceLookup(*aDirichletDomain);
+	if (theErrorMessage != NULL)
+		goto CleanUpConstructDirichletDomain;
+
+CleanUpConstructDirichletDomain:
+
+	if (theErrorMessage != NULL)
+		FreeDirichletDomain(aDirichletDomain);
+
+	return theErrorMessage;
+}
+
+
+static ErrorText MakeInitialDomain(
+	MatrixList		*aHolonomyGroup,	//	input, identity first, at least 3 elements
+	DirichletDomain	**aDirichletDomain)	//	output
+{
+	ErrorText		theErrorMessage	= NULL;
+	Vector			theHalfspaceA,
+					theHalfspaceB,
+					theHalfspaceC,
+					theHalfspaceD,
+					theCrossProduct;
+	unsigned int	theThirdIndex,
+					theFourthIndex;
+
 	//	Thinking projectively (as explained at the top of this file)
 	//	each matrix determines a halfspace of R⁴ or, equivalently,
 	//	a hemisphere of S³.  Just as any two distinct hemispheres of S²
@@ -360,7 +1007,7 @@ ErrorText ConstructDirichletDomain(
 										&aHolonomyGroup->itsMatrices[theThirdIndex],
 										aDirichletDomain);
 		if (theErrorMessage != NULL)
-			goto CleanUpConstructDirichletDomain;
+			goto CleanUpMakeInitialDomain;
 
 		//	Look for a fourth independent group element.
 		for (	theFourthIndex = theThirdIndex + 1;
@@ -373,7 +1020,7 @@ ErrorText ConstructDirichletDomain(
 			//	to test with the fourth hyperplane avoids the two (antipodal)
 			//	banana vertices.
 			MakeHalfspaceInequality(&aHolonomyGroup->itsMatrices[theFourthIndex], &theHalfspaceD);
-			if (fabs(VectorDotProduct(&theHalfspaceD, &(*aDirichletDomain)->itsVertexList->itsRawPosition)) > HYPERPLANARITY_EPSILON)
+			if (fabs(VectorDotProduct(&theHalfspaceD, &(*aDirichletDomain)->itsVertexRawPositions[0])) > HYPERPLANARITY_EPSILON)
 				break;	//	success!
 		}
 		if (theFourthIndex < aHolonomyGroup->itsNumMatrices)
@@ -382,7 +1029,7 @@ ErrorText ConstructDirichletDomain(
 			//	to get a tetrahedron.
 			theErrorMessage = IntersectWithHalfspace(*aDirichletDomain, &aHolonomyGroup->itsMatrices[theFourthIndex]);
 			if (theErrorMessage != NULL)
-				goto CleanUpConstructDirichletDomain;
+				goto CleanUpMakeInitialDomain;
 		}
 		else
 		{
@@ -392,7 +1039,7 @@ ErrorText ConstructDirichletDomain(
 			//	Even though we've constructed the Dirichlet domain,
 			//	the graphics code isn't prepared to draw it.
 			theErrorMessage = u"Chimney-like spaces not supported.";
-			goto CleanUpConstructDirichletDomain;
+			goto CleanUpMakeInitialDomain;
 		}
 	}
 	else
@@ -402,136 +1049,674 @@ ErrorText ConstructDirichletDomain(
 		//	The current code *is* prepared to handle such a space!
 		theErrorMessage = MakeLens(	&aHolonomyGroup->itsMatrices[1],
 									&aHolonomyGroup->itsMatrices[2],
+									aHolonomyGroup->itsNumMatrices,
 									aDirichletDomain);
 		if (theErrorMessage != NULL)
-			goto CleanUpConstructDirichletDomain;
+			goto CleanUpMakeInitialDomain;
 	}
 
-	//	Intersect the initial banana with the halfspace determined
-	//	by each matrix in aHolonomyGroup.  For best numerical accuracy
-	//	(and least work!) start with the nearest group elements and work
-	//	towards the more distance ones.
+CleanUpMakeInitialDomain:
+
+	if (theErrorMessage != NULL)
+		FreeDirichletDomain(aDirichletDomain);
+
+	return theErrorMessage;
+}
+
+
+static ErrorText CutWithGroupElements(
+	MatrixList		*aHolonomyGroup,	//	input
+	DirichletDomain	*aDirichletDomain,	//	input and output
+	double			*aBoundingRatio)	//	output
+{
+	ErrorText		theErrorMessage	= NULL;
+	unsigned int	theNumJobs,
+					theNumFaces,
+					i,
+					j;
+	CuttingJob		theJobs[MAX_PARALLEL_JOBS];
+	void			*theJobPointers[MAX_PARALLEL_JOBS];
+
+	//	Each IntersectWithHalfspace() call modifies the whole polyhedron,
+	//	so a single polyhedron must be cut serially.  But the Dirichlet
+	//	domain is the intersection of the halfspaces, in any order
+	//	and with any grouping, so each of several jobs may cut
+	//	its own copy of the initial polyhedron with its own share
+	//	of the group elements.  The present thread then cuts job 0's
+	//	result with the halfspaces defining each other job's result.
+	//	Those few faces -- typically dozens, not thousands --
+	//	carry everything the other jobs learned, so the merge
+	//	costs little more than a single job's final cuts.
 	//
-	//	Technical note:  For large tilings all but the first handful
-	//	of group elements will be irrelevant.  If desired one could
-	//	modify this code to break the loop when the slicing halfspaces
-	//	lie further away than the most distance vertices.
-	for (i = 0; i < aHolonomyGroup->itsNumMatrices; i++)
+	//	The jobs share the group elements round-robin, rather than
+	//	in contiguous blocks, so that each job sees its share
+	//	of the nearby elements early on and can skip the distant ones,
+	//	just as a single job would.
+	//
+	//	The resulting polyhedron doesn't depend on the number of jobs,
+	//	except for roundoff error in the vertex positions,
+	//	but the order of its faces does, because job 0's faces come first
+	//	and the merge appends the others' in job order.  So let
+	//	the number of jobs depend only on the size of the group,
+	//	not on the number of processors, to get the same face order,
+	//	and indeed the same bits, on every computer.
+
+	theNumJobs = NUM_CUTTING_JOBS;
+	if (theNumJobs > aHolonomyGroup->itsNumMatrices / MIN_ELEMENTS_PER_CUTTING_JOB)
+		theNumJobs = aHolonomyGroup->itsNumMatrices / MIN_ELEMENTS_PER_CUTTING_JOB;
+	if (theNumJobs < 1)
+		theNumJobs = 1;
+
+	for (i = 0; i < theNumJobs; i++)
 	{
-		theErrorMessage = IntersectWithHalfspace(*aDirichletDomain, &aHolonomyGroup->itsMatrices[i]);
+		theJobs[i].itsDirichletDomain	= (i == 0 ? aDirichletDomain : NULL);
+		theJobs[i].itsHolonomyGroup		= aHolonomyGroup;
+		theJobs[i].itsFirstElement		= i;
+		theJobs[i].itsElementStride		= theNumJobs;
+		theJobs[i].itsBoundingRatio		= INFINITY;
+		theJobs[i].itsErrorMessage		= NULL;
+
+		theJobPointers[i] = &theJobs[i];
+	}
+
+	for (i = 1; i < theNumJobs; i++)
+	{
+		theErrorMessage = MakeInitialDomain(aHolonomyGroup, &theJobs[i].itsDirichletDomain);
 		if (theErrorMessage != NULL)
-			goto CleanUpConstructDirichletDomain;
+			goto CleanUpCutWithGroupElements;
 	}
 
-	//	Record the space type.
-	if (aHolonomyGroup->itsMatrices[1].m[3][3] <  1.0)
-		(*aDirichletDomain)->itsSpaceType = SpaceSpherical;
-	else
-	if (aHolonomyGroup->itsMatrices[1].m[3][3] == 1.0)
-		(*aDirichletDomain)->itsSpaceType = SpaceFlat;
-	else
-		(*aDirichletDomain)->itsSpaceType = SpaceHyperbolic;
+	RunJobsInParallel(theNumJobs, CutWithElementSubset, theJobPointers);
 
-	//	Normalize each vertex's position relative to the geometry.
-//WILL NEED TO THINK ABOUT THIS STEP WITH VERTICES AT INFINITY.
-	for (	theVertex = (*aDirichletDomain)->itsVertexList;
-			theVertex != NULL;
-			theVertex = theVertex->itsNext)
+	for (i = 0; i < theNumJobs; i++)
 	{
-		theErrorMessage = VectorNormalize(	&theVertex->itsRawPosition,
-											(*aDirichletDomain)->itsSpaceType,
-											&theVertex->itsNormalizedPosition);
-		if (theErrorMessage != NULL)
-			goto CleanUpConstructDirichletDomain;
+		if (theJobs[i].itsErrorMessage != NULL)
+		{
+			theErrorMessage = theJobs[i].itsErrorMessage;
+			goto CleanUpCutWithGroupElements;
+		}
 	}
 
-	//	Normalize each vertex's raw position to sit on the unit 3-sphere.
-	//	This ignores the space's intrinsic geometry (spherical, flat or
-	//	hyperbolic) but provides reasonable interpolation between
-	//	finite vertices and vertices at infinity.  In addition, it serves
-	//	the more prosaic purpose or making it easy to sum vertex positions
-	//	to get face centers.
-	//
-	//	Note:  Unlike (I think) the rest of the algorithm, this step
-	//	requires a division.  Consider this if moving to exact arithmetic.
-	//	At any rate, the normalization isn't needed for the main algorithm.
-	for (	theVertex = (*aDirichletDomain)->itsVertexList;
-			theVertex != NULL;
-			theVertex = theVertex->itsNext)
+	//	Merge the other jobs' results into job 0's.
+	*aBoundingRatio = theJobs[0].itsBoundingRatio;
+	for (i = 1; i < theNumJobs; i++)
 	{
-		theErrorMessage = VectorNormalize(	&theVertex->itsRawPosition,
-											SpaceSpherical,	//	regardless of true SpaceType
-											&theVertex->itsRawPosition);
+		for (j = 0; j < theJobs[i].itsDirichletDomain->itsNumFaces; j++)
+		{
+			if (HalfTranslationRatio(theJobs[i].itsDirichletDomain->itsFaces[j].itsMatrix.m[3]) > *aBoundingRatio + CULLING_EPSILON)
+				continue;
+
+			theNumFaces = aDirichletDomain->itsNumFaces;
+
+			theErrorMessage = IntersectWithHalfspace(aDirichletDomain, &theJobs[i].itsDirichletDomain->itsFaces[j].itsMatrix);
+			if (theErrorMessage != NULL)
+				goto CleanUpCutWithGroupElements;
+
+			if (aDirichletDomain->itsNumFaces != theNumFaces)
+				*aBoundingRatio = ProvisionalBoundingRatio(aDirichletDomain);
+		}
+	}
+
+CleanUpCutWithGroupElements:
+
+	for (i = 1; i < theNumJobs; i++)
+		FreeDirichletDomain(&theJobs[i].itsDirichletDomain);
+
+	return theErrorMessage;
+}
+
+
+static void CutWithElementSubset(void *aCuttingJob)
+{
+	CuttingJob		*theJob;
+	DirichletDomain	*theDirichletDomain;
+	MatrixList		*theHolonomyGroup;
+	double			theBoundingRatio;
+	unsigned int	theNumVertices,
+					theNumFaces,
+					i;
+
+	theJob				= (CuttingJob *) aCuttingJob;
+	theDirichletDomain	= theJob->itsDirichletDomain;
+	theHolonomyGroup	= theJob->itsHolonomyGroup;
+
+	theBoundingRatio = ProvisionalBoundingRatio(theDirichletDomain);
+	for (i = theJob->itsFirstElement; i < theHolonomyGroup->itsNumMatrices; i += theJob->itsElementStride)
+	{
+		if (HalfTranslationRatio(theHolonomyGroup->itsMatrices[i].m[3]) > theBoundingRatio + CULLING_EPSILON)
+			continue;
+
+		theNumVertices	= theDirichletDomain->itsNumVertices;
+		theNumFaces		= theDirichletDomain->itsNumFaces;
+
+		theJob->itsErrorMessage = IntersectWithHalfspace(theDirichletDomain, &theHolonomyGroup->itsMatrices[i]);
+		if (theJob->itsErrorMessage != NULL)
+			return;
+
+		//	A nontrivial cut always adds a face.
+		if (theDirichletDomain->itsNumFaces    != theNumFaces
+		 || theDirichletDomain->itsNumVertices != theNumVertices)
+		{
+			theBoundingRatio = ProvisionalBoundingRatio(theDirichletDomain);
+		}
+	}
+
+	theJob->itsBoundingRatio = theBoundingRatio;
+}
+
+
+static ErrorText CutWithRemainingElements(
+	DirichletDomain	*aDirichletDomain,		//	input and output
+	MatrixList		*someElements,			//	input, in the original coordinates
+	Matrix			*aBasepointPlacement,	//	input, may be NULL
+	double			*aBoundingRatio)		//	input and output
+{
+	ErrorText		theErrorMessage;
+	Matrix			thePlacement,
+					thePlacementInverse,
+					theConjugate;
+	double			theRow[4],
+					theImage[4];
+	unsigned int	theNumVertices,
+					theNumFaces,
+					i,
+					j,
+					k;
+
+	//	Cut aDirichletDomain with P g P⁻¹ for each element g,
+	//	exactly as ConstructDirichletDomain() would, but don't bother
+	//	conjugating an element unless its bisecting plane might reach
+	//	the provisional domain.  The bounding test needs only
+	//	the conjugate's last row -- the image (0,0,0,1) P g P⁻¹
+	//	of the basepoint -- which costs two vector-matrix products
+	//	instead of two matrix-matrix products.
+
+	if (aBasepointPlacement != NULL)
+		thePlacement = *aBasepointPlacement;
+	else
+		MatrixIdentity(&thePlacement);
+	MatrixGeometricInverse(&thePlacement, &thePlacementInverse);
+
+	for (i = 0; i < someElements->itsNumMatrices; i++)
+	{
+		if (MatrixIsIdentity(&someElements->itsMatrices[i]))
+			continue;
+
+		for (j = 0; j < 4; j++)
+		{
+			theRow[j] = 0.0;
+			for (k = 0; k < 4; k++)
+				theRow[j] += thePlacement.m[3][k] * someElements->itsMatrices[i].m[k][j];
+		}
+		for (j = 0; j < 4; j++)
+		{
+			theImage[j] = 0.0;
+			for (k = 0; k < 4; k++)
+				theImage[j] += theRow[k] * thePlacementInverse.m[k][j];
+		}
+
+		if (HalfTranslationRatio(theImage) > *aBoundingRatio + CULLING_EPSILON)
+			continue;
+
+		ConjugateMatrix(&someElements->itsMatrices[i], &thePlacement, &thePlacementInverse, &theConjugate);
+		if (FixesBasepoint(theConjugate.m[3]))
+			return u"A group element fixes the requested basepoint.";
+
+		theNumVertices	= aDirichletDomain->itsNumVertices;
+		theNumFaces		= aDirichletDomain->itsNumFaces;
+
+		theErrorMessage = IntersectWithHalfspace(aDirichletDomain, &theConjugate);
 		if (theErrorMessage != NULL)
-			goto CleanUpConstructDirichletDomain;
+			return theErrorMessage;
+
+		if (aDirichletDomain->itsNumFaces    != theNumFaces
+		 || aDirichletDomain->itsNumVertices != theNumVertices)
+		{
+			*aBoundingRatio = ProvisionalBoundingRatio(aDirichletDomain);
+		}
 	}
 
-	//	Assign colors to the Dirichlet domain's faces
-	//	so that matching faces have the same color.
-	AssignFaceColors(*aDirichletDomain);
+	return NULL;
+}
 
-	//	Compute the center of each face,
-	//	normalized to the unit 3-sphere and to the SpaceType.
-	ComputeFaceCenters(*aDirichletDomain);
-	
-	//	Compute the dimensions of the triangular wedges comprising each face.
-	ComputeWallDimensions(*aDirichletDomain);
 
-	//	Compute the faces of the vertex figure(s).
-	//	One face of the vertex figure(s) sits at each vertex
-	//	of the fundamental polyhedron.
-	//	This code relies on the fact that for each vertex,
-	//	itsRawPosition has already been normalized to sit on the 3-sphere.
-	theErrorMessage = ComputeVertexFigures(*aDirichletDomain);
-	if (theErrorMessage != NULL)
-		goto CleanUpConstructDirichletDomain;
-	
-	//	Precompute some information in preparation for constructing
-	//	the Dirichlet domain mesh and the vertex figures mesh.
-	PrepareForDirichletMesh(*aDirichletDomain);
-	PrepareForVertexFiguresMesh(*aDirichletDomain);
+static void ConjugateMatrix(
+	Matrix	*aMatrix,				//	input
+	Matrix	*aConjugator,			//	input
+	Matrix	*aConjugatorInverse,	//	input
+	Matrix	*aConjugate)			//	output
+{
+	Matrix	theProduct;
 
-CleanUpConstructDirichletDomain:
+	//	Compute aConjugator · aMatrix · aConjugatorInverse.
+	MatrixProduct(aConjugator, aMatrix, &theProduct);
+	MatrixProduct(&theProduct, aConjugatorInverse, aConjugate);
+}
 
-	if (theErrorMessage != NULL)
-		FreeDirichletDomain(aDirichletDomain);
 
-	return theErrorMessage;
+DirichletDomain *RetainDirichletDomain(DirichletDomain *aDirichletDomain)
+{
+	//	Add a reference to aDirichletDomain (which may be NULL)
+	//	and return it, so the caller may write
+	//
+	//		theCopy = RetainDirichletDomain(theOriginal);
+	//
+	//	and later call FreeDirichletDomain(&theCopy) as usual.
+
+	if (aDirichletDomain != NULL)
+	{
+		LockMutex(aDirichletDomain->itsLock);
+		aDirichletDomain->itsReferenceCount++;
+		UnlockMutex(aDirichletDomain->itsLock);
+	}
+
+	return aDirichletDomain;
 }
 
 
 void FreeDirichletDomain(DirichletDomain **aDirichletDomain)
 {
-	HEVertex	*theDeadVertex;
-	HEHalfEdge	*theDeadHalfEdge;
-	HEFace		*theDeadFace;
+	unsigned int	theReferenceCount;
+
+	//	Let go of the caller's reference to *aDirichletDomain,
+	//	and free it if nobody else holds it.
 
 	if (aDirichletDomain != NULL
 	 && *aDirichletDomain != NULL)
 	{
-		while ((*aDirichletDomain)->itsVertexList != NULL)
+		LockMutex((*aDirichletDomain)->itsLock);
+		theReferenceCount = --(*aDirichletDomain)->itsReferenceCount;
+		UnlockMutex((*aDirichletDomain)->itsLock);
+
+		if (theReferenceCount > 0)
+		{
+			*aDirichletDomain = NULL;
+			return;
+		}
+
+		FreeMutexLock(&(*aDirichletDomain)->itsLock);
+		FREE_MEMORY_SAFELY((*aDirichletDomain)->itsVertexRawPositions);
+		FREE_MEMORY_SAFELY((*aDirichletDomain)->itsVertexHalfspaceStatus);
+		FREE_MEMORY_SAFELY((*aDirichletDomain)->itsVertices);
+		FREE_MEMORY_SAFELY((*aDirichletDomain)->itsHalfEdges);
+		FREE_MEMORY_SAFELY((*aDirichletDomain)->itsFaces);
+		FREE_MEMORY_SAFELY((*aDirichletDomain)->itsNewIndices);
+		FREE_MEMORY_SAFELY((*aDirichletDomain)->itsFaceLookupStarts);
+		FREE_MEMORY_SAFELY((*aDirichletDomain)->itsFaceLookupFaces);
+
+		FREE_MEMORY_SAFELY(*aDirichletDomain);
+	}
+}
+
+
+double DirichletDomainCircumradius(const DirichletDomain *aDirichletDomain)
+{
+	unsigned int	i;
+	Vector			*thePosition;
+	double			theVertexDistance,
+					theCircumradius;
+
+	//	Return the distance from the basepoint (0,0,0,1)
+	//	to the Dirichlet domain's most distant vertex.
+	//
+	//	A group element whose translation distance exceeds
+	//	twice the circumradius can't contribute a face,
+	//	because its bisecting plane lies wholly beyond the domain.
+	//	So once a tiling reaches twice the circumradius,
+	//	the Dirichlet domain is complete.
+
+	if (aDirichletDomain == NULL)
+		return 0.0;
+
+	//	Let the recorded SpaceType, not the vertices' last coordinates,
+	//	decide the geometry.  After roundoff a flat vertex's normalized
+	//	w-coordinate may miss 1.0 by an ulp, which would fool
+	//	VectorGeometricDistance() into treating it as spherical.
+
+	theCircumradius = 0.0;
+
+	for (i = 0; i < aDirichletDomain->itsNumVertices; i++)
+	{
+		thePosition = &aDirichletDomain->itsVertices[i].itsNormalizedPosition;
+
+		switch (aDirichletDomain->itsSpaceType)
+		{
+			case SpaceSpherical:
+				theVertexDistance = SafeAcos(thePosition->v[3]);
+				break;
+
+			case SpaceFlat:
+				theVertexDistance = sqrt(thePosition->v[0] * thePosition->v[0]
+									   + thePosition->v[1] * thePosition->v[1]
+									   + thePosition->v[2] * thePosition->v[2]);
+				break;
+
+			case SpaceHyperbolic:
+				theVertexDistance = SafeAcosh(thePosition->v[3]);
+				break;
+
+			default:
+				theVertexDistance = VectorGeometricDistance(thePosition);
+				break;
+		}
+
+		if (theCircumradius < theVertexDistance)
+			theCircumradius = theVertexDistance;
+	}
+
+	return theCircumradius;
+}
+
+
+void GetDirichletDomainCounts(
+	const DirichletDomain	*aDirichletDomain,	//	input, may be NULL
+	unsigned int			*aNumVertices,		//	output
+	unsigned int			*aNumEdges,			//	output
+	unsigned int			*aNumFaces)			//	output
+{
+	//	The 3-sphere and projective 3-space have no Dirichlet domain,
+	//	and report no vertices, edges or faces.
+	if (aDirichletDomain != NULL)
+	{
+		*aNumVertices	= aDirichletDomain->itsNumVertices;
+		*aNumEdges		= aDirichletDomain->itsNumHalfEdges / 2;
+		*aNumFaces		= aDirichletDomain->itsNumFaces;
+	}
+	else
+	{
+		*aNumVertices	= 0;
+		*aNumEdges		= 0;
+		*aNumFaces		= 0;
+	}
+}
+
+
+bool GetDirichletFacePairing(	//	returns false if aFace is out of range
+	const DirichletDomain	*aDirichletDomain,	//	input
+	unsigned int			aFace,				//	input
+	Matrix					*aFacePairing,		//	output
+	unsigned int			*aMateFace)			//	output
+{
+	HEFace			*theFaces;
+	Matrix			theInverseMatrix;
+	unsigned int	theMate;
+
+	//	Report the group element that defines aFace,
+	//	along with the index of the mate face that its inverse defines.
+	//	A face whose matrix is its own inverse (for example a mirror)
+	//	is its own mate.
+
+	if (aDirichletDomain == NULL
+	 || aFace >= aDirichletDomain->itsNumFaces)
+	{
+		return false;
+	}
+
+	theFaces = aDirichletDomain->itsFaces;
+
+	*aFacePairing	= theFaces[aFace].itsMatrix;
+	*aMateFace		= aFace;
+
+	MatrixGeometricInverse(&theFaces[aFace].itsMatrix, &theInverseMatrix);
+	for (theMate = 0; theMate < aDirichletDomain->itsNumFaces; theMate++)
+	{
+		if (theMate != aFace
+		 && MatrixEquality(&theFaces[theMate].itsMatrix, &theInverseMatrix, MATE_MATRIX_EPSILON))
+		{
+			*aMateFace = theMate;
+			break;
+		}
+	}
+
+	return true;
+}
+
+
+static DirichletDomain *AllocateDirichletDomain(void)
+{
+	DirichletDomain	*theDirichletDomain;
+
+	theDirichletDomain = (DirichletDomain *) GET_MEMORY(sizeof(DirichletDomain));
+	if (theDirichletDomain == NULL)
+		return NULL;
+
+	//	The caller holds the one and only reference.
+	theDirichletDomain->itsLock = CreateMutexLock();
+	if (theDirichletDomain->itsLock == NULL)
+	{
+		FREE_MEMORY(theDirichletDomain);
+		return NULL;
+	}
+	theDirichletDomain->itsReferenceCount				= 1;
+
+	//	Start with empty arrays.
+	//	ReserveDirichletSpace() will allocate them as needed.
+
+	theDirichletDomain->itsNumVertices					= 0;
+	theDirichletDomain->itsVertexArraySize				= 0;
+	theDirichletDomain->itsVertexRawPositions			= NULL;
+	theDirichletDomain->itsVertexHalfspaceStatus		= NULL;
+	theDirichletDomain->itsVertices						= NULL;
+
+	theDirichletDomain->itsNumHalfEdges					= 0;
+	theDirichletDomain->itsHalfEdgeArraySize			= 0;
+	theDirichletDomain->itsHalfEdges					= NULL;
+
+	theDirichletDomain->itsNumFaces						= 0;
+	theDirichletDomain->itsFaceArraySize				= 0;
+	theDirichletDomain->itsFaces						= NULL;
+
+	theDirichletDomain->itsNewIndexArraySize			= 0;
+	theDirichletDomain->itsNewIndices					= NULL;
+
+	theDirichletDomain->itsFaceLookupStarts				= NULL;
+	theDirichletDomain->itsFaceLookupFaces				= NULL;
+
+	theDirichletDomain->itsSpaceType					= SpaceNone;
+	MatrixIdentity(&theDirichletDomain->itsBasepointPlacement);
+
+	theDirichletDomain->itsDirichletNumMeshVertices		= 0;
+	theDirichletDomain->itsDirichletNumMeshFaces		= 0;
+	theDirichletDomain->itsVertexFiguresNumMeshVertices	= 0;
+	theDirichletDomain->itsVertexFiguresNumMeshFaces	= 0;
+
+	return theDirichletDomain;
+}
+
+
+static ErrorText ReserveDirichletSpace(
+	DirichletDomain	*aDirichletDomain,		//	input and output
+	unsigned int	aNumExtraVertices,		//	input
+	unsigned int	aNumExtraHalfEdges,		//	input
+	unsigned int	aNumExtraFaces)			//	input
+{
+	ErrorText		theOutOfMemoryMessage	= u"Out of memory in ReserveDirichletSpace().";
+	unsigned int	theNumNeededVertices,
+					theNumNeededHalfEdges,
+					theNumNeededFaces,
+					theNewSize;
+
+	//	Make sure the arrays have room for the requested number
+	//	of additional components, so the caller may append them
+	//	without the arrays moving.  The caller may hold pointers
+	//	into the arrays until it next calls ReserveDirichletSpace().
+
+	if (aNumExtraVertices  > MAX_HE_ARRAY_SIZE - aDirichletDomain->itsNumVertices
+	 || aNumExtraHalfEdges > MAX_HE_ARRAY_SIZE - aDirichletDomain->itsNumHalfEdges
+	 || aNumExtraFaces     > MAX_HE_ARRAY_SIZE - aDirichletDomain->itsNumFaces)
+	{
+		return u"Dirichlet domain too large in ReserveDirichletSpace().";
+	}
+
+	theNumNeededVertices	= aDirichletDomain->itsNumVertices  + aNumExtraVertices;
+	theNumNeededHalfEdges	= aDirichletDomain->itsNumHalfEdges + aNumExtraHalfEdges;
+	theNumNeededFaces		= aDirichletDomain->itsNumFaces     + aNumExtraFaces;
+
+	if (theNumNeededVertices > aDirichletDomain->itsVertexArraySize)
+	{
+		theNewSize = ArraySizeFor(theNumNeededVertices);
+		if ( ! ResizeArray((void **) &aDirichletDomain->itsVertexRawPositions,    theNewSize, sizeof(Vector           ))
+		 || ! ResizeArray((void **) &aDirichletDomain->itsVertexHalfspaceStatus, theNewSize, sizeof(VertexVsHalfspace))
+		 || ! ResizeArray((void **) &aDirichletDomain->itsVertices,              theNewSize, sizeof(HEVertex         )))
 		{
-			theDeadVertex						= (*aDirichletDomain)->itsVertexList;
-			(*aDirichletDomain)->itsVertexList	= theDeadVertex->itsNext;
-			FREE_MEMORY(theDeadVertex);
+			return theOutOfMemoryMessage;
 		}
+		aDirichletDomain->itsVertexArraySize = theNewSize;
+	}
+
+	if (theNumNeededHalfEdges > aDirichletDomain->itsHalfEdgeArraySize)
+	{
+		theNewSize = ArraySizeFor(theNumNeededHalfEdges);
+		if ( ! ResizeArray((void **) &aDirichletDomain->itsHalfEdges, theNewSize, sizeof(HEHalfEdge)))
+			return theOutOfMemoryMessage;
+		aDirichletDomain->itsHalfEdgeArraySize = theNewSize;
+	}
+
+	if (theNumNeededFaces > aDirichletDomain->itsFaceArraySize)
+	{
+		theNewSize = ArraySizeFor(theNumNeededFaces);
+		if ( ! ResizeArray((void **) &aDirichletDomain->itsFaces, theNewSize, sizeof(HEFace)))
+			return theOutOfMemoryMessage;
+		aDirichletDomain->itsFaceArraySize = theNewSize;
+	}
+
+	//	Keep room for one index per component of the largest array.
+	theNewSize = aDirichletDomain->itsVertexArraySize;
+	if (theNewSize < aDirichletDomain->itsHalfEdgeArraySize)
+		theNewSize = aDirichletDomain->itsHalfEdgeArraySize;
+	if (theNewSize < aDirichletDomain->itsFaceArraySize)
+		theNewSize = aDirichletDomain->itsFaceArraySize;
+	if (theNewSize > aDirichletDomain->itsNewIndexArraySize)
+	{
+		if ( ! ResizeArray((void **) &aDirichletDomain->itsNewIndices, theNewSize, sizeof(uint32_t)))
+			return theOutOfMemoryMessage;
+		aDirichletDomain->itsNewIndexArraySize = theNewSize;
+	}
+
+	return NULL;
+}
+
+
+static unsigned int ArraySizeFor(unsigned int aNumElements)	//	at most MAX_HE_ARRAY_SIZE
+{
+	unsigned int	theArraySize;
+
+	//	Grow the arrays geometrically, so that appending components
+	//	one halfspace at a time costs only amortized constant time
+	//	per component.
+	theArraySize = MIN_HE_ARRAY_SIZE;
+	while (theArraySize < aNumElements)
+		theArraySize *= 2;
+
+	return theArraySize;
+}
+
+
+static bool ResizeArray(
+	void			**anArray,		//	input and output
+	unsigned int	aNumElements,	//	input
+	size_t			anElementSize)	//	input
+{
+	void	*theResizedArray;
+
+	//	Let GET_MEMORY() allocate each array the first time,
+	//	so gMemCount counts it once, and let RESIZE_MEMORY()
+	//	enlarge it thereafter.  If the request fails,
+	//	leave *anArray as it was, for FreeDirichletDomain() to free.
+
+	if (*anArray == NULL)
+		theResizedArray = GET_MEMORY(aNumElements * anElementSize);
+	else
+		theResizedArray = RESIZE_MEMORY(*anArray, aNumElements * anElementSize);
+
+	if (theResizedArray == NULL)
+		return false;
+
+	*anArray = theResizedArray;
+
+	return true;
+}
+
 
-		while ((*aDirichletDomain)->itsHalfEdgeList != NULL)
+static void CompactDirichletDomain(DirichletDomain *aDirichletDomain)
+{
+	uint32_t		*theNewIndices;
+	HEVertex		*theVertices;
+	HEHalfEdge		*theHalfEdges;
+	HEFace			*theFaces;
+	unsigned int	theNumSurvivors,
+					i;
+
+	//	Discard the vertices that lie outside the most recent halfspace,
+	//	along with the half edges and faces that IntersectWithHalfspace()
+	//	marked for deletion.  Slide the survivors down to fill the gaps,
+	//	preserving their relative order, and record each old index's
+	//	new value in theNewIndices so we may update the links.
+
+	theNewIndices	= aDirichletDomain->itsNewIndices;
+	theVertices		= aDirichletDomain->itsVertices;
+	theHalfEdges	= aDirichletDomain->itsHalfEdges;
+	theFaces		= aDirichletDomain->itsFaces;
+
+	//	Vertices
+	theNumSurvivors = 0;
+	for (i = 0; i < aDirichletDomain->itsNumVertices; i++)
+	{
+		if (aDirichletDomain->itsVertexHalfspaceStatus[i] != VertexOutsideHalfspace)
 		{
-			theDeadHalfEdge							= (*aDirichletDomain)->itsHalfEdgeList;
-			(*aDirichletDomain)->itsHalfEdgeList	= theDeadHalfEdge->itsNext;
-			FREE_MEMORY(theDeadHalfEdge);
+			aDirichletDomain->itsVertexRawPositions[theNumSurvivors]	= aDirichletDomain->itsVertexRawPositions[i];
+			aDirichletDomain->itsVertexHalfspaceStatus[theNumSurvivors]	= aDirichletDomain->itsVertexHalfspaceStatus[i];
+			theVertices[theNumSurvivors]								= theVertices[i];
+			theNewIndices[i] = theNumSurvivors++;
 		}
+		else
+			theNewIndices[i] = HE_NO_INDEX;
+	}
+	aDirichletDomain->itsNumVertices = theNumSurvivors;
 
-		while ((*aDirichletDomain)->itsFaceList != NULL)
+	for (i = 0; i < aDirichletDomain->itsNumHalfEdges; i++)
+		theHalfEdges[i].itsTip = theNewIndices[theHalfEdges[i].itsTip];
+
+	//	Half edges
+	theNumSurvivors = 0;
+	for (i = 0; i < aDirichletDomain->itsNumHalfEdges; i++)
+	{
+		if ( ! theHalfEdges[i].itsDeletionFlag )
 		{
-			theDeadFace							= (*aDirichletDomain)->itsFaceList;
-			(*aDirichletDomain)->itsFaceList	= theDeadFace->itsNext;
-			FREE_MEMORY(theDeadFace);
+			theHalfEdges[theNumSurvivors] = theHalfEdges[i];
+			theNewIndices[i] = theNumSurvivors++;
 		}
+		else
+			theNewIndices[i] = HE_NO_INDEX;
+	}
+	aDirichletDomain->itsNumHalfEdges = theNumSurvivors;
 
-		FREE_MEMORY_SAFELY(*aDirichletDomain);
+	for (i = 0; i < aDirichletDomain->itsNumHalfEdges; i++)
+	{
+		theHalfEdges[i].itsMate		= theNewIndices[theHalfEdges[i].itsMate ];
+		theHalfEdges[i].itsCycle	= theNewIndices[theHalfEdges[i].itsCycle];
+	}
+	for (i = 0; i < aDirichletDomain->itsNumVertices; i++)
+		theVertices[i].itsOutboundHalfEdge = theNewIndices[theVertices[i].itsOutboundHalfEdge];
+	for (i = 0; i < aDirichletDomain->itsNumFaces; i++)
+		theFaces[i].itsHalfEdge = theNewIndices[theFaces[i].itsHalfEdge];
+
+	//	Faces
+	theNumSurvivors = 0;
+	for (i = 0; i < aDirichletDomain->itsNumFaces; i++)
+	{
+		if ( ! theFaces[i].itsDeletionFlag )
+		{
+			theFaces[theNumSurvivors] = theFaces[i];
+			theNewIndices[i] = theNumSurvivors++;
+		}
+		else
+			theNewIndices[i] = HE_NO_INDEX;
 	}
+	aDirichletDomain->itsNumFaces = theNumSurvivors;
+
+	for (i = 0; i < aDirichletDomain->itsNumHalfEdges; i++)
+		theHalfEdges[i].itsFace = theNewIndices[theHalfEdges[i].itsFace];
 }
 
 
@@ -541,13 +1726,13 @@ static ErrorText MakeBanana(
 	Matrix			*aMatrixC,			//	input
 	DirichletDomain	**aDirichletDomain)	//	output
 {
-	ErrorText		theErrorMessage			= NULL,
-					theOutOfMemoryMessage	= u"Out of memory in MakeBanana().";
+	ErrorText		theErrorMessage			= NULL;
 	Matrix			*theMatrices[3];
 	Vector			theHalfspaces[3];
-	HEVertex		*theVertices[2];
-	HEHalfEdge		*theHalfEdges[3][2];	//	indexed by which face, coming from which vertex
-	HEFace			*theFaces[3];
+	Vector			*theRawPositions;
+	HEVertex		*theVertices;
+	HEHalfEdge		*theHalfEdges;
+	HEFace			*theFaces;
 	unsigned int	i,
 					j;
 
@@ -567,56 +1752,31 @@ static ErrorText MakeBanana(
 	for (i = 0; i < 3; i++)
 		MakeHalfspaceInequality(theMatrices[i], &theHalfspaces[i]);
 
-	//	Allocate the base DirichletDomain structure.
-	//	Initialize its lists to NULL immediately, so everything will be kosher
-	//	if we encounter an error later in the construction.
-	*aDirichletDomain = (DirichletDomain *) GET_MEMORY(sizeof(DirichletDomain));
+	//	Allocate the base DirichletDomain structure, with empty arrays,
+	//	so everything will be kosher if we encounter an error later
+	//	in the construction.
+	*aDirichletDomain = AllocateDirichletDomain();
 	if (*aDirichletDomain == NULL)
 	{
-		theErrorMessage = theOutOfMemoryMessage;
+		theErrorMessage = u"Out of memory in MakeBanana().";
 		goto CleanUpMakeBanana;
 	}
-	(*aDirichletDomain)->itsVertexList		= NULL;
-	(*aDirichletDomain)->itsHalfEdgeList	= NULL;
-	(*aDirichletDomain)->itsFaceList		= NULL;
 
-	//	Allocate memory for the new vertices, half edges and faces.
-	//	Put them on the Dirichlet domain's linked lists immediately,
-	//	so that if anything goes wrong all memory will get freed.
-	for (i = 0; i < 2; i++)
-	{
-		theVertices[i] = (HEVertex *) GET_MEMORY(sizeof(HEVertex));
-		if (theVertices[i] == NULL)
-		{
-			theErrorMessage = theOutOfMemoryMessage;
-			goto CleanUpMakeBanana;
-		}
-		theVertices[i]->itsNext				= (*aDirichletDomain)->itsVertexList;
-		(*aDirichletDomain)->itsVertexList	= theVertices[i];
-	}
-	for (i = 0; i < 3; i++)
-		for (j = 0; j < 2; j++)
-		{
-			theHalfEdges[i][j] = (HEHalfEdge *) GET_MEMORY(sizeof(HEHalfEdge));
-			if (theHalfEdges[i][j] == NULL)
-			{
-				theErrorMessage = theOutOfMemoryMessage;
-				goto CleanUpMakeBanana;
-			}
-			theHalfEdges[i][j]->itsNext				= (*aDirichletDomain)->itsHalfEdgeList;
-			(*aDirichletDomain)->itsHalfEdgeList	= theHalfEdges[i][j];
-		}
-	for (i = 0; i < 3; i++)
-	{
-		theFaces[i] = (HEFace *) GET_MEMORY(sizeof(HEFace));
-		if (theFaces[i] == NULL)
-		{
-			theErrorMessage = theOutOfMemoryMessage;
-			goto CleanUpMakeBanana;
-		}
-		theFaces[i]->itsNext				= (*aDirichletDomain)->itsFaceList;
-		(*aDirichletDomain)->itsFaceList	= theFaces[i];
-	}
+	//	Make room for 2 vertices, 3×2 half edges and 3 faces.
+	//	Because the arrays start out empty, vertex i sits at index i,
+	//	the half edge on face i coming from vertex j sits at index 2i + j,
+	//	and face i sits at index i.
+	theErrorMessage = ReserveDirichletSpace(*aDirichletDomain, 2, 3*2, 3);
+	if (theErrorMessage != NULL)
+		goto CleanUpMakeBanana;
+	(*aDirichletDomain)->itsNumVertices		= 2;
+	(*aDirichletDomain)->itsNumHalfEdges	= 3*2;
+	(*aDirichletDomain)->itsNumFaces		= 3;
+
+	theRawPositions	= (*aDirichletDomain)->itsVertexRawPositions;
+	theVertices		= (*aDirichletDomain)->itsVertices;
+	theHalfEdges	= (*aDirichletDomain)->itsHalfEdges;
+	theFaces		= (*aDirichletDomain)->itsFaces;
 
 	//	Set up the vertices.
 
@@ -637,7 +1797,7 @@ static ErrorText MakeBanana(
 	//
 	//				(-1, -ε/2, -ε/2, -ε/2)
 	//
-	//	So with the half edge pointers organized as below, we want
+	//	So with the half edge indices organized as below, we want
 	//	the cross product to be vertex 0 (near the south pole (0,0,0,-1))
 	//	and it's negative to be vertex 1 (near the north pole (0,0,0,+1))
 	//	to give clockwise oriented faces in our left-handed coordinate system.
@@ -648,44 +1808,44 @@ static ErrorText MakeBanana(
 	VectorTernaryCrossProduct(	&theHalfspaces[0],
 								&theHalfspaces[1],
 								&theHalfspaces[2],
-								&theVertices[0]->itsRawPosition);
-	VectorNegate(	&theVertices[0]->itsRawPosition,
-					&theVertices[1]->itsRawPosition);
+								&theRawPositions[0]);
+	VectorNegate(	&theRawPositions[0],
+					&theRawPositions[1]);
 
 	for (i = 0; i < 2; i++)
 	{
 		//	Let each vertex see an outbound edge on face 0.
-		theVertices[i]->itsOutboundHalfEdge = theHalfEdges[0][i];
+		theVertices[i].itsOutboundHalfEdge = 2*0 + i;
 	}
 
 	//	Set up the half edges.
 	for (i = 0; i < 3; i++)
 		for (j = 0; j < 2; j++)
 		{
-			//	Let theHalfEdges[i][j] run from vertex j to vertex ~j.
-			theHalfEdges[i][j]->itsTip = theVertices[!j];
+			//	Let half edge 2i + j run from vertex j to vertex ~j.
+			theHalfEdges[2*i + j].itsTip = !j;
 
 			//	It mate sits on a neighboring face.
-			theHalfEdges[i][j]->itsMate = theHalfEdges[(i+1+j)%3][!j];
+			theHalfEdges[2*i + j].itsMate = 2*((i+1+j)%3) + !j;
 
 			//	Two two half edges on each face form their own cycle.
-			theHalfEdges[i][j]->itsCycle = theHalfEdges[i][!j];
+			theHalfEdges[2*i + j].itsCycle = 2*i + !j;
 
 			//	The edge sees the face.
-			theHalfEdges[i][j]->itsFace = theFaces[i];
+			theHalfEdges[2*i + j].itsFace = i;
 		}
 
 	//	Set up the faces.
 	for (i = 0; i < 3; i++)
 	{
 		//	The face sees one of its edges.
-		theFaces[i]->itsHalfEdge = theHalfEdges[i][0];
+		theFaces[i].itsHalfEdge = 2*i + 0;
 
 		//	Copy the matrix.
-		theFaces[i]->itsMatrix = *theMatrices[i];
+		theFaces[i].itsMatrix = *theMatrices[i];
 
 		//	Set the halfspace inequality.
-		theFaces[i]->itsHalfspace = theHalfspaces[i];
+		theFaces[i].itsHalfspace = theHalfspaces[i];
 	}
 
 CleanUpMakeBanana:
@@ -700,23 +1860,34 @@ CleanUpMakeBanana:
 static ErrorText MakeLens(
 	Matrix			*aMatrixA,			//	input
 	Matrix			*aMatrixB,			//	input
+	unsigned int	aGroupOrder,		//	input, used only for a tilted lens space
 	DirichletDomain	**aDirichletDomain)	//	output
 {
 	//	This is not a fully general algorithm!
 	//	It assumes a central axis passing through the basepoint (0,0,0,1)
 	//	and running in the z-direction.  In other words, it assumes
 	//	the face planes, whether for a lens or for a slab,
-	//	are “parallel” to the xy-plane.
+	//	are “parallel” to the xy-plane.  The one exception
+	//	is a lens space seen from a basepoint that
+	//	ConstructDirichletDomainAtBasepoint() has moved.
 
-	ErrorText		theErrorMessage			= NULL,
-					theOutOfMemoryMessage	= u"Out of memory in MakeLens().";
+	ErrorText		theErrorMessage			= NULL;
 	unsigned int	n;
-	double			theApproximateN;
-	HEVertex		**theVertices		= NULL;	//	*theVertices[n]
-	HEHalfEdge		*(*theHalfEdges)[2]	= NULL;	//	*theHalfEdges[n][2]
-	HEFace			*theFaces[2];
+	double			theApproximateN,
+					theDotProduct;
+	bool			theOrderIsKnown;
+	Vector			theBasis[4],
+					theVertex,
+					theImage;
+	Matrix			theFrame,
+					*theMatrix;
+	Vector			*theRawPositions;
+	HEVertex		*theVertices;
+	HEHalfEdge		*theHalfEdges;
+	HEFace			*theFaces;
 	unsigned int	i,
-					j;
+					j,
+					k;
 
 	//	Make sure the output pointer is clear.
 	if (*aDirichletDomain != NULL)
@@ -725,9 +1896,12 @@ static ErrorText MakeLens(
 	//	The two face planes will meet along the circle
 	//	{x² + y² = 1, z² + w² = 0}, which we divide into n segments
 	//	(n ≥ 3) in such a way as to respect the group.
+	//	theBasis[2] and theBasis[3] span that circle.
 	//
 	//	Warning:  The determination of n is ad hoc and will
 	//	work only with the sorts of matrices we are expecting!
+	theBasis[2] = (Vector) {{1.0, 0.0, 0.0, 0.0}};
+	theBasis[3] = (Vector) {{0.0, 1.0, 0.0, 0.0}};
 	if (aMatrixA->m[3][3] == 1.0)
 	{
 		//	Flat space.
@@ -738,158 +1912,229 @@ static ErrorText MakeLens(
 	else if (aMatrixA->m[3][3] < 1.0)
 	{
 		//	Lens space.
-		//	Infer the order from the zw-rotation.
-		if (aMatrixA->m[0][2] != 0.0 || aMatrixA->m[0][3] != 0.0
-		 || aMatrixA->m[1][2] != 0.0 || aMatrixA->m[1][3] != 0.0
-		 || aMatrixA->m[2][0] != 0.0 || aMatrixA->m[2][1] != 0.0
-		 || aMatrixA->m[3][0] != 0.0 || aMatrixA->m[3][1] != 0.0)
+		//	Infer the order from the zw-rotation, if there is one.
+		theOrderIsKnown = false;
+		if (aMatrixA->m[0][2] == 0.0 && aMatrixA->m[0][3] == 0.0
+		 && aMatrixA->m[1][2] == 0.0 && aMatrixA->m[1][3] == 0.0
+		 && aMatrixA->m[2][0] == 0.0 && aMatrixA->m[2][1] == 0.0
+		 && aMatrixA->m[3][0] == 0.0 && aMatrixA->m[3][1] == 0.0)
 		{
-			theErrorMessage = u"MakeLens() confused by potential lens space.";
-			goto CleanUpMakeLens;
+			theApproximateN = (2*PI)/fabs(atan2(aMatrixA->m[3][2], aMatrixA->m[3][3]));
+			n = (unsigned int)floor(theApproximateN + 0.5);
+			theOrderIsKnown = (fabs(theApproximateN - n) <= ORDER_EPSILON);
 		}
 
-		theApproximateN = (2*PI)/fabs(atan2(aMatrixA->m[3][2], aMatrixA->m[3][3]));
-		n = (unsigned int)floor(theApproximateN + 0.5);
-		if (fabs(theApproximateN - n) > ORDER_EPSILON)
+		if ( ! theOrderIsKnown )
 		{
-			theErrorMessage = u"MakeLens() couldn't deduce order of potential lens space.";
-			goto CleanUpMakeLens;
-		}
-	}
-	else
-	{
-		theErrorMessage = u"MakeLens() can't handle hyperbolic slab spaces.";
-		goto CleanUpMakeLens;
-	}
-
-	//	Allocate the base DirichletDomain structure.
-	//	Initialize its lists to NULL immediately, so everything will be kosher
-	//	if we encounter an error later in the construction.
-	*aDirichletDomain = (DirichletDomain *) GET_MEMORY(sizeof(DirichletDomain));
-	if (*aDirichletDomain == NULL)
-	{
-		theErrorMessage = theOutOfMemoryMessage;
-		goto CleanUpMakeLens;
-	}
-	(*aDirichletDomain)->itsVertexList		= NULL;
-	(*aDirichletDomain)->itsHalfEdgeList	= NULL;
-	(*aDirichletDomain)->itsFaceList		= NULL;
+			//	Either the axis is tilted, or the basepoint has slid
+			//	along the axis of a mirrored lens, so that aMatrixA
+			//	no longer moves it through a whole segment.
+			//	Either way, the face planes meet along whichever great circle
+			//	is orthogonal to both faces' normal vectors.
+			//	Let theBasis[0] and theBasis[1] span the normal vectors,
+			//	and fill in theBasis[2] and theBasis[3] orthogonal to them.
+			MakeHalfspaceInequality(aMatrixA, &theBasis[0]);
+			MakeHalfspaceInequality(aMatrixB, &theBasis[1]);
+			VectorNormalize(&theBasis[0], SpaceSpherical, &theBasis[0]);
+			theDotProduct = VectorDotProduct(&theBasis[1], &theBasis[0]);
+			for (j = 0; j < 4; j++)
+				theBasis[1].v[j] -= theDotProduct * theBasis[0].v[j];
+			if (VectorDotProduct(&theBasis[1], &theBasis[1]) < LENS_AXIS_EPSILON)
+			{
+				theErrorMessage = u"MakeLens() confused by potential lens space.";
+				goto CleanUpMakeLens;
+			}
+			VectorNormalize(&theBasis[1], SpaceSpherical, &theBasis[1]);
+			ChooseCircleVector(2, theBasis, &theBasis[2]);
+			ChooseCircleVector(3, theBasis, &theBasis[3]);
+
+			//	Orient the circle the way the xy-circle sits
+			//	relative to an untilted lens's face normals.
+			theFrame.itsParity = ImagePositive;
+			for (j = 0; j < 4; j++)
+				for (k = 0; k < 4; k++)
+					theFrame.m[j][k] = theBasis[(j + 2) % 4].v[k];
+			if (MatrixDeterminant(&theFrame) < 0.0)
+				VectorNegate(&theBasis[3], &theBasis[3]);
+
+			//	Without the zw-rotation to go by, let each group element
+			//	get its own segment.  For a Lens(n,1) or a mirrored lens
+			//	centered on the z-axis, that's the same n as above.
+			n = aGroupOrder;
+			if (n < 3)
+			{
+				theErrorMessage = u"MakeLens() couldn't deduce order of potential lens space.";
+				goto CleanUpMakeLens;
+			}
 
-	//	Allocate memory for the new vertices, half edges and faces.
-	//	Put them on the Dirichlet domain's linked lists immediately,
-	//	so that if anything goes wrong all memory will get freed.
+			//	aMatrixA and aMatrixB must take the circle to itself,
+			//	and take the first two vertices to vertices.
+			for (i = 0; i < 2; i++)
+			{
+				theMatrix = (i == 0 ? aMatrixA : aMatrixB);
 
-	theVertices = (HEVertex **) GET_MEMORY(n * sizeof(HEVertex *));
-	if (theVertices == NULL)
-	{
-		theErrorMessage = theOutOfMemoryMessage;
-		goto CleanUpMakeLens;
-	}
-	for (i = 0; i < n; i++)
-	{
-		theVertices[i] = (HEVertex *) GET_MEMORY(sizeof(HEVertex));
-		if (theVertices[i] == NULL)
-		{
-			theErrorMessage = theOutOfMemoryMessage;
-			goto CleanUpMakeLens;
+				for (k = 0; k < 2; k++)
+				{
+					for (j = 0; j < 4; j++)
+						theVertex.v[j] = cos(k*2*PI/n) * theBasis[2].v[j]
+									   + sin(k*2*PI/n) * theBasis[3].v[j];
+					VectorTimesMatrix(&theVertex, theMatrix, &theImage);
+
+					if (fabs(VectorDotProduct(&theImage, &theBasis[0])) > LENS_AXIS_EPSILON
+					 || fabs(VectorDotProduct(&theImage, &theBasis[1])) > LENS_AXIS_EPSILON)
+					{
+						theErrorMessage = u"MakeLens() confused by potential lens space.";
+						goto CleanUpMakeLens;
+					}
+
+					theApproximateN = n * atan2(VectorDotProduct(&theImage, &theBasis[3]),
+												VectorDotProduct(&theImage, &theBasis[2])) / (2*PI);
+					if (fabs(theApproximateN - floor(theApproximateN + 0.5)) > ORDER_EPSILON)
+					{
+						theErrorMessage = u"MakeLens() couldn't deduce order of potential lens space.";
+						goto CleanUpMakeLens;
+					}
+				}
+			}
 		}
-		theVertices[i]->itsNext				= (*aDirichletDomain)->itsVertexList;
-		(*aDirichletDomain)->itsVertexList	= theVertices[i];
 	}
-
-	theHalfEdges = (HEHalfEdge *(*)[2]) GET_MEMORY(n * sizeof(HEHalfEdge *[2]));
-	if (theHalfEdges == NULL)
+	else
 	{
-		theErrorMessage = theOutOfMemoryMessage;
+		theErrorMessage = u"MakeLens() can't handle hyperbolic slab spaces.";
 		goto CleanUpMakeLens;
 	}
-	for (i = 0; i < n; i++)
-		for (j = 0; j < 2; j++)
-		{
-			theHalfEdges[i][j] = (HEHalfEdge *) GET_MEMORY(sizeof(HEHalfEdge));
-			if (theHalfEdges[i][j] == NULL)
-			{
-				theErrorMessage = theOutOfMemoryMessage;
-				goto CleanUpMakeLens;
-			}
-			theHalfEdges[i][j]->itsNext				= (*aDirichletDomain)->itsHalfEdgeList;
-			(*aDirichletDomain)->itsHalfEdgeList	= theHalfEdges[i][j];
-		}
 
-	for (i = 0; i < 2; i++)
+	//	Allocate the base DirichletDomain structure, with empty arrays,
+	//	so everything will be kosher if we encounter an error later
+	//	in the construction.
+	*aDirichletDomain = AllocateDirichletDomain();
+	if (*aDirichletDomain == NULL)
 	{
-		theFaces[i] = (HEFace *) GET_MEMORY(sizeof(HEFace));
-		if (theFaces[i] == NULL)
-		{
-			theErrorMessage = theOutOfMemoryMessage;
-			goto CleanUpMakeLens;
-		}
-		theFaces[i]->itsNext				= (*aDirichletDomain)->itsFaceList;
-		(*aDirichletDomain)->itsFaceList	= theFaces[i];
+		theErrorMessage = u"Out of memory in MakeLens().";
+		goto CleanUpMakeLens;
 	}
 
+	//	Make room for n vertices, n×2 half edges and 2 faces.
+	//	Because the arrays start out empty, vertex i sits at index i,
+	//	the half edge on face j leaving (resp. entering) vertex i
+	//	sits at index 2i + j, and face j sits at index j.
+	theErrorMessage = ReserveDirichletSpace(*aDirichletDomain, n, n*2, 2);
+	if (theErrorMessage != NULL)
+		goto CleanUpMakeLens;
+	(*aDirichletDomain)->itsNumVertices		= n;
+	(*aDirichletDomain)->itsNumHalfEdges	= n*2;
+	(*aDirichletDomain)->itsNumFaces		= 2;
+
+	theRawPositions	= (*aDirichletDomain)->itsVertexRawPositions;
+	theVertices		= (*aDirichletDomain)->itsVertices;
+	theHalfEdges	= (*aDirichletDomain)->itsHalfEdges;
+	theFaces		= (*aDirichletDomain)->itsFaces;
+
 	//	Set up the vertices.
 	for (i = 0; i < n; i++)
 	{
-		//	All vertices sit on the xy circle.
-		theVertices[i]->itsRawPosition.v[0] = cos(i*2*PI/n);
-		theVertices[i]->itsRawPosition.v[1] = sin(i*2*PI/n);
-		theVertices[i]->itsRawPosition.v[2] = 0.0;
-		theVertices[i]->itsRawPosition.v[3] = 0.0;
+		//	All vertices sit on the circle spanned by theBasis[2] and theBasis[3],
+		//	which is the xy circle unless the lens's axis is tilted.
+		//	Adding 0.0 turns any -0.0 into 0.0, so the xy circle's
+		//	vertices come out bit-for-bit the same as they always have.
+		for (j = 0; j < 4; j++)
+			theRawPositions[i].v[j] = cos(i*2*PI/n) * theBasis[2].v[j]
+									+ sin(i*2*PI/n) * theBasis[3].v[j]
+									+ 0.0;
 
 		//	Let each vertex see an outbound edge on face 0
 		//	(the face sitting at positive z).
-		theVertices[i]->itsOutboundHalfEdge = theHalfEdges[i][0];
+		theVertices[i].itsOutboundHalfEdge = 2*i + 0;
 	}
 
 	//	Set up the half edges.
 	for (i = 0; i < n; i++)
 	{
-		//	Let theHalfEdges[i][j] connect vertex i to vertex (i+1)%n.
+		//	Let half edges 2i + 0 and 2i + 1 connect vertex i to vertex (i+1)%n.
 		//	On face 0 (at positive z) the half edge runs "forward"
 		//	while on face 1 (at negative z) the half edge runs "backwards".
-		theHalfEdges[i][0]->itsTip = theVertices[(i+1)%n];
-		theHalfEdges[i][1]->itsTip = theVertices[   i   ];
+		theHalfEdges[2*i + 0].itsTip = (i+1)%n;
+		theHalfEdges[2*i + 1].itsTip =    i   ;
 
-		//	theHalfEdges[i][0] and theHalfEdges[i][1] are mates.
-		theHalfEdges[i][0]->itsMate = theHalfEdges[i][1];
-		theHalfEdges[i][1]->itsMate = theHalfEdges[i][0];
+		//	Half edges 2i + 0 and 2i + 1 are mates.
+		theHalfEdges[2*i + 0].itsMate = 2*i + 1;
+		theHalfEdges[2*i + 1].itsMate = 2*i + 0;
 
 		//	All half edges should cycle clockwise as seen from the outside.
-		theHalfEdges[i][0]->itsCycle = theHalfEdges[( i+1 )%n][0];
-		theHalfEdges[i][1]->itsCycle = theHalfEdges[(i+n-1)%n][1];
+		theHalfEdges[2*i + 0].itsCycle = 2*(( i+1 )%n) + 0;
+		theHalfEdges[2*i + 1].itsCycle = 2*((i+n-1)%n) + 1;
 
 		//	Note the faces.
-		theHalfEdges[i][0]->itsFace = theFaces[0];
-		theHalfEdges[i][1]->itsFace = theFaces[1];
+		theHalfEdges[2*i + 0].itsFace = 0;
+		theHalfEdges[2*i + 1].itsFace = 1;
 	}
 
 	//	Set up the faces.
 
 	//		Each face sees one of its edges.
-	theFaces[0]->itsHalfEdge = theHalfEdges[0][0];
-	theFaces[1]->itsHalfEdge = theHalfEdges[0][1];
+	theFaces[0].itsHalfEdge = 2*0 + 0;
+	theFaces[1].itsHalfEdge = 2*0 + 1;
 
 	//		Set the halfspace inequalities.
-	MakeHalfspaceInequality(aMatrixA, &theFaces[0]->itsHalfspace);
-	MakeHalfspaceInequality(aMatrixB, &theFaces[1]->itsHalfspace);
+	MakeHalfspaceInequality(aMatrixA, &theFaces[0].itsHalfspace);
+	MakeHalfspaceInequality(aMatrixB, &theFaces[1].itsHalfspace);
 
 	//		Copy the matrices.
-	theFaces[0]->itsMatrix = *aMatrixA;
-	theFaces[1]->itsMatrix = *aMatrixB;
+	theFaces[0].itsMatrix = *aMatrixA;
+	theFaces[1].itsMatrix = *aMatrixB;
 
 CleanUpMakeLens:
 
 	if (theErrorMessage != NULL)
 		FreeDirichletDomain(aDirichletDomain);
 
-	FREE_MEMORY_SAFELY(theHalfEdges);
-	FREE_MEMORY_SAFELY(theVertices);
-
 	return theErrorMessage;
 }
 
 
+static void ChooseCircleVector(
+	unsigned int	aNumBasisVectors,	//	input
+	Vector			*someBasisVectors,	//	input, orthonormal
+	Vector			*aCircleVector)		//	output
+{
+	Vector			theCandidate,
+					theBestCandidate		= {{0.0, 0.0, 0.0, 0.0}};
+	double			theDotProduct,
+					theLengthSquared,
+					theBestLengthSquared	= 0.0;
+	unsigned int	i,
+					j,
+					k;
+
+	//	Of the unit vectors in the x, y, z and w directions,
+	//	find the one lying furthest from the span of someBasisVectors,
+	//	and return the unit vector in the direction
+	//	of its component orthogonal to them.
+
+	for (i = 0; i < 4; i++)
+	{
+		for (j = 0; j < 4; j++)
+			theCandidate.v[j] = (i == j) ? 1.0 : 0.0;
+
+		for (k = 0; k < aNumBasisVectors; k++)
+		{
+			theDotProduct = VectorDotProduct(&theCandidate, &someBasisVectors[k]);
+			for (j = 0; j < 4; j++)
+				theCandidate.v[j] -= theDotProduct * someBasisVectors[k].v[j];
+		}
+
+		theLengthSquared = VectorDotProduct(&theCandidate, &theCandidate);
+		if (theLengthSquared > theBestLengthSquared)
+		{
+			theBestCandidate		= theCandidate;
+			theBestLengthSquared	= theLengthSquared;
+		}
+	}
+
+	VectorNormalize(&theBestCandidate, SpaceSpherical, aCircleVector);
+}
+
+
 static void MakeHalfspaceInequality(
 	Matrix	*aMatrix,		//	input
 	Vector	*anInequality)	//	output
@@ -935,35 +2180,35 @@ static ErrorText IntersectWithHalfspace(
 	DirichletDomain	*aDirichletDomain,	//	input and output
 	Matrix			*aMatrix)			//	input
 {
-	ErrorText	theMemoryError = u"Memory request failed in IntersectWithHalfspace().";
-	Vector		theHalfspace;
-	bool		theCutIsNontrivial;
-	double		theDotProduct;
-	HEVertex	*theVertex,
-				*theVertex1,
-				*theVertex2,
-				*theNewVertex;
-	HEHalfEdge	*theHalfEdge1,
-				*theHalfEdge1a,
-				*theHalfEdge1b,
-				*theHalfEdge2,
-				*theHalfEdge2a,
-				*theHalfEdge2b;
-	HEFace		*theFace,
-				*theInnerFace,
-				*theOuterFace;
-	HEHalfEdge	*theGoingOutEdge,
-				*theGoingInEdge,
-				*theHalfEdge,
-				*theInnerHalfEdge,
-				*theOuterHalfEdge;
-	HEFace		*theNewFace;
-	HEVertex	**theVertexPtr,
-				*theDeadVertex;
-	HEHalfEdge	**theHalfEdgePtr,
-				*theDeadHalfEdge;
-	HEFace		**theFacePtr,
-				*theDeadFace;
+	ErrorText			theErrorMessage;
+	Vector				theHalfspace;
+	unsigned int		theStatusMask;
+	Vector				*theRawPositions;
+	VertexVsHalfspace	*theStatus;
+	HEVertex			*theVertices;
+	HEHalfEdge			*theHalfEdges;
+	HEFace				*theFaces;
+	unsigned int		theNumOldHalfEdges,
+						theNumOldFaces,
+						theVertex,
+						theVertex1,
+						theVertex2,
+						theNewVertex,
+						theHalfEdge1,
+						theHalfEdge1a,
+						theHalfEdge1b,
+						theHalfEdge2,
+						theHalfEdge2a,
+						theHalfEdge2b,
+						theFace,
+						theInnerFace,
+						theOuterFace,
+						theGoingOutEdge,
+						theGoingInEdge,
+						theHalfEdge,
+						theInnerHalfEdge,
+						theOuterHalfEdge,
+						theNewFace;
 
 	//	Ignore the identity matrix.
 	if (MatrixIsIdentity(aMatrix))
@@ -975,48 +2220,47 @@ static ErrorText IntersectWithHalfspace(
 	//	Evaluate the halfspace equation on all vertices
 	//	of the provisional Dirichlet domain.
 	//	Work with raw (non-normalized) positions for now.
-
-	theCutIsNontrivial = false;
-
-	for (	theVertex = aDirichletDomain->itsVertexList;
-			theVertex != NULL;
-			theVertex = theVertex->itsNext)
-	{
-		theDotProduct = VectorDotProduct(&theHalfspace, &theVertex->itsRawPosition);
-
-		if (theDotProduct < -VERTEX_HALFSPACE_EPSILON)
-		{
-			theVertex->itsHalfspaceStatus = VertexInsideHalfspace;
-		}
-		else
-		if (theDotProduct > +VERTEX_HALFSPACE_EPSILON)
-		{
-			theVertex->itsHalfspaceStatus = VertexOutsideHalfspace;
-			theCutIsNontrivial = true;
-		}
-		else
-		{
-			theVertex->itsHalfspaceStatus = VertexOnBoundary;
-		}
-	}
+	theStatusMask = ClassifyVertices(	aDirichletDomain->itsNumVertices,
+										aDirichletDomain->itsVertexRawPositions,
+										&theHalfspace,
+										aDirichletDomain->itsVertexHalfspaceStatus);
 
 	//	If the halfspace fails to cut aDirichletDomain,
 	//	nothing needs to be done.
-	if ( ! theCutIsNontrivial )
+	if ( ! (theStatusMask & VERTEX_STATUS_BIT(VertexOutsideHalfspace)) )
 		return NULL;
 
+	//	Make room for the worst case, in which the halfspace cuts
+	//	every edge (adding a vertex and two half edges per edge)
+	//	and every face (adding two half edges and a face per face),
+	//	and then contributes one new face of its own.
+	//	Once the room is reserved the arrays won't move,
+	//	so we may keep pointers into them for the rest of this function.
+	theErrorMessage = ReserveDirichletSpace(	aDirichletDomain,
+												aDirichletDomain->itsNumHalfEdges / 2,
+												aDirichletDomain->itsNumHalfEdges + 2 * aDirichletDomain->itsNumFaces,
+												aDirichletDomain->itsNumFaces + 1);
+	if (theErrorMessage != NULL)
+		return theErrorMessage;
+
+	theRawPositions	= aDirichletDomain->itsVertexRawPositions;
+	theStatus		= aDirichletDomain->itsVertexHalfspaceStatus;
+	theVertices		= aDirichletDomain->itsVertices;
+	theHalfEdges	= aDirichletDomain->itsHalfEdges;
+	theFaces		= aDirichletDomain->itsFaces;
+
 	//	Wherever the slicing halfspace crosses an edge,
 	//	introduce a new vertex at the cut point.
-	for (	theHalfEdge1 = aDirichletDomain->itsHalfEdgeList;
-			theHalfEdge1 != NULL;
-			theHalfEdge1 = theHalfEdge1->itsNext)
+	//	Visit only the half edges that were present at the start.
+	theNumOldHalfEdges = aDirichletDomain->itsNumHalfEdges;
+	for (theHalfEdge1 = theNumOldHalfEdges; theHalfEdge1-- > 0; )
 	{
 		//	Find the mate.
-		theHalfEdge2 = theHalfEdge1->itsMate;
+		theHalfEdge2 = theHalfEdges[theHalfEdge1].itsMate;
 
 		//	Find the adjacent vertices.
-		theVertex1 = theHalfEdge1->itsTip;
-		theVertex2 = theHalfEdge2->itsTip;
+		theVertex1 = theHalfEdges[theHalfEdge1].itsTip;
+		theVertex2 = theHalfEdges[theHalfEdge2].itsTip;
 
 		//	Does the edge get cut?
 		//
@@ -1026,8 +2270,8 @@ static ErrorText IntersectWithHalfspace(
 		//	a reliable orientation for the ternary cross product.
 		//	The for(;;) loop will eventually consider all half edges,
 		//	so all edges will get properly cut.
-		if (theVertex1->itsHalfspaceStatus == VertexInsideHalfspace
-		 && theVertex2->itsHalfspaceStatus == VertexOutsideHalfspace)
+		if (theStatus[theVertex1] == VertexInsideHalfspace
+		 && theStatus[theVertex2] == VertexOutsideHalfspace)
 		{
 			//	Split the pair of half edges as shown.
 			//	(View this diagram in a mirror if you're orienting
@@ -1037,14 +2281,10 @@ static ErrorText IntersectWithHalfspace(
 			//		  1      ---2b---> vertex  ---2a--->   2
 			//
 
-			//	Create a new vertex and put it on the list.
-			theNewVertex = (HEVertex *) GET_MEMORY(sizeof(HEVertex));
-			if (theNewVertex == NULL)
-				return theMemoryError;
-			theNewVertex->itsNext			= aDirichletDomain->itsVertexList;
-			aDirichletDomain->itsVertexList	= theNewVertex;
+			//	Append a new vertex.
+			theNewVertex = aDirichletDomain->itsNumVertices++;
 
-			//	Set the new vertex's raw position, along with itsHalfspaceStatus.
+			//	Set the new vertex's raw position, along with its halfspace status.
 			//	We'll compute the normalized position when the Dirichlet domain
 			//	is complete.
 			//
@@ -1054,61 +2294,51 @@ static ErrorText IntersectWithHalfspace(
 			//	for one set of inputs it should remain right for all other
 			//	inputs as well.  (Yes, I know, I should give this more
 			//	careful thought!)
-			VectorTernaryCrossProduct(	&theHalfEdge1->itsFace->itsHalfspace,
-										&theHalfEdge2->itsFace->itsHalfspace,
+			VectorTernaryCrossProduct(	&theFaces[theHalfEdges[theHalfEdge1].itsFace].itsHalfspace,
+										&theFaces[theHalfEdges[theHalfEdge2].itsFace].itsHalfspace,
 										&theHalfspace,
-										&theNewVertex->itsRawPosition);
-			theNewVertex->itsHalfspaceStatus = VertexOnBoundary;
+										&theRawPositions[theNewVertex]);
+			theStatus[theNewVertex] = VertexOnBoundary;
 
-			//	We'll set theNewVertex->itsOutboundHalfEdge in a moment,
+			//	We'll set the new vertex's itsOutboundHalfEdge in a moment,
 			//	after the creating the new edges.
 
-			//	Create two new edges and put them on the list.
-
-			theHalfEdge1a = (HEHalfEdge *) GET_MEMORY(sizeof(HEHalfEdge));
-			if (theHalfEdge1a == NULL)
-				return theMemoryError;
-			theHalfEdge1a->itsNext				= aDirichletDomain->itsHalfEdgeList;
-			aDirichletDomain->itsHalfEdgeList	= theHalfEdge1a;
-
-			theHalfEdge2a = (HEHalfEdge *) GET_MEMORY(sizeof(HEHalfEdge));
-			if (theHalfEdge2a == NULL)
-				return theMemoryError;
-			theHalfEdge2a->itsNext				= aDirichletDomain->itsHalfEdgeList;
-			aDirichletDomain->itsHalfEdgeList	= theHalfEdge2a;
+			//	Append two new half edges.
+			theHalfEdge1a = aDirichletDomain->itsNumHalfEdges++;
+			theHalfEdge2a = aDirichletDomain->itsNumHalfEdges++;
 
 			//	Recycle the existing pair of edges.
 			//	Let them become theHalfEdge1b and theHalfEdge2b
 			//	(not theHalfEdge1a and theHalfEdge2a) so that other
-			//	vertices and edges that used to point to theHalfEdge1
+			//	vertices and edges that used to refer to theHalfEdge1
 			//	and theHalfEdge2 will remain valid.
 			theHalfEdge1b = theHalfEdge1;
 			theHalfEdge2b = theHalfEdge2;
 
 			//	Set the tips.
-			theHalfEdge1a->itsTip = theHalfEdge1b->itsTip;
-			theHalfEdge2a->itsTip = theHalfEdge2b->itsTip;
-			theHalfEdge1b->itsTip = theNewVertex;
-			theHalfEdge2b->itsTip = theNewVertex;
+			theHalfEdges[theHalfEdge1a].itsTip = theHalfEdges[theHalfEdge1b].itsTip;
+			theHalfEdges[theHalfEdge2a].itsTip = theHalfEdges[theHalfEdge2b].itsTip;
+			theHalfEdges[theHalfEdge1b].itsTip = theNewVertex;
+			theHalfEdges[theHalfEdge2b].itsTip = theNewVertex;
 
 			//	Set the mates.
-			theHalfEdge1a->itsMate	= theHalfEdge2b;
-			theHalfEdge2a->itsMate	= theHalfEdge1b;
-			theHalfEdge1b->itsMate	= theHalfEdge2a;
-			theHalfEdge2b->itsMate	= theHalfEdge1a;
+			theHalfEdges[theHalfEdge1a].itsMate	= theHalfEdge2b;
+			theHalfEdges[theHalfEdge2a].itsMate	= theHalfEdge1b;
+			theHalfEdges[theHalfEdge1b].itsMate	= theHalfEdge2a;
+			theHalfEdges[theHalfEdge2b].itsMate	= theHalfEdge1a;
 
 			//	Set the cycles.
-			theHalfEdge1a->itsCycle = theHalfEdge1b->itsCycle;
-			theHalfEdge2a->itsCycle = theHalfEdge2b->itsCycle;
-			theHalfEdge1b->itsCycle = theHalfEdge1a;
-			theHalfEdge2b->itsCycle = theHalfEdge2a;
+			theHalfEdges[theHalfEdge1a].itsCycle = theHalfEdges[theHalfEdge1b].itsCycle;
+			theHalfEdges[theHalfEdge2a].itsCycle = theHalfEdges[theHalfEdge2b].itsCycle;
+			theHalfEdges[theHalfEdge1b].itsCycle = theHalfEdge1a;
+			theHalfEdges[theHalfEdge2b].itsCycle = theHalfEdge2a;
 
 			//	Set the faces.
-			theHalfEdge1a->itsFace = theHalfEdge1b->itsFace;
-			theHalfEdge2a->itsFace = theHalfEdge2b->itsFace;
+			theHalfEdges[theHalfEdge1a].itsFace = theHalfEdges[theHalfEdge1b].itsFace;
+			theHalfEdges[theHalfEdge2a].itsFace = theHalfEdges[theHalfEdge2b].itsFace;
 
 			//	The new vertex sits at the tail of both theHalfEdge1a and theHalfEdge2a.
-			theNewVertex->itsOutboundHalfEdge = theHalfEdge1a;
+			theVertices[theNewVertex].itsOutboundHalfEdge = theHalfEdge1a;
 		}
 	}
 
@@ -1116,240 +2346,476 @@ static ErrorText IntersectWithHalfspace(
 	//	introduce a new edge along the cut.
 	//	The required vertices are already in place
 	//	from the previous step.
-	for (	theFace = aDirichletDomain->itsFaceList;
-			theFace != NULL;
-			theFace = theFace->itsNext)
+	//	Visit only the faces that were present at the start.
+	theNumOldFaces = aDirichletDomain->itsNumFaces;
+	for (theFace = theNumOldFaces; theFace-- > 0; )
 	{
 		//	Look for half edges where the face's cycle is about to leave
 		//	the halfspace and where it's about to re-enter the halfspace.
 
-		theGoingOutEdge	= NULL;
-		theGoingInEdge	= NULL;
+		theGoingOutEdge	= HE_NO_INDEX;
+		theGoingInEdge	= HE_NO_INDEX;
 
-		theHalfEdge = theFace->itsHalfEdge;
+		theHalfEdge = theFaces[theFace].itsHalfEdge;
 		do
 		{
-			if (theHalfEdge->itsTip->itsHalfspaceStatus == VertexOnBoundary)
+			if (theStatus[theHalfEdges[theHalfEdge].itsTip] == VertexOnBoundary)
 			{
-				switch (theHalfEdge->itsCycle->itsTip->itsHalfspaceStatus)
+				switch (theStatus[theHalfEdges[theHalfEdges[theHalfEdge].itsCycle].itsTip])
 				{
 					case VertexInsideHalfspace:		theGoingInEdge  = theHalfEdge;	break;
 					case VertexOnBoundary:											break;
 					case VertexOutsideHalfspace:	theGoingOutEdge = theHalfEdge;	break;
 				}
 			}
-			theHalfEdge = theHalfEdge->itsCycle;
-		} while (theHalfEdge != theFace->itsHalfEdge);
+			theHalfEdge = theHalfEdges[theHalfEdge].itsCycle;
+		} while (theHalfEdge != theFaces[theFace].itsHalfEdge);
 
 		//	If the halfspace doesn't cut the face, there's nothing to be done.
-		if (theGoingOutEdge	== NULL
-		 || theGoingInEdge  == NULL)
+		if (theGoingOutEdge	== HE_NO_INDEX
+		 || theGoingInEdge  == HE_NO_INDEX)
 			continue;
 
-		//	Create two new half edges and one new face.
+		//	Append two new half edges and one new face.
 		//	The face will eventually be discarded,
 		//	but install it anyhow to keep the data structure clean.
-
-		theInnerHalfEdge = (HEHalfEdge *) GET_MEMORY(sizeof(HEHalfEdge));
-		if (theInnerHalfEdge == NULL)
-			return theMemoryError;
-		theInnerHalfEdge->itsNext			= aDirichletDomain->itsHalfEdgeList;
-		aDirichletDomain->itsHalfEdgeList	= theInnerHalfEdge;
-
-		theOuterHalfEdge = (HEHalfEdge *) GET_MEMORY(sizeof(HEHalfEdge));
-		if (theOuterHalfEdge == NULL)
-			return theMemoryError;
-		theOuterHalfEdge->itsNext			= aDirichletDomain->itsHalfEdgeList;
-		aDirichletDomain->itsHalfEdgeList	= theOuterHalfEdge;
-
-		theOuterFace = (HEFace *) GET_MEMORY(sizeof(HEFace));
-		if (theOuterFace == NULL)
-			return theMemoryError;
-		theOuterFace->itsNext			= aDirichletDomain->itsFaceList;
-		aDirichletDomain->itsFaceList	= theOuterFace;
+		theInnerHalfEdge	= aDirichletDomain->itsNumHalfEdges++;
+		theOuterHalfEdge	= aDirichletDomain->itsNumHalfEdges++;
+		theOuterFace		= aDirichletDomain->itsNumFaces++;
 
 		//	Recycle theFace as theInnerFace.
 		theInnerFace = theFace;
 
 		//	Set the tips.
-		theInnerHalfEdge->itsTip	= theGoingInEdge->itsTip;
-		theOuterHalfEdge->itsTip	= theGoingOutEdge->itsTip;
+		theHalfEdges[theInnerHalfEdge].itsTip	= theHalfEdges[theGoingInEdge ].itsTip;
+		theHalfEdges[theOuterHalfEdge].itsTip	= theHalfEdges[theGoingOutEdge].itsTip;
 
 		//	Set the mates.
-		theInnerHalfEdge->itsMate	= theOuterHalfEdge;
-		theOuterHalfEdge->itsMate	= theInnerHalfEdge;
+		theHalfEdges[theInnerHalfEdge].itsMate	= theOuterHalfEdge;
+		theHalfEdges[theOuterHalfEdge].itsMate	= theInnerHalfEdge;
 
 		//	Set the cycles.
-		theInnerHalfEdge->itsCycle	= theGoingInEdge->itsCycle;
-		theOuterHalfEdge->itsCycle	= theGoingOutEdge->itsCycle;
-		theGoingOutEdge->itsCycle	= theInnerHalfEdge;
-		theGoingInEdge->itsCycle	= theOuterHalfEdge;
+		theHalfEdges[theInnerHalfEdge].itsCycle	= theHalfEdges[theGoingInEdge ].itsCycle;
+		theHalfEdges[theOuterHalfEdge].itsCycle	= theHalfEdges[theGoingOutEdge].itsCycle;
+		theHalfEdges[theGoingOutEdge ].itsCycle	= theInnerHalfEdge;
+		theHalfEdges[theGoingInEdge  ].itsCycle	= theOuterHalfEdge;
 
 		//	Set the inner face (which equals the original face).
-		theInnerHalfEdge->itsFace	= theInnerFace;
-		theInnerFace->itsHalfEdge	= theInnerHalfEdge;
+		theHalfEdges[theInnerHalfEdge].itsFace	= theInnerFace;
+		theFaces[theInnerFace].itsHalfEdge		= theInnerHalfEdge;
 
 		//	Set the outer face.
 		theHalfEdge = theOuterHalfEdge;
 		do
 		{
-			theHalfEdge->itsFace = theOuterFace;
-			theHalfEdge = theHalfEdge->itsCycle;
+			theHalfEdges[theHalfEdge].itsFace = theOuterFace;
+			theHalfEdge = theHalfEdges[theHalfEdge].itsCycle;
 		} while (theHalfEdge != theOuterHalfEdge);
-		theOuterFace->itsHalfEdge	= theOuterHalfEdge;
+		theFaces[theOuterFace].itsHalfEdge = theOuterHalfEdge;
 	}
 
-	//	Allocate a new face to lie on the boundary of the halfspace.
-	theNewFace = (HEFace *) GET_MEMORY(sizeof(HEFace));
-	if (theNewFace == NULL)
-		return theMemoryError;
-	theNewFace->itsNext				= aDirichletDomain->itsFaceList;
-	aDirichletDomain->itsFaceList	= theNewFace;
+	//	Append a new face to lie on the boundary of the halfspace.
+	theNewFace = aDirichletDomain->itsNumFaces++;
 
 	//	Mark for deletion all half edges and faces
 	//	that are incident to a VertexOutsideHalfspace.
-	for (	theFace = aDirichletDomain->itsFaceList;
-			theFace != NULL;
-			theFace = theFace->itsNext)
+	for (theFace = 0; theFace < aDirichletDomain->itsNumFaces; theFace++)
 	{
-		theFace->itsDeletionFlag = false;
+		theFaces[theFace].itsDeletionFlag = false;
 	}
-	for (	theHalfEdge = aDirichletDomain->itsHalfEdgeList;
-			theHalfEdge != NULL;
-			theHalfEdge = theHalfEdge->itsNext)
+	for (theHalfEdge = 0; theHalfEdge < aDirichletDomain->itsNumHalfEdges; theHalfEdge++)
 	{
-		if (theHalfEdge->itsTip->itsHalfspaceStatus				== VertexOutsideHalfspace
-		 || theHalfEdge->itsMate->itsTip->itsHalfspaceStatus	== VertexOutsideHalfspace)
+		if (theStatus[theHalfEdges[theHalfEdge].itsTip]								== VertexOutsideHalfspace
+		 || theStatus[theHalfEdges[theHalfEdges[theHalfEdge].itsMate].itsTip]	== VertexOutsideHalfspace)
 		{
-			theHalfEdge->itsDeletionFlag			= true;
-			theHalfEdge->itsFace->itsDeletionFlag	= true;
+			theHalfEdges[theHalfEdge].itsDeletionFlag					= true;
+			theFaces[theHalfEdges[theHalfEdge].itsFace].itsDeletionFlag	= true;
 		}
 		else
-			theHalfEdge->itsDeletionFlag			= false;
+			theHalfEdges[theHalfEdge].itsDeletionFlag					= false;
 	}
 
 	//	Make sure all surviving vertices see a surviving half edge.
-	for (	theVertex = aDirichletDomain->itsVertexList;
-			theVertex != NULL;
-			theVertex = theVertex->itsNext)
+	for (theVertex = 0; theVertex < aDirichletDomain->itsNumVertices; theVertex++)
 	{
-		if (theVertex->itsHalfspaceStatus != VertexOutsideHalfspace)
+		if (theStatus[theVertex] != VertexOutsideHalfspace)
 		{
-			while (theVertex->itsOutboundHalfEdge->itsDeletionFlag)
+			while (theHalfEdges[theVertices[theVertex].itsOutboundHalfEdge].itsDeletionFlag)
 			{
-				theVertex->itsOutboundHalfEdge
-					= theVertex->itsOutboundHalfEdge->itsMate->itsCycle;
+				theVertices[theVertex].itsOutboundHalfEdge
+					= theHalfEdges[theHalfEdges[theVertices[theVertex].itsOutboundHalfEdge].itsMate].itsCycle;
 			}
 		}
 	}
 
 	//	Install the new face.
-	for (	theHalfEdge = aDirichletDomain->itsHalfEdgeList;
-			theHalfEdge != NULL;
-			theHalfEdge = theHalfEdge->itsNext)
+	for (theHalfEdge = aDirichletDomain->itsNumHalfEdges; theHalfEdge-- > 0; )
 	{
-		if ( ! theHalfEdge->itsDeletionFlag
-		 && theHalfEdge->itsFace->itsDeletionFlag)
+		if ( ! theHalfEdges[theHalfEdge].itsDeletionFlag
+		 && theFaces[theHalfEdges[theHalfEdge].itsFace].itsDeletionFlag)
 		{
-			theHalfEdge->itsFace	= theNewFace;
-			theNewFace->itsHalfEdge	= theHalfEdge;
+			theHalfEdges[theHalfEdge].itsFace	= theNewFace;
+			theFaces[theNewFace].itsHalfEdge	= theHalfEdge;
 
-			while (theHalfEdge->itsCycle->itsDeletionFlag)
+			while (theHalfEdges[theHalfEdges[theHalfEdge].itsCycle].itsDeletionFlag)
 			{
-				theHalfEdge->itsCycle = theHalfEdge->itsCycle->itsMate->itsCycle;
+				theHalfEdges[theHalfEdge].itsCycle
+					= theHalfEdges[theHalfEdges[theHalfEdges[theHalfEdge].itsCycle].itsMate].itsCycle;
 			}
 		}
 	}
 
 	//	Set the new face's halfspace inequality and matrix.
-	theNewFace->itsHalfspace	= theHalfspace;
-	theNewFace->itsMatrix		= *aMatrix;
+	theFaces[theNewFace].itsHalfspace	= theHalfspace;
+	theFaces[theNewFace].itsMatrix		= *aMatrix;
 
 	//	Delete excluded vertices, half edges and faces.
+	CompactDirichletDomain(aDirichletDomain);
+
+	//	Done!
+	return NULL;
+}
+
+
+static unsigned int ClassifyVertices(
+	unsigned int		aNumVertices,		//	input
+	const Vector		*someRawPositions,	//	input
+	const Vector		*aHalfspace,		//	input
+	VertexVsHalfspace	*someStatuses)		//	output
+{
+	unsigned int	i,
+					theStatus,
+					theAmbiguity,
+					theStatusMask;
+	double			a,
+					b,
+					c,
+					d,
+					theDotProduct,
+					theErrorBound;
+
+	//	Classify each vertex as inside the halfspace, outside it,
+	//	or on its boundary, and return a bitmask telling which
+	//	of those statuses occurred.  The caller may then reject
+	//	a trivial cut with a single test.
+	//
+	//	IntersectWithHalfspace() calls this function for every
+	//	halfspace it considers, and most halfspaces don't cut,
+	//	so this loop is the algorithm's inner loop.  Keep it free
+	//	of branches and function calls, so the compiler may vectorize it
+	//	on whatever instruction set the platform provides:
+	//	with the enum values chosen above,
+	//
+	//		(dot > ε) + (dot ≥ -ε)
+	//
+	//	is 0, 1 or 2 for a vertex inside, on or outside the halfspace.
+	//
+	//	In the style of Shewchuk's adaptive predicates, the same pass
+	//	also bounds each dot product's roundoff error.  When a dot product
+	//	lies too close to ±ε for its floating-point status to be trusted,
+	//	the loop merely notes the ambiguity, and a second pass re-evaluates
+	//	the vertices exactly.  Typical inputs never need the second pass.
+	//
+	//	Note that the tolerance ε itself remains essential:  each raw position
+	//	is the rounded result of earlier cuts, so a vertex that "should" lie
+	//	on a plane -- as many do in mirrored and high-symmetry spaces -- 
+	//	typically misses it by roundoff error.  Exact arithmetic makes
+	//	the comparison against ±ε consistent, not the tolerance unnecessary.
 
-	theVertexPtr = &aDirichletDomain->itsVertexList;
-	while (*theVertexPtr != NULL)
+	a = aHalfspace->v[0];
+	b = aHalfspace->v[1];
+	c = aHalfspace->v[2];
+	d = aHalfspace->v[3];
+
+	theStatusMask = 0;
+
+	for (i = 0; i < aNumVertices; i++)
 	{
-		if ((*theVertexPtr)->itsHalfspaceStatus == VertexOutsideHalfspace)
-		{
-			theDeadVertex	= *theVertexPtr;
-			*theVertexPtr	= theDeadVertex->itsNext;
-			FREE_MEMORY(theDeadVertex);
-		}
-		else
-			theVertexPtr = &(*theVertexPtr)->itsNext;
+		theDotProduct	= a * someRawPositions[i].v[0]
+						+ b * someRawPositions[i].v[1]
+						+ c * someRawPositions[i].v[2]
+						+ d * someRawPositions[i].v[3];
+
+		theErrorBound	= DOT_PRODUCT_ERROR_BOUND
+						* ( fabs(a * someRawPositions[i].v[0])
+						  + fabs(b * someRawPositions[i].v[1])
+						  + fabs(c * someRawPositions[i].v[2])
+						  + fabs(d * someRawPositions[i].v[3]) );
+
+		theStatus	= (unsigned int)(theDotProduct >  +VERTEX_HALFSPACE_EPSILON)
+					+ (unsigned int)(theDotProduct >= -VERTEX_HALFSPACE_EPSILON);
+
+		theAmbiguity	= (unsigned int)(fabs(theDotProduct - VERTEX_HALFSPACE_EPSILON) <= theErrorBound)
+						| (unsigned int)(fabs(theDotProduct + VERTEX_HALFSPACE_EPSILON) <= theErrorBound);
+
+		someStatuses[i]	= (VertexVsHalfspace) theStatus;
+		theStatusMask  |= VERTEX_STATUS_BIT(theStatus) | (theAmbiguity * VERTEX_AMBIGUOUS_BIT);
 	}
 
-	theHalfEdgePtr = &aDirichletDomain->itsHalfEdgeList;
-	while (*theHalfEdgePtr != NULL)
+	if (theStatusMask & VERTEX_AMBIGUOUS_BIT)
 	{
-		if ((*theHalfEdgePtr)->itsDeletionFlag)
+		//	Ambiguities are rare, so rather than keeping track
+		//	of which vertices were ambiguous, simply re-evaluate
+		//	all vertices exactly and rebuild the status mask.
+		theStatusMask = 0;
+
+		for (i = 0; i < aNumVertices; i++)
 		{
-			theDeadHalfEdge	= *theHalfEdgePtr;
-			*theHalfEdgePtr	= theDeadHalfEdge->itsNext;
-			FREE_MEMORY(theDeadHalfEdge);
+			someStatuses[i] = ExactVertexStatus(&someRawPositions[i], aHalfspace);
+			theStatusMask  |= VERTEX_STATUS_BIT(someStatuses[i]);
 		}
-		else
-			theHalfEdgePtr = &(*theHalfEdgePtr)->itsNext;
 	}
 
-	theFacePtr = &aDirichletDomain->itsFaceList;
-	while (*theFacePtr != NULL)
+	return theStatusMask;
+}
+
+static VertexVsHalfspace ExactVertexStatus(
+	const Vector	*aRawPosition,	//	input
+	const Vector	*aHalfspace)	//	input
+{
+	//	Compare the exact value of the dot product
+	//	to ±VERTEX_HALFSPACE_EPSILON.
+
+	if (ExactDotProductSign(aHalfspace, aRawPosition, -VERTEX_HALFSPACE_EPSILON) > 0)
+		return VertexOutsideHalfspace;
+	else
+	if (ExactDotProductSign(aHalfspace, aRawPosition, +VERTEX_HALFSPACE_EPSILON) < 0)
+		return VertexInsideHalfspace;
+	else
+		return VertexOnBoundary;
+}
+
+static signed int ExactDotProductSign(
+	const Vector	*aVectorA,	//	input
+	const Vector	*aVectorB,	//	input
+	double			anOffset)	//	input
+{
+	double			theTerms[9],
+					theExpansion[9],
+					theSum,
+					theBig,
+					theLittle,
+					theRoundoff;
+	unsigned int	theNumComponents,
+					i,
+					j;
+
+	//	Return the sign (-1, 0 or +1) of the exact value of
+	//
+	//		aVectorA · aVectorB + anOffset
+	//
+	//	Following Shewchuk ("Adaptive Precision Floating-Point Arithmetic
+	//	and Fast Robust Geometric Predicates", 1997), split each product
+	//	exactly into a rounded product and its roundoff error, using fma(),
+	//	and then accumulate all nine terms into a nonoverlapping expansion
+	//	of increasing magnitude.  The expansion's most significant
+	//	nonzero component carries the sign of the exact sum.
+	//	(Overflow and underflow can't occur for the moderate values
+	//	that arise in a Dirichlet domain computation.)
+
+	for (i = 0; i < 4; i++)
+	{
+		theTerms[2*i    ] = aVectorA->v[i] * aVectorB->v[i];
+		theTerms[2*i + 1] = fma(aVectorA->v[i], aVectorB->v[i], -theTerms[2*i]);
+	}
+	theTerms[8] = anOffset;
+
+	//	Grow the expansion one term at a time.
+	theNumComponents = 0;
+	for (i = 0; i < 9; i++)
 	{
-		if ((*theFacePtr)->itsDeletionFlag)
+		theSum = theTerms[i];
+		for (j = 0; j < theNumComponents; j++)
 		{
-			theDeadFace	= *theFacePtr;
-			*theFacePtr	= theDeadFace->itsNext;
-			FREE_MEMORY(theDeadFace);
+			//	Knuth's TwoSum:  theBig + theRoundoff == theSum + theExpansion[j] exactly.
+			theBig		= theSum + theExpansion[j];
+			theLittle	= theBig - theSum;
+			theRoundoff	= (theSum - (theBig - theLittle)) + (theExpansion[j] - theLittle);
+
+			theExpansion[j]	= theRoundoff;
+			theSum			= theBig;
 		}
+		theExpansion[theNumComponents++] = theSum;
+	}
+
+	for (i = theNumComponents; i-- > 0; )
+	{
+		if (theExpansion[i] > 0.0)
+			return +1;
+		if (theExpansion[i] < 0.0)
+			return -1;
+	}
+
+	return 0;
+}
+
+static double ProvisionalBoundingRatio(DirichletDomain *aDirichletDomain)
+{
+	unsigned int	i;
+	Vector			*theRawPosition;
+	double			theSpatialLengthSquared,
+					theRatio,
+					theMaxRatio;
+
+	//	In the projective model each geometry's ball of radius r
+	//	about the basepoint (0,0,0,1) is the cone
+	//
+	//		√(x² + y² + z²) ≤ k w
+	//
+	//	where k = tan(r), r or tanh(r) in the spherical, flat
+	//	or hyperbolic case, respectively.  The provisional domain
+	//	is the cone over its vertices, so the smallest such k
+	//	containing it is the largest ratio √(x² + y² + z²) / w
+	//	among its vertices' raw positions.  Raw positions need
+	//	not be normalized, because the ratio is scale-invariant.
+	//
+	//	If some vertex has w ≤ 0 (as the initial banana's
+	//	antipodal vertices do) the domain fits in no such ball,
+	//	and we return infinity to disable culling.
+	//	In the hyperbolic case a ratio ≥ 1 likewise means
+	//	the domain isn't yet bounded, and because HalfTranslationRatio()
+	//	is always less than 1 there, culling is automatically disabled.
+
+	theMaxRatio = 0.0;
+
+	for (i = 0; i < aDirichletDomain->itsNumVertices; i++)
+	{
+		theRawPosition = &aDirichletDomain->itsVertexRawPositions[i];
+
+		if (theRawPosition->v[3] <= 0.0)
+			return INFINITY;
+
+		theSpatialLengthSquared	= theRawPosition->v[0] * theRawPosition->v[0]
+								+ theRawPosition->v[1] * theRawPosition->v[1]
+								+ theRawPosition->v[2] * theRawPosition->v[2];
+		theRatio = sqrt(theSpatialLengthSquared) / theRawPosition->v[3];
+
+		if (theMaxRatio < theRatio)
+			theMaxRatio = theRatio;
+	}
+
+	return theMaxRatio;
+}
+
+static double HalfTranslationRatio(const double aBasepointImage[4])
+{
+	double	theSpatialLengthSquared;
+
+	//	A group element's last row (x,y,z,w) gives the image
+	//	of the basepoint, at some distance d from the basepoint.  The ratio
+	//
+	//		√(x² + y² + z²) / (1 + w)
+	//
+	//	equals tan(d/2), d/2 or tanh(d/2) in the spherical, flat
+	//	or hyperbolic case, respectively, which is exactly
+	//	the ProvisionalBoundingRatio() of a ball of radius d/2.
+	//	That's where the group element's bisecting plane sits.
+	//
+	//	A spherical element taking the basepoint to its antipode
+	//	has 1 + w = 0 and bisects along the equator w = 0,
+	//	which no domain with a finite ProvisionalBoundingRatio() reaches.
+	//
+	//	Near the antipode both √(x² + y² + z²) and 1 + w are tiny,
+	//	and a conjugated antipodal map may carry enough roundoff
+	//	to make their quotient meaningless.  On the unit 3-sphere
+	//	x² + y² + z² = 1 - w², so the equivalent ratio
+	//
+	//		(1 - w) / √(x² + y² + z²)
+	//
+	//	is the well-conditioned one whenever w < 0.
+
+	theSpatialLengthSquared	= aBasepointImage[0] * aBasepointImage[0]
+							+ aBasepointImage[1] * aBasepointImage[1]
+							+ aBasepointImage[2] * aBasepointImage[2];
+
+	if (aBasepointImage[3] < 0.0)
+	{
+		if (theSpatialLengthSquared == 0.0)
+			return INFINITY;
 		else
-			theFacePtr = &(*theFacePtr)->itsNext;
+			return (1.0 - aBasepointImage[3]) / sqrt(theSpatialLengthSquared);
 	}
 
-	//	Done!
-	return NULL;
+	return sqrt(theSpatialLengthSquared) / (1.0 + aBasepointImage[3]);
+}
+
+static __cdecl signed int CompareHalfTranslationRatios(
+	const void	*p1,
+	const void	*p2)
+{
+	double	theRatio1,
+			theRatio2;
+
+	//	HalfTranslationRatio() increases with translation distance,
+	//	so sorting by it sorts group elements near-to-far.
+
+	theRatio1 = HalfTranslationRatio(((const Matrix *) p1)->m[3]);
+	theRatio2 = HalfTranslationRatio(((const Matrix *) p2)->m[3]);
+
+	if (theRatio1 < theRatio2)
+		return -1;
+
+	if (theRatio1 > theRatio2)
+		return +1;
+
+	return 0;
+}
+
+static bool FixesBasepoint(const double aBasepointImage[4])
+{
+	double	theDistanceSquared;
+
+	//	Does a group element, whose last row is aBasepointImage,
+	//	(nearly) fix the basepoint (0,0,0,1)?  Measure the distance
+	//	in R⁴ rather than via HalfTranslationRatio(), which
+	//	can't tell a near-identity from a noisy antipodal map.
+
+	theDistanceSquared	= aBasepointImage[0] * aBasepointImage[0]
+						+ aBasepointImage[1] * aBasepointImage[1]
+						+ aBasepointImage[2] * aBasepointImage[2]
+						+ (aBasepointImage[3] - 1.0) * (aBasepointImage[3] - 1.0);
+
+	return theDistanceSquared < FIXED_BASEPOINT_EPSILON * FIXED_BASEPOINT_EPSILON;
 }
 
 
 static void AssignFaceColors(DirichletDomain *aDirichletDomain)
 {
-	HEFace			*theFace;
-	unsigned int	theCount;
+	HEFace			*theFaces;
+	unsigned int	theFace,
+					theCount;
 	Matrix			theInverseMatrix;
-	HEFace			*theMate;
+	unsigned int	theMate;
 	double			theColorParameter;
 
+	theFaces = aDirichletDomain->itsFaces;
+
 	//	Initialize each color index to 0xFFFFFFFF as a marker.
-	for (	theFace = aDirichletDomain->itsFaceList;
-			theFace != NULL;
-			theFace = theFace->itsNext)
+	for (theFace = 0; theFace < aDirichletDomain->itsNumFaces; theFace++)
 	{
-		theFace->itsColorIndex = 0xFFFFFFFF;
+		theFaces[theFace].itsColorIndex = 0xFFFFFFFF;
 	}
 
 	//	Count the face pairs as we go along.
 	theCount = 0;
 
-	//	Assign an index to each face that doesn't already have one.
-	for (	theFace = aDirichletDomain->itsFaceList;
-			theFace != NULL;
-			theFace = theFace->itsNext)
+	//	Assign an index to each face that doesn't already have one,
+	//	visiting the faces newest first.
+	for (theFace = aDirichletDomain->itsNumFaces; theFace-- > 0; )
 	{
-		if (theFace->itsColorIndex == 0xFFFFFFFF)
+		if (theFaces[theFace].itsColorIndex == 0xFFFFFFFF)
 		{
 			//	Assign to theFace the next available color index.
-			theFace->itsColorIndex = theCount++;
+			theFaces[theFace].itsColorIndex = theCount++;
 
 			//	If theFace has a distinct mate,
 			//	assign the same index to the mate.
-			MatrixGeometricInverse(&theFace->itsMatrix, &theInverseMatrix);
-			for (	theMate = theFace->itsNext;
-					theMate != NULL;
-					theMate = theMate->itsNext)
+			MatrixGeometricInverse(&theFaces[theFace].itsMatrix, &theInverseMatrix);
+			for (theMate = theFace; theMate-- > 0; )
 			{
-				if (MatrixEquality(&theMate->itsMatrix, &theInverseMatrix, MATE_MATRIX_EPSILON))
+				if (MatrixEquality(&theFaces[theMate].itsMatrix, &theInverseMatrix, MATE_MATRIX_EPSILON))
 				{
-					theMate->itsColorIndex = theFace->itsColorIndex;
+					theFaces[theMate].itsColorIndex = theFaces[theFace].itsColorIndex;
 					break;
 				}
 			}
@@ -1359,21 +2825,19 @@ static void AssignFaceColors(DirichletDomain *aDirichletDomain)
 	//	Now that we know how many face pairs we've got,
 	//	we can convert the temporary indices to a set
 	//	of evenly spaced colors.
-	for (	theFace = aDirichletDomain->itsFaceList;
-			theFace != NULL;
-			theFace = theFace->itsNext)
+	for (theFace = 0; theFace < aDirichletDomain->itsNumFaces; theFace++)
 	{
 		//	Convert the temporary index to a parameter in the range [0,1],
 		//	with uniform spacing.
-		theColorParameter = (double)theFace->itsColorIndex / (double)theCount;
+		theColorParameter = (double)theFaces[theFace].itsColorIndex / (double)theCount;
 
 		//	Interpret theColorParameter as a hue.
 		HSLAtoRGBA(	&(HSLAColor){theColorParameter, 0.3, 0.5, 1.0},
-					&theFace->itsColorRGBA);
+					&theFaces[theFace].itsColorRGBA);
 
 		//	Interpret theColorParameter as a greyscale value.
-//		theFace->itsColorGreyscale = 0.5 * (theColorParameter + 1.0);
-		theFace->itsColorGreyscale = (theColorParameter + 4.0) / 5.0;
+//		theFaces[theFace].itsColorGreyscale = 0.5 * (theColorParameter + 1.0);
+		theFaces[theFace].itsColorGreyscale = (theColorParameter + 4.0) / 5.0;
 	}
 }
 
@@ -1381,19 +2845,20 @@ static void AssignFaceColors(DirichletDomain *aDirichletDomain)
 static void ComputeFaceCenters(DirichletDomain *aDirichletDomain)
 {
 	HEFace			*theFace;
-	unsigned int	i;
+	unsigned int	i,
+					j;
 
 	//	Compute the center of each face, normalized to the unit 3-sphere
 	//	for easy interpolation to vertices at infinity.
 
-	for (	theFace = aDirichletDomain->itsFaceList;
-			theFace != NULL;
-			theFace = theFace->itsNext)
+	for (i = 0; i < aDirichletDomain->itsNumFaces; i++)
 	{
+		theFace = &aDirichletDomain->itsFaces[i];
+
 		//	The center sits midway between the basepoint (0,0,0,1)
 		//	and its image under the face-pairing matrix.
-		for (i = 0; i < 4; i++)
-			theFace->itsRawCenter.v[i] = 0.5 * theFace->itsMatrix.m[3][i];
+		for (j = 0; j < 4; j++)
+			theFace->itsRawCenter.v[j] = 0.5 * theFace->itsMatrix.m[3][j];
 		theFace->itsRawCenter.v[3] += 0.5;
 
 		//	Normalize to the unit 3-sphere...
@@ -1407,36 +2872,40 @@ static void ComputeFaceCenters(DirichletDomain *aDirichletDomain)
 
 static void ComputeWallDimensions(DirichletDomain *aDirichletDomain)
 {
-	double		theMaxBase;
-	HEFace		*theFace;
-	Vector		*theFaceCenter;
-	HEHalfEdge	*theHalfEdge;
-	Vector		*theTail,
-				*theTip;
-	double		theSide0,
-				theSide1,
-				theSide2,
-				s,
-				theArea;
+	double			theMaxBase;
+	HEVertex		*theVertices;
+	HEHalfEdge		*theHalfEdges;
+	HEFace			*theFace;
+	Vector			*theFaceCenter;
+	HEHalfEdge		*theHalfEdge;
+	Vector			*theTail,
+					*theTip;
+	double			theSide0,
+					theSide1,
+					theSide2,
+					s,
+					theArea;
+	unsigned int	i;
 
+	theVertices		= aDirichletDomain->itsVertices;
+	theHalfEdges	= aDirichletDomain->itsHalfEdges;
 	
 	//	Compute the dimensions of the triangular wedges comprising each face.
 	theMaxBase = 0;
-	for (	theFace = aDirichletDomain->itsFaceList;
-			theFace != NULL;
-			theFace = theFace->itsNext)
+	for (i = 0; i < aDirichletDomain->itsNumFaces; i++)
 	{
-		theFaceCenter = &theFace->itsNormalizedCenter;
+		theFace			= &aDirichletDomain->itsFaces[i];
+		theFaceCenter	= &theFace->itsNormalizedCenter;
 
-		theHalfEdge = theFace->itsHalfEdge;
+		theHalfEdge = &theHalfEdges[theFace->itsHalfEdge];
 		do
 		{
 			//	Advance to the next HalfEdge,
 			//	but only after reading the current HalfEdge's tip,
 			//	which will be the next HalfEdge's tail.
-			theTail		= &theHalfEdge->itsTip->itsNormalizedPosition;
-			theHalfEdge	= theHalfEdge->itsCycle;
-			theTip		= &theHalfEdge->itsTip->itsNormalizedPosition;
+			theTail		= &theVertices[theHalfEdge->itsTip].itsNormalizedPosition;
+			theHalfEdge	= &theHalfEdges[theHalfEdge->itsCycle];
+			theTip		= &theVertices[theHalfEdge->itsTip].itsNormalizedPosition;
 
 			//	Compute the current wedge's dimensions.
 			//	The computation is exact in the flat case,
@@ -1454,18 +2923,16 @@ static void ComputeWallDimensions(DirichletDomain *aDirichletDomain)
 			if (theMaxBase < theHalfEdge->itsBase)
 				theMaxBase = theHalfEdge->itsBase;
 
-		} while (theHalfEdge != theFace->itsHalfEdge);
+		} while (theHalfEdge != &theHalfEdges[theFace->itsHalfEdge]);
 	}
 	
 	//	Rescale itsBase and itsAltitude so that the largest base has length 1.
 	if (theMaxBase > 0.0)
 	{
-		for (	theHalfEdge = aDirichletDomain->itsHalfEdgeList;
-				theHalfEdge != NULL;
-				theHalfEdge = theHalfEdge->itsNext)
+		for (i = 0; i < aDirichletDomain->itsNumHalfEdges; i++)
 		{
-			theHalfEdge->itsBase		/= theMaxBase;
-			theHalfEdge->itsAltitude	/= theMaxBase;
+			theHalfEdges[i].itsBase		/= theMaxBase;
+			theHalfEdges[i].itsAltitude	/= theMaxBase;
 		}
 	}
 }
@@ -1474,6 +2941,9 @@ static void ComputeWallDimensions(DirichletDomain *aDirichletDomain)
 static ErrorText ComputeVertexFigures(DirichletDomain *aDirichletDomain)
 {
 	ErrorText		theErrorMessage	= NULL;
+	Vector			*theRawPositions;
+	HEVertex		*theVertices;
+	HEHalfEdge		*theHalfEdges;
 	HEVertex		*theVertex;
 	HEHalfEdge		*theHalfEdge;
 	Vector			theTail,
@@ -1485,20 +2955,24 @@ static ErrorText ComputeVertexFigures(DirichletDomain *aDirichletDomain)
 					theScaledPointA,
 					theScaledPointB;
 	double			theDotProduct;
+	unsigned int	i;
 
 	//	Compute the faces of the vertex figure(s).
 	//	One face of the vertex figure(s) sits at each vertex
 	//	of the fundamental polyhedron.
 	//	This code relies on the fact that for each vertex,
-	//	itsRawPosition has already been normalized to sit on the 3-sphere.
+	//	the raw position has already been normalized to sit on the 3-sphere.
+
+	theRawPositions	= aDirichletDomain->itsVertexRawPositions;
+	theVertices		= aDirichletDomain->itsVertices;
+	theHalfEdges	= aDirichletDomain->itsHalfEdges;
 
 	//	Compute the "outer point" on each half edge.
-	for (	theHalfEdge = aDirichletDomain->itsHalfEdgeList;
-			theHalfEdge != NULL;
-			theHalfEdge = theHalfEdge->itsNext)
+	for (i = 0; i < aDirichletDomain->itsNumHalfEdges; i++)
 	{
-		theTail			= theHalfEdge->itsMate->itsTip->itsRawPosition;
-		theTip			= theHalfEdge->itsTip->itsRawPosition;
+		theHalfEdge		= &theHalfEdges[i];
+		theTail			= theRawPositions[theHalfEdges[theHalfEdge->itsMate].itsTip];
+		theTip			= theRawPositions[theHalfEdge->itsTip];
 		theDotProduct	= VectorDotProduct(&theTail, &theTip);
 		ScalarTimesVector(theDotProduct, &theTail, &theComponent);
 		VectorDifference(&theTip, &theComponent, &theNormal);
@@ -1516,22 +2990,22 @@ static ErrorText ComputeVertexFigures(DirichletDomain *aDirichletDomain)
 	}
 
 	//	Compute the center of each face of the vertex figure.
-	for (	theVertex = aDirichletDomain->itsVertexList;
-			theVertex != NULL;
-			theVertex = theVertex->itsNext)
+	for (i = 0; i < aDirichletDomain->itsNumVertices; i++)
 	{
+		theVertex = &theVertices[i];
+
 		theVertex->itsCenterPoint = (Vector) {{0.0, 0.0, 0.0, 0.0}};
 
-		theHalfEdge = theVertex->itsOutboundHalfEdge;
+		theHalfEdge = &theHalfEdges[theVertex->itsOutboundHalfEdge];
 		do
 		{
 			VectorSum(	&theVertex->itsCenterPoint,
 						&theHalfEdge->itsOuterPoint,
 						&theVertex->itsCenterPoint);
 
-			theHalfEdge = theHalfEdge->itsMate->itsCycle;
+			theHalfEdge = &theHalfEdges[theHalfEdges[theHalfEdge->itsMate].itsCycle];
 
-		} while (theHalfEdge != theVertex->itsOutboundHalfEdge);
+		} while (theHalfEdge != &theHalfEdges[theVertex->itsOutboundHalfEdge]);
 
 		theErrorMessage = VectorNormalize(	&theVertex->itsCenterPoint,
 											aDirichletDomain->itsSpaceType,
@@ -1542,15 +3016,14 @@ static ErrorText ComputeVertexFigures(DirichletDomain *aDirichletDomain)
 
 	//	Interpolate the inner vertices between
 	//	the outer vertices and the center.
-	for (	theHalfEdge = aDirichletDomain->itsHalfEdgeList;
-			theHalfEdge != NULL;
-			theHalfEdge = theHalfEdge->itsNext)
+	for (i = 0; i < aDirichletDomain->itsNumHalfEdges; i++)
 	{
+		theHalfEdge = &theHalfEdges[i];
 		ScalarTimesVector(	VERTEX_FIGURE_CUTOUT,
 							&theHalfEdge->itsOuterPoint,
 							&theScaledPointA);
 		ScalarTimesVector(	1.0 - VERTEX_FIGURE_CUTOUT,
-							&theHalfEdge->itsMate->itsTip->itsCenterPoint,
+							&theVertices[theHalfEdges[theHalfEdge->itsMate].itsTip].itsCenterPoint,
 							&theScaledPointB);
 		VectorSum(&theScaledPointA, &theScaledPointB, &theHalfEdge->itsInnerPoint);
 		theErrorMessage = VectorNormalize(	&theHalfEdge->itsInnerPoint,
@@ -1566,9 +3039,11 @@ static ErrorText ComputeVertexFigures(DirichletDomain *aDirichletDomain)
 
 static void PrepareForDirichletMesh(DirichletDomain *aDirichletDomain)
 {
-	HEFace			*theFace;
-	HEHalfEdge		*theHalfEdge;
-	unsigned int	theFaceOrder;
+	HEHalfEdge		*theHalfEdges;
+	unsigned int	theFirstHalfEdge,
+					theHalfEdge,
+					theFaceOrder,
+					i;
 
 	//	Each n-sided face will contribute an annular region,
 	//	realized as n trapezoids, each with 4 vertices and 2 faces.
@@ -1576,18 +3051,19 @@ static void PrepareForDirichletMesh(DirichletDomain *aDirichletDomain)
 	aDirichletDomain->itsDirichletNumMeshVertices	= 0;
 	aDirichletDomain->itsDirichletNumMeshFaces		= 0;
 
-	for (	theFace = aDirichletDomain->itsFaceList;
-			theFace != NULL;
-			theFace = theFace->itsNext)
+	theHalfEdges = aDirichletDomain->itsHalfEdges;
+
+	for (i = 0; i < aDirichletDomain->itsNumFaces; i++)
 	{
 		//	Compute the face order n.
 		theFaceOrder = 0;
-		theHalfEdge = theFace->itsHalfEdge;
+		theFirstHalfEdge	= aDirichletDomain->itsFaces[i].itsHalfEdge;
+		theHalfEdge			= theFirstHalfEdge;
 		do
 		{
-			theFaceOrder++;							//	count this edge
-			theHalfEdge	= theHalfEdge->itsCycle;	//	move on to the next edge
-		} while (theHalfEdge != theFace->itsHalfEdge);
+			theFaceOrder++;										//	count this edge
+			theHalfEdge	= theHalfEdges[theHalfEdge].itsCycle;	//	move on to the next edge
+		} while (theHalfEdge != theFirstHalfEdge);
 	
 		//	Increment the global counts.
 		aDirichletDomain->itsDirichletNumMeshVertices	+= 4*theFaceOrder;
@@ -1597,9 +3073,11 @@ static void PrepareForDirichletMesh(DirichletDomain *aDirichletDomain)
 
 static void PrepareForVertexFiguresMesh(DirichletDomain *aDirichletDomain)
 {
-	HEVertex		*theVertex;
-	HEHalfEdge		*theHalfEdge;
-	unsigned int	theVertexOrder;
+	HEHalfEdge		*theHalfEdges;
+	unsigned int	theFirstHalfEdge,
+					theHalfEdge,
+					theVertexOrder,
+					i;
 
 	//	Each order-n vertex will contribute an annular region,
 	//	realized as a triangle strip with 2n+2 vertices and 2n faces
@@ -1611,18 +3089,19 @@ static void PrepareForVertexFiguresMesh(DirichletDomain *aDirichletDomain)
 	aDirichletDomain->itsVertexFiguresNumMeshVertices	= 0;
 	aDirichletDomain->itsVertexFiguresNumMeshFaces		= 0;
 
-	for (	theVertex = aDirichletDomain->itsVertexList;
-			theVertex != NULL;
-			theVertex = theVertex->itsNext)
+	theHalfEdges = aDirichletDomain->itsHalfEdges;
+
+	for (i = 0; i < aDirichletDomain->itsNumVertices; i++)
 	{
 		//	Compute the vertex order.
 		theVertexOrder = 0;
-		theHalfEdge = theVertex->itsOutboundHalfEdge;
+		theFirstHalfEdge	= aDirichletDomain->itsVertices[i].itsOutboundHalfEdge;
+		theHalfEdge			= theFirstHalfEdge;
 		do
 		{
-			theVertexOrder++;								//	count this edge
-			theHalfEdge	= theHalfEdge->itsMate->itsCycle;	//	move on to the next edge
-		} while (theHalfEdge != theVertex->itsOutboundHalfEdge);
+			theVertexOrder++;															//	count this edge
+			theHalfEdge	= theHalfEdges[theHalfEdges[theHalfEdge].itsMate].itsCycle;	//	move on to the next edge
+		} while (theHalfEdge != theFirstHalfEdge);
 	
 		//	Increment the global counts.
 		aDirichletDomain->itsVertexFiguresNumMeshVertices	+= 2*theVertexOrder + 2;
@@ -1632,13 +3111,21 @@ static void PrepareForVertexFiguresMesh(DirichletDomain *aDirichletDomain)
 
 
 void StayInDirichletDomain(
-	DirichletDomain	*aDirichletDomain,	//	input
-	Matrix			*aPlacement)		//	input and output
+	const DirichletDomain	*aDirichletDomain,	//	input
+	Matrix					*aPlacement)		//	input and output
 {
-	HEFace			*theFace;
-	double			theFaceValue;
+	unsigned int	theNumRestorations,
+					theNumCandidates,
+					theCell,
+					theFace,
+					theWorstFace,
+					i,
+					j;
+	const uint32_t	*theCandidates;
+	HEFace			*theFaces;
+	double			theFaceValue,
+					theWorstFaceValue;
 	Matrix			theRestoringMatrix;
-	unsigned int	i;
 
 	if (aDirichletDomain == NULL)
 		return;
@@ -1649,41 +3136,80 @@ void StayInDirichletDomain(
 
 	//	If the object strays out of the Dirichlet domain,
 	//	use a face-pairing matrix to bring it back in.
-	for (	theFace = aDirichletDomain->itsFaceList;
-			theFace != NULL;
-			theFace = theFace->itsNext)
+	//	Repeat until the object is back inside, so that even
+	//	an object that has strayed past a vertex gets fully restored.
+	//
+	//	The object's position is the image of the basepoint (0,0,0,1)
+	//	under the action of aPlacement, namely aPlacement->m[3].
+	//	If the object lies outside the Dirichlet domain, then the ray
+	//	from the basepoint through the object exits the domain through
+	//	some face, and the object lies beyond that face's plane.
+	//	So it suffices to test the faces visible in the object's direction,
+	//	which the face lookup table provides.
+
+	theFaces = aDirichletDomain->itsFaces;
+
+	for (theNumRestorations = 0; theNumRestorations < MAX_RESTORATIONS; theNumRestorations++)
 	{
-		//	Evaluate the halfspace equation on the image of the basepoint (0,0,0,1)
-		//	under the action of aPlacement.
-		theFaceValue = 0;
-		for (i = 0; i < 4; i++)
-			theFaceValue += theFace->itsHalfspace.v[i] * aPlacement->m[3][i];
+		//	Which faces might the object have gone past?
+		//	The lookup table works in the hemisphere w > 0
+		//	(in which any domain that has a lookup table lies),
+		//	where a point's direction from the basepoint
+		//	is the direction of its (x,y,z) coordinates.
+		if (aDirichletDomain->itsFaceLookupStarts != NULL
+		 && aPlacement->m[3][3] > 0.0)
+		{
+			theCell				= FaceLookupCell(aPlacement->m[3]);
+			theCandidates		= &aDirichletDomain->itsFaceLookupFaces[aDirichletDomain->itsFaceLookupStarts[theCell]];
+			theNumCandidates	= aDirichletDomain->itsFaceLookupStarts[theCell + 1]
+								- aDirichletDomain->itsFaceLookupStarts[theCell];
+		}
+		else
+		{
+			theCandidates		= NULL;	//	test all faces
+			theNumCandidates	= aDirichletDomain->itsNumFaces;
+		}
 
-		//	The value we just computed will be positive
-		//	iff the user has gone past the given face plane.
-		if (theFaceValue > RESTORING_EPSILON)
+		//	Find the face whose plane the object has gone furthest past.
+		theWorstFace		= HE_NO_INDEX;
+		theWorstFaceValue	= RESTORING_EPSILON;
+		for (j = 0; j < theNumCandidates; j++)
 		{
-			//	Apply the inverse of the face-pairing matrix
-			//	to bring the user back closer to the origin.
-			MatrixGeometricInverse(&theFace->itsMatrix, &theRestoringMatrix);
-			MatrixProduct(aPlacement, &theRestoringMatrix, aPlacement);
+			theFace = (theCandidates != NULL) ? theCandidates[j] : j;
+
+			//	Evaluate the halfspace equation on the object's position.
+			//	The value will be positive iff the object
+			//	has gone past the given face plane.
+			theFaceValue = 0;
+			for (i = 0; i < 4; i++)
+				theFaceValue += theFaces[theFace].itsHalfspace.v[i] * aPlacement->m[3][i];
+
+			if (theFaceValue > theWorstFaceValue)
+			{
+				theWorstFace		= theFace;
+				theWorstFaceValue	= theFaceValue;
+			}
 		}
+
+		//	If the object hasn't gone past any face, it's inside.
+		if (theWorstFace == HE_NO_INDEX)
+			break;
+
+		//	Apply the inverse of the face-pairing matrix
+		//	to bring the object back closer to the origin.
+		MatrixGeometricInverse(&theFaces[theWorstFace].itsMatrix, &theRestoringMatrix);
+		MatrixProduct(aPlacement, &theRestoringMatrix, aPlacement);
 	}
 }
 
 
 ErrorText ConstructHoneycomb(
-	MatrixList		*aHolonomyGroup,	//	input
-	DirichletDomain	*aDirichletDomain,	//	input
-	Honeycomb		**aHoneycomb)		//	output
+	MatrixList				*aHolonomyGroup,	//	input
+	const DirichletDomain	*aDirichletDomain,	//	input
+	Honeycomb				**aHoneycomb)		//	output
 {
 	ErrorText		theErrorMessage	= NULL;
-	unsigned int	theNumVertices;
-	HEVertex		*theVertex;
-	unsigned int	i,
-					j;
-
-	static Vector	theBasepoint		= {{0.0, 0.0, 0.0, 1.0}};
+	unsigned int	i;
 
 	if (aHolonomyGroup == NULL)
 		return u"ConstructHoneycomb() received a NULL holonomy group.";
@@ -1698,58 +3224,25 @@ ErrorText ConstructHoneycomb(
 //	if (aDirichletDomain == NULL)
 //		return u"ConstructHoneycomb() received a NULL Dirichlet domain.";
 
-	//	Count the Dirichlet domain's vertices.
-	theNumVertices = 0;
-	if (aDirichletDomain != NULL)
-	{
-		for (	theVertex = aDirichletDomain->itsVertexList;
-				theVertex != NULL;
-				theVertex = theVertex->itsNext)
-		{
-			theNumVertices++;
-		}
-	}
-
 	//	Allocate memory for the honeycomb.
-	*aHoneycomb = AllocateHoneycomb(aHolonomyGroup->itsNumMatrices, theNumVertices);
+	*aHoneycomb = AllocateHoneycomb(aHolonomyGroup->itsNumMatrices, CountVertices(aDirichletDomain));
 	if (*aHoneycomb == NULL)
 	{
 		theErrorMessage = u"Couldn't get memory for aHoneycomb in ConstructHoneycomb().";
 		goto CleanUpConstructHoneycomb;
 	}
 
-	//	For each cell...
+	//	Set up each cell.
 	for (i = 0; i < aHolonomyGroup->itsNumMatrices; i++)
-	{
-		//	Set the matrix.
-		(*aHoneycomb)->itsCells[i].itsMatrix = aHolonomyGroup->itsMatrices[i];
-
-		//	Compute the image of the basepoint (0,0,0,1).
-		VectorTimesMatrix(	&theBasepoint,
-							&aHolonomyGroup->itsMatrices[i],
-							&(*aHoneycomb)->itsCells[i].itsCenter);
-
-		//	Compute the image of the vertices.
-		if (aDirichletDomain != NULL)
-		{
-			for (	theVertex = aDirichletDomain->itsVertexList, j = 0;
-					theVertex != NULL && j < theNumVertices;
-					theVertex = theVertex->itsNext, j++)
-			{
-				VectorTimesMatrix(	&theVertex->itsRawPosition,
-									&aHolonomyGroup->itsMatrices[i],
-									&(*aHoneycomb)->itsCells[i].itsVertices[j]);
-			}
-		}
+		SetUpHoneycell(*aHoneycomb, i, &aHolonomyGroup->itsMatrices[i], aDirichletDomain);
 
-		//	Record the number of vertices.
-		(*aHoneycomb)->itsCells[i].itsNumVertices = theNumVertices;
-	}
+	//	Organize the cells into a bounding-ball hierarchy for culling.
+	theErrorMessage = BuildHoneycombHierarchy(*aHoneycomb, aDirichletDomain);
+	if (theErrorMessage != NULL)
+		goto CleanUpConstructHoneycomb;
 
 CleanUpConstructHoneycomb:
 
-	//	The present code flags an error only when *aHoneycomb == NULL,
-	//	but let's include clean-up code anyhow, for future robustness.
 	if (theErrorMessage != NULL)
 		FreeHoneycomb(aHoneycomb);
 
@@ -1757,49 +3250,350 @@ CleanUpConstructHoneycomb:
 }
 
 
-static Honeycomb *AllocateHoneycomb(
-	unsigned int	aNumCells,
-	unsigned int	aNumVertices)
+static ErrorText MakeFaceLookup(DirichletDomain *aDirichletDomain)
 {
-	Honeycomb		*theHoneycomb	= NULL;
-	unsigned int	i;
+	ErrorText		theErrorMessage	= NULL;
+	double			theCellCenter[3],
+					theCellRadius;
+	unsigned int	thePass,
+					theCell,
+					theFace,
+					theCount;
+
+	//	Build the face lookup table that StayInDirichletDomain() uses.
+	//	Cell c lists each face whose visible directions (as seen
+	//	from the basepoint) come within FACE_LOOKUP_MARGIN of the cell.
+	//	Because each cell is contained in the spherical cap
+	//	of radius theCellRadius about theCellCenter,
+	//	it suffices to compare each face's angular distance
+	//	from theCellCenter to theCellRadius.
+	//
+	//	This relies on the raw vertex positions having been normalized
+	//	to the unit 3-sphere, and on the domain lying within
+	//	the hemisphere w > 0.  Otherwise -- for example for a lens space,
+	//	whose vertices lie on the equator w = 0 -- leave the table empty
+	//	and let StayInDirichletDomain() test every face.
 
-	if ( aNumCells   > 0xFFFFFFFF / sizeof(Honeycell)	//	for safety
-	 || aNumVertices > 0xFFFFFFFF / sizeof(Vector))
-		goto CleanUpAllocateHoneycomb;
+	FREE_MEMORY_SAFELY(aDirichletDomain->itsFaceLookupStarts);
+	FREE_MEMORY_SAFELY(aDirichletDomain->itsFaceLookupFaces);
 
-	theHoneycomb = (Honeycomb *) GET_MEMORY(sizeof(Honeycomb));
-	if (theHoneycomb != NULL)
+	if (ProvisionalBoundingRatio(aDirichletDomain) == INFINITY)
+		return NULL;
+
+	aDirichletDomain->itsFaceLookupStarts = (uint32_t *) GET_MEMORY((FACE_LOOKUP_NUM_CELLS + 1) * sizeof(uint32_t));
+	if (aDirichletDomain->itsFaceLookupStarts == NULL)
+	{
+		theErrorMessage = u"Couldn't allocate memory for the face lookup table.";
+		goto CleanUpMakeFaceLookup;
+	}
+
+	//	Pass 0 counts each cell's faces,
+	//	while pass 1 records them.
+	for (thePass = 0; thePass < 2; thePass++)
+	{
+		theCount = 0;
+
+		for (theCell = 0; theCell < FACE_LOOKUP_NUM_CELLS; theCell++)
+		{
+			aDirichletDomain->itsFaceLookupStarts[theCell] = theCount;
+
+			theCellRadius = FaceLookupCellGeometry(theCell, theCellCenter);
+
+			for (theFace = 0; theFace < aDirichletDomain->itsNumFaces; theFace++)
+			{
+				if (DirectionToFaceAngle(aDirichletDomain, theFace, theCellCenter)
+					<= theCellRadius + FACE_LOOKUP_MARGIN)
+				{
+					if (thePass == 1)
+						aDirichletDomain->itsFaceLookupFaces[theCount] = theFace;
+					theCount++;
+				}
+			}
+		}
+		aDirichletDomain->itsFaceLookupStarts[FACE_LOOKUP_NUM_CELLS] = theCount;
+
+		if (thePass == 0)
+		{
+			aDirichletDomain->itsFaceLookupFaces = (uint32_t *) GET_MEMORY((theCount > 0 ? theCount : 1) * sizeof(uint32_t));
+			if (aDirichletDomain->itsFaceLookupFaces == NULL)
+			{
+				theErrorMessage = u"Couldn't allocate memory for the face lookup table.";
+				goto CleanUpMakeFaceLookup;
+			}
+		}
+	}
+
+CleanUpMakeFaceLookup:
+
+	if (theErrorMessage != NULL)
+	{
+		FREE_MEMORY_SAFELY(aDirichletDomain->itsFaceLookupStarts);
+		FREE_MEMORY_SAFELY(aDirichletDomain->itsFaceLookupFaces);
+	}
+
+	return theErrorMessage;
+}
+
+static unsigned int FaceLookupCell(const double aDirection[3])	//	aDirection need not be normalized
+{
+	unsigned int	theAxis,
+					theSign,
+					theIndex[2],
+					i;
+	double			theMaxComponent,
+					theCoordinate;
+
+	//	Project aDirection radially onto the cube [-1,+1]³.
+	//	The largest component tells which side of the cube it hits.
+	theAxis = 0;
+	for (i = 1; i < 3; i++)
+		if (fabs(aDirection[i]) > fabs(aDirection[theAxis]))
+			theAxis = i;
+	theMaxComponent	= fabs(aDirection[theAxis]);
+	theSign			= (aDirection[theAxis] < 0.0) ? 1 : 0;
+
+	//	The basepoint itself has no direction, but any cell will do.
+	if (theMaxComponent == 0.0)
+		return 0;
+
+	//	Find the cell within that side.
+	for (i = 0; i < 2; i++)
+	{
+		theCoordinate	= aDirection[(theAxis + 1 + i) % 3] / theMaxComponent;	//	in [-1,+1]
+		theIndex[i]		= (unsigned int) floor(0.5 * (theCoordinate + 1.0) * FACE_LOOKUP_RESOLUTION);
+		if (theIndex[i] >= FACE_LOOKUP_RESOLUTION)
+			theIndex[i] = FACE_LOOKUP_RESOLUTION - 1;
+	}
+
+	return ((2*theAxis + theSign) * FACE_LOOKUP_RESOLUTION + theIndex[0]) * FACE_LOOKUP_RESOLUTION + theIndex[1];
+}
+
+static double FaceLookupCellGeometry(	//	returns the radius of a spherical cap containing the cell
+	unsigned int	aCell,		//	input
+	double			aCenter[3])	//	output, unit length
+{
+	unsigned int	theAxis,
+					theSign,
+					theIndex[2],
+					i,
+					j;
+	double			theCorner[3],
+					theLength,
+					theAngle,
+					theRadius;
+
+	//	Invert FaceLookupCell().
+	theIndex[1]	= aCell % FACE_LOOKUP_RESOLUTION;
+	aCell		/= FACE_LOOKUP_RESOLUTION;
+	theIndex[0]	= aCell % FACE_LOOKUP_RESOLUTION;
+	aCell		/= FACE_LOOKUP_RESOLUTION;
+	theSign		= aCell % 2;
+	theAxis		= aCell / 2;
+
+	//	The cell's center.
+	aCenter[theAxis] = theSign ? -1.0 : +1.0;
+	for (i = 0; i < 2; i++)
+		aCenter[(theAxis + 1 + i) % 3] = (2.0 * (theIndex[i] + 0.5) / FACE_LOOKUP_RESOLUTION) - 1.0;
+	theLength = sqrt(aCenter[0]*aCenter[0] + aCenter[1]*aCenter[1] + aCenter[2]*aCenter[2]);
+	for (i = 0; i < 3; i++)
+		aCenter[i] /= theLength;
+
+	//	The cell's corner furthest from its center
+	//	determines the radius of the cap.
+	theRadius = 0.0;
+	for (j = 0; j < 4; j++)
+	{
+		theCorner[theAxis] = theSign ? -1.0 : +1.0;
+		for (i = 0; i < 2; i++)
+			theCorner[(theAxis + 1 + i) % 3] = (2.0 * (theIndex[i] + ((j >> i) & 1)) / FACE_LOOKUP_RESOLUTION) - 1.0;
+		theLength = sqrt(theCorner[0]*theCorner[0] + theCorner[1]*theCorner[1] + theCorner[2]*theCorner[2]);
+
+		theAngle = SafeAcos((aCenter[0]*theCorner[0] + aCenter[1]*theCorner[1] + aCenter[2]*theCorner[2]) / theLength);
+		if (theRadius < theAngle)
+			theRadius = theAngle;
+	}
+
+	return theRadius;
+}
+
+static double DirectionToFaceAngle(
+	DirichletDomain	*aDirichletDomain,	//	input
+	unsigned int	aFace,				//	input
+	const double	aDirection[3])		//	input, unit length
+{
+	HEHalfEdge		*theHalfEdges;
+	Vector			*theRawPositions;
+	unsigned int	theHalfEdge,
+					i;
+	double			theCentroid[3],
+					a[3],
+					b[3],
+					m[3],
+					ma[3],
+					bm[3],
+					theLength,
+					theNormalComponent,
+					theAngle,
+					theOtherAngle,
+					theMinAngle;
+	bool			theInsideFlag;
+
+	//	Seen from the basepoint, aFace occupies a convex cone of directions,
+	//	namely the cone spanned by the (x,y,z) parts of its vertices.
+	//	Return 0 if aDirection lies within that cone, or otherwise
+	//	the angle from aDirection to the cone's boundary.
+	//	The vertices' raw positions lie on the unit 3-sphere with w > 0,
+	//	so each has a nonzero (x,y,z) part.
+
+	theHalfEdges	= aDirichletDomain->itsHalfEdges;
+	theRawPositions	= aDirichletDomain->itsVertexRawPositions;
+
+	//	The centroid lies inside the cone,
+	//	which tells us how to orient each side's normal vector.
+	theCentroid[0] = theCentroid[1] = theCentroid[2] = 0.0;
+	theHalfEdge = aDirichletDomain->itsFaces[aFace].itsHalfEdge;
+	do
+	{
+		for (i = 0; i < 3; i++)
+			theCentroid[i] += theRawPositions[theHalfEdges[theHalfEdge].itsTip].v[i];
+		theHalfEdge = theHalfEdges[theHalfEdge].itsCycle;
+	} while (theHalfEdge != aDirichletDomain->itsFaces[aFace].itsHalfEdge);
+
+	theInsideFlag	= true;
+	theMinAngle		= PI;
+
+	do
+	{
+		//	Let a and b be the unit directions of the current side's endpoints.
+		for (i = 0; i < 3; i++)
+		{
+			a[i] = theRawPositions[theHalfEdges[theHalfEdge].itsTip].v[i];
+			b[i] = theRawPositions[theHalfEdges[theHalfEdges[theHalfEdge].itsCycle].itsTip].v[i];
+		}
+		theLength = sqrt(a[0]*a[0] + a[1]*a[1] + a[2]*a[2]);
+		for (i = 0; i < 3; i++)
+			a[i] /= theLength;
+		theLength = sqrt(b[0]*b[0] + b[1]*b[1] + b[2]*b[2]);
+		for (i = 0; i < 3; i++)
+			b[i] /= theLength;
+
+		//	Let m be the unit normal to the side's great circle,
+		//	oriented so that a rotates towards b about m.
+		m[0] = a[1]*b[2] - a[2]*b[1];
+		m[1] = a[2]*b[0] - a[0]*b[2];
+		m[2] = a[0]*b[1] - a[1]*b[0];
+		theLength = sqrt(m[0]*m[0] + m[1]*m[1] + m[2]*m[2]);
+		if (theLength > 0.0)
+		{
+			for (i = 0; i < 3; i++)
+				m[i] /= theLength;
+
+			//	The cone lies on the centroid's side of the great circle.
+			theNormalComponent = m[0]*aDirection[0] + m[1]*aDirection[1] + m[2]*aDirection[2];
+			if (m[0]*theCentroid[0] + m[1]*theCentroid[1] + m[2]*theCentroid[2] < 0.0)
+				theNormalComponent = - theNormalComponent;
+			if (theNormalComponent < 0.0)
+				theInsideFlag = false;
+
+			//	If aDirection's projection onto the great circle
+			//	lands between a and b, its distance to the side is
+			//	its angle to the great circle.  Otherwise its nearest point
+			//	on the side is an endpoint.  The projection lands
+			//	between a and b iff (a × aDirection)·m ≥ 0
+			//	and (aDirection × b)·m ≥ 0, or equivalently
+			//	aDirection·(m × a) ≥ 0 and aDirection·(b × m) ≥ 0.
+			ma[0] = m[1]*a[2] - m[2]*a[1];
+			ma[1] = m[2]*a[0] - m[0]*a[2];
+			ma[2] = m[0]*a[1] - m[1]*a[0];
+			bm[0] = b[1]*m[2] - b[2]*m[1];
+			bm[1] = b[2]*m[0] - b[0]*m[2];
+			bm[2] = b[0]*m[1] - b[1]*m[0];
+			if (aDirection[0]*ma[0] + aDirection[1]*ma[1] + aDirection[2]*ma[2] >= 0.0
+			 && aDirection[0]*bm[0] + aDirection[1]*bm[1] + aDirection[2]*bm[2] >= 0.0)
+			{
+				theAngle = 0.5*PI - SafeAcos(fabs(theNormalComponent));
+			}
+			else
+			{
+				theAngle		= SafeAcos(aDirection[0]*a[0] + aDirection[1]*a[1] + aDirection[2]*a[2]);
+				theOtherAngle	= SafeAcos(aDirection[0]*b[0] + aDirection[1]*b[1] + aDirection[2]*b[2]);
+				if (theAngle > theOtherAngle)
+					theAngle = theOtherAngle;
+			}
+			if (theMinAngle > theAngle)
+				theMinAngle = theAngle;
+		}
+
+		theHalfEdge = theHalfEdges[theHalfEdge].itsCycle;
+	} while (theHalfEdge != aDirichletDomain->itsFaces[aFace].itsHalfEdge);
+
+	return theInsideFlag ? 0.0 : theMinAngle;
+}
+
+
+static Honeycomb *AllocateHoneycomb(
+	unsigned int	aNumCells,
+	unsigned int	aNumVertices)
+{
+	Honeycomb		*theHoneycomb	= NULL;
+	unsigned int	i;
+
+	if ( aNumCells   > 0xFFFFFFFF / sizeof(Matrix)	//	for safety
+	 || aNumVertices > 0xFFFFFFFF / (4 * sizeof(float))
+	 || (aNumVertices > 0 && aNumCells > 0xFFFFFFFF / (4 * sizeof(float)) / aNumVertices))
+		goto CleanUpAllocateHoneycomb;
+
+	theHoneycomb = (Honeycomb *) GET_MEMORY(sizeof(Honeycomb));
+	if (theHoneycomb != NULL)
 	{
 		//	For safe error handling, immediately set all pointers to NULL.
 		theHoneycomb->itsCells			= NULL;
+		theHoneycomb->itsCellMatrices	= NULL;
+		theHoneycomb->itsCellVertices	= NULL;
+		theHoneycomb->itsNodes			= NULL;
+		theHoneycomb->itsNodeCells		= NULL;
 		theHoneycomb->itsVisibleCells	= NULL;
+		theHoneycomb->itsScratchCells	= NULL;
 	}
 	else
 		goto CleanUpAllocateHoneycomb;
 
-	theHoneycomb->itsNumCells	= aNumCells;
-	theHoneycomb->itsCells		= (Honeycell *) GET_MEMORY(aNumCells * sizeof(Honeycell));
+	//	The caller builds the hierarchy once the cells are in place.
+	theHoneycomb->itsSpaceType	= SpaceNone;
+	theHoneycomb->itsNumNodes	= 0;
+
+	//	SortVisibleCells() increments the frame number before each use,
+	//	so no cell will appear to have been visible last frame.
+	theHoneycomb->itsFrameNumber	= 1;
+
+	theHoneycomb->itsNumCells			= aNumCells;
+	theHoneycomb->itsNumCellVertices	= aNumVertices;
+
+	theHoneycomb->itsCellMatrices = (Matrix *) GET_MEMORY(aNumCells * sizeof(Matrix));
+	if (theHoneycomb->itsCellMatrices == NULL)
+		goto CleanUpAllocateHoneycomb;
+
+	theHoneycomb->itsCells = (Honeycell *) GET_MEMORY(aNumCells * sizeof(Honeycell));
 	if (theHoneycomb->itsCells != NULL)
 	{
-		//	For safe error handling, immediately set all pointers to NULL.
-		for (i = 0; i < aNumCells; i++)
-			theHoneycomb->itsCells[i].itsVertices = NULL;
-
 		for (i = 0; i < aNumCells; i++)
 		{
-			theHoneycomb->itsCells[i].itsNumVertices = aNumVertices;
-			if (aNumVertices != 0)
-			{
-				theHoneycomb->itsCells[i].itsVertices = (Vector *) GET_MEMORY(aNumVertices * sizeof(Vector));
-				if (theHoneycomb->itsCells[i].itsVertices == NULL)
-					goto CleanUpAllocateHoneycomb;
-			}
+			theHoneycomb->itsCells[i].itsMatrix			= &theHoneycomb->itsCellMatrices[i];
+			theHoneycomb->itsCells[i].itsClipMargin		= INFINITY;
+			theHoneycomb->itsCells[i].itsVisibleFrame	= 0;
 		}
 	}
 	else
 		goto CleanUpAllocateHoneycomb;
 
+	//	All the cells' vertex images share a single block of memory.
+	if (aNumVertices != 0)
+	{
+		theHoneycomb->itsCellVertices = (float *) GET_MEMORY((size_t) aNumCells * aNumVertices * 4 * sizeof(float));
+		if (theHoneycomb->itsCellVertices == NULL)
+			goto CleanUpAllocateHoneycomb;
+	}
+
 	//	Allocate itsVisibleCells and initialize to an empty array.
 	//	For simplicity allocate the maximal buffer size, even though
 	//	we will never use all of it.
@@ -1813,66 +3607,1796 @@ static Honeycomb *AllocateHoneycomb(
 	else
 		goto CleanUpAllocateHoneycomb;
 
-	//	Success
-	return theHoneycomb;
+	//	SortVisibleCells() needs scratch space as large as itsVisibleCells.
+	theHoneycomb->itsScratchCells		= (Honeycell **) GET_MEMORY(aNumCells * sizeof(Honeycell *));
+	if (theHoneycomb->itsScratchCells == NULL)
+		goto CleanUpAllocateHoneycomb;
+
+	//	Success
+	return theHoneycomb;
+
+CleanUpAllocateHoneycomb:
+
+	//	We reach this point iff some memory allocation call failed.
+	//	Free whatever memory may have been allocated.
+	//	Other pointers should all be NULL.
+	FreeHoneycomb(&theHoneycomb);
+	
+	//	Failure
+	return NULL;
+}
+
+
+ErrorText ExtendHoneycomb(
+	Honeycomb				*aHoneycomb,		//	input and output
+	MatrixList				*someNewElements,	//	input
+	const DirichletDomain	*aDirichletDomain)	//	input
+{
+	unsigned int	theNumVertices,
+					theOldNumCells,
+					theNewNumCells,
+					i;
+	Honeycell		*theLargerCellArray,
+					**theLargerVisibleCellArray,
+					**theLargerScratchCellArray;
+	Matrix			*theLargerMatrixArray;
+	float			*theLargerVertexArray;
+
+	//	Append a cell for each of someNewElements,
+	//	leaving the existing cells as they are.
+
+	if (aHoneycomb == NULL
+	 || someNewElements == NULL)
+		return u"ExtendHoneycomb() received a NULL input.";
+
+	if (someNewElements->itsNumMatrices == 0)
+		return NULL;
+
+	theNumVertices	= CountVertices(aDirichletDomain);
+	theOldNumCells	= aHoneycomb->itsNumCells;
+	theNewNumCells	= theOldNumCells + someNewElements->itsNumMatrices;
+
+	if (theNewNumCells < theOldNumCells						//	for safety
+	 || theNewNumCells > 0xFFFFFFFF / sizeof(Matrix)
+	 || (theNumVertices > 0 && theNewNumCells > 0xFFFFFFFF / (4 * sizeof(float)) / theNumVertices))
+		return u"Too many cells in ExtendHoneycomb().";
+
+	if (theNumVertices != aHoneycomb->itsNumCellVertices)
+		return u"ExtendHoneycomb() received a Dirichlet domain with the wrong number of vertices.";
+
+	//	The existing hierarchy covers only the old cells.
+	//	Discard it now, so that if we fail part way through,
+	//	SortVisibleCells() falls back to testing every cell.
+	FreeHoneycombHierarchy(aHoneycomb);
+
+	//	Enlarge the cell array.  The existing itsVisibleCells
+	//	would point into the old array, so clear the visible list.
+	//	SortVisibleCells() will rebuild it at render time.
+	//	Skip a frame number, so that no cell appears to have been
+	//	visible in the frame preceding the next one.
+	theLargerCellArray = (Honeycell *) RESIZE_MEMORY(aHoneycomb->itsCells, theNewNumCells * sizeof(Honeycell));
+	if (theLargerCellArray == NULL)
+		return u"Couldn't enlarge the cell array in ExtendHoneycomb().";
+	aHoneycomb->itsCells			= theLargerCellArray;
+	aHoneycomb->itsNumVisibleCells	= 0;
+	aHoneycomb->itsFrameNumber++;
+
+	//	Enlarge the parallel matrix array, and re-aim the existing cells
+	//	at their matrices' possibly new locations.
+	theLargerMatrixArray = (Matrix *) RESIZE_MEMORY(aHoneycomb->itsCellMatrices, theNewNumCells * sizeof(Matrix));
+	if (theLargerMatrixArray == NULL)
+		return u"Couldn't enlarge the cell matrix array in ExtendHoneycomb().";
+	aHoneycomb->itsCellMatrices = theLargerMatrixArray;
+	for (i = 0; i < theOldNumCells; i++)
+		aHoneycomb->itsCells[i].itsMatrix = &aHoneycomb->itsCellMatrices[i];
+
+	//	Enlarge the vertex images' single shared block.
+	//	Should there be no block yet, get one with GET_MEMORY(),
+	//	so that gMemCount counts it.
+	if (theNumVertices != 0)
+	{
+		if (aHoneycomb->itsCellVertices != NULL)
+			theLargerVertexArray = (float *) RESIZE_MEMORY(aHoneycomb->itsCellVertices, (size_t) theNewNumCells * theNumVertices * 4 * sizeof(float));
+		else
+			theLargerVertexArray = (float *) GET_MEMORY((size_t) theNewNumCells * theNumVertices * 4 * sizeof(float));
+		if (theLargerVertexArray == NULL)
+			return u"Couldn't enlarge the cell vertex array in ExtendHoneycomb().";
+		aHoneycomb->itsCellVertices = theLargerVertexArray;
+	}
+
+	theLargerVisibleCellArray = (Honeycell **) RESIZE_MEMORY(aHoneycomb->itsVisibleCells, theNewNumCells * sizeof(Honeycell *));
+	if (theLargerVisibleCellArray == NULL)
+		return u"Couldn't enlarge the visible cell array in ExtendHoneycomb().";
+	aHoneycomb->itsVisibleCells = theLargerVisibleCellArray;
+	for (i = 0; i < theNewNumCells; i++)
+		aHoneycomb->itsVisibleCells[i] = NULL;
+
+	theLargerScratchCellArray = (Honeycell **) RESIZE_MEMORY(aHoneycomb->itsScratchCells, theNewNumCells * sizeof(Honeycell *));
+	if (theLargerScratchCellArray == NULL)
+		return u"Couldn't enlarge the scratch cell array in ExtendHoneycomb().";
+	aHoneycomb->itsScratchCells = theLargerScratchCellArray;
+
+	//	Set up the new cells.
+	for (i = theOldNumCells; i < theNewNumCells; i++)
+	{
+		aHoneycomb->itsCells[i].itsMatrix		= &aHoneycomb->itsCellMatrices[i];
+		aHoneycomb->itsCells[i].itsClipMargin	= INFINITY;
+		aHoneycomb->itsCells[i].itsVisibleFrame	= 0;
+
+		SetUpHoneycell(aHoneycomb, i, &someNewElements->itsMatrices[i - theOldNumCells], aDirichletDomain);
+	}
+	aHoneycomb->itsNumCells = theNewNumCells;
+
+	//	Rebuild the hierarchy over all the cells, old and new.
+	return BuildHoneycombHierarchy(aHoneycomb, aDirichletDomain);
+}
+
+
+static void SetUpHoneycell(
+	Honeycomb				*aHoneycomb,		//	cell arrays must already be allocated
+	unsigned int			aCell,
+	Matrix					*aMatrix,
+	const DirichletDomain	*aDirichletDomain)	//	may be NULL
+{
+	Vector			theVertexImage;
+	unsigned int	j;
+
+	static Vector	theBasepoint		= {{0.0, 0.0, 0.0, 1.0}};
+
+	//	Set the matrix.
+	aHoneycomb->itsCellMatrices[aCell] = *aMatrix;
+
+	//	Compute the image of the basepoint (0,0,0,1).
+	VectorTimesMatrix(&theBasepoint, aMatrix, &aHoneycomb->itsCells[aCell].itsCenter);
+
+	//	Compute the image of the vertices.
+	if (aDirichletDomain != NULL)
+	{
+		for (	j = 0;
+				j < aDirichletDomain->itsNumVertices && j < aHoneycomb->itsNumCellVertices;
+				j++)
+		{
+			VectorTimesMatrix(&aDirichletDomain->itsVertexRawPositions[j], aMatrix, &theVertexImage);
+			PutCellVertex(aHoneycomb, aCell, j, &theVertexImage);
+		}
+	}
+}
+
+
+static void PutCellVertex(
+	Honeycomb		*aHoneycomb,
+	unsigned int	aCell,
+	unsigned int	aVertex,
+	Vector			*aVertexImage)	//	any positive multiple of the vertex's image
+{
+	Vector			theNormalizedImage;
+	float			*theFloats;
+	unsigned int	i;
+
+	//	Store the image normalized to unit length in R⁴,
+	//	regardless of the geometry, so that its floats' rounding errors
+	//	stay within a fixed fraction of its length (see CellMayBeVisible()).
+	if (VectorNormalize(aVertexImage, SpaceSpherical, &theNormalizedImage) != NULL)
+		theNormalizedImage = *aVertexImage;	//	can't happen for a genuine vertex image
+
+	theFloats = &aHoneycomb->itsCellVertices[4 * ((size_t) aCell * aHoneycomb->itsNumCellVertices + aVertex)];
+	for (i = 0; i < 4; i++)
+		theFloats[i] = (float) theNormalizedImage.v[i];
+}
+
+
+static unsigned int CountVertices(const DirichletDomain *aDirichletDomain)	//	may be NULL
+{
+	return (aDirichletDomain != NULL) ? aDirichletDomain->itsNumVertices : 0;
+}
+
+
+static ErrorText BuildHoneycombHierarchy(
+	Honeycomb				*aHoneycomb,		//	input and output
+	const DirichletDomain	*aDirichletDomain)	//	may be NULL
+{
+	ErrorText		theErrorMessage	= NULL;
+	unsigned int	theMaxNumNodes,
+					i;
+	double			theCellRadius;
+	CellSortKey		*theSortKeys	= NULL;
+
+	//	Organize the cells into a hierarchy of bounding balls,
+	//	so that SortVisibleCells() may reject a whole subtree
+	//	-- too far away or wholly outside the view frustum --
+	//	with a single test.
+	//
+	//	The balls live in the space's own geometry, not in R⁴:
+	//	a hyperbolic view matrix is a Lorentz transformation,
+	//	which would distort a Euclidean ball in R⁴ but maps
+	//	a hyperbolic ball to a hyperbolic ball of the same radius.
+
+	FreeHoneycombHierarchy(aHoneycomb);
+
+	//	The 3-sphere has no Dirichlet domain.
+	aHoneycomb->itsSpaceType = (aDirichletDomain != NULL) ?
+								aDirichletDomain->itsSpaceType : SpaceSpherical;
+
+	if (aHoneycomb->itsNumCells == 0)
+		return NULL;
+
+	//	A binary tree whose leaves each hold at least one cell
+	//	has at most 2n - 1 nodes.
+	if (aHoneycomb->itsNumCells > 0xFFFFFFFF / (2 * sizeof(HoneycombNode)))
+		return u"Too many cells in BuildHoneycombHierarchy().";
+	theMaxNumNodes = 2 * aHoneycomb->itsNumCells - 1;
+
+	//	Each cell's vertices lie within the Dirichlet domain's
+	//	circumradius of the cell's center.  CellMayBeVisible()
+	//	treats a cell with no vertices as visible,
+	//	so never let the frustum test reject such a cell.
+	if (CountVertices(aDirichletDomain) > 0)
+		theCellRadius = DirichletDomainCircumradius(aDirichletDomain) + HONEYCOMB_BALL_EPSILON;
+	else
+		theCellRadius = INFINITY;
+
+	//	All cells are congruent, so they share a single bounding radius.
+	for (i = 0; i < aHoneycomb->itsNumCells; i++)
+		aHoneycomb->itsCells[i].itsClipMargin = ClipMargin(aHoneycomb->itsSpaceType, theCellRadius);
+
+	aHoneycomb->itsNodes		= (HoneycombNode *) GET_MEMORY(theMaxNumNodes * sizeof(HoneycombNode));
+	aHoneycomb->itsNodeCells	= (unsigned int *) GET_MEMORY(aHoneycomb->itsNumCells * sizeof(unsigned int));
+	theSortKeys					= (CellSortKey *) GET_MEMORY(aHoneycomb->itsNumCells * sizeof(CellSortKey));
+	if (aHoneycomb->itsNodes     == NULL
+	 || aHoneycomb->itsNodeCells == NULL
+	 || theSortKeys              == NULL)
+	{
+		theErrorMessage = u"Couldn't get memory for the honeycomb's bounding-ball hierarchy.";
+		goto CleanUpBuildHoneycombHierarchy;
+	}
+
+	for (i = 0; i < aHoneycomb->itsNumCells; i++)
+		aHoneycomb->itsNodeCells[i] = i;
+
+	BuildHoneycombNode(aHoneycomb, 0, aHoneycomb->itsNumCells, theCellRadius, theSortKeys);
+
+	GEOMETRY_GAMES_ASSERT(	aHoneycomb->itsNumNodes <= theMaxNumNodes,
+							"Honeycomb hierarchy overflowed its node array");
+
+CleanUpBuildHoneycombHierarchy:
+
+	FREE_MEMORY_SAFELY(theSortKeys);
+
+	if (theErrorMessage != NULL)
+		FreeHoneycombHierarchy(aHoneycomb);
+
+	return theErrorMessage;
+}
+
+
+static void BuildHoneycombNode(
+	Honeycomb		*aHoneycomb,	//	itsNodes and itsNodeCells must already be allocated
+	unsigned int	aFirstCell,		//	index into itsNodeCells
+	unsigned int	aNumCells,		//	at least 1
+	double			aCellRadius,	//	radius of a ball about a cell's center containing the whole cell
+	CellSortKey		*someSortKeys)	//	scratch space for at least aNumCells keys
+{
+	unsigned int	theNodeIndex,
+					*theCells,
+					theSplitAxis,
+					i,
+					j;
+	HoneycombNode	*theNode;
+	Vector			theSum,
+					*theCellCenter;
+	double			theMin[4],
+					theMax[4],
+					theDistance;
+
+	theNodeIndex	= aHoneycomb->itsNumNodes++;
+	theNode			= &aHoneycomb->itsNodes[theNodeIndex];
+	theCells		= &aHoneycomb->itsNodeCells[aFirstCell];
+
+	theNode->itsFirstCell	= aFirstCell;
+	theNode->itsNumCells	= aNumCells;
+	theNode->itsSecondChild	= 0;
+
+	//	Center the node's ball at the normalized centroid
+	//	of its cells' centers, and note each coordinate's range.
+	for (j = 0; j < 4; j++)
+	{
+		theSum.v[j] = 0.0;
+		theMin[j]	= +INFINITY;
+		theMax[j]	= -INFINITY;
+	}
+	for (i = 0; i < aNumCells; i++)
+	{
+		theCellCenter = &aHoneycomb->itsCells[theCells[i]].itsCenter;
+		for (j = 0; j < 4; j++)
+		{
+			theSum.v[j] += theCellCenter->v[j];
+			if (theMin[j] > theCellCenter->v[j])
+				theMin[j] = theCellCenter->v[j];
+			if (theMax[j] < theCellCenter->v[j])
+				theMax[j] = theCellCenter->v[j];
+		}
+	}
+
+	//	On S³ the centroid may sit at (or very near) the origin of R⁴.
+	//	Any center gives a valid ball, so fall back to the first cell's.
+	if (VectorNormalize(&theSum, aHoneycomb->itsSpaceType, &theNode->itsCenter) != NULL)
+		theNode->itsCenter = aHoneycomb->itsCells[theCells[0]].itsCenter;
+
+	//	A flat center must have w exactly 1, or VectorGeometricDistance()
+	//	would mistake it for a spherical point.
+	if (aHoneycomb->itsSpaceType == SpaceFlat)
+		theNode->itsCenter.v[3] = 1.0;
+
+	theNode->itsCenterRadius = 0.0;
+	for (i = 0; i < aNumCells; i++)
+	{
+		theDistance = HoneycombDistance(aHoneycomb->itsSpaceType,
+										&theNode->itsCenter,
+										&aHoneycomb->itsCells[theCells[i]].itsCenter);
+		if (theNode->itsCenterRadius < theDistance)
+			theNode->itsCenterRadius = theDistance;
+	}
+	theNode->itsCenterRadius += HONEYCOMB_BALL_EPSILON;
+
+	//	The node's cells all lie within aCellRadius of their centers.
+	theNode->itsClipMargin = ClipMargin(aHoneycomb->itsSpaceType, theNode->itsCenterRadius + aCellRadius);
+
+	if (aNumCells <= HONEYCOMB_LEAF_CELLS)
+		return;
+
+	//	Split the cells at the median of whichever ambient coordinate
+	//	varies the most.  Break ties by cell index, so the hierarchy
+	//	doesn't depend on qsort()'s whims.
+	theSplitAxis = 0;
+	for (j = 1; j < 4; j++)
+		if (theMax[j] - theMin[j] > theMax[theSplitAxis] - theMin[theSplitAxis])
+			theSplitAxis = j;
+
+	for (i = 0; i < aNumCells; i++)
+	{
+		someSortKeys[i].itsKey	= aHoneycomb->itsCells[theCells[i]].itsCenter.v[theSplitAxis];
+		someSortKeys[i].itsCell	= theCells[i];
+	}
+	qsort(someSortKeys, aNumCells, sizeof(CellSortKey), CompareCellSortKeys);
+	for (i = 0; i < aNumCells; i++)
+		theCells[i] = someSortKeys[i].itsCell;
+
+	//	The first child immediately follows its parent.
+	//	Don't use theNode after the recursive call --
+	//	write to the node array directly instead.
+	BuildHoneycombNode(	aHoneycomb,
+						aFirstCell,
+						aNumCells / 2,
+						aCellRadius,
+						someSortKeys);
+	aHoneycomb->itsNodes[theNodeIndex].itsSecondChild = aHoneycomb->itsNumNodes;
+	BuildHoneycombNode(	aHoneycomb,
+						aFirstCell + aNumCells / 2,
+						aNumCells - aNumCells / 2,
+						aCellRadius,
+						someSortKeys);
+}
+
+
+static __cdecl signed int CompareCellSortKeys(
+	const void	*p1,
+	const void	*p2)
+{
+	const CellSortKey	*theKey1 = (const CellSortKey *) p1,
+						*theKey2 = (const CellSortKey *) p2;
+
+	if (theKey1->itsKey < theKey2->itsKey)
+		return -1;
+	if (theKey1->itsKey > theKey2->itsKey)
+		return +1;
+
+	if (theKey1->itsCell < theKey2->itsCell)
+		return -1;
+	if (theKey1->itsCell > theKey2->itsCell)
+		return +1;
+
+	return 0;
+}
+
+
+static double ClipMargin(
+	SpaceType	aSpaceType,
+	double		aBallRadius)
+{
+	//	BallVersusFrustum() compares the signed distance from a ball's center
+	//	to a clipping plane against the ball's radius.  The plane's equation
+	//	gives not the distance itself but its sine (spherical case),
+	//	the distance (flat case) or its sinh (hyperbolic case),
+	//	so return the corresponding function of the radius.
+	//	A spherical ball reaching beyond a hemisphere can't lie
+	//	wholly on either side of any clipping plane,
+	//	so return INFINITY to disable the test.
+
+	switch (aSpaceType)
+	{
+		case SpaceSpherical:
+			return (aBallRadius < 0.5*PI) ? sin(aBallRadius) : INFINITY;
+
+		case SpaceFlat:
+			return aBallRadius;
+
+		case SpaceHyperbolic:
+			return sinh(aBallRadius);
+
+		default:
+			return INFINITY;
+	}
+}
+
+
+static double HoneycombDistance(
+	SpaceType	aSpaceType,
+	Vector		*aPointA,	//	normalized to aSpaceType
+	Vector		*aPointB)	//	normalized to aSpaceType
+{
+	//	Let aSpaceType, not the points' w-coordinates, decide the geometry.
+	//	(VectorGeometricDistance2() uses the Euclidean dot product
+	//	even in the hyperbolic case, which isn't what we want here.)
+
+	switch (aSpaceType)
+	{
+		case SpaceSpherical:
+			return SafeAcos(  aPointA->v[0] * aPointB->v[0]
+							+ aPointA->v[1] * aPointB->v[1]
+							+ aPointA->v[2] * aPointB->v[2]
+							+ aPointA->v[3] * aPointB->v[3]);
+
+		case SpaceFlat:
+			return sqrt(  (aPointA->v[0] - aPointB->v[0]) * (aPointA->v[0] - aPointB->v[0])
+						+ (aPointA->v[1] - aPointB->v[1]) * (aPointA->v[1] - aPointB->v[1])
+						+ (aPointA->v[2] - aPointB->v[2]) * (aPointA->v[2] - aPointB->v[2]));
+
+		case SpaceHyperbolic:
+			return SafeAcosh(- aPointA->v[0] * aPointB->v[0]
+							 - aPointA->v[1] * aPointB->v[1]
+							 - aPointA->v[2] * aPointB->v[2]
+							 + aPointA->v[3] * aPointB->v[3]);
+
+		default:
+			return 0.0;
+	}
+}
+
+
+static void FreeHoneycombHierarchy(Honeycomb *aHoneycomb)
+{
+	FREE_MEMORY_SAFELY(aHoneycomb->itsNodes);
+	FREE_MEMORY_SAFELY(aHoneycomb->itsNodeCells);
+	aHoneycomb->itsNumNodes = 0;
+}
+
+
+void FreeHoneycomb(Honeycomb **aHoneycomb)
+{
+	if (aHoneycomb != NULL
+	 && *aHoneycomb != NULL)
+	{
+		FREE_MEMORY_SAFELY((*aHoneycomb)->itsCells);
+		FREE_MEMORY_SAFELY((*aHoneycomb)->itsCellMatrices);
+		FREE_MEMORY_SAFELY((*aHoneycomb)->itsCellVertices);
+		FreeHoneycombHierarchy(*aHoneycomb);
+		FREE_MEMORY_SAFELY((*aHoneycomb)->itsVisibleCells);
+		FREE_MEMORY_SAFELY((*aHoneycomb)->itsScratchCells);
+		FREE_MEMORY_SAFELY(*aHoneycomb);
+	}
+}
+
+
+ErrorText WriteSpaceCacheImage(
+	SpaceCacheInfo			*aSpaceCacheInfo,	//	input
+	const DirichletDomain	*aDirichletDomain,	//	input, may be NULL for the 3-sphere
+	Honeycomb				*aHoneycomb,		//	input
+	size_t					*aNumBytes,			//	output
+	Byte					**someBytes)		//	output, caller must FREE_MEMORY() it
+{
+	ErrorText		theErrorMessage		= NULL;
+	unsigned int	theNumVertices		= 0,
+					theNumHalfEdges		= 0,
+					theNumFaces			= 0,
+					theNumCellVertices,
+					theFlags,
+					i,
+					j;
+	HEVertex		*theVertex;
+	HEHalfEdge		*theHalfEdge;
+	HEFace			*theFace;
+	const float		*theFloats;
+	size_t			theNumBytes;
+	Byte			*theCursor;
+
+	//	Flatten the Dirichlet domain and the honeycomb into a single
+	//	relocatable byte image, suitable for writing to disk and later
+	//	memory-mapping back in.  The image stores
+	//
+	//		a header,
+	//		the Dirichlet domain's vertices, half edges and faces,
+	//			in their array order, with their array indices, and
+	//		the honeycomb's cells, in their near-to-far order,
+	//			each with its matrix, center and vertex images,
+	//			the latter as the honeycomb's own unit-length floats.
+	//
+	//	The cells' matrices are precisely the sorted holonomy group.
+	//	All numbers are written little-endian, whatever the host's
+	//	byte order, and all doubles sit at 8-byte aligned offsets.
+
+	if (*someBytes != NULL)
+		return u"WriteSpaceCacheImage() received a non-NULL output location.";
+	
+	if (aHoneycomb == NULL)
+		return u"WriteSpaceCacheImage() received a NULL honeycomb.";
+
+	if (aDirichletDomain != NULL)
+	{
+		theNumVertices	= aDirichletDomain->itsNumVertices;
+		theNumHalfEdges	= aDirichletDomain->itsNumHalfEdges;
+		theNumFaces		= aDirichletDomain->itsNumFaces;
+	}
+
+	//	Every cell carries the same number of vertex images.
+	theNumCellVertices = aHoneycomb->itsNumCellVertices;
+
+	//	Allocate the image.
+	theNumBytes	= SPACE_CACHE_HEADER_BYTES
+				+ (size_t) theNumVertices  * SPACE_CACHE_VERTEX_BYTES
+				+ (size_t) theNumHalfEdges * SPACE_CACHE_HALFEDGE_BYTES
+				+ (size_t) theNumFaces     * SPACE_CACHE_FACE_BYTES
+				+ (size_t) aHoneycomb->itsNumCells
+					* (SPACE_CACHE_CELL_BYTES + (size_t) theNumCellVertices * SPACE_CACHE_CELL_VERTEX_BYTES);
+	*someBytes = (Byte *) GET_MEMORY(theNumBytes);
+	if (*someBytes == NULL)
+	{
+		theErrorMessage = u"Couldn't allocate memory for the space cache image.";
+		goto CleanUpWriteSpaceCacheImage;
+	}
+	*aNumBytes	= theNumBytes;
+	theCursor	= *someBytes;
+
+	//	Header
+	theFlags = 0;
+	if (aSpaceCacheInfo->itsDrawBackHemisphere)
+		theFlags |= SPACE_CACHE_FLAG_BACK_HEMISPHERE;
+	if (aSpaceCacheInfo->itsThreeSphereFlag)
+		theFlags |= SPACE_CACHE_FLAG_THREE_SPHERE;
+	if (aDirichletDomain != NULL)
+		theFlags |= SPACE_CACHE_FLAG_HAS_DOMAIN;
+	memcpy(theCursor, SPACE_CACHE_SIGNATURE, 8);
+	theCursor += 8;
+	PutUInt32(&theCursor, SPACE_CACHE_VERSION);
+	PutUInt32(&theCursor, (uint32_t) aSpaceCacheInfo->itsSpaceType);
+	PutUInt64(&theCursor, aSpaceCacheInfo->itsKey);
+	PutUInt32(&theCursor, theFlags);
+	PutUInt32(&theCursor, theNumVertices);
+	PutUInt32(&theCursor, theNumHalfEdges);
+	PutUInt32(&theCursor, theNumFaces);
+	PutUInt32(&theCursor, aHoneycomb->itsNumCells);
+	PutUInt32(&theCursor, theNumCellVertices);
+	PutUInt32(&theCursor, aDirichletDomain != NULL ? aDirichletDomain->itsDirichletNumMeshVertices     : 0);
+	PutUInt32(&theCursor, aDirichletDomain != NULL ? aDirichletDomain->itsDirichletNumMeshFaces        : 0);
+	PutUInt32(&theCursor, aDirichletDomain != NULL ? aDirichletDomain->itsVertexFiguresNumMeshVertices : 0);
+	PutUInt32(&theCursor, aDirichletDomain != NULL ? aDirichletDomain->itsVertexFiguresNumMeshFaces    : 0);
+
+	//	Vertices
+	for (i = 0; i < theNumVertices; i++)
+	{
+		theVertex = &aDirichletDomain->itsVertices[i];
+		PutVector(&theCursor, &aDirichletDomain->itsVertexRawPositions[i]);
+		PutVector(&theCursor, &theVertex->itsNormalizedPosition);
+		PutVector(&theCursor, &theVertex->itsCenterPoint);
+		PutUInt32(&theCursor, theVertex->itsOutboundHalfEdge);
+		PutUInt32(&theCursor, 0);	//	padding
+	}
+
+	//	Half edges
+	for (i = 0; i < theNumHalfEdges; i++)
+	{
+		theHalfEdge = &aDirichletDomain->itsHalfEdges[i];
+		PutUInt32(&theCursor, theHalfEdge->itsTip  );
+		PutUInt32(&theCursor, theHalfEdge->itsMate );
+		PutUInt32(&theCursor, theHalfEdge->itsCycle);
+		PutUInt32(&theCursor, theHalfEdge->itsFace );
+		PutDouble(&theCursor, theHalfEdge->itsBase);
+		PutDouble(&theCursor, theHalfEdge->itsAltitude);
+		PutVector(&theCursor, &theHalfEdge->itsOuterPoint);
+		PutVector(&theCursor, &theHalfEdge->itsInnerPoint);
+	}
+
+	//	Faces
+	for (i = 0; i < theNumFaces; i++)
+	{
+		theFace = &aDirichletDomain->itsFaces[i];
+		PutUInt32(&theCursor, theFace->itsHalfEdge);
+		PutUInt32(&theCursor, theFace->itsColorIndex);
+		PutVector(&theCursor, &theFace->itsHalfspace);
+		PutMatrix(&theCursor, &theFace->itsMatrix);
+		PutDouble(&theCursor, theFace->itsColorRGBA.r);
+		PutDouble(&theCursor, theFace->itsColorRGBA.g);
+		PutDouble(&theCursor, theFace->itsColorRGBA.b);
+		PutDouble(&theCursor, theFace->itsColorRGBA.a);
+		PutDouble(&theCursor, theFace->itsColorGreyscale);
+		PutVector(&theCursor, &theFace->itsRawCenter);
+		PutVector(&theCursor, &theFace->itsNormalizedCenter);
+	}
+
+	//	Cells
+	for (i = 0; i < aHoneycomb->itsNumCells; i++)
+	{
+		PutMatrix(&theCursor, &aHoneycomb->itsCellMatrices[i]);
+		PutVector(&theCursor, &aHoneycomb->itsCells[i].itsCenter);
+		theFloats = &aHoneycomb->itsCellVertices[4 * (size_t) i * theNumCellVertices];
+		for (j = 0; j < 4 * theNumCellVertices; j++)
+			PutFloat(&theCursor, theFloats[j]);
+	}
+
+	GEOMETRY_GAMES_ASSERT(	theCursor == *someBytes + theNumBytes,
+							"Space cache image size doesn't match its contents");
+
+CleanUpWriteSpaceCacheImage:
+
+	if (theErrorMessage != NULL)
+	{
+		FREE_MEMORY_SAFELY(*someBytes);
+		*aNumBytes = 0;
+	}
+
+	return theErrorMessage;
+}
+
+
+ErrorText ReadSpaceCacheImage(
+	const Byte		*someBytes,			//	input, typically memory-mapped
+	size_t			aNumBytes,			//	input
+	SpaceCacheInfo	*aSpaceCacheInfo,	//	output
+	DirichletDomain	**aDirichletDomain,	//	output, NULL for the 3-sphere
+	Honeycomb		**aHoneycomb)		//	output
+{
+	ErrorText		theErrorMessage		= NULL;
+	const Byte		*theCursor;
+	uint32_t		theVersion,
+					theFlags,
+					theNumVertices,
+					theNumHalfEdges,
+					theNumFaces,
+					theNumCells,
+					theNumCellVertices;
+	HEVertex		*theVertex;
+	HEHalfEdge		*theHalfEdge;
+	HEFace			*theFace;
+	float			*theFloats;
+	unsigned int	i,
+					j;
+
+	//	Rebuild a Dirichlet domain and a honeycomb from an image
+	//	that WriteSpaceCacheImage() created.  The image gets read
+	//	in a single pass, straight from the (possibly memory-mapped)
+	//	bytes, directly into the Dirichlet domain's arrays.
+	//	No geometry gets recomputed.
+	//
+	//	Treat the image as untrusted:  it may be stale, truncated
+	//	or corrupt, in which case return an error and let the caller
+	//	fall back to computing the space from scratch.
+
+	if (*aDirichletDomain != NULL
+	 || *aHoneycomb != NULL)
+		return u"ReadSpaceCacheImage() received a non-NULL output location.";
+
+	//	Header
+	if (aNumBytes < SPACE_CACHE_HEADER_BYTES
+	 || memcmp(someBytes, SPACE_CACHE_SIGNATURE, 8) != 0)
+		return u"Space cache image has no valid header.";
+	theCursor = someBytes + 8;
+	theVersion = GetUInt32(&theCursor);
+	if (theVersion != SPACE_CACHE_VERSION)
+		return u"Space cache image has an unknown version.";
+	aSpaceCacheInfo->itsSpaceType	= (SpaceType) GetUInt32(&theCursor);
+	aSpaceCacheInfo->itsKey			= GetUInt64(&theCursor);
+	theFlags						= GetUInt32(&theCursor);
+	theNumVertices					= GetUInt32(&theCursor);
+	theNumHalfEdges					= GetUInt32(&theCursor);
+	theNumFaces						= GetUInt32(&theCursor);
+	theNumCells						= GetUInt32(&theCursor);
+	theNumCellVertices				= GetUInt32(&theCursor);
+	aSpaceCacheInfo->itsDrawBackHemisphere	= ((theFlags & SPACE_CACHE_FLAG_BACK_HEMISPHERE) != 0);
+	aSpaceCacheInfo->itsThreeSphereFlag		= ((theFlags & SPACE_CACHE_FLAG_THREE_SPHERE   ) != 0);
+
+	if (aSpaceCacheInfo->itsSpaceType != SpaceSpherical
+	 && aSpaceCacheInfo->itsSpaceType != SpaceFlat
+	 && aSpaceCacheInfo->itsSpaceType != SpaceHyperbolic)
+		return u"Space cache image has an invalid space type.";
+
+	if (((theFlags & SPACE_CACHE_FLAG_HAS_DOMAIN) != 0) != (theNumVertices > 0)
+	 || theNumVertices  > 0xFFFF
+	 || theNumHalfEdges > 0xFFFF
+	 || theNumFaces     > 0xFFFF
+	 || theNumCellVertices != theNumVertices
+	 || theNumCells == 0
+	 || theNumCells > 0xFFFFFFFF / (SPACE_CACHE_CELL_BYTES + theNumCellVertices * SPACE_CACHE_CELL_VERTEX_BYTES)
+	 || aNumBytes !=	SPACE_CACHE_HEADER_BYTES
+					+ (size_t) theNumVertices  * SPACE_CACHE_VERTEX_BYTES
+					+ (size_t) theNumHalfEdges * SPACE_CACHE_HALFEDGE_BYTES
+					+ (size_t) theNumFaces     * SPACE_CACHE_FACE_BYTES
+					+ (size_t) theNumCells
+						* (SPACE_CACHE_CELL_BYTES + (size_t) theNumCellVertices * SPACE_CACHE_CELL_VERTEX_BYTES))
+		return u"Space cache image has inconsistent sizes.";
+
+	if (theNumVertices > 0)
+	{
+		//	Allocate the Dirichlet domain and its arrays
+		//	just as ConstructDirichletDomain() would,
+		//	so FreeDirichletDomain() may free them as usual.
+		
+		*aDirichletDomain = AllocateDirichletDomain();
+		if (*aDirichletDomain == NULL)
+		{
+			theErrorMessage = u"Couldn't allocate memory for the cached Dirichlet domain.";
+			goto CleanUpReadSpaceCacheImage;
+		}
+		theErrorMessage = ReserveDirichletSpace(*aDirichletDomain, theNumVertices, theNumHalfEdges, theNumFaces);
+		if (theErrorMessage != NULL)
+			goto CleanUpReadSpaceCacheImage;
+		(*aDirichletDomain)->itsNumVertices		= theNumVertices;
+		(*aDirichletDomain)->itsNumHalfEdges	= theNumHalfEdges;
+		(*aDirichletDomain)->itsNumFaces		= theNumFaces;
+		(*aDirichletDomain)->itsSpaceType		= aSpaceCacheInfo->itsSpaceType;
+		(*aDirichletDomain)->itsDirichletNumMeshVertices		= GetUInt32(&theCursor);
+		(*aDirichletDomain)->itsDirichletNumMeshFaces			= GetUInt32(&theCursor);
+		(*aDirichletDomain)->itsVertexFiguresNumMeshVertices	= GetUInt32(&theCursor);
+		(*aDirichletDomain)->itsVertexFiguresNumMeshFaces		= GetUInt32(&theCursor);
+
+		//	Read the components, validating each stored index.
+		
+		for (i = 0; i < theNumVertices; i++)
+		{
+			theVertex = &(*aDirichletDomain)->itsVertices[i];
+			GetVector(&theCursor, &(*aDirichletDomain)->itsVertexRawPositions[i]);
+			GetVector(&theCursor, &theVertex->itsNormalizedPosition);
+			GetVector(&theCursor, &theVertex->itsCenterPoint);
+			theVertex->itsOutboundHalfEdge = GetUInt32(&theCursor);
+			(void) GetUInt32(&theCursor);	//	padding
+			if (theVertex->itsOutboundHalfEdge >= theNumHalfEdges)
+				goto CorruptImage;
+			(*aDirichletDomain)->itsVertexHalfspaceStatus[i] = VertexInsideHalfspace;	//	unused after construction
+		}
+
+		for (i = 0; i < theNumHalfEdges; i++)
+		{
+			theHalfEdge = &(*aDirichletDomain)->itsHalfEdges[i];
+			theHalfEdge->itsTip		= GetUInt32(&theCursor);
+			theHalfEdge->itsMate	= GetUInt32(&theCursor);
+			theHalfEdge->itsCycle	= GetUInt32(&theCursor);
+			theHalfEdge->itsFace	= GetUInt32(&theCursor);
+			if (theHalfEdge->itsTip   >= theNumVertices
+			 || theHalfEdge->itsMate  >= theNumHalfEdges
+			 || theHalfEdge->itsCycle >= theNumHalfEdges
+			 || theHalfEdge->itsFace  >= theNumFaces)
+				goto CorruptImage;
+			theHalfEdge->itsBase			= GetDouble(&theCursor);
+			theHalfEdge->itsAltitude		= GetDouble(&theCursor);
+			GetVector(&theCursor, &theHalfEdge->itsOuterPoint);
+			GetVector(&theCursor, &theHalfEdge->itsInnerPoint);
+			theHalfEdge->itsDeletionFlag	= false;	//	unused after construction
+		}
+
+		for (i = 0; i < theNumFaces; i++)
+		{
+			theFace = &(*aDirichletDomain)->itsFaces[i];
+			theFace->itsHalfEdge = GetUInt32(&theCursor);
+			if (theFace->itsHalfEdge >= theNumHalfEdges)
+				goto CorruptImage;
+			theFace->itsColorIndex		= GetUInt32(&theCursor);
+			GetVector(&theCursor, &theFace->itsHalfspace);
+			GetMatrix(&theCursor, &theFace->itsMatrix);
+			theFace->itsColorRGBA.r		= GetDouble(&theCursor);
+			theFace->itsColorRGBA.g		= GetDouble(&theCursor);
+			theFace->itsColorRGBA.b		= GetDouble(&theCursor);
+			theFace->itsColorRGBA.a		= GetDouble(&theCursor);
+			theFace->itsColorGreyscale	= GetDouble(&theCursor);
+			GetVector(&theCursor, &theFace->itsRawCenter);
+			GetVector(&theCursor, &theFace->itsNormalizedCenter);
+			theFace->itsDeletionFlag	= false;	//	unused after construction
+		}
+
+		//	In-range indices aren't enough:  a non-closing itsCycle
+		//	or an asymmetric itsMate would send MakeFaceLookup()
+		//	and every later walk around a face or vertex
+		//	into an infinite loop.
+		if ( ! HalfEdgeStructureIsValid(*aDirichletDomain) )
+		{
+			theErrorMessage = u"Space cache image contains an inconsistent Dirichlet domain.";
+			goto CleanUpReadSpaceCacheImage;
+		}
+
+		//	The cache doesn't record the face lookup table,
+		//	which is quick to recompute.
+		theErrorMessage = MakeFaceLookup(*aDirichletDomain);
+		if (theErrorMessage != NULL)
+			goto CleanUpReadSpaceCacheImage;
+	}
+	else
+	{
+		//	The 3-sphere has no Dirichlet domain.
+		//	Skip the unused mesh counts.
+		theCursor += 4 * 4;
+	}
+
+	//	Cells
+	*aHoneycomb = AllocateHoneycomb(theNumCells, theNumCellVertices);
+	if (*aHoneycomb == NULL)
+	{
+		theErrorMessage = u"Couldn't allocate memory for the cached honeycomb.";
+		goto CleanUpReadSpaceCacheImage;
+	}
+	for (i = 0; i < theNumCells; i++)
+	{
+		GetMatrix(&theCursor, &(*aHoneycomb)->itsCellMatrices[i]);
+		GetVector(&theCursor, &(*aHoneycomb)->itsCells[i].itsCenter);
+		theFloats = &(*aHoneycomb)->itsCellVertices[4 * (size_t) i * theNumCellVertices];
+		for (j = 0; j < 4 * theNumCellVertices; j++)
+			theFloats[j] = GetFloat(&theCursor);
+		(*aHoneycomb)->itsCells[i].itsDistance = 0.0;
+	}
+
+	GEOMETRY_GAMES_ASSERT(	theCursor == someBytes + aNumBytes,
+							"Space cache image size doesn't match its contents");
+
+	//	The cache doesn't record the bounding-ball hierarchy either.
+	theErrorMessage = BuildHoneycombHierarchy(*aHoneycomb, *aDirichletDomain);
+	if (theErrorMessage != NULL)
+		goto CleanUpReadSpaceCacheImage;
+
+	goto CleanUpReadSpaceCacheImage;
+
+CorruptImage:
+
+	theErrorMessage = u"Space cache image contains an invalid index.";
+
+CleanUpReadSpaceCacheImage:
+
+	if (theErrorMessage != NULL)
+	{
+		FreeDirichletDomain(aDirichletDomain);
+		FreeHoneycomb(aHoneycomb);
+	}
+
+	return theErrorMessage;
+}
+
+
+static bool HalfEdgeStructureIsValid(DirichletDomain *aDirichletDomain)
+{
+	HEHalfEdge		*theHalfEdges;
+	unsigned int	theNumVisited,
+					theFirstHalfEdge,
+					theHalfEdge,
+					i;
+	bool			theStructureIsValid;
+
+	//	Check that
+	//
+	//		itsMate is an involution without fixed points,
+	//		each face's itsCycle returns to its start
+	//			within itsNumHalfEdges steps, and
+	//		each half edge on a face's cycle points back to that face.
+	//
+	//	Insist too that the faces' cycles visit each half edge
+	//	exactly once.  itsCycle is then a permutation, so a walk
+	//	around a face or a vertex closes up no matter which
+	//	half edge it starts from.
+	//
+	//	Use itsDeletionFlag, which is otherwise unused after
+	//	construction, to mark visited half edges.
+
+	theHalfEdges = aDirichletDomain->itsHalfEdges;
+
+	for (i = 0; i < aDirichletDomain->itsNumHalfEdges; i++)
+	{
+		if (theHalfEdges[i].itsMate == i
+		 || theHalfEdges[theHalfEdges[i].itsMate].itsMate != i)
+			return false;
+	}
+
+	theNumVisited		= 0;
+	theStructureIsValid	= true;
+	for (i = 0; i < aDirichletDomain->itsNumFaces && theStructureIsValid; i++)
+	{
+		theFirstHalfEdge	= aDirichletDomain->itsFaces[i].itsHalfEdge;
+		theHalfEdge			= theFirstHalfEdge;
+		do
+		{
+			if (theHalfEdges[theHalfEdge].itsDeletionFlag		//	revisits a half edge
+			 || theHalfEdges[theHalfEdge].itsFace != i			//	belongs to another face
+			 || theNumVisited == aDirichletDomain->itsNumHalfEdges)	//	never closes
+			{
+				theStructureIsValid = false;
+				break;
+			}
+			theHalfEdges[theHalfEdge].itsDeletionFlag = true;
+			theNumVisited++;
+			theHalfEdge = theHalfEdges[theHalfEdge].itsCycle;
+
+		} while (theHalfEdge != theFirstHalfEdge);
+	}
+	if (theNumVisited != aDirichletDomain->itsNumHalfEdges)
+		theStructureIsValid = false;
+
+	for (i = 0; i < aDirichletDomain->itsNumHalfEdges; i++)
+		theHalfEdges[i].itsDeletionFlag = false;
+
+	return theStructureIsValid;
+}
+
+
+static void PutUInt32(
+	Byte		**aCursor,
+	uint32_t	aValue)
+{
+	unsigned int	i;
+
+	for (i = 0; i < 4; i++)
+		*(*aCursor)++ = (Byte)(aValue >> (8*i));
+}
+
+static void PutUInt64(
+	Byte		**aCursor,
+	uint64_t	aValue)
+{
+	unsigned int	i;
+
+	for (i = 0; i < 8; i++)
+		*(*aCursor)++ = (Byte)(aValue >> (8*i));
+}
+
+static void PutDouble(
+	Byte		**aCursor,
+	double		aValue)
+{
+	uint64_t	theBits;
+
+	//	Write the IEEE 754 bit pattern little-endian.
+	memcpy(&theBits, &aValue, sizeof(theBits));
+	PutUInt64(aCursor, theBits);
+}
+
+static void PutVector(
+	Byte		**aCursor,
+	Vector		*aVector)
+{
+	unsigned int	i;
+
+	for (i = 0; i < 4; i++)
+		PutDouble(aCursor, aVector->v[i]);
+}
+
+static void PutMatrix(
+	Byte		**aCursor,
+	Matrix		*aMatrix)
+{
+	unsigned int	i,
+					j;
+
+	for (i = 0; i < 4; i++)
+		for (j = 0; j < 4; j++)
+			PutDouble(aCursor, aMatrix->m[i][j]);
+	PutUInt32(aCursor, aMatrix->itsParity == ImageNegative ? 1 : 0);
+	PutUInt32(aCursor, 0);	//	padding
+}
+
+static void PutFloat(
+	Byte		**aCursor,
+	float		aValue)
+{
+	uint32_t	theBits;
+
+	//	Write the IEEE 754 bit pattern little-endian.
+	memcpy(&theBits, &aValue, sizeof(theBits));
+	PutUInt32(aCursor, theBits);
+}
+
+static uint32_t GetUInt32(
+	const Byte	**aCursor)
+{
+	uint32_t		theValue	= 0;
+	unsigned int	i;
+
+	for (i = 0; i < 4; i++)
+		theValue |= (uint32_t)(*(*aCursor)++) << (8*i);
+
+	return theValue;
+}
+
+static uint64_t GetUInt64(
+	const Byte	**aCursor)
+{
+	uint64_t		theValue	= 0;
+	unsigned int	i;
+
+	for (i = 0; i < 8; i++)
+		theValue |= (uint64_t)(*(*aCursor)++) << (8*i);
+
+	return theValue;
+}
+
+static double GetDouble(
+	const Byte	**aCursor)
+{
+	uint64_t	theBits;
+	double		theValue;
+
+	theBits = GetUInt64(aCursor);
+	memcpy(&theValue, &theBits, sizeof(theValue));
+
+	return theValue;
+}
+
+static float GetFloat(
+	const Byte	**aCursor)
+{
+	uint32_t	theBits;
+	float		theValue;
+
+	theBits = GetUInt32(aCursor);
+	memcpy(&theValue, &theBits, sizeof(theValue));
+
+	return theValue;
+}
+
+static void GetVector(
+	const Byte	**aCursor,
+	Vector		*aVector)
+{
+	unsigned int	i;
+
+	for (i = 0; i < 4; i++)
+		aVector->v[i] = GetDouble(aCursor);
+}
+
+static void GetMatrix(
+	const Byte	**aCursor,
+	Matrix		*aMatrix)
+{
+	unsigned int	i,
+					j;
+
+	for (i = 0; i < 4; i++)
+		for (j = 0; j < 4; j++)
+			aMatrix->m[i][j] = GetDouble(aCursor);
+	aMatrix->itsParity = (GetUInt32(aCursor) != 0) ? ImageNegative : ImagePositive;
+	(void) GetUInt32(aCursor);	//	padding
+}
+
+static ErrorText MakeDirichletMesh(
+	const DirichletDomain	*aDirichletDomain,		//	input
+	double					anAperture,				//	input, in range [0.0, 1.0) (closed to almost open)
+	bool					aColorCodingFlag,		//	input
+	bool					aGreyscaleFlag,			//	input
+	DirichletVBOData		*someVertices,			//	output, itsDirichletNumMeshVertices entries
+	unsigned short			*someIndices,			//	output, 3 * itsDirichletNumMeshFaces entries
+	unsigned int			*someFaceFirstVertices,	//	output, itsNumFaces entries, may be NULL
+	unsigned int			*someFaceNumVertices)	//	output, itsNumFaces entries, may be NULL
+{
+	DirichletVBOData	*theVBOVertex;
+	unsigned short		*theVBOIndex,
+						theVBOVertexIndex;
+	double				theTextureMultiple;
+	HEVertex			*theVertices;
+	HEHalfEdge			*theHalfEdges;
+	HEFace				*theFace;
+	float				theColor[4];
+	Vector				*theFaceCenter;		//	normalized to the SpaceType
+	HEHalfEdge			*theHalfEdge,
+						*theNextHalfEdge;
+	bool				theParity;
+	Vector				*theNearOuterVertex,//	normalized to the SpaceType
+						theNearInnerVertex,	//	normalized to the SpaceType
+						*theFarOuterVertex,	//	normalized to the SpaceType
+						theFarInnerVertex;	//	normalized to the SpaceType
+	double				theBaseTex,
+						theAltitudeTex;
+	unsigned int		i;
+
+	//	Triangulate the Dirichlet domain's faces, each with a window
+	//	of the given aperture, into caller-provided arrays.
+	//	This is pure CPU work, so the OpenGL code and the exporters
+	//	may share it.  someFaceNumVertices may be non-NULL
+	//	only if someFaceFirstVertices is too.
+
+	//	The mesh gets indexed with unsigned shorts.
+	if (aDirichletDomain->itsDirichletNumMeshVertices > 0xFFFF)
+		return u"The Dirichlet domain has too many faces and edges to triangulate.";
+
+	theTextureMultiple = (aColorCodingFlag ? FACE_TEXTURE_MULTIPLE_PLAIN : FACE_TEXTURE_MULTIPLE_WOOD);
+	
+	//	Keep a running pointer to the vertex currently under construction,
+	//	and also keep track of its index in the array.  Keeping both these
+	//	things is redundant, yet nevertheless convenient.
+	theVBOVertex		= someVertices;
+	theVBOVertexIndex	= 0;
+	
+	//	Keep a running pointer to the current entry in the index buffer.
+	theVBOIndex = someIndices;
+
+	theVertices		= aDirichletDomain->itsVertices;
+	theHalfEdges	= aDirichletDomain->itsHalfEdges;
+
+	//	Process each face in turn, newest first.
+	for (i = aDirichletDomain->itsNumFaces; i-- > 0; )
+	{
+		theFace = &aDirichletDomain->itsFaces[i];
+
+		if (someFaceFirstVertices != NULL)
+			someFaceFirstVertices[i] = theVBOVertexIndex;
+
+		if (aColorCodingFlag && ! aGreyscaleFlag)
+		{
+			//	itsColorRGBA is already alpha-premultiplied
+			theColor[0] = (float) theFace->itsColorRGBA.r;
+			theColor[1] = (float) theFace->itsColorRGBA.g;
+			theColor[2] = (float) theFace->itsColorRGBA.b;
+			theColor[3] = (float) theFace->itsColorRGBA.a;
+		}
+		else
+		{
+			//	If the alpha component were less than 1.0,
+			//	we'd need to premultiply the RGB components by it.
+			theColor[0] = (float) theFace->itsColorGreyscale;
+			theColor[1] = (float) theFace->itsColorGreyscale;
+			theColor[2] = (float) theFace->itsColorGreyscale;
+			theColor[3] = (float) 1.0;
+		}
+
+		theFaceCenter = &theFace->itsNormalizedCenter;
+
+		//	After opening a window in the center of an n-sided face,
+		//	an annulus-like shape remains, which we triangulate
+		//	as n trapezoids, each with 4 vertices and 2 faces.
+		//
+		//	(An earlier version of this algorithm, archived 
+		//	in the file "2n+2 vertices per Dirichlet face.c",
+		//	used only 2n+2 vertices for the annulus,
+		//	but got the texturing right only for regular faces,
+		//	not irregular ones.  Furthermore it wasn't much faster.)
+		
+		//	Let the tangential texture coordinate run alternately
+		//	forwards and backwards, so the texture coordinates will
+		//	match up whenever possible.
+		theParity = false;
+
+		theHalfEdge = &theHalfEdges[theFace->itsHalfEdge];
+		do
+		{
+			theNextHalfEdge = &theHalfEdges[theHalfEdge->itsCycle];
+
+			//	Use outer vertices and face centers normalized to the SpaceType.
+			//
+			//	(Note:  This won't work if we later support vertices-at-infinity.
+			//	For vertices-at-infinity, we'd have to use raw positions.
+			//	For now let's stick with normalized vectors
+			//	to facilitate texturing.  See details below.)
+
+			theNearOuterVertex = &theVertices[theHalfEdge->itsTip].itsNormalizedPosition;
+			VectorInterpolate(	theFaceCenter,
+								theNearOuterVertex,
+								anAperture,
+								&theNearInnerVertex);
+			(void) VectorNormalize(&theNearInnerVertex, aDirichletDomain->itsSpaceType, &theNearInnerVertex);
+
+			theFarOuterVertex = &theVertices[theNextHalfEdge->itsTip].itsNormalizedPosition;
+			VectorInterpolate(	theFaceCenter,
+								theFarOuterVertex,
+								anAperture,
+								&theFarInnerVertex);
+			(void) VectorNormalize(&theFarInnerVertex, aDirichletDomain->itsSpaceType, &theFarInnerVertex);
+			
+			//	Convert the triangle's dimensions from physical units
+			//	to texture coordinate units.
+			theBaseTex		= theTextureMultiple * theNextHalfEdge->itsBase;
+			theAltitudeTex	= theTextureMultiple * theNextHalfEdge->itsAltitude;
+			
+			//	Get the proportions for the texturing exactly right 
+			//	in the flat, regular case and approximately right otherwise.
+			//
+			//	Note.  Perspectively correct texture mapping
+			//	is a real challenge in curved spaces.
+			//	In the flat case, we're mapping a trapezoidal portion
+			//	of a Dirichlet domain face onto a trapezoidal region
+			//	in the texture, and we're guaranteed success just so
+			//	we make sure the two trapezoids have the same shape
+			//	(otherwise the final texturing will kink along the trapezoid's
+			//	diagonal, where it splits into two triangles).
+			//	In the spherical and hyperbolic cases, however,
+			//	some residual distortion seems inevitable.
+			//	Vertices-at-infinity would further complicate matters.
+
+			//	near inner vertex
+			theVBOVertex->pos[0] = (float) theNearInnerVertex.v[0];
+			theVBOVertex->pos[1] = (float) theNearInnerVertex.v[1];
+			theVBOVertex->pos[2] = (float) theNearInnerVertex.v[2];
+			theVBOVertex->pos[3] = (float) theNearInnerVertex.v[3];
+			theVBOVertex->tex[0] = (float) ( theBaseTex * ( theParity ? 0.5 - 0.5*anAperture : 0.5 + 0.5*anAperture ) );
+			theVBOVertex->tex[1] = (float) ( theAltitudeTex * (1.0 - anAperture) );
+			theVBOVertex->col[0] = theColor[0];
+			theVBOVertex->col[1] = theColor[1];
+			theVBOVertex->col[2] = theColor[2];
+			theVBOVertex->col[3] = theColor[3];
+			theVBOVertex++;
+
+			//	near outer vertex
+			theVBOVertex->pos[0] = (float) theNearOuterVertex->v[0];
+			theVBOVertex->pos[1] = (float) theNearOuterVertex->v[1];
+			theVBOVertex->pos[2] = (float) theNearOuterVertex->v[2];
+			theVBOVertex->pos[3] = (float) theNearOuterVertex->v[3];
+			theVBOVertex->tex[0] = (float) ( theBaseTex * ( theParity ? 0.0 : 1.0 ) );
+			theVBOVertex->tex[1] = (float) 0.0;
+			theVBOVertex->col[0] = theColor[0];
+			theVBOVertex->col[1] = theColor[1];
+			theVBOVertex->col[2] = theColor[2];
+			theVBOVertex->col[3] = theColor[3];
+			theVBOVertex++;
+
+			//	far inner vertex
+			theVBOVertex->pos[0] = (float) theFarInnerVertex.v[0];
+			theVBOVertex->pos[1] = (float) theFarInnerVertex.v[1];
+			theVBOVertex->pos[2] = (float) theFarInnerVertex.v[2];
+			theVBOVertex->pos[3] = (float) theFarInnerVertex.v[3];
+			theVBOVertex->tex[0] = (float) ( theBaseTex * ( theParity ? 0.5 + 0.5*anAperture : 0.5 - 0.5*anAperture ) );
+			theVBOVertex->tex[1] = (float) ( theAltitudeTex * (1.0 - anAperture) );
+			theVBOVertex->col[0] = theColor[0];
+			theVBOVertex->col[1] = theColor[1];
+			theVBOVertex->col[2] = theColor[2];
+			theVBOVertex->col[3] = theColor[3];
+			theVBOVertex++;
+
+			//	far outer vertex
+			theVBOVertex->pos[0] = (float) theFarOuterVertex->v[0];
+			theVBOVertex->pos[1] = (float) theFarOuterVertex->v[1];
+			theVBOVertex->pos[2] = (float) theFarOuterVertex->v[2];
+			theVBOVertex->pos[3] = (float) theFarOuterVertex->v[3];
+			theVBOVertex->tex[0] = (float) ( theBaseTex * ( theParity ? 1.0 : 0.0 ) );
+			theVBOVertex->tex[1] = (float) 0.0;
+			theVBOVertex->col[0] = theColor[0];
+			theVBOVertex->col[1] = theColor[1];
+			theVBOVertex->col[2] = theColor[2];
+			theVBOVertex->col[3] = theColor[3];
+			theVBOVertex++;
+			
+			//	Create a pair of triangles.
+
+			*theVBOIndex++ = theVBOVertexIndex + 0;
+			*theVBOIndex++ = theVBOVertexIndex + 1;
+			*theVBOIndex++ = theVBOVertexIndex + 2;
+
+			*theVBOIndex++ = theVBOVertexIndex + 2;
+			*theVBOIndex++ = theVBOVertexIndex + 1;
+			*theVBOIndex++ = theVBOVertexIndex + 3;
+			
+			//	Update theVBOVertexIndex.
+			theVBOVertexIndex += 4;
+			
+			//	Let the tangential texture coordinate
+			//	run the other way next time.
+			theParity = ! theParity;
+			
+			//	Move on to the next HalfEdge.
+			theHalfEdge	= theNextHalfEdge;
+
+		} while (theHalfEdge != &theHalfEdges[theFace->itsHalfEdge]);
+
+		if (someFaceNumVertices != NULL)
+			someFaceNumVertices[i] = theVBOVertexIndex - someFaceFirstVertices[i];
+	}
+	
+	//	Did we write the correct number of entries into the arrays?
+	if ((unsigned int)(theVBOVertex - someVertices) != aDirichletDomain->itsDirichletNumMeshVertices
+	 || (unsigned int)(theVBOIndex  - someIndices ) != 3 * aDirichletDomain->itsDirichletNumMeshFaces
+	 || theVBOVertexIndex != aDirichletDomain->itsDirichletNumMeshVertices)
+	{
+		return u"Wrong number of array entries written in MakeDirichletMesh().";
+	}
+
+	return NULL;
+}
+
+
+ErrorText WriteDirichletMeshImage(
+	const DirichletDomain	*aDirichletDomain,	//	input
+	double					anAperture,			//	input, in range [0.0, 1.0)
+	bool					aColorCodingFlag,	//	input
+	bool					aGreyscaleFlag,		//	input
+	size_t					*aNumBytes,			//	output
+	Byte					**someBytes)		//	output, caller must FREE_MEMORY() it
+{
+	ErrorText			theErrorMessage			= NULL;
+	DirichletVBOData	*theMeshVertices		= NULL;
+	unsigned short		*theMeshIndices			= NULL;
+	unsigned int		*theFaceFirstVertices	= NULL,
+						*theFaceNumVertices		= NULL,
+						theNumFaces,
+						theNumMeshVertices,
+						theNumMeshIndices,
+						theFlags,
+						theMateFace,
+						i,
+						j;
+	Matrix				theFacePairing;
+	size_t				theNumBytes;
+	Byte				*theCursor;
+
+	//	Flatten the Dirichlet domain's mesh -- the same triangles
+	//	MakeDirichletVBO() would send to the GPU -- into a byte image
+	//	that other tools may memory-map and use directly.  The image stores
+	//
+	//		a header,
+	//		one record per Dirichlet face, giving its range of mesh
+	//			vertices and indices, its mate face and its face-pairing
+	//			matrix (whose parity says whether it reverses orientation),
+	//		the mesh vertices, each with a position (x,y,z,w) normalized
+	//			to the SpaceType, texture coordinates (u,v) and
+	//			a color (r,g,b,a), all as 32-bit floats, and
+	//		the mesh's triangles, as unsigned 16-bit vertex indices,
+	//			padded with zeros to a multiple of 8 bytes.
+	//
+	//	As in a space cache image, all numbers are little-endian.
+
+	if (*someBytes != NULL)
+		return u"WriteDirichletMeshImage() received a non-NULL output location.";
+
+	if (aDirichletDomain == NULL)
+		return u"WriteDirichletMeshImage() received a NULL Dirichlet domain.";
+
+	theErrorMessage = AllocateDirichletMesh(aDirichletDomain,
+											anAperture,
+											aColorCodingFlag,
+											aGreyscaleFlag,
+											&theMeshVertices,
+											&theMeshIndices,
+											&theFaceFirstVertices,
+											&theFaceNumVertices);
+	if (theErrorMessage != NULL)
+		goto CleanUpWriteDirichletMeshImage;
+
+	theNumFaces			= aDirichletDomain->itsNumFaces;
+	theNumMeshVertices	= aDirichletDomain->itsDirichletNumMeshVertices;
+	theNumMeshIndices	= 3 * aDirichletDomain->itsDirichletNumMeshFaces;
+
+	//	Allocate the image.
+	theNumBytes	= DIRICHLET_MESH_HEADER_BYTES
+				+ (size_t) theNumFaces        * DIRICHLET_MESH_FACE_BYTES
+				+ (size_t) theNumMeshVertices * DIRICHLET_MESH_VERTEX_BYTES
+				+ (((size_t) theNumMeshIndices * DIRICHLET_MESH_INDEX_BYTES + 7) & ~(size_t)7);
+	*someBytes = (Byte *) GET_MEMORY(theNumBytes);
+	if (*someBytes == NULL)
+	{
+		theErrorMessage = u"Couldn't allocate memory for the Dirichlet mesh image.";
+		goto CleanUpWriteDirichletMeshImage;
+	}
+	*aNumBytes	= theNumBytes;
+	theCursor	= *someBytes;
+
+	//	Header
+	theFlags = 0;
+	if (aColorCodingFlag)
+		theFlags |= DIRICHLET_MESH_FLAG_COLOR_CODING;
+	if (aGreyscaleFlag)
+		theFlags |= DIRICHLET_MESH_FLAG_GREYSCALE;
+	memcpy(theCursor, DIRICHLET_MESH_SIGNATURE, 8);
+	theCursor += 8;
+	PutUInt32(&theCursor, DIRICHLET_MESH_VERSION);
+	PutUInt32(&theCursor, (uint32_t) aDirichletDomain->itsSpaceType);
+	PutUInt32(&theCursor, theFlags);
+	PutUInt32(&theCursor, theNumFaces);
+	PutUInt32(&theCursor, theNumMeshVertices);
+	PutUInt32(&theCursor, theNumMeshIndices);
+	PutDouble(&theCursor, anAperture);
+	PutUInt32(&theCursor, 0);	//	reserved
+	PutUInt32(&theCursor, 0);	//	reserved
+
+	//	Faces
+	for (i = 0; i < theNumFaces; i++)
+	{
+		(void) GetDirichletFacePairing(aDirichletDomain, i, &theFacePairing, &theMateFace);
+
+		PutUInt32(&theCursor, theFaceFirstVertices[i]);
+		PutUInt32(&theCursor, theFaceNumVertices[i]);
+		PutUInt32(&theCursor, 3 * theFaceFirstVertices[i] / 2);	//	2 triangles per 4 vertices
+		PutUInt32(&theCursor, 3 * theFaceNumVertices[i]   / 2);
+		PutUInt32(&theCursor, theMateFace);
+		PutUInt32(&theCursor, 0);	//	padding
+		PutMatrix(&theCursor, &theFacePairing);
+	}
+
+	//	Mesh vertices
+	for (i = 0; i < theNumMeshVertices; i++)
+	{
+		for (j = 0; j < 4; j++)
+			PutFloat(&theCursor, theMeshVertices[i].pos[j]);
+		for (j = 0; j < 2; j++)
+			PutFloat(&theCursor, theMeshVertices[i].tex[j]);
+		for (j = 0; j < 4; j++)
+			PutFloat(&theCursor, theMeshVertices[i].col[j]);
+	}
+
+	//	Mesh indices, padded with zeros
+	for (i = 0; i < theNumMeshIndices; i++)
+	{
+		*theCursor++ = (Byte)(theMeshIndices[i]     );
+		*theCursor++ = (Byte)(theMeshIndices[i] >> 8);
+	}
+	while (theCursor < *someBytes + theNumBytes)
+		*theCursor++ = 0;
+
+	GEOMETRY_GAMES_ASSERT(	theCursor == *someBytes + theNumBytes,
+							"Dirichlet mesh image size doesn't match its contents");
+
+CleanUpWriteDirichletMeshImage:
+
+	FREE_MEMORY_SAFELY(theMeshVertices);
+	FREE_MEMORY_SAFELY(theMeshIndices);
+	FREE_MEMORY_SAFELY(theFaceFirstVertices);
+	FREE_MEMORY_SAFELY(theFaceNumVertices);
+
+	if (theErrorMessage != NULL)
+	{
+		FREE_MEMORY_SAFELY(*someBytes);
+		*aNumBytes = 0;
+	}
+
+	return theErrorMessage;
+}
+
+
+ErrorText WriteDirichletGLB(
+	const DirichletDomain	*aDirichletDomain,	//	input
+	double					anAperture,			//	input, in range [0.0, 1.0)
+	bool					aColorCodingFlag,	//	input
+	bool					aGreyscaleFlag,		//	input
+	size_t					*aNumBytes,			//	output
+	Byte					**someBytes)		//	output, caller must FREE_MEMORY() it
+{
+	ErrorText			theErrorMessage			= NULL;
+	DirichletVBOData	*theMeshVertices		= NULL;
+	unsigned short		*theMeshIndices			= NULL;
+	unsigned int		*theFaceFirstVertices	= NULL,
+						*theFaceNumVertices		= NULL,
+						theNumFaces,
+						theNumMeshVertices,
+						theNumMeshIndices,
+						theMateFace,
+						i,
+						j;
+	float				(*thePositions)[3]		= NULL,
+						theMin[3],
+						theMax[3],
+						theDenominator;
+	Matrix				theFacePairing;
+	char				*theJSON				= NULL;
+	size_t				theJSONBufferSize,
+						theJSONLength,
+						theJSONChunkBytes,
+						thePositionBytes,
+						theTexCoordBytes,
+						theColorBytes,
+						theIndexBytes,
+						theBinChunkBytes,
+						theNumBytes;
+	Byte				*theCursor;
+
+	//	Write the Dirichlet domain's mesh as a self-contained binary glTF 2.0
+	//	file (.glb), for viewers and modeling tools that know nothing
+	//	of curved spaces.  glTF wants 3D positions, so project
+	//	each normalized vertex (x,y,z,w) to
+	//
+	//		spherical:	(x,y,z)/(1 + w)	stereographic projection
+	//		flat:		(x,y,z)/w		(w = 1)
+	//		hyperbolic:	(x,y,z)/w		Klein model
+	//
+	//	The projective maps keep the faces flat.  A spherical domain
+	//	may reach the equator w = 0 (a lens space does), so it gets
+	//	the stereographic projection instead, which curves the faces
+	//	but stays finite everywhere except the antipode (0,0,0,-1).
+	//
+	//	Curved Spaces uses left-handed coordinates, while glTF's
+	//	are right-handed, so negate z.  That reflection also turns
+	//	the faces' clockwise-from-outside winding counterclockwise,
+	//	as glTF expects.
+	//
+	//	The mesh's "extras" list each Dirichlet face's mate face,
+	//	its face-pairing parity, and its range of triangle indices.
+
+	if (*someBytes != NULL)
+		return u"WriteDirichletGLB() received a non-NULL output location.";
+
+	if (aDirichletDomain == NULL)
+		return u"WriteDirichletGLB() received a NULL Dirichlet domain.";
+
+	theErrorMessage = AllocateDirichletMesh(aDirichletDomain,
+											anAperture,
+											aColorCodingFlag,
+											aGreyscaleFlag,
+											&theMeshVertices,
+											&theMeshIndices,
+											&theFaceFirstVertices,
+											&theFaceNumVertices);
+	if (theErrorMessage != NULL)
+		goto CleanUpWriteDirichletGLB;
+
+	theNumFaces			= aDirichletDomain->itsNumFaces;
+	theNumMeshVertices	= aDirichletDomain->itsDirichletNumMeshVertices;
+	theNumMeshIndices	= 3 * aDirichletDomain->itsDirichletNumMeshFaces;
+
+	//	Project the positions.
+	thePositions = (float (*)[3]) GET_MEMORY(theNumMeshVertices * sizeof(float [3]));
+	if (thePositions == NULL)
+	{
+		theErrorMessage = u"Couldn't allocate memory for projected positions in WriteDirichletGLB().";
+		goto CleanUpWriteDirichletGLB;
+	}
+	for (j = 0; j < 3; j++)
+	{
+		theMin[j] = +INFINITY;
+		theMax[j] = -INFINITY;
+	}
+	for (i = 0; i < theNumMeshVertices; i++)
+	{
+		if (aDirichletDomain->itsSpaceType == SpaceSpherical)
+			theDenominator = 1.0f + theMeshVertices[i].pos[3];
+		else
+			theDenominator = theMeshVertices[i].pos[3];
+
+		if ( ! (theDenominator > 0.0f) )
+		{
+			theErrorMessage = u"Couldn't project a Dirichlet domain vertex into 3D.";
+			goto CleanUpWriteDirichletGLB;
+		}
+
+		thePositions[i][0] =  theMeshVertices[i].pos[0] / theDenominator;
+		thePositions[i][1] =  theMeshVertices[i].pos[1] / theDenominator;
+		thePositions[i][2] = -theMeshVertices[i].pos[2] / theDenominator;
+
+		for (j = 0; j < 3; j++)
+		{
+			if (thePositions[i][j] < theMin[j])
+				theMin[j] = thePositions[i][j];
+			if (thePositions[i][j] > theMax[j])
+				theMax[j] = thePositions[i][j];
+		}
+	}
+
+	//	Lay out the binary chunk as four consecutive arrays,
+	//	one glTF buffer view each.
+	thePositionBytes	= (size_t) theNumMeshVertices * 3 * sizeof(float);
+	theTexCoordBytes	= (size_t) theNumMeshVertices * 2 * sizeof(float);
+	theColorBytes		= (size_t) theNumMeshVertices * 4 * sizeof(float);
+	theIndexBytes		= (size_t) theNumMeshIndices  * 2;
+	theBinChunkBytes	= (thePositionBytes + theTexCoordBytes + theColorBytes + theIndexBytes + 3) & ~(size_t)3;
+
+	//	Write the JSON text.
+	theJSONBufferSize	= GLTF_JSON_BASE_BYTES + (size_t) theNumFaces * GLTF_JSON_BYTES_PER_FACE;
+	theJSONLength		= 0;
+	theJSON = (char *) GET_MEMORY(theJSONBufferSize);
+	if (theJSON == NULL)
+	{
+		theErrorMessage = u"Couldn't allocate memory for the glTF text.";
+		goto CleanUpWriteDirichletGLB;
+	}
+
+	AppendJSON(theJSON, theJSONBufferSize, &theJSONLength,
+		"{\"asset\":{\"version\":\"2.0\",\"generator\":\"Curved Spaces\"},"
+		"\"scene\":0,\"scenes\":[{\"nodes\":[0]}],\"nodes\":[{\"mesh\":0}],"
+		"\"materials\":[{\"pbrMetallicRoughness\":{\"baseColorFactor\":[1,1,1,1],\"metallicFactor\":0,\"roughnessFactor\":1},\"doubleSided\":true}],"
+		"\"buffers\":[{\"byteLength\":%zu}],"
+		"\"bufferViews\":["
+			"{\"buffer\":0,\"byteOffset\":0,\"byteLength\":%zu,\"target\":34962},"
+			"{\"buffer\":0,\"byteOffset\":%zu,\"byteLength\":%zu,\"target\":34962},"
+			"{\"buffer\":0,\"byteOffset\":%zu,\"byteLength\":%zu,\"target\":34962},"
+			"{\"buffer\":0,\"byteOffset\":%zu,\"byteLength\":%zu,\"target\":34963}],"
+		"\"accessors\":["
+			"{\"bufferView\":0,\"componentType\":5126,\"count\":%u,\"type\":\"VEC3\",\"min\":[%.9g,%.9g,%.9g],\"max\":[%.9g,%.9g,%.9g]},"
+			"{\"bufferView\":1,\"componentType\":5126,\"count\":%u,\"type\":\"VEC2\"},"
+			"{\"bufferView\":2,\"componentType\":5126,\"count\":%u,\"type\":\"VEC4\"},"
+			"{\"bufferView\":3,\"componentType\":5123,\"count\":%u,\"type\":\"SCALAR\"}],"
+		"\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0,\"TEXCOORD_0\":1,\"COLOR_0\":2},\"indices\":3,\"material\":0}],"
+		"\"extras\":{\"spaceType\":\"%s\",\"projection\":\"%s\",\"faces\":[",
+		theBinChunkBytes,
+		thePositionBytes,
+		thePositionBytes, theTexCoordBytes,
+		thePositionBytes + theTexCoordBytes, theColorBytes,
+		thePositionBytes + theTexCoordBytes + theColorBytes, theIndexBytes,
+		theNumMeshVertices, theMin[0], theMin[1], theMin[2], theMax[0], theMax[1], theMax[2],
+		theNumMeshVertices,
+		theNumMeshVertices,
+		theNumMeshIndices,
+		aDirichletDomain->itsSpaceType == SpaceSpherical ? "spherical" :
+			(aDirichletDomain->itsSpaceType == SpaceFlat ? "flat" : "hyperbolic"),
+		aDirichletDomain->itsSpaceType == SpaceSpherical ? "stereographic" : "projective");
+
+	for (i = 0; i < theNumFaces; i++)
+	{
+		(void) GetDirichletFacePairing(aDirichletDomain, i, &theFacePairing, &theMateFace);
+
+		AppendJSON(theJSON, theJSONBufferSize, &theJSONLength,
+			"%s{\"mate\":%u,\"parity\":\"%s\",\"firstIndex\":%u,\"indexCount\":%u}",
+			i > 0 ? "," : "",
+			theMateFace,
+			theFacePairing.itsParity == ImageNegative ? "negative" : "positive",
+			3 * theFaceFirstVertices[i] / 2,
+			3 * theFaceNumVertices[i]   / 2);
+	}
+
+	AppendJSON(theJSON, theJSONBufferSize, &theJSONLength, "]}}]}");
+
+	if (theJSONLength >= theJSONBufferSize)
+	{
+		theErrorMessage = u"The glTF text overflowed its buffer.";
+		goto CleanUpWriteDirichletGLB;
+	}
+	theJSONChunkBytes = (theJSONLength + 3) & ~(size_t)3;
+
+	//	Allocate the file image.
+	theNumBytes = 12 + 8 + theJSONChunkBytes + 8 + theBinChunkBytes;
+	*someBytes = (Byte *) GET_MEMORY(theNumBytes);
+	if (*someBytes == NULL)
+	{
+		theErrorMessage = u"Couldn't allocate memory for the glTF image.";
+		goto CleanUpWriteDirichletGLB;
+	}
+	*aNumBytes	= theNumBytes;
+	theCursor	= *someBytes;
+
+	//	File header
+	PutUInt32(&theCursor, GLB_MAGIC);
+	PutUInt32(&theCursor, GLB_VERSION);
+	PutUInt32(&theCursor, (uint32_t) theNumBytes);
+
+	//	JSON chunk, padded with spaces
+	PutUInt32(&theCursor, (uint32_t) theJSONChunkBytes);
+	PutUInt32(&theCursor, GLB_CHUNK_TYPE_JSON);
+	memcpy(theCursor, theJSON, theJSONLength);
+	theCursor += theJSONLength;
+	for (i = (unsigned int) theJSONLength; i < theJSONChunkBytes; i++)
+		*theCursor++ = ' ';
+
+	//	Binary chunk, padded with zeros
+	PutUInt32(&theCursor, (uint32_t) theBinChunkBytes);
+	PutUInt32(&theCursor, GLB_CHUNK_TYPE_BIN);
+	for (i = 0; i < theNumMeshVertices; i++)
+		for (j = 0; j < 3; j++)
+			PutFloat(&theCursor, thePositions[i][j]);
+	for (i = 0; i < theNumMeshVertices; i++)
+		for (j = 0; j < 2; j++)
+			PutFloat(&theCursor, theMeshVertices[i].tex[j]);
+	for (i = 0; i < theNumMeshVertices; i++)
+		for (j = 0; j < 4; j++)
+			PutFloat(&theCursor, theMeshVertices[i].col[j]);
+	for (i = 0; i < theNumMeshIndices; i++)
+	{
+		*theCursor++ = (Byte)(theMeshIndices[i]     );
+		*theCursor++ = (Byte)(theMeshIndices[i] >> 8);
+	}
+	while (theCursor < *someBytes + theNumBytes)
+		*theCursor++ = 0;
+
+	GEOMETRY_GAMES_ASSERT(	theCursor == *someBytes + theNumBytes,
+							"glTF image size doesn't match its contents");
+
+CleanUpWriteDirichletGLB:
+
+	FREE_MEMORY_SAFELY(theMeshVertices);
+	FREE_MEMORY_SAFELY(theMeshIndices);
+	FREE_MEMORY_SAFELY(theFaceFirstVertices);
+	FREE_MEMORY_SAFELY(theFaceNumVertices);
+	FREE_MEMORY_SAFELY(thePositions);
+	FREE_MEMORY_SAFELY(theJSON);
+
+	if (theErrorMessage != NULL)
+	{
+		FREE_MEMORY_SAFELY(*someBytes);
+		*aNumBytes = 0;
+	}
+
+	return theErrorMessage;
+}
+
+
+static ErrorText AllocateDirichletMesh(
+	const DirichletDomain	*aDirichletDomain,		//	input
+	double					anAperture,				//	input
+	bool					aColorCodingFlag,		//	input
+	bool					aGreyscaleFlag,			//	input
+	DirichletVBOData		**someVertices,			//	output, caller must FREE_MEMORY() it
+	unsigned short			**someIndices,			//	output, caller must FREE_MEMORY() it
+	unsigned int			**someFaceFirstVertices,//	output, caller must FREE_MEMORY() it
+	unsigned int			**someFaceNumVertices)	//	output, caller must FREE_MEMORY() it
+{
+	ErrorText	theErrorMessage	= NULL;
+
+	if ( ! (anAperture >= 0.0 && anAperture < 1.0) )
+		return u"The Dirichlet mesh's aperture must be at least 0.0 and less than 1.0.";
+
+	//	GET_MEMORY(0) might legitimately return NULL,
+	//	so allocate at least one element of each array.
+	*someVertices			= (DirichletVBOData *) GET_MEMORY((aDirichletDomain->itsDirichletNumMeshVertices + 1) * sizeof(DirichletVBOData));
+	*someIndices			= ( unsigned short * ) GET_MEMORY((3 * aDirichletDomain->itsDirichletNumMeshFaces + 1) * sizeof(unsigned short));
+	*someFaceFirstVertices	= (  unsigned int *  ) GET_MEMORY((aDirichletDomain->itsNumFaces + 1) * sizeof(unsigned int));
+	*someFaceNumVertices	= (  unsigned int *  ) GET_MEMORY((aDirichletDomain->itsNumFaces + 1) * sizeof(unsigned int));
+	if (*someVertices			== NULL
+	 || *someIndices			== NULL
+	 || *someFaceFirstVertices	== NULL
+	 || *someFaceNumVertices	== NULL)
+	{
+		theErrorMessage = u"Couldn't get memory to construct the Dirichlet mesh.";
+		goto CleanUpAllocateDirichletMesh;
+	}
+
+	theErrorMessage = MakeDirichletMesh(aDirichletDomain,
+										anAperture,
+										aColorCodingFlag,
+										aGreyscaleFlag,
+										*someVertices,
+										*someIndices,
+										*someFaceFirstVertices,
+										*someFaceNumVertices);
 
-CleanUpAllocateHoneycomb:
+CleanUpAllocateDirichletMesh:
 
-	//	We reach this point iff some memory allocation call failed.
-	//	Free whatever memory may have been allocated.
-	//	Other pointers should all be NULL.
-	FreeHoneycomb(&theHoneycomb);
-	
-	//	Failure
-	return NULL;
+	if (theErrorMessage != NULL)
+	{
+		FREE_MEMORY_SAFELY(*someVertices);
+		FREE_MEMORY_SAFELY(*someIndices);
+		FREE_MEMORY_SAFELY(*someFaceFirstVertices);
+		FREE_MEMORY_SAFELY(*someFaceNumVertices);
+	}
+
+	return theErrorMessage;
 }
 
 
-void FreeHoneycomb(Honeycomb **aHoneycomb)
+static void AppendJSON(
+	char		*aBuffer,		//	input and output
+	size_t		aBufferSize,	//	input
+	size_t		*aLength,		//	input and output
+	const char	*aFormat,		//	input
+	...)
 {
-	unsigned int	i;
+	va_list	theArguments;
+	int		theCount;
 
-	if (aHoneycomb != NULL
-	 && *aHoneycomb != NULL)
+	//	Append formatted text to aBuffer.  On overflow, set *aLength
+	//	to aBufferSize, so that later calls do nothing
+	//	and the caller need check for overflow only once at the end.
+
+	if (*aLength >= aBufferSize)
+		return;
+
+	va_start(theArguments, aFormat);
+	theCount = vsnprintf(aBuffer + *aLength, aBufferSize - *aLength, aFormat, theArguments);
+	va_end(theArguments);
+
+	if (theCount < 0
+	 || (size_t) theCount >= aBufferSize - *aLength)
 	{
-		if ((*aHoneycomb)->itsCells != NULL)
-		{
-			for (i = 0; i < (*aHoneycomb)->itsNumCells; i++)
-				FREE_MEMORY_SAFELY((*aHoneycomb)->itsCells[i].itsVertices);
-			FREE_MEMORY_SAFELY((*aHoneycomb)->itsCells);
-		}
-		FREE_MEMORY_SAFELY((*aHoneycomb)->itsVisibleCells);
-		FREE_MEMORY_SAFELY(*aHoneycomb);
+		*aLength = aBufferSize;
 	}
+	else
+		*aLength += (size_t) theCount;
 }
 
 
 ErrorText MakeDirichletVBO(
-	GLuint			aVertexBufferName,
-	GLuint			anIndexBufferName,
-	DirichletDomain	*aDirichletDomain,
-	double			anAperture,	//	in range [0.0, 1.0] (closed to open)
-	bool			aColorCodingFlag,
-	bool			aGreyscaleFlag)
+	GLuint					aVertexBufferName,
+	GLuint					anIndexBufferName,
+	const DirichletDomain	*aDirichletDomain,
+	double					anAperture,			//	in range [0.0, 1.0] (closed to open)
+	bool					aColorCodingFlag,
+	bool					aGreyscaleFlag)
 {
+	ErrorText			theErrorMessage;
 	bool				theDirichletDomainIsPresentAndVisible;
-	DirichletVBOData	*theVBOVertices	= NULL,
-						*theVBOVertex;
-	unsigned short		*theVBOIndices	= NULL,
-						*theVBOIndex,
-						theVBOVertexIndex;
-	double				theTextureMultiple;
-	HEFace				*theFace;
-	float				theColor[4];
-	Vector				*theFaceCenter;		//	normalized to the SpaceType
-	HEHalfEdge			*theHalfEdge;
-	bool				theParity;
-	Vector				*theNearOuterVertex,//	normalized to the SpaceType
-						theNearInnerVertex,	//	normalized to the SpaceType
-						*theFarOuterVertex,	//	normalized to the SpaceType
-						theFarInnerVertex;	//	normalized to the SpaceType
-	double				theBaseTex,
-						theAltitudeTex;
+	DirichletVBOData	*theVBOVertices	= NULL;
+	unsigned short		*theVBOIndices	= NULL;
 
 	static const Byte	theDummyByte = 0x00;
 
@@ -1885,185 +5409,24 @@ ErrorText MakeDirichletVBO(
 		if (theVBOVertices == NULL
 		 || theVBOIndices  == NULL)
 		{
+			FREE_MEMORY_SAFELY(theVBOVertices);
+			FREE_MEMORY_SAFELY(theVBOIndices );
 			return u"MakeDirichletVAO() couldn't get memory to construct vertex data.";
 		}
 
-		theTextureMultiple = (aColorCodingFlag ? FACE_TEXTURE_MULTIPLE_PLAIN : FACE_TEXTURE_MULTIPLE_WOOD);
-		
-		//	Keep a running pointer to the vertex currently under construction,
-		//	and also keep track of its index in the array.  Keeping both these
-		//	things is redundant, yet nevertheless convenient.
-		theVBOVertex		= theVBOVertices;
-		theVBOVertexIndex	= 0;
-		
-		//	Keep a running pointer to the current entry in the index buffer.
-		theVBOIndex = theVBOIndices;
-
-		//	Process each face in turn.
-		for (	theFace = aDirichletDomain->itsFaceList;
-				theFace != NULL;
-				theFace = theFace->itsNext)
-		{
-			if (aColorCodingFlag && ! aGreyscaleFlag)
-			{
-				//	itsColorRGBA is already alpha-premultiplied
-				theColor[0] = (float) theFace->itsColorRGBA.r;
-				theColor[1] = (float) theFace->itsColorRGBA.g;
-				theColor[2] = (float) theFace->itsColorRGBA.b;
-				theColor[3] = (float) theFace->itsColorRGBA.a;
-			}
-			else
-			{
-				//	If the alpha component were less than 1.0,
-				//	we'd need to premultiply the RGB components by it.
-				theColor[0] = (float) theFace->itsColorGreyscale;
-				theColor[1] = (float) theFace->itsColorGreyscale;
-				theColor[2] = (float) theFace->itsColorGreyscale;
-				theColor[3] = (float) 1.0;
-			}
-
-			theFaceCenter = &theFace->itsNormalizedCenter;
-
-			//	After opening a window in the center of an n-sided face,
-			//	an annulus-like shape remains, which we triangulate
-			//	as n trapezoids, each with 4 vertices and 2 faces.
-			//
-			//	(An earlier version of this algorithm, archived 
-			//	in the file "2n+2 vertices per Dirichlet face.c",
-			//	used only 2n+2 vertices for the annulus,
-			//	but got the texturing right only for regular faces,
-			//	not irregular ones.  Furthermore it wasn't much faster.)
-			
-			//	Let the tangential texture coordinate run alternately
-			//	forwards and backwards, so the texture coordinates will
-			//	match up whenever possible.
-			theParity = false;
-
-			theHalfEdge = theFace->itsHalfEdge;
-			do
-			{
-				//	Use outer vertices and face centers normalized to the SpaceType.
-				//
-				//	(Note:  This won't work if we later support vertices-at-infinity.
-				//	For vertices-at-infinity, we'd have to use raw positions.
-				//	For now let's stick with normalized vectors
-				//	to facilitate texturing.  See details below.)
-
-				theNearOuterVertex = &theHalfEdge->itsTip->itsNormalizedPosition;
-				VectorInterpolate(	theFaceCenter,
-									theNearOuterVertex,
-									anAperture,
-									&theNearInnerVertex);
-				(void) VectorNormalize(&theNearInnerVertex, aDirichletDomain->itsSpaceType, &theNearInnerVertex);
-
-				theFarOuterVertex = &theHalfEdge->itsCycle->itsTip->itsNormalizedPosition;
-				VectorInterpolate(	theFaceCenter,
-									theFarOuterVertex,
-									anAperture,
-									&theFarInnerVertex);
-				(void) VectorNormalize(&theFarInnerVertex, aDirichletDomain->itsSpaceType, &theFarInnerVertex);
-				
-				//	Convert the triangle's dimensions from physical units
-				//	to texture coordinate units.
-				theBaseTex		= theTextureMultiple * theHalfEdge->itsCycle->itsBase;
-				theAltitudeTex	= theTextureMultiple * theHalfEdge->itsCycle->itsAltitude;
-				
-				//	Get the proportions for the texturing exactly right 
-				//	in the flat, regular case and approximately right otherwise.
-				//
-				//	Note.  Perspectively correct texture mapping
-				//	is a real challenge in curved spaces.
-				//	In the flat case, we're mapping a trapezoidal portion
-				//	of a Dirichlet domain face onto a trapezoidal region
-				//	in the texture, and we're guaranteed success just so
-				//	we make sure the two trapezoids have the same shape
-				//	(otherwise the final texturing will kink along the trapezoid's
-				//	diagonal, where it splits into two triangles).
-				//	In the spherical and hyperbolic cases, however,
-				//	some residual distortion seems inevitable.
-				//	Vertices-at-infinity would further complicate matters.
-
-				//	near inner vertex
-				theVBOVertex->pos[0] = (float) theNearInnerVertex.v[0];
-				theVBOVertex->pos[1] = (float) theNearInnerVertex.v[1];
-				theVBOVertex->pos[2] = (float) theNearInnerVertex.v[2];
-				theVBOVertex->pos[3] = (float) theNearInnerVertex.v[3];
-				theVBOVertex->tex[0] = (float) ( theBaseTex * ( theParity ? 0.5 - 0.5*anAperture : 0.5 + 0.5*anAperture ) );
-				theVBOVertex->tex[1] = (float) ( theAltitudeTex * (1.0 - anAperture) );
-				theVBOVertex->col[0] = theColor[0];
-				theVBOVertex->col[1] = theColor[1];
-				theVBOVertex->col[2] = theColor[2];
-				theVBOVertex->col[3] = theColor[3];
-				theVBOVertex++;
-
-				//	near outer vertex
-				theVBOVertex->pos[0] = (float) theNearOuterVertex->v[0];
-				theVBOVertex->pos[1] = (float) theNearOuterVertex->v[1];
-				theVBOVertex->pos[2] = (float) theNearOuterVertex->v[2];
-				theVBOVertex->pos[3] = (float) theNearOuterVertex->v[3];
-				theVBOVertex->tex[0] = (float) ( theBaseTex * ( theParity ? 0.0 : 1.0 ) );
-				theVBOVertex->tex[1] = (float) 0.0;
-				theVBOVertex->col[0] = theColor[0];
-				theVBOVertex->col[1] = theColor[1];
-				theVBOVertex->col[2] = theColor[2];
-				theVBOVertex->col[3] = theColor[3];
-				theVBOVertex++;
-
-				//	far inner vertex
-				theVBOVertex->pos[0] = (float) theFarInnerVertex.v[0];
-				theVBOVertex->pos[1] = (float) theFarInnerVertex.v[1];
-				theVBOVertex->pos[2] = (float) theFarInnerVertex.v[2];
-				theVBOVertex->pos[3] = (float) theFarInnerVertex.v[3];
-				theVBOVertex->tex[0] = (float) ( theBaseTex * ( theParity ? 0.5 + 0.5*anAperture : 0.5 - 0.5*anAperture ) );
-				theVBOVertex->tex[1] = (float) ( theAltitudeTex * (1.0 - anAperture) );
-				theVBOVertex->col[0] = theColor[0];
-				theVBOVertex->col[1] = theColor[1];
-				theVBOVertex->col[2] = theColor[2];
-				theVBOVertex->col[3] = theColor[3];
-				theVBOVertex++;
-
-				//	far outer vertex
-				theVBOVertex->pos[0] = (float) theFarOuterVertex->v[0];
-				theVBOVertex->pos[1] = (float) theFarOuterVertex->v[1];
-				theVBOVertex->pos[2] = (float) theFarOuterVertex->v[2];
-				theVBOVertex->pos[3] = (float) theFarOuterVertex->v[3];
-				theVBOVertex->tex[0] = (float) ( theBaseTex * ( theParity ? 1.0 : 0.0 ) );
-				theVBOVertex->tex[1] = (float) 0.0;
-				theVBOVertex->col[0] = theColor[0];
-				theVBOVertex->col[1] = theColor[1];
-				theVBOVertex->col[2] = theColor[2];
-				theVBOVertex->col[3] = theColor[3];
-				theVBOVertex++;
-				
-				//	Create a pair of triangles.
-
-				*theVBOIndex++ = theVBOVertexIndex + 0;
-				*theVBOIndex++ = theVBOVertexIndex + 1;
-				*theVBOIndex++ = theVBOVertexIndex + 2;
-
-				*theVBOIndex++ = theVBOVertexIndex + 2;
-				*theVBOIndex++ = theVBOVertexIndex + 1;
-				*theVBOIndex++ = theVBOVertexIndex + 3;
-				
-				//	Update theVBOVertexIndex.
-				theVBOVertexIndex += 4;
-				
-				//	Let the tangential texture coordinate
-				//	run the other way next time.
-				theParity = ! theParity;
-				
-				//	Move on to the next HalfEdge.
-				theHalfEdge	= theHalfEdge->itsCycle;
-
-			} while (theHalfEdge != theFace->itsHalfEdge);
-		}
-		
-		//	Did we write the correct number of entries into the arrays?
-		if ((unsigned int)(theVBOVertex - theVBOVertices) != aDirichletDomain->itsDirichletNumMeshVertices
-		 || (unsigned int)(theVBOIndex  - theVBOIndices ) != 3 * aDirichletDomain->itsDirichletNumMeshFaces
-		 || theVBOVertexIndex != aDirichletDomain->itsDirichletNumMeshVertices)
+		theErrorMessage = MakeDirichletMesh(aDirichletDomain,
+											anAperture,
+											aColorCodingFlag,
+											aGreyscaleFlag,
+											theVBOVertices,
+											theVBOIndices,
+											NULL,
+											NULL);
+		if (theErrorMessage != NULL)
 		{
-			return u"Wrong number of array entries written in MakeDirichletVAO().";
+			FREE_MEMORY_SAFELY(theVBOVertices);
+			FREE_MEMORY_SAFELY(theVBOIndices );
+			return theErrorMessage;
 		}
 	}
 
@@ -2144,11 +5507,11 @@ void BindDirichletVAO(
 }
 
 void DrawDirichletVAO(
-	GLuint			aDirichletTexture,
-	DirichletDomain	*aDirichletDomain,
-	Honeycomb		*aHoneycomb,
-	Matrix			*aWorldPlacement,	//	the world's placement in eye space
-	double			aCurrentAperture)
+	GLuint					aDirichletTexture,
+	const DirichletDomain	*aDirichletDomain,
+	Honeycomb				*aHoneycomb,
+	Matrix					*aWorldPlacement,	//	the world's placement in eye space
+	double					aCurrentAperture)
 {
 	unsigned int	i;
 	Matrix			*theDirichletPlacement;	//	the (translated) Dirichlet domain's placement in world space
@@ -2171,7 +5534,7 @@ void DrawDirichletVAO(
 	{
 		//	Each element of the tiling group defines
 		//	a placement of the Dirichlet domain in world space.
-		theDirichletPlacement = &aHoneycomb->itsVisibleCells[i]->itsMatrix;
+		theDirichletPlacement = aHoneycomb->itsVisibleCells[i]->itsMatrix;
 
 		//	Let front faces wind counterclockwise (resp. clockwise)
 		//	when the Dirichlet domain's placement in eye space preserves (resp. reverses) parity.
@@ -2192,18 +5555,20 @@ void DrawDirichletVAO(
 
 
 void MakeVertexFiguresVBO(
-	GLuint			aVertexBufferName,
-	GLuint			anIndexBufferName,
-	DirichletDomain	*aDirichletDomain)
+	GLuint					aVertexBufferName,
+	GLuint					anIndexBufferName,
+	const DirichletDomain	*aDirichletDomain)
 {
 	VertexFiguresVBOData	*theVBOVertices	= NULL,
 							*theVBOVertex;
 	unsigned short			*theVBOIndices	= NULL,
 							*theVBOIndex,
 							theVBOVertexIndex;
-	HEVertex				*theVertex;
-	HEHalfEdge				*theHalfEdge;
-	unsigned int			theCount;
+	HEHalfEdge				*theHalfEdges,
+							*theFirstHalfEdge,
+							*theHalfEdge;
+	unsigned int			theCount,
+							i;
 
 	static const Byte		theDummyByte = 0x00;
 
@@ -2223,16 +5588,18 @@ void MakeVertexFiguresVBO(
 		//	Keep a running pointer to the current entry in the index buffer.
 		theVBOIndex = theVBOIndices;
 
-		//	Process each vertex in turn.
-		for (	theVertex = aDirichletDomain->itsVertexList;
-				theVertex != NULL;
-				theVertex = theVertex->itsNext)
+		theHalfEdges = aDirichletDomain->itsHalfEdges;
+
+		//	Process each vertex in turn, newest first.
+		for (i = aDirichletDomain->itsNumVertices; i-- > 0; )
 		{
-			//	For a closed loop we'll want to process theVertex->itsOutboundHalfEdge twice,
+			theFirstHalfEdge = &theHalfEdges[aDirichletDomain->itsVertices[i].itsOutboundHalfEdge];
+
+			//	For a closed loop we'll want to process theFirstHalfEdge twice,
 			//	once at the beginning of the loop and then once again at the end.
-			for (	theHalfEdge = theVertex->itsOutboundHalfEdge, theCount = 0;
-					theHalfEdge != theVertex->itsOutboundHalfEdge->itsMate->itsCycle || theCount == 1;
-					theHalfEdge	= theHalfEdge->itsMate->itsCycle, theCount++)
+			for (	theHalfEdge = theFirstHalfEdge, theCount = 0;
+					theHalfEdge != &theHalfEdges[theHalfEdges[theFirstHalfEdge->itsMate].itsCycle] || theCount == 1;
+					theHalfEdge	= &theHalfEdges[theHalfEdges[theHalfEdge->itsMate].itsCycle], theCount++)
 			{
 				//	outer vertex
 				theVBOVertex->pos[0] = (float) theHalfEdge->itsOuterPoint.v[0];
@@ -2350,10 +5717,10 @@ void BindVertexFiguresVAO(
 }
 
 void DrawVertexFiguresVAO(
-	GLuint			aVertexFigureTexture,
-	DirichletDomain	*aDirichletDomain,
-	Honeycomb		*aHoneycomb,
-	Matrix			*aWorldPlacement)	//	the world's placement in eye space
+	GLuint					aVertexFigureTexture,
+	const DirichletDomain	*aDirichletDomain,
+	Honeycomb				*aHoneycomb,
+	Matrix					*aWorldPlacement)		//	the world's placement in eye space
 {
 	unsigned int	thePass,
 					i;
@@ -2394,7 +5761,7 @@ void DrawVertexFiguresVAO(
 		{
 			//	Each element of the tiling group defines
 			//	a placement of the Dirichlet domain in world space.
-			theDirichletPlacement = &aHoneycomb->itsVisibleCells[i]->itsMatrix;
+			theDirichletPlacement = aHoneycomb->itsVisibleCells[i]->itsMatrix;
 
 			//	Let front faces wind counterclockwise (resp. clockwise)
 			//	when the Dirichlet domain's placement in eye space preserves (resp. reverses) parity.
@@ -2424,41 +5791,521 @@ void SortVisibleCells(
 	Matrix		*aViewMatrix,			//	current modelview  matrix
 	double		aDrawingRadius)
 {
-	unsigned int	i;
+	unsigned int	theNumJobs,
+					theRoots[MAX_CULLING_ROOTS],
+					theNumRoots,
+					theNumKeptCells,
+					theNumNewCells,
+					i,
+					j;
+	double			theClipNorms[6],
+					theVertexTolerances[6];
+	CullingJob		theJobs[MAX_PARALLEL_JOBS];
+	void			*theJobPointers[MAX_PARALLEL_JOBS];
 
 	if (aHoneycomb != NULL)
 	{
-		//	Count the number of visible cells.
-		aHoneycomb->itsNumVisibleCells = 0;
+		//	From one frame to the next the observer moves only a tiny step,
+		//	so the visible cells and their order change very little.
+		//	Keep last frame's list, and let each cell remember the last frame
+		//	in which it was visible.  Should the frame count ever approach
+		//	overflow, start afresh.
+		if (aHoneycomb->itsFrameNumber >= 0xFFFFFFF0)
+		{
+			for (i = 0; i < aHoneycomb->itsNumCells; i++)
+				aHoneycomb->itsCells[i].itsVisibleFrame = 0;
+			aHoneycomb->itsFrameNumber		= 1;
+			aHoneycomb->itsNumVisibleCells	= 0;
+		}
+		aHoneycomb->itsFrameNumber++;
+
+		ComputeClipNorms(aHoneycomb->itsSpaceType, aViewProjectionMatrix, theClipNorms, theVertexTolerances);
+
+		//	Split the culling among several parallel jobs.
+		//	The cells' tests are independent of one another,
+		//	and each job touches only the cells in its own subtrees,
+		//	so the jobs never write to the same memory.
+		//	Nor do they allocate any memory, which would only slow them down.
+		//	With no hierarchy (which happens only if ExtendHoneycomb()
+		//	failed part way through) a single job tests every cell.
+		theNumJobs = GetNumProcessors();
+		if (theNumJobs > MAX_PARALLEL_JOBS)
+			theNumJobs = MAX_PARALLEL_JOBS;
+		if (theNumJobs > aHoneycomb->itsNumCells / MIN_CELLS_PER_CULLING_JOB)
+			theNumJobs = aHoneycomb->itsNumCells / MIN_CELLS_PER_CULLING_JOB;
+		if (theNumJobs < 1 || aHoneycomb->itsNodes == NULL)
+			theNumJobs = 1;
+
+		//	A single job starts from the hierarchy's root,
+		//	so that it may reject the largest possible subtrees.
+		theNumRoots = GatherCullingRoots(	aHoneycomb,
+											theNumJobs > 1 ? theNumJobs * CULLING_ROOTS_PER_JOB : 1,
+											theRoots);
+
+		for (i = 0; i < theNumJobs; i++)
+		{
+			theJobs[i].itsHoneycomb				= aHoneycomb;
+			theJobs[i].itsViewProjectionMatrix	= aViewProjectionMatrix;
+			theJobs[i].itsViewMatrix			= aViewMatrix;
+			theJobs[i].itsClipNorms				= theClipNorms;
+			theJobs[i].itsVertexTolerances		= theVertexTolerances;
+			theJobs[i].itsDrawingRadius			= aDrawingRadius;
+			theJobs[i].itsRoots					= theRoots;
+			theJobs[i].itsNumRoots				= theNumRoots;
+			theJobs[i].itsFirstRoot				= i;
+			theJobs[i].itsRootStride			= theNumJobs;
+			theJobs[i].itsNumNewCells			= 0;
+
+			//	A job can't find more newly visible cells
+			//	than there are cells in its subtrees.
+			if (i == 0)
+				theJobs[i].itsFirstNewCell = 0;
+			else
+			{
+				theJobs[i].itsFirstNewCell = theJobs[i - 1].itsFirstNewCell;
+				if (aHoneycomb->itsNodes != NULL)
+					for (j = i - 1; j < theNumRoots; j += theNumJobs)
+						theJobs[i].itsFirstNewCell += aHoneycomb->itsNodes[theRoots[j]].itsNumCells;
+			}
+
+			theJobPointers[i] = &theJobs[i];
+		}
+
+		RunJobsInParallel(theNumJobs, CullHoneycombSubtrees, theJobPointers);
+
+		//	Keep whichever of last frame's cells remain visible,
+		//	in last frame's order, and append each job's newly visible cells.
+		theNumKeptCells = 0;
+		for (i = 0; i < aHoneycomb->itsNumVisibleCells; i++)
+			if (aHoneycomb->itsVisibleCells[i]->itsVisibleFrame == aHoneycomb->itsFrameNumber)
+				aHoneycomb->itsVisibleCells[theNumKeptCells++] = aHoneycomb->itsVisibleCells[i];
+
+		theNumNewCells = 0;
+		for (i = 0; i < theNumJobs; i++)
+		{
+			memcpy(	&aHoneycomb->itsVisibleCells[theNumKeptCells + theNumNewCells],
+					&aHoneycomb->itsScratchCells[theJobs[i].itsFirstNewCell],
+					theJobs[i].itsNumNewCells * sizeof(Honeycell *));
+			theNumNewCells += theJobs[i].itsNumNewCells;
+		}
+
+		aHoneycomb->itsNumVisibleCells = theNumKeptCells + theNumNewCells;
+
+		//	Sort the visible cells in increasing distance
+		//	from the observer.  Last frame's order is nearly right,
+		//	so an insertion sort usually finishes in nearly linear time.
+		SortVisibleCellList(aHoneycomb->itsVisibleCells,
+							aHoneycomb->itsNumVisibleCells,
+							aHoneycomb->itsScratchCells);
+	}
+}
+
+
+static unsigned int GatherCullingRoots(
+	Honeycomb		*aHoneycomb,
+	unsigned int	aMinNumRoots,					//	at most MAX_CULLING_ROOTS / 2
+	unsigned int	someRoots[MAX_CULLING_ROOTS])	//	output
+{
+	unsigned int	theDepth,
+					theStack[HONEYCOMB_MAX_DEPTH],
+					theStackDepths[HONEYCOMB_MAX_DEPTH],
+					theStackSize,
+					theNode,
+					theNodeDepth,
+					theNumRoots;
+
+	//	Cut the hierarchy at the shallowest depth with at least aMinNumRoots
+	//	nodes (if the hierarchy reaches that deep), and return the nodes
+	//	at that depth, along with any shallower leaves, in depth-first order.
+	//	Together they cover each cell exactly once.
+
+	if (aHoneycomb->itsNodes == NULL)
+		return 0;
+
+	for (theDepth = 0; (1u << theDepth) < aMinNumRoots; theDepth++)
+		;
+
+	theNumRoots		= 0;
+	theStack[0]		= 0;
+	theStackDepths[0] = 0;
+	theStackSize	= 1;
+	while (theStackSize > 0)
+	{
+		theStackSize--;
+		theNode			= theStack[theStackSize];
+		theNodeDepth	= theStackDepths[theStackSize];
+
+		if (theNodeDepth == theDepth
+		 || aHoneycomb->itsNodes[theNode].itsSecondChild == 0)
+		{
+			someRoots[theNumRoots++] = theNode;
+		}
+		else
+		{
+			theStack[theStackSize]			= aHoneycomb->itsNodes[theNode].itsSecondChild;
+			theStackDepths[theStackSize]	= theNodeDepth + 1;
+			theStackSize++;
+			theStack[theStackSize]			= theNode + 1;
+			theStackDepths[theStackSize]	= theNodeDepth + 1;
+			theStackSize++;
+		}
+	}
+
+	return theNumRoots;
+}
+
+
+static void CullHoneycombSubtrees(void *aCullingJob)
+{
+	CullingJob		*theJob;
+	Honeycomb		*theHoneycomb;
+	unsigned int	i;
+
+	theJob			= (CullingJob *) aCullingJob;
+	theHoneycomb	= theJob->itsHoneycomb;
+
+	if (theHoneycomb->itsNodes == NULL)
+	{
+		for (i = 0; i < theHoneycomb->itsNumCells; i++)
+			AddCellIfVisible(theJob, &theHoneycomb->itsCells[i], false);
+	}
+	else
+	{
+		for (i = theJob->itsFirstRoot; i < theJob->itsNumRoots; i += theJob->itsRootStride)
+			CullHoneycombSubtree(theJob, theJob->itsRoots[i]);
+	}
+}
+
+
+static void CullHoneycombSubtree(
+	CullingJob		*aCullingJob,
+	unsigned int	aRoot)
+{
+	Honeycomb		*theHoneycomb;
+	unsigned int	theStack[HONEYCOMB_MAX_DEPTH],
+					theStackSize,
+					i;
+	bool			theStackInsideFlags[HONEYCOMB_MAX_DEPTH],
+					theNodeIsInside;
+	HoneycombNode	*theNode;
+	Vector			theNodeCenter;
+
+	static Vector	theBasepoint		= {{0.0, 0.0, 0.0, 1.0}};
+
+	//	Walk the bounding-ball hierarchy depth first,
+	//	skipping any subtree whose ball lies wholly beyond
+	//	the drawing radius or wholly outside the view frustum.
+	//	Once a ball lies wholly inside the view frustum,
+	//	its whole subtree needs no further frustum tests,
+	//	so only cells near the frustum's boundary get tested individually.
+	//	The stack never holds more than one entry per level,
+	//	plus one.
+
+	theHoneycomb = aCullingJob->itsHoneycomb;
+
+	theStack[0]				= aRoot;
+	theStackInsideFlags[0]	= false;
+	theStackSize			= 1;
+	while (theStackSize > 0)
+	{
+		theStackSize--;
+		theNode			= &theHoneycomb->itsNodes[theStack[theStackSize]];
+		theNodeIsInside	= theStackInsideFlags[theStackSize];
+
+		//	As in AddCellIfVisible(), test the distance first.
+		VectorTimesMatrix(&theNode->itsCenter, aCullingJob->itsViewMatrix, &theNodeCenter);
+		if (HoneycombDistance(theHoneycomb->itsSpaceType, &theBasepoint, &theNodeCenter)
+				- theNode->itsCenterRadius > aCullingJob->itsDrawingRadius)
+			continue;
+
+		//	A ball wholly outside a clipping plane contains cells
+		//	whose every vertex lies outside that same plane,
+		//	so CellMayBeVisible() would reject each cell anyhow.
+		//	A ball wholly inside all clipping planes contains cells
+		//	that CellMayBeVisible() would accept.
+		if ( ! theNodeIsInside )
+		{
+			switch (BallVersusFrustum(	&theNode->itsCenter,
+										theNode->itsClipMargin,
+										aCullingJob->itsViewProjectionMatrix,
+										aCullingJob->itsClipNorms))
+			{
+				case BallOutsideFrustum:	continue;
+				case BallStraddlesFrustum:	break;
+				case BallInsideFrustum:		theNodeIsInside = true;	break;
+			}
+		}
+
+		if (theNode->itsSecondChild == 0)	//	leaf
+		{
+			for (i = theNode->itsFirstCell; i < theNode->itsFirstCell + theNode->itsNumCells; i++)
+				AddCellIfVisible(	aCullingJob,
+									&theHoneycomb->itsCells[theHoneycomb->itsNodeCells[i]],
+									theNodeIsInside);
+		}
+		else
+		{
+			GEOMETRY_GAMES_ASSERT(	theStackSize + 2 <= HONEYCOMB_MAX_DEPTH,
+									"Honeycomb hierarchy is unexpectedly deep");
+			theStack[theStackSize]				= theNode->itsSecondChild;
+			theStackInsideFlags[theStackSize]	= theNodeIsInside;
+			theStackSize++;
+			theStack[theStackSize]				= (unsigned int)(theNode - theHoneycomb->itsNodes) + 1;
+			theStackInsideFlags[theStackSize]	= theNodeIsInside;
+			theStackSize++;
+		}
+	}
+}
+
+
+static void AddCellIfVisible(
+	CullingJob	*aCullingJob,
+	Honeycell	*aCell,
+	bool		aCellIsInsideFrustum)	//	already known to lie wholly inside the view frustum?
+{
+	Honeycomb	*theHoneycomb;
+
+	//	In the hyperbolic mirrored dodecahedron test case,
+	//	the frame rate almost doubles (on Carla) when we test
+	//	the distance before the visibility rather than
+	//	the other way around.
+
+	theHoneycomb = aCullingJob->itsHoneycomb;
 
-		//	In the hyperbolic mirrored dodecahedron test case,
-		//	the frame rate almost doubles (on Carla) when we test
-		//	the distance before the visibility rather than
-		//	the other way around.
-		for (i = 0; i < aHoneycomb->itsNumCells; i++)
+	aCell->itsDistance = CellCenterDistance(aCell, aCullingJob->itsViewMatrix);
+
+	if (aCell->itsDistance <= aCullingJob->itsDrawingRadius)
+	{
+		if (aCellIsInsideFrustum
+		 || CellMayBeVisible(aCullingJob, aCell))
 		{
-			aHoneycomb->itsCells[i].itsDistance
-				= CellCenterDistance(&aHoneycomb->itsCells[i], aViewMatrix);
+			//	A cell that was visible last frame is already in the list.
+			if (aCell->itsVisibleFrame != theHoneycomb->itsFrameNumber - 1)
+			{
+				theHoneycomb->itsScratchCells[aCullingJob->itsFirstNewCell + aCullingJob->itsNumNewCells] = aCell;
+				aCullingJob->itsNumNewCells++;
+			}
+
+			aCell->itsVisibleFrame = theHoneycomb->itsFrameNumber;
+		}
+	}
+}
+
+
+static void SortVisibleCellList(
+	Honeycell		**someCells,		//	input and output
+	unsigned int	aNumCells,
+	Honeycell		**aScratchBuffer)	//	room for at least aNumCells cells
+{
+	//	Run an insertion sort, which takes time proportional to
+	//	the number of cells plus the number of cells out of order.
+	//	If the order has changed a lot -- for example, because
+	//	the observer just passed through a face of the Dirichlet domain
+	//	and all the cells got new names -- give up, radix sort the cells
+	//	by approximate distance, and let a second insertion sort
+	//	finish the job.  Either way the result is the same, because
+	//	CompareCellCenterDistances() never reports a tie
+	//	between distinct cells.
+	if ( ! InsertionSortCells(someCells, aNumCells, true) )
+	{
+		RadixSortCells(someCells, aNumCells, aScratchBuffer);
+		(void) InsertionSortCells(someCells, aNumCells, false);
+	}
+}
+
+
+static bool InsertionSortCells(
+	Honeycell		**someCells,	//	input and output
+	unsigned int	aNumCells,
+	bool			aMayGiveUpFlag)	//	give up if the cells are far from sorted?
+{
+	unsigned int	theNumShifts,
+					i,
+					j;
+	Honeycell		*theCell;
 
-			if (aHoneycomb->itsCells[i].itsDistance <= aDrawingRadius)
+	theNumShifts = 0;
+
+	for (i = 1; i < aNumCells; i++)
+	{
+		theCell = someCells[i];
+
+		for (j = i; j > 0 && CompareCellCenterDistances(&someCells[j - 1], &theCell) > 0; j--)
+		{
+			//	If we give up, leave someCells a permutation of the original cells.
+			if (aMayGiveUpFlag
+			 && ++theNumShifts > MAX_VISIBLE_CELL_SHIFTS_PER_CELL * aNumCells)
 			{
-				if (CellMayBeVisible(&aHoneycomb->itsCells[i], aViewProjectionMatrix))
-					aHoneycomb->itsVisibleCells[aHoneycomb->itsNumVisibleCells++] = &aHoneycomb->itsCells[i];
+				someCells[j] = theCell;
+				return false;
 			}
+
+			someCells[j] = someCells[j - 1];
 		}
 
-		//	Sort the visible cells in increasing distance
-		//	from the observer.  The cells should be roughly sorted
-		//	to begin with (because they are sorted in order of
-		//	increasing distance from the basepoint (0,0,0,1))
-		//	so it makes little difference whether we use qsort()
-		//	or a bubble sort.  The important thing is that we're sorting
-		//	only the visible cells, not the whole honeycomb.
-		qsort(	aHoneycomb->itsVisibleCells,
-				aHoneycomb->itsNumVisibleCells,
-				sizeof(Honeycell *),
-				CompareCellCenterDistances);
+		someCells[j] = theCell;
+	}
+
+	return true;
+}
+
+
+static void RadixSortCells(
+	Honeycell		**someCells,		//	input and output
+	unsigned int	aNumCells,
+	Honeycell		**aScratchBuffer)	//	room for at least aNumCells cells
+{
+	unsigned int	theCounts[256],
+					thePass,
+					theSum,
+					theCount,
+					i;
+	Honeycell		**theSource,
+					**theDestination,
+					**theSwap;
+	union
+	{
+		float		itsFloat;
+		uint32_t	itsBits;
+	}				theKey;
+
+	//	Sort the cells by their distances rounded to single precision.
+	//	A non-negative float's bits, read as an unsigned integer,
+	//	increase with the float itself, so four stable counting sorts
+	//	on successive bytes, least significant first, sort the cells.
+	//	After an even number of passes the cells land back in someCells.
+	//	Only cells whose distances agree to single precision
+	//	may remain out of order, for InsertionSortCells() to fix.
+
+	theSource		= someCells;
+	theDestination	= aScratchBuffer;
+
+	for (thePass = 0; thePass < 4; thePass++)
+	{
+		for (i = 0; i < 256; i++)
+			theCounts[i] = 0;
+
+		for (i = 0; i < aNumCells; i++)
+		{
+			theKey.itsFloat = (float) theSource[i]->itsDistance;
+			theCounts[(theKey.itsBits >> (8 * thePass)) & 0xFF]++;
+		}
+
+		theSum = 0;
+		for (i = 0; i < 256; i++)
+		{
+			theCount		= theCounts[i];
+			theCounts[i]	= theSum;
+			theSum			+= theCount;
+		}
+
+		for (i = 0; i < aNumCells; i++)
+		{
+			theKey.itsFloat = (float) theSource[i]->itsDistance;
+			theDestination[theCounts[(theKey.itsBits >> (8 * thePass)) & 0xFF]++] = theSource[i];
+		}
+
+		theSwap			= theSource;
+		theSource		= theDestination;
+		theDestination	= theSwap;
+	}
+}
+
+
+static void ComputeClipNorms(
+	SpaceType	aSpaceType,
+	Matrix		*aViewProjectionMatrix,	//	composition of modelview and projection matrices
+	double		someClipNorms[6],		//	output
+	double		someVertexTolerances[6])	//	output
+{
+	unsigned int	i,
+					j,
+					k;
+	double			n[4],
+					theNormSquared;
+
+	//	CellMayBeVisible() excludes a vertex v with projected image v' = v M
+	//	when v'[3] + v'[j] < 0 or v'[3] - v'[j] < 0.  Each such inequality
+	//	reads v·n < 0, for n the sum or difference of columns 3 and j of M,
+	//	and so defines a halfspace whose boundary is a plane in the space.
+	//	Record the length of each normal vector n relative to the space's
+	//	geometry, so that v·n / |n| gives the sine of the distance from v
+	//	to the plane (spherical case), the distance itself (flat case)
+	//	or its sinh (hyperbolic case).  In the hyperbolic case
+	//	a plane with |n|² ≤ 0 misses hyperbolic space altogether,
+	//	so all points sit on the same side and a length of 0 works fine.
+	//
+	//	Also record how far beyond each plane CellMayBeVisible()
+	//	should let a float vertex image sit (see CELL_VERTEX_TOLERANCE).
+	//	The images have unit length in R⁴, whatever the geometry,
+	//	so here n's plain Euclidean length in R⁴ is the one that matters.
+	for (j = 0; j < 3; j++)
+	{
+		for (k = 0; k < 2; k++)
+		{
+			for (i = 0; i < 4; i++)
+				n[i] = aViewProjectionMatrix->m[i][3]
+					 + (k == 0 ? +1.0 : -1.0) * aViewProjectionMatrix->m[i][j];
+
+			theNormSquared = n[0]*n[0] + n[1]*n[1] + n[2]*n[2];
+			switch (aSpaceType)
+			{
+				case SpaceSpherical:	theNormSquared += n[3]*n[3];	break;
+				case SpaceFlat:									break;
+				case SpaceHyperbolic:	theNormSquared -= n[3]*n[3];	break;
+				default:										break;
+			}
+
+			someClipNorms[2*j + k] = (theNormSquared > 0.0) ? sqrt(theNormSquared) : 0.0;
+
+			someVertexTolerances[2*j + k] = CELL_VERTEX_TOLERANCE
+				* sqrt(n[0]*n[0] + n[1]*n[1] + n[2]*n[2] + n[3]*n[3]);
+		}
+	}
+}
+
+
+static BallVsFrustum BallVersusFrustum(
+	Vector			*aCenter,				//	normalized to the SpaceType
+	double			aClipMargin,			//	from ClipMargin()
+	Matrix			*aViewProjectionMatrix,	//	composition of modelview and projection matrices
+	const double	someClipNorms[6])		//	from ComputeClipNorms()
+{
+	Vector			theProjectedCenter;
+	double			theValue,
+					theThreshold;
+	bool			theBallIsInside;
+	unsigned int	j,
+					k;
+
+	//	A ball lies wholly on one side of a clipping plane iff its center
+	//	lies on that side by more than its radius (see ClipMargin()
+	//	and ComputeClipNorms()).
+
+	if (aClipMargin == INFINITY)
+		return BallStraddlesFrustum;
+
+	VectorTimesMatrix(aCenter, aViewProjectionMatrix, &theProjectedCenter);
+
+	theBallIsInside = true;
+
+	for (j = 0; j < 3; j++)
+	{
+		for (k = 0; k < 2; k++)
+		{
+			theValue		= theProjectedCenter.v[3]
+							+ (k == 0 ? +1.0 : -1.0) * theProjectedCenter.v[j];
+			theThreshold	= aClipMargin * someClipNorms[2*j + k];
+
+			if (theValue < - theThreshold)
+				return BallOutsideFrustum;
+
+			if (theValue <= + theThreshold)
+				theBallIsInside = false;
+		}
 	}
+
+	return theBallIsInside ? BallInsideFrustum : BallStraddlesFrustum;
 }
 
 
@@ -2477,23 +6324,43 @@ static double CellCenterDistance(
 
 
 static bool CellMayBeVisible(
-	Honeycell	*aCell,
-	Matrix		*aViewProjectionMatrix)	//	composition of modelview and projection matrices
+	CullingJob	*aCullingJob,
+	Honeycell	*aCell)
 {
+	Honeycomb		*theHoneycomb;
+	Matrix			*theMatrix;
+	const double	*theTolerances;
+	const float		*theVertex;
 	bool			thePosClipExcludesAllVertices[3],
 					theNegClipExcludesAllVertices[3],
 					theVertexIsVisible;
-	Vector			theProjectedVertex;
+	double			theProjectedVertex[4];
 	unsigned int	i,
 					j;
 
+	theHoneycomb	= aCullingJob->itsHoneycomb;
+	theMatrix		= aCullingJob->itsViewProjectionMatrix;
+	theTolerances	= aCullingJob->itsVertexTolerances;
+
 	//	Special case:  Treat a cell with no vertices,
 	//	which occurs for the 3-sphere, as visible.  
 	//	We'll need the 3-sphere to display Clifford parallels.
 	//	(Confession:  This is a hack.  I hope it causes no trouble.)
-	if (aCell->itsNumVertices == 0)
+	if (theHoneycomb->itsNumCellVertices == 0)
 		return true;
 
+	//	Most cells lie wholly inside the view frustum or wholly outside
+	//	some clipping plane.  A single test against the cell's bounding ball
+	//	settles those cases, and agrees with the vertex-by-vertex test below:
+	//	if the ball lies inside, so does the first vertex;
+	//	if it lies outside some plane, so do all the vertices.
+	switch (BallVersusFrustum(&aCell->itsCenter, aCell->itsClipMargin, theMatrix, aCullingJob->itsClipNorms))
+	{
+		case BallInsideFrustum:		return true;
+		case BallOutsideFrustum:	return false;
+		case BallStraddlesFrustum:	break;
+	}
+
 	//	Generic case:
 
 	for (j = 0; j < 3; j++)
@@ -2502,11 +6369,18 @@ static bool CellMayBeVisible(
 		theNegClipExcludesAllVertices[j] = true;
 	}
 
-	for (i = 0; i < aCell->itsNumVertices; i++)
+	//	The cell's vertex images sit side by side
+	//	in the honeycomb's shared array.
+	theVertex = &theHoneycomb->itsCellVertices[
+					4 * ((size_t)(aCell - theHoneycomb->itsCells) * theHoneycomb->itsNumCellVertices)];
+
+	for (i = 0; i < theHoneycomb->itsNumCellVertices; i++, theVertex += 4)
 	{
-		VectorTimesMatrix(	&aCell->itsVertices[i],
-							aViewProjectionMatrix,
-							&theProjectedVertex);
+		for (j = 0; j < 4; j++)
+			theProjectedVertex[j] = theVertex[0] * theMatrix->m[0][j]
+								  + theVertex[1] * theMatrix->m[1][j]
+								  + theVertex[2] * theMatrix->m[2][j]
+								  + theVertex[3] * theMatrix->m[3][j];
 
 		theVertexIsVisible = true;
 
@@ -2516,12 +6390,12 @@ static bool CellMayBeVisible(
 			//	so that the z < -w or z > +w hyperplanes
 			//	don't falsely exclude lens space images.
 
-			if (theProjectedVertex.v[j] < -theProjectedVertex.v[3])
+			if (theProjectedVertex[j] < -theProjectedVertex[3] - theTolerances[2*j + 0])
 				theVertexIsVisible = false;
 			else
 				theNegClipExcludesAllVertices[j] = false;
 
-			if (theProjectedVertex.v[j] > +theProjectedVertex.v[3])
+			if (theProjectedVertex[j] > +theProjectedVertex[3] + theTolerances[2*j + 1])
 				theVertexIsVisible = false;
 			else
 				thePosClipExcludesAllVertices[j] = false;
@@ -2563,5 +6437,13 @@ static __cdecl signed int CompareCellCenterDistances(
 	if (theDifference > 0.0)
 		return +1;
 
+	//	The bounding-ball hierarchy visits the cells in no special order,
+	//	so break ties by position in the honeycomb.
+	if (*((Honeycell **) p1) < *((Honeycell **) p2))
+		return -1;
+
+	if (*((Honeycell **) p1) > *((Honeycell **) p2))
+		return +1;
+
 	return 0;
 }
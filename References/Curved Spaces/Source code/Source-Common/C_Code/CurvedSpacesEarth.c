@@ -462,7 +462,7 @@ void DrawEarthVAO(
 	{
 		//	Each element of the tiling group defines
 		//	a placement of the Dirichlet domain in world space.
-		theDirichletPlacement = &aHoneycomb->itsVisibleCells[i]->itsMatrix;
+		theDirichletPlacement = aHoneycomb->itsVisibleCells[i]->itsMatrix;
 
 		//	In the spherical case, stick with the best level of detail
 		//	for the whole drawing, because the number of cells is typically
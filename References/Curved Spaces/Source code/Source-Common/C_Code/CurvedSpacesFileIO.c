@@ -10,6 +10,7 @@
 //	See TermsOfUse.txt
 
 #include "CurvedSpaces-Common.h"
+#include <string.h>	//	for memcpy()
 #ifdef HIGH_RESOLUTION_SCREENSHOT
 #include <math.h>
 #endif
@@ -26,13 +27,80 @@ typedef enum
 	HyperbolicSpaceSeifertWeber
 } HyperbolicSpaceType;
 
-
+//	LoadGenerators() tiles the space only out to a fraction
+//	of the full tiling radius before returning, so the user
+//	sees something right away.  A secondary thread then tiles
+//	the rest of the way in NUM_LOADING_STAGES further stages,
+//	publishing a deeper honeycomb at the end of each stage.
+//	The number of tiles grows rapidly with the radius,
+//	so the first stage takes only a small fraction of the total time.
+#define FIRST_STAGE_RADIUS_FRACTION		0.5
+#define NUM_LOADING_STAGES				4
+
+//	If the first stage's tiling isn't deep enough to determine
+//	the Dirichlet domain, deepen it by at least this much and try again.
+#define FIRST_STAGE_RADIUS_INCREMENT	0.5
+
+//	A space cache file's name is its key, as 16 hex digits,
+//	followed by SPACE_CACHE_EXTENSION.
+#define SPACE_CACHE_EXTENSION			u".cscache"
+#define SPACE_CACHE_PATH_BUFFER_LENGTH	(CACHE_DIRECTORY_BUFFER_LENGTH + 32)
+
+//	The main thread and the loading thread share the SpaceLoader.
+//	Whichever thread lets go of it last frees it.
+struct SpaceLoader
+{
+	//	The following fields are protected by itsLock.
+	MutexLock			*itsLock;
+	unsigned int		itsReferenceCount;
+	bool				itsCancelFlag,
+						itsFinishedFlag;
+	Honeycomb			*itsPublishedHoneycomb,		//	not yet adopted, or NULL
+						*itsSpareHoneycomb;			//	adopted and since replaced, or NULL
+
+	//	The following field belongs to the main thread alone,
+	//	which must wait for or detach the loading thread
+	//	before letting go of the SpaceLoader.
+	JoinableThread		*itsThread;
+
+	//	The following fields belong to the loading thread alone.
+	//	In particular, the loading thread holds its own reference
+	//	to md's Dirichlet domain, so the main thread may free
+	//	md->itsDirichletDomain whenever it likes.  The Dirichlet domain
+	//	never changes, so both threads may read it at once.
+	TilingInProgress	*itsTiling;
+	MatrixList			*itsElements;				//	all group elements found so far
+	DirichletDomain		*itsDirichletDomain;
+	double				itsFirstStageRadius,
+						itsFinalRadius;
+
+	//	Once the loading thread has tiled the full radius,
+	//	it writes a cache file, unless itsCachePathName is empty.
+	SpaceCacheInfo		itsCacheInfo;
+	Char16				itsCachePathName[SPACE_CACHE_PATH_BUFFER_LENGTH];
+};
+
+
+static ErrorText	ParseGeneratorFile(Byte *anInputText, MatrixList **aGeneratorList, HyperbolicSpaceType *aHyperbolicSpaceType);
 static bool			StringBeginsWith(Byte *anInputText, Byte *aPossibleBeginning);
 static void			RemoveComments(Byte *anInputText);
 static ErrorText	ReadMatrices(Byte *anInputText, MatrixList **aMatrixList);
 static bool			ReadOneNumber(Byte *aString, double *aValue, Byte **aStoppingPoint, ErrorText *anError);
 static ErrorText	LoadGenerators(ModelData *md, MatrixList *aGeneratorList, HyperbolicSpaceType aHyperbolicSpaceType);
 static ErrorText	DetectSpaceType(MatrixList *aGeneratorList, SpaceType *aSpaceType);
+static ErrorText	AppendMatrices(MatrixList **aMatrixList, MatrixList *someMoreMatrices);
+static ErrorText	AppendTileWords(TileWord **someWords, unsigned int aNumOldWords, TileWord *someMoreWords, unsigned int aNumMoreWords);
+static ErrorText	TileSpace(ModelData *md, MatrixList *aGeneratorList, uint64_t aCacheKey, const Char16 *aCachePathName);
+static ErrorText	TileUntilDirichletDomainIsComplete(TilingInProgress *aTiling, SpaceType aSpaceType, double aTilingRadius, double *aStageRadius, MatrixList **aHolonomyGroup, TileWord **someWords, DirichletDomain **aDirichletDomain, TilingStatistics *aStatistics);
+static ErrorText	StartSpaceLoader(ModelData *md, TilingInProgress **aTiling, MatrixList **someElements, double aFirstStageRadius, uint64_t aCacheKey, const Char16 *aCachePathName);
+static void			LoadRemainingStages(void *aSpaceLoader);
+static ErrorText	CatchUpHoneycomb(Honeycomb *aHoneycomb, MatrixList *someElements, const DirichletDomain *aDirichletDomain);
+static bool			SpaceLoaderWasCancelled(void *aSpaceLoader);
+static void			ReleaseSpaceLoader(SpaceLoader **aSpaceLoader);
+static uint64_t		SpaceCacheKey(MatrixList *aGeneratorList, double aTilingRadius);
+static bool			MakeCachePathName(const Char16 *aCacheDirectory, uint64_t aCacheKey, Char16 *aPathBuffer, unsigned int aPathBufferLength);
+static bool			LoadSpaceFromCache(ModelData *md, const Char16 *aCachePathName, uint64_t aCacheKey);
+static void			SaveSpaceToCache(const Char16 *aCachePathName, SpaceCacheInfo *aSpaceCacheInfo, DirichletDomain *aDirichletDomain, Honeycomb *aHoneycomb);
 
 
 ErrorText LoadGeneratorFile(
@@ -43,12 +111,134 @@ ErrorText LoadGeneratorFile(
 	HyperbolicSpaceType	theHyperbolicSpaceType;
 	MatrixList			*theGenerators	= NULL;
 
+	//	Parse the input text into 4×4 matrices.
+	theErrorMessage = ParseGeneratorFile(anInputText, &theGenerators, &theHyperbolicSpaceType);
+	if (theErrorMessage != NULL)
+		goto CleanUpLoadGeneratorFile;
+		
+	//	Load theGenerators.
+	theErrorMessage = LoadGenerators(md, theGenerators, theHyperbolicSpaceType);
+	if (theErrorMessage != NULL)
+		goto CleanUpLoadGeneratorFile;
+
+CleanUpLoadGeneratorFile:
+
+	FreeMatrixList(&theGenerators);
+
+	return theErrorMessage;
+}
+
+
+ErrorText ComputeDirichletDomainFromFile(
+	Byte				*anInputText,		//	input, zero-terminated, and hopefully UTF-8 or Latin-1;
+											//		gets overwritten
+	double				aMaxTilingRadius,	//	input, ignored for spherical spaces
+	SpaceType			*aSpaceType,		//	output
+	double				*aTilingRadius,		//	output, the radius that sufficed
+	DirichletDomain		**aDirichletDomain,	//	output, NULL for the 3-sphere or projective 3-space
+	MatrixList			**aHolonomyGroup,	//	output, may be NULL if not wanted
+	TileWord			**someWords,		//	output, may be NULL if not wanted;
+											//		indexed like *aHolonomyGroup
+	TilingStatistics	*aStatistics)		//	output, may be NULL if not wanted
+{
+	ErrorText			theErrorMessage	= NULL;
+	HyperbolicSpaceType	theHyperbolicSpaceType;
+	MatrixList			*theGenerators		= NULL,
+						*theHolonomyGroup	= NULL;
+	TileWord			*theWords			= NULL;
+	TilingInProgress	*theTiling			= NULL;
+
+	//	Compute the Dirichlet domain for a generator file,
+	//	with no ModelData, no honeycomb, no cache and no secondary thread,
+	//	for use by command-line tools that precompute fundamental domains.
+	//	Tile only as deeply as the Dirichlet domain requires,
+	//	but never beyond aMaxTilingRadius.
+	//
+	//	A caller that wants to construct further Dirichlet domains
+	//	-- for example at other basepoints -- may ask for the group elements
+	//	that determined this one, along with the word in the generators
+	//	that gives each group element.  A caller may also ask
+	//	how much work and memory the tiling took.
+	//
+	//	This function touches no shared state, so a caller
+	//	may run it for different files on different threads at once.
+
+	*aSpaceType		= SpaceNone;
+	*aTilingRadius	= 0.0;
+
+	if (*aDirichletDomain != NULL
+	 || (aHolonomyGroup != NULL && *aHolonomyGroup != NULL)
+	 || (someWords != NULL && *someWords != NULL))
+		return u"ComputeDirichletDomainFromFile() received a non-NULL output location.";
+
+	//	The words make sense only alongside the group elements they spell.
+	if (someWords != NULL && aHolonomyGroup == NULL)
+		return u"ComputeDirichletDomainFromFile() can report words only along with the holonomy group.";
+
+	theErrorMessage = ParseGeneratorFile(anInputText, &theGenerators, &theHyperbolicSpaceType);
+	if (theErrorMessage != NULL)
+		goto CleanUpComputeDirichletDomainFromFile;
+
+	theErrorMessage = DetectSpaceType(theGenerators, aSpaceType);
+	if (theErrorMessage != NULL)
+		goto CleanUpComputeDirichletDomainFromFile;
+
+	//	As in LoadGenerators(), any tiling radius greater than π
+	//	will suffice to tile all of S³.
+	if (*aSpaceType == SpaceSpherical)
+		aMaxTilingRadius = 3.15;
+
+	theErrorMessage = BeginTiling(theGenerators, *aSpaceType == SpaceHyperbolic, aStatistics != NULL, &theTiling);
+	if (theErrorMessage != NULL)
+		goto CleanUpComputeDirichletDomainFromFile;
+
+	theErrorMessage = TileUntilDirichletDomainIsComplete(	theTiling,
+															*aSpaceType,
+															aMaxTilingRadius,
+															aTilingRadius,
+															&theHolonomyGroup,
+															someWords != NULL ? &theWords : NULL,
+															aDirichletDomain,
+															aStatistics);
+	if (theErrorMessage != NULL)
+		goto CleanUpComputeDirichletDomainFromFile;
+
+	if (aHolonomyGroup != NULL)
+	{
+		*aHolonomyGroup		= theHolonomyGroup;
+		theHolonomyGroup	= NULL;
+	}
+	if (someWords != NULL)
+	{
+		*someWords	= theWords;
+		theWords	= NULL;
+	}
+
+CleanUpComputeDirichletDomainFromFile:
+
+	if (theErrorMessage != NULL)
+		FreeDirichletDomain(aDirichletDomain);
+
+	FreeTiling(&theTiling);
+	FreeMatrixList(&theHolonomyGroup);
+	FREE_MEMORY_SAFELY(theWords);
+	FreeMatrixList(&theGenerators);
+
+	return theErrorMessage;
+}
+
+
+static ErrorText ParseGeneratorFile(
+	Byte				*anInputText,			//	input, zero-terminated, and hopefully UTF-8 or Latin-1;
+												//		gets overwritten
+	MatrixList			**aGeneratorList,		//	output
+	HyperbolicSpaceType	*aHyperbolicSpaceType)	//	output
+{
 	//	Make sure we didn't get UTF-16 data by mistake.
 	if ((anInputText[0] == 0xFF && anInputText[1] == 0xFE)
 	 || (anInputText[0] == 0xFE && anInputText[1] == 0xFF))
 	{
-		theErrorMessage = u"The matrix file is in UTF-16 format.  Please convert to UTF-8.";
-		goto CleanUpLoadGeneratorFile;
+		return u"The matrix file is in UTF-16 format.  Please convert to UTF-8.";
 	}
 	
 	//	If a UTF-8 byte-order-mark is present, skip over it.
@@ -62,32 +252,19 @@ ErrorText LoadGeneratorFile(
 	//		#	Seifert-Weber Dodecahedral Space
 	//
 	if (StringBeginsWith(anInputText, (Byte *)"#	Mirrored Right-Angled Dodecahedron"))
-		theHyperbolicSpaceType = HyperbolicSpaceMirroredDodecahedron;
+		*aHyperbolicSpaceType = HyperbolicSpaceMirroredDodecahedron;
 	else
 	if (StringBeginsWith(anInputText, (Byte *)"#	Seifert-Weber Dodecahedral Space"))
-		theHyperbolicSpaceType = HyperbolicSpaceSeifertWeber;
+		*aHyperbolicSpaceType = HyperbolicSpaceSeifertWeber;
 	else
-		theHyperbolicSpaceType = HyperbolicSpaceGeneric;
+		*aHyperbolicSpaceType = HyperbolicSpaceGeneric;
 
 	//	Remove comments.
 	//	What remains should be plain 7-bit ASCII (common to both UTF-8 and Latin-1).
 	RemoveComments(anInputText);
 
 	//	Parse the input text into 4×4 matrices.
-	theErrorMessage = ReadMatrices(anInputText, &theGenerators);
-	if (theErrorMessage != NULL)
-		goto CleanUpLoadGeneratorFile;
-		
-	//	Load theGenerators.
-	theErrorMessage = LoadGenerators(md, theGenerators, theHyperbolicSpaceType);
-	if (theErrorMessage != NULL)
-		goto CleanUpLoadGeneratorFile;
-
-CleanUpLoadGeneratorFile:
-
-	FreeMatrixList(&theGenerators);
-
-	return theErrorMessage;
+	return ReadMatrices(anInputText, aGeneratorList);
 }
 
 static bool StringBeginsWith(
@@ -281,15 +458,18 @@ static ErrorText LoadGenerators(
 	HyperbolicSpaceType	aHyperbolicSpaceType)
 {
 	ErrorText	theErrorMessage		= NULL;
-	MatrixList	*theHolonomyGroup	= NULL;
+	uint64_t	theCacheKey;
+	Char16		theCachePathName[SPACE_CACHE_PATH_BUFFER_LENGTH];
 #ifdef HIGH_RESOLUTION_SCREENSHOT
 	Matrix		theRotation,
 				theTranslation;
 #endif
 
-	//	Delete any pre-existing Dirichlet domain and honeycomb,
+	//	Stop any loading thread that's still working on a previous space,
+	//	delete any pre-existing Dirichlet domain and honeycomb,
 	//	reset the user's placement and speed, and reset the centerpiece.
 	md->itsSpaceType = SpaceNone;
+	CancelSpaceLoader(&md->itsSpaceLoader, false);
 	FreeDirichletDomain(&md->itsDirichletDomain);
 	FreeHoneycomb(&md->itsHoneycomb);
 	MatrixIdentity(&md->itsUserPlacement);
@@ -400,38 +580,17 @@ static ErrorText LoadGenerators(
 			break;
 	}
 
-	//	Use the generators to construct the holonomy group
-	//	out to the desired tiling radius.
-	//	Assume the group is discrete and no element fixes the origin.
-	theErrorMessage = ConstructHolonomyGroup(	aGeneratorList,
-												md->itsTilingRadius,
-												&theHolonomyGroup);
-	if (theErrorMessage != NULL)
-		goto CleanUpLoadGenerators;
-
-	//	In the case of a spherical space, we'll want to draw the back hemisphere
-	//	if and only if the holonomy group does not contain the antipodal matrix.
-	theErrorMessage = NeedsBackHemisphere(theHolonomyGroup, md->itsSpaceType, &md->itsDrawBackHemisphere);
-	if (theErrorMessage != NULL)
-		goto CleanUpLoadGenerators;
-	
-	//	The space is a 3-sphere iff theHolonomyGroup 
-	//	contains the identity matrix alone.
-	md->itsThreeSphereFlag = (theHolonomyGroup->itsNumMatrices == 1);
-
-	//	Use the holonomy group to construct a Dirichlet domain.
-	theErrorMessage = ConstructDirichletDomain(	theHolonomyGroup,
-												&md->itsDirichletDomain);
-	if (theErrorMessage != NULL)
-		goto CleanUpLoadGenerators;
-
-	//	Use the holonomy group and the Dirichlet domain
-	//	to construct a honeycomb.
-	theErrorMessage = ConstructHoneycomb(	theHolonomyGroup,
-											md->itsDirichletDomain,
-											&md->itsHoneycomb);
-	if (theErrorMessage != NULL)
-		goto CleanUpLoadGenerators;
+	//	If we've computed this space before, read it from the cache.
+	//	Otherwise compute it from scratch.
+	theCacheKey = SpaceCacheKey(aGeneratorList, md->itsTilingRadius);
+	if ( ! MakeCachePathName(md->itsCacheDirectory, theCacheKey, theCachePathName, BUFFER_LENGTH(theCachePathName)) )
+		theCachePathName[0] = 0;	//	disable the cache
+	if ( ! LoadSpaceFromCache(md, theCachePathName, theCacheKey) )
+	{
+		theErrorMessage = TileSpace(md, aGeneratorList, theCacheKey, theCachePathName);
+		if (theErrorMessage != NULL)
+			goto CleanUpLoadGenerators;
+	}
 
 #ifdef CENTERPIECE_DISPLACEMENT
 	//	For ad hoc convenience in the Shape of Space lecture,
@@ -478,12 +637,573 @@ CleanUpLoadGenerators:
 
 	md->itsRedrawRequestFlag = true;
 
+	return theErrorMessage;
+}
+
+
+static ErrorText TileSpace(
+	ModelData		*md,
+	MatrixList		*aGeneratorList,
+	uint64_t		aCacheKey,
+	const Char16	*aCachePathName)	//	empty string if cache is disabled
+{
+	ErrorText			theErrorMessage		= NULL;
+	TilingInProgress	*theTiling			= NULL;
+	MatrixList			*theHolonomyGroup	= NULL;
+	double				theStageRadius;
+	SpaceCacheInfo		theCacheInfo;
+
+	//	Compute md's Dirichlet domain and honeycomb from scratch.
+	//	LoadGenerators() has already set the space type and the radii,
+	//	and will free md's Dirichlet domain and honeycomb
+	//	if an error occurs.
+
+	//	Use the generators to construct the holonomy group,
+	//	at first only out to a fraction of the desired tiling radius.
+	//	Assume the group is discrete and no element fixes the origin.
+	//
+	//	In the hyperbolic case, re-orthonormalize each new group element
+	//	to keep numerical error from accumulating in the deeper tiles.
+	theErrorMessage = BeginTiling(aGeneratorList, md->itsSpaceType == SpaceHyperbolic, false, &theTiling);
+	if (theErrorMessage != NULL)
+		goto CleanUpTileSpace;
+
+	//	Tile out only as far as needed to determine the Dirichlet domain.
+	theErrorMessage = TileUntilDirichletDomainIsComplete(	theTiling,
+															md->itsSpaceType,
+															md->itsTilingRadius,
+															&theStageRadius,
+															&theHolonomyGroup,
+															NULL,
+															&md->itsDirichletDomain,
+															NULL);
+	if (theErrorMessage != NULL)
+		goto CleanUpTileSpace;
+
+	//	In the case of a spherical space, we'll want to draw the back hemisphere
+	//	if and only if the holonomy group does not contain the antipodal matrix.
+	//	Spherical spaces always get tiled completely in the first stage.
+	theErrorMessage = NeedsBackHemisphere(theHolonomyGroup, md->itsSpaceType, &md->itsDrawBackHemisphere);
+	if (theErrorMessage != NULL)
+		goto CleanUpTileSpace;
+	
+	//	The space is a 3-sphere iff theHolonomyGroup 
+	//	contains the identity matrix alone.
+	md->itsThreeSphereFlag = (theHolonomyGroup->itsNumMatrices == 1);
+
+	//	Use the holonomy group and the Dirichlet domain
+	//	to construct a honeycomb.
+	theErrorMessage = ConstructHoneycomb(	theHolonomyGroup,
+											md->itsDirichletDomain,
+											&md->itsHoneycomb);
+	if (theErrorMessage != NULL)
+		goto CleanUpTileSpace;
+
+	//	If the first stage already reached the full tiling radius,
+	//	the space is complete, so cache it right away.
+	//	Otherwise let a secondary thread take over theTiling,
+	//	finish the job and cache the completed space.
+	if (theStageRadius < md->itsTilingRadius)
+	{
+		theErrorMessage = StartSpaceLoader(md, &theTiling, &theHolonomyGroup, theStageRadius, aCacheKey, aCachePathName);
+		if (theErrorMessage != NULL)
+			goto CleanUpTileSpace;
+	}
+	else
+	{
+		theCacheInfo.itsKey					= aCacheKey;
+		theCacheInfo.itsSpaceType			= md->itsSpaceType;
+		theCacheInfo.itsDrawBackHemisphere	= md->itsDrawBackHemisphere;
+		theCacheInfo.itsThreeSphereFlag		= md->itsThreeSphereFlag;
+		SaveSpaceToCache(aCachePathName, &theCacheInfo, md->itsDirichletDomain, md->itsHoneycomb);
+	}
+
+CleanUpTileSpace:
+
+	FreeTiling(&theTiling);
 	FreeMatrixList(&theHolonomyGroup);
 
 	return theErrorMessage;
 }
 
 
+static ErrorText TileUntilDirichletDomainIsComplete(
+	TilingInProgress	*aTiling,			//	input and output
+	SpaceType			aSpaceType,			//	input
+	double				aTilingRadius,		//	input, the most we're willing to tile
+	double				*aStageRadius,		//	output, the radius we actually tiled
+	MatrixList			**aHolonomyGroup,	//	input and output, all group elements found so far
+	TileWord			**someWords,		//	optional input and output (may be NULL),
+											//		all words found so far
+	DirichletDomain		**aDirichletDomain,	//	output
+	TilingStatistics	*aStatistics)		//	optional output (may be NULL)
+{
+	ErrorText		theErrorMessage	= NULL;
+	MatrixList		*theNewElements	= NULL;
+	TileWord		*theNewWords	= NULL;
+	unsigned int	theNumOldElements;
+	double			theStageRadius	= 0.0,
+					theCircumradius;
+
+	//	Extend aTiling in stages, reconstructing the Dirichlet domain
+	//	after each stage, until the tiling is deep enough
+	//	to determine the Dirichlet domain or reaches aTilingRadius,
+	//	whichever comes first.
+
+	//	A spherical group is finite, so rather than tiling S³
+	//	out to some radius, enumerate the group's Cayley table.
+	//	The first ExtendTiling() will then report the whole group.
+	if (aSpaceType == SpaceSpherical)
+	{
+		theErrorMessage = CompleteFiniteTiling(aTiling);
+		if (theErrorMessage != NULL)
+			goto CleanUpTileUntilDirichletDomainIsComplete;
+	}
+
+	//	In the spherical case the tiling is already complete,
+	//	so go straight to the full tiling radius.
+	theStageRadius = (aSpaceType == SpaceSpherical) ?
+						aTilingRadius :
+						FIRST_STAGE_RADIUS_FRACTION * aTilingRadius;
+
+	while (true)
+	{
+		theErrorMessage = ExtendTiling(	aTiling,
+										theStageRadius,
+										&theNewElements,
+										someWords != NULL ? &theNewWords : NULL,
+										aStatistics,
+										NULL);
+		if (theErrorMessage != NULL)
+			goto CleanUpTileUntilDirichletDomainIsComplete;
+		theNumOldElements = (*aHolonomyGroup != NULL) ? (*aHolonomyGroup)->itsNumMatrices : 0;
+		if (someWords != NULL)
+		{
+			theErrorMessage = AppendTileWords(someWords, theNumOldElements, theNewWords, theNewElements->itsNumMatrices);
+			FREE_MEMORY_SAFELY(theNewWords);
+			if (theErrorMessage != NULL)
+				goto CleanUpTileUntilDirichletDomainIsComplete;
+		}
+		theErrorMessage = AppendMatrices(aHolonomyGroup, theNewElements);
+		FreeMatrixList(&theNewElements);
+		if (theErrorMessage != NULL)
+			goto CleanUpTileUntilDirichletDomainIsComplete;
+
+		//	Use the holonomy group to construct a Dirichlet domain.
+		FreeDirichletDomain(aDirichletDomain);
+		theErrorMessage = ConstructDirichletDomain(	*aHolonomyGroup,
+													aDirichletDomain);
+
+		//	At the full tiling radius, the Dirichlet domain is
+		//	whatever it is, and any error is real.
+		if (theStageRadius >= aTilingRadius)
+		{
+			if (theErrorMessage != NULL)
+				goto CleanUpTileUntilDirichletDomainIsComplete;
+			break;
+		}
+
+		//	At a partial tiling radius, the group elements found so far
+		//	may be too few to bound the Dirichlet domain, in which case
+		//	ConstructDirichletDomain() fails.  If it succeeds,
+		//	the domain is complete only if the tiling reaches
+		//	at least twice its circumradius.
+		if (theErrorMessage == NULL)
+		{
+			theCircumradius = DirichletDomainCircumradius(*aDirichletDomain);
+			if (2.0 * theCircumradius <= theStageRadius)
+				break;
+		}
+		else
+		{
+			theErrorMessage	= NULL;
+			theCircumradius	= 0.0;
+		}
+		theStageRadius += FIRST_STAGE_RADIUS_INCREMENT;
+		if (theStageRadius < 2.0 * theCircumradius)
+			theStageRadius = 2.0 * theCircumradius;
+		if (theStageRadius > aTilingRadius)
+			theStageRadius = aTilingRadius;
+	}
+
+CleanUpTileUntilDirichletDomainIsComplete:
+
+	*aStageRadius = theStageRadius;
+
+	FreeMatrixList(&theNewElements);
+	FREE_MEMORY_SAFELY(theNewWords);
+
+	return theErrorMessage;
+}
+
+
+static ErrorText StartSpaceLoader(
+	ModelData			*md,
+	TilingInProgress	**aTiling,				//	input, taken over on success
+	MatrixList			**someElements,			//	input, taken over on success
+	double				aFirstStageRadius,
+	uint64_t			aCacheKey,
+	const Char16		*aCachePathName)		//	empty string if cache is disabled
+{
+	ErrorText	theErrorMessage	= NULL;
+	SpaceLoader	*theSpaceLoader	= NULL;
+
+	//	Launch a secondary thread to tile the rest of the way
+	//	from aFirstStageRadius out to md->itsTilingRadius.
+	//	The secondary thread never touches md.  Instead,
+	//	the main thread calls AdoptLoadedSpace() once per frame
+	//	to collect whatever the secondary thread has published.
+
+	theSpaceLoader = (SpaceLoader *) GET_MEMORY(sizeof(SpaceLoader));
+	if (theSpaceLoader == NULL)
+	{
+		theErrorMessage = u"Couldn't allocate memory for the SpaceLoader.";
+		goto CleanUpStartSpaceLoader;
+	}
+	theSpaceLoader->itsLock					= NULL;
+	theSpaceLoader->itsReferenceCount		= 2;	//	main thread and loading thread
+	theSpaceLoader->itsCancelFlag			= false;
+	theSpaceLoader->itsFinishedFlag			= false;
+	theSpaceLoader->itsPublishedHoneycomb	= NULL;
+	theSpaceLoader->itsSpareHoneycomb		= NULL;
+	theSpaceLoader->itsThread				= NULL;
+	theSpaceLoader->itsTiling				= NULL;
+	theSpaceLoader->itsElements				= NULL;
+	theSpaceLoader->itsDirichletDomain		= NULL;
+	theSpaceLoader->itsFirstStageRadius		= aFirstStageRadius;
+	theSpaceLoader->itsFinalRadius			= md->itsTilingRadius;
+	theSpaceLoader->itsCacheInfo.itsKey					= aCacheKey;
+	theSpaceLoader->itsCacheInfo.itsSpaceType			= md->itsSpaceType;
+	theSpaceLoader->itsCacheInfo.itsDrawBackHemisphere	= md->itsDrawBackHemisphere;
+	theSpaceLoader->itsCacheInfo.itsThreeSphereFlag		= md->itsThreeSphereFlag;
+	if ( ! Strcpy16(theSpaceLoader->itsCachePathName, BUFFER_LENGTH(theSpaceLoader->itsCachePathName), aCachePathName) )
+		theSpaceLoader->itsCachePathName[0] = 0;
+
+	theSpaceLoader->itsLock = CreateMutexLock();
+	if (theSpaceLoader->itsLock == NULL)
+	{
+		theErrorMessage = u"Couldn't create a MutexLock for the SpaceLoader.";
+		goto CleanUpStartSpaceLoader;
+	}
+
+	//	Share md's Dirichlet domain with the loading thread.
+	//	The reference count spares the two threads from having
+	//	to coordinate the lifetime of md->itsDirichletDomain.
+	theSpaceLoader->itsDirichletDomain = RetainDirichletDomain(md->itsDirichletDomain);
+
+	//	Everything's ready, so take over the tiling and the group elements.
+	theSpaceLoader->itsTiling	= *aTiling;
+	theSpaceLoader->itsElements	= *someElements;
+	*aTiling					= NULL;
+	*someElements				= NULL;
+
+	theErrorMessage = StartNewThreadWithData(LoadRemainingStages, theSpaceLoader, &theSpaceLoader->itsThread);
+	if (theErrorMessage != NULL)
+	{
+		//	No loading thread holds the SpaceLoader,
+		//	so give the tiling and the group elements back to the caller,
+		//	which will free them, and free the SpaceLoader below.
+		*aTiling					= theSpaceLoader->itsTiling;
+		*someElements				= theSpaceLoader->itsElements;
+		theSpaceLoader->itsTiling	= NULL;
+		theSpaceLoader->itsElements	= NULL;
+		goto CleanUpStartSpaceLoader;
+	}
+
+	md->itsSpaceLoader	= theSpaceLoader;
+	theSpaceLoader		= NULL;
+
+CleanUpStartSpaceLoader:
+
+	if (theSpaceLoader != NULL)
+	{
+		FreeDirichletDomain(&theSpaceLoader->itsDirichletDomain);
+		FreeMutexLock(&theSpaceLoader->itsLock);
+		FREE_MEMORY(theSpaceLoader);
+	}
+
+	return theErrorMessage;
+}
+
+
+static void LoadRemainingStages(
+	void	*aSpaceLoader)
+{
+	SpaceLoader		*theSpaceLoader		= (SpaceLoader *) aSpaceLoader;
+	ErrorText		theErrorMessage		= NULL;
+	MatrixList		*theNewElements		= NULL;
+	Honeycomb		*theHoneycomb		= NULL;
+	bool			theCancelFlag		= false;
+	unsigned int	theStage;
+	double			theStageRadius;
+	CancelTest		theCancelTest;
+
+	//	Runs on the loading thread.
+	//
+	//	Extend the tiling one stage at a time.  At the end of each stage
+	//	publish a honeycomb containing all the group elements found so far.
+	//	The main thread may be drawing the previous stage's honeycomb,
+	//	so we can't extend that one.  Instead we bring a spare honeycomb
+	//	up to date -- the one the main thread has most recently let go of,
+	//	or one we published but the main thread never adopted --
+	//	so that at most two honeycombs exist at once and each stage
+	//	adds only the cells the spare lacks, rather than rebuilding them all.
+	//	The group elements come out sorted near-to-far within each stage,
+	//	and each stage lies mostly beyond the previous one,
+	//	so the honeycomb remains essentially sorted near-to-far.
+	//
+	//	If an error occurs -- most likely insufficient memory --
+	//	simply stop, leaving the most recently published honeycomb in place.
+	//	The main thread has already reported any errors in the group itself.
+	//
+	//	ExtendTiling() polls the cancel flag as it goes, so that
+	//	a new space or the app's quitting needn't wait for a whole stage.
+	//	A cancelled ExtendTiling() reports an error, and we stop.
+
+	theCancelTest.itsTestFunction	= SpaceLoaderWasCancelled;
+	theCancelTest.itsTestData		= theSpaceLoader;
+
+	for (theStage = 1; theStage <= NUM_LOADING_STAGES; theStage++)
+	{
+		theStageRadius = theSpaceLoader->itsFirstStageRadius
+					   + (theSpaceLoader->itsFinalRadius - theSpaceLoader->itsFirstStageRadius)
+						 * theStage / NUM_LOADING_STAGES;
+
+		theErrorMessage = ExtendTiling(theSpaceLoader->itsTiling, theStageRadius, &theNewElements, NULL, NULL, &theCancelTest);
+		if (theErrorMessage != NULL)
+			break;
+		theErrorMessage = AppendMatrices(&theSpaceLoader->itsElements, theNewElements);
+		FreeMatrixList(&theNewElements);
+		if (theErrorMessage != NULL)
+			break;
+
+		//	Prefer an unadopted honeycomb to a spare,
+		//	because it's the more nearly complete of the two.
+		LockMutex(theSpaceLoader->itsLock);
+		if (theSpaceLoader->itsPublishedHoneycomb != NULL)
+		{
+			theHoneycomb							= theSpaceLoader->itsPublishedHoneycomb;
+			theSpaceLoader->itsPublishedHoneycomb	= NULL;
+		}
+		else
+		{
+			theHoneycomb							= theSpaceLoader->itsSpareHoneycomb;
+			theSpaceLoader->itsSpareHoneycomb		= NULL;
+		}
+		UnlockMutex(theSpaceLoader->itsLock);
+
+		if (theHoneycomb != NULL)
+			theErrorMessage = CatchUpHoneycomb(	theHoneycomb,
+												theSpaceLoader->itsElements,
+												theSpaceLoader->itsDirichletDomain);
+		else
+			theErrorMessage = ConstructHoneycomb(	theSpaceLoader->itsElements,
+													theSpaceLoader->itsDirichletDomain,
+													&theHoneycomb);
+		if (theErrorMessage != NULL)
+		{
+			FreeHoneycomb(&theHoneycomb);
+			break;
+		}
+
+		//	Cache the completed space before handing off theHoneycomb,
+		//	unless the main thread no longer wants it.
+		if (theStage == NUM_LOADING_STAGES
+		 && ! SpaceLoaderWasCancelled(theSpaceLoader))
+			SaveSpaceToCache(	theSpaceLoader->itsCachePathName,
+								&theSpaceLoader->itsCacheInfo,
+								theSpaceLoader->itsDirichletDomain,
+								theHoneycomb);
+
+		//	Publish theHoneycomb, replacing any earlier honeycomb
+		//	that the main thread never got around to adopting.
+		LockMutex(theSpaceLoader->itsLock);
+		theCancelFlag = theSpaceLoader->itsCancelFlag;
+		if ( ! theCancelFlag )
+		{
+			FreeHoneycomb(&theSpaceLoader->itsPublishedHoneycomb);
+			theSpaceLoader->itsPublishedHoneycomb = theHoneycomb;
+			theHoneycomb = NULL;
+		}
+		UnlockMutex(theSpaceLoader->itsLock);
+		FreeHoneycomb(&theHoneycomb);
+
+		if (theCancelFlag)
+			break;
+	}
+
+	LockMutex(theSpaceLoader->itsLock);
+	theSpaceLoader->itsFinishedFlag = true;
+	UnlockMutex(theSpaceLoader->itsLock);
+
+	ReleaseSpaceLoader(&theSpaceLoader);
+}
+
+
+static ErrorText CatchUpHoneycomb(
+	Honeycomb				*aHoneycomb,		//	input and output
+	MatrixList				*someElements,		//	input
+	const DirichletDomain	*aDirichletDomain)	//	input
+{
+	ErrorText		theErrorMessage		= NULL;
+	MatrixList		*theMissingElements	= NULL;
+	unsigned int	theNumCells;
+
+	//	Runs on the loading thread.
+	//
+	//	aHoneycomb's cells correspond to the first itsNumCells
+	//	of someElements, because the SpaceLoader only ever appends
+	//	to its group elements.  Append cells for the rest.
+
+	theNumCells = aHoneycomb->itsNumCells;
+	if (theNumCells > someElements->itsNumMatrices)
+	{
+		theErrorMessage = u"CatchUpHoneycomb() received a honeycomb with more cells than group elements.";
+		goto CleanUpCatchUpHoneycomb;
+	}
+
+	theMissingElements = AllocateMatrixList(someElements->itsNumMatrices - theNumCells);
+	if (theMissingElements == NULL)
+	{
+		theErrorMessage = u"Couldn't allocate memory for the missing group elements.";
+		goto CleanUpCatchUpHoneycomb;
+	}
+	if (theMissingElements->itsNumMatrices > 0)
+		memcpy(	theMissingElements->itsMatrices,
+				someElements->itsMatrices + theNumCells,
+				theMissingElements->itsNumMatrices * sizeof(Matrix));
+
+	theErrorMessage = ExtendHoneycomb(aHoneycomb, theMissingElements, aDirichletDomain);
+	if (theErrorMessage != NULL)
+		goto CleanUpCatchUpHoneycomb;
+
+CleanUpCatchUpHoneycomb:
+
+	FreeMatrixList(&theMissingElements);
+
+	return theErrorMessage;
+}
+
+
+void AdoptLoadedSpace(
+	ModelData	*md)
+{
+	SpaceLoader	*theSpaceLoader;
+	bool		theFinishedFlag;
+
+	//	Runs on the main thread, once per frame.
+	//
+	//	If the loading thread has published a deeper honeycomb,
+	//	swap it in for the current one.  The swap takes effect
+	//	between frames, so the renderer always sees a complete honeycomb.
+	//
+	//	Never wait for the loading thread.  If it happens to hold
+	//	the lock right now, try again next frame.
+
+	theSpaceLoader = md->itsSpaceLoader;
+	if (theSpaceLoader == NULL)
+		return;
+
+	if ( ! TryLockMutex(theSpaceLoader->itsLock) )
+		return;
+
+	//	Give the replaced honeycomb back to the loading thread,
+	//	which will bring it up to date for a later stage.
+	if (theSpaceLoader->itsPublishedHoneycomb != NULL)
+	{
+		FreeHoneycomb(&theSpaceLoader->itsSpareHoneycomb);
+		theSpaceLoader->itsSpareHoneycomb		= md->itsHoneycomb;
+		md->itsHoneycomb						= theSpaceLoader->itsPublishedHoneycomb;
+		theSpaceLoader->itsPublishedHoneycomb	= NULL;
+		md->itsRedrawRequestFlag				= true;
+	}
+
+	theFinishedFlag = theSpaceLoader->itsFinishedFlag;
+
+	UnlockMutex(theSpaceLoader->itsLock);
+
+	//	The loading thread has nothing left to do but let go
+	//	of the SpaceLoader, so it won't keep us waiting long.
+	if (theFinishedFlag)
+	{
+		WaitForThread(&theSpaceLoader->itsThread);
+		ReleaseSpaceLoader(&md->itsSpaceLoader);
+	}
+}
+
+
+void CancelSpaceLoader(
+	SpaceLoader	**aSpaceLoader,
+	bool		aWaitFlag)
+{
+	//	Runs on the main thread.
+	//
+	//	Ask the loading thread to stop as soon as it can
+	//	-- ExtendTiling() polls the request between batches of Tiles --
+	//	and let go of the SpaceLoader.
+	//
+	//	When switching spaces, pass aWaitFlag = false so as not to wait
+	//	for the loading thread:  it frees the SpaceLoader itself once it's done.
+	//	When quitting, pass aWaitFlag = true, so that the loading thread
+	//	has freed all its memory and temporary files before we return.
+
+	if (*aSpaceLoader == NULL)
+		return;
+
+	LockMutex((*aSpaceLoader)->itsLock);
+	(*aSpaceLoader)->itsCancelFlag = true;
+	UnlockMutex((*aSpaceLoader)->itsLock);
+
+	if (aWaitFlag)
+		WaitForThread(&(*aSpaceLoader)->itsThread);
+	else
+		DetachThread(&(*aSpaceLoader)->itsThread);
+
+	ReleaseSpaceLoader(aSpaceLoader);
+}
+
+
+static bool SpaceLoaderWasCancelled(
+	void	*aSpaceLoader)
+{
+	SpaceLoader	*theSpaceLoader = (SpaceLoader *) aSpaceLoader;
+	bool		theCancelFlag;
+
+	//	Runs on the loading thread.
+
+	LockMutex(theSpaceLoader->itsLock);
+	theCancelFlag = theSpaceLoader->itsCancelFlag;
+	UnlockMutex(theSpaceLoader->itsLock);
+
+	return theCancelFlag;
+}
+
+
+static void ReleaseSpaceLoader(
+	SpaceLoader	**aSpaceLoader)
+{
+	unsigned int	theReferenceCount;
+
+	//	Let go of *aSpaceLoader, and free it if nobody else holds it.
+
+	LockMutex((*aSpaceLoader)->itsLock);
+	theReferenceCount = --(*aSpaceLoader)->itsReferenceCount;
+	UnlockMutex((*aSpaceLoader)->itsLock);
+
+	if (theReferenceCount == 0)
+	{
+		FreeHoneycomb(&(*aSpaceLoader)->itsPublishedHoneycomb);
+		FreeHoneycomb(&(*aSpaceLoader)->itsSpareHoneycomb);
+		FreeTiling(&(*aSpaceLoader)->itsTiling);
+		FreeMatrixList(&(*aSpaceLoader)->itsElements);
+		FreeDirichletDomain(&(*aSpaceLoader)->itsDirichletDomain);
+		FreeMutexLock(&(*aSpaceLoader)->itsLock);
+		FREE_MEMORY(*aSpaceLoader);
+	}
+
+	*aSpaceLoader = NULL;
+}
+
 static ErrorText DetectSpaceType(
 	MatrixList		*aGeneratorList,
 	SpaceType		*aSpaceType)
@@ -528,3 +1248,223 @@ static ErrorText DetectSpaceType(
 
 	return NULL;
 }
+
+
+static ErrorText AppendMatrices(
+	MatrixList	**aMatrixList,		//	input and output;  *aMatrixList may be NULL
+	MatrixList	*someMoreMatrices)	//	input
+{
+	MatrixList		*theCombinedList	= NULL;
+	unsigned int	theNumOldMatrices,
+					i;
+
+	//	Replace *aMatrixList with a list containing its own matrices
+	//	followed by someMoreMatrices.
+
+	theNumOldMatrices = (*aMatrixList != NULL) ? (*aMatrixList)->itsNumMatrices : 0;
+
+	theCombinedList = AllocateMatrixList(theNumOldMatrices + someMoreMatrices->itsNumMatrices);
+	if (theCombinedList == NULL)
+		return u"Couldn't allocate memory for the combined matrix list.";
+
+	for (i = 0; i < theNumOldMatrices; i++)
+		theCombinedList->itsMatrices[i] = (*aMatrixList)->itsMatrices[i];
+	for (i = 0; i < someMoreMatrices->itsNumMatrices; i++)
+		theCombinedList->itsMatrices[theNumOldMatrices + i] = someMoreMatrices->itsMatrices[i];
+
+	FreeMatrixList(aMatrixList);
+	*aMatrixList = theCombinedList;
+
+	return NULL;
+}
+
+
+static ErrorText AppendTileWords(
+	TileWord		**someWords,		//	input and output;  *someWords may be NULL
+	unsigned int	aNumOldWords,		//	input
+	TileWord		*someMoreWords,		//	input
+	unsigned int	aNumMoreWords)		//	input
+{
+	TileWord		*theCombinedWords	= NULL;
+	unsigned int	i;
+
+	//	Replace *someWords with an array containing its own aNumOldWords words
+	//	followed by someMoreWords, just as AppendMatrices() does
+	//	for the corresponding group elements.  ExtendTiling() already
+	//	counts itsParent from the start of its first call,
+	//	so the words need no adjustment.
+
+	//	Allocate at least one TileWord, so that GET_MEMORY()
+	//	won't return NULL when there are no words at all.
+	theCombinedWords = (TileWord *) GET_MEMORY(
+		(aNumOldWords + aNumMoreWords > 0 ? aNumOldWords + aNumMoreWords : 1) * sizeof(TileWord));
+	if (theCombinedWords == NULL)
+		return u"Couldn't allocate memory for the combined words.";
+
+	for (i = 0; i < aNumOldWords; i++)
+		theCombinedWords[i] = (*someWords)[i];
+	for (i = 0; i < aNumMoreWords; i++)
+		theCombinedWords[aNumOldWords + i] = someMoreWords[i];
+
+	FREE_MEMORY_SAFELY(*someWords);
+	*someWords = theCombinedWords;
+
+	return NULL;
+}
+
+
+static uint64_t SpaceCacheKey(
+	MatrixList	*aGeneratorList,
+	double		aTilingRadius)
+{
+	uint64_t		theHash;
+	double			theNumber;
+	uint64_t		theBits;
+	unsigned int	i,
+					j,
+					k,
+					b;
+
+	//	Hash the generators' entries and the tiling radius,
+	//	using the 64-bit FNV-1a hash on the numbers' little-endian
+	//	IEEE 754 bit patterns, so the key is the same on every platform.
+	//	A different generator order gives a different key,
+	//	which costs only an occasional redundant cache file.
+
+	theHash = 0xCBF29CE484222325ULL;	//	FNV offset basis
+
+	for (i = 0; i <= 16 * aGeneratorList->itsNumMatrices; i++)
+	{
+		if (i < 16 * aGeneratorList->itsNumMatrices)
+		{
+			j = (i / 4) % 4;
+			k = i % 4;
+			theNumber = aGeneratorList->itsMatrices[i / 16].m[j][k];
+		}
+		else
+			theNumber = aTilingRadius;
+
+		memcpy(&theBits, &theNumber, sizeof(theBits));
+		for (b = 0; b < 8; b++)
+		{
+			theHash ^= (theBits >> (8*b)) & 0xFF;
+			theHash *= 0x00000100000001B3ULL;	//	FNV prime
+		}
+	}
+
+	return theHash;
+}
+
+
+static bool MakeCachePathName(
+	const Char16	*aCacheDirectory,	//	empty string if cache is disabled
+	uint64_t		aCacheKey,
+	Char16			*aPathBuffer,
+	unsigned int	aPathBufferLength)
+{
+	Char16			theFileName[16 + 1];
+	unsigned int	i,
+					theDigit;
+
+	//	Assemble a path of the form <cache directory>/<key>.cscache .
+	//	Return false if the cache is disabled or the path won't fit.
+
+	if (aCacheDirectory[0] == 0)
+		return false;
+
+	for (i = 0; i < 16; i++)
+	{
+		theDigit = (unsigned int)(aCacheKey >> (4 * (15 - i))) & 0xF;
+		theFileName[i] = (Char16)(theDigit < 10 ? '0' + theDigit : 'a' + (theDigit - 10));
+	}
+	theFileName[16] = 0;
+
+	return Strcpy16(aPathBuffer, aPathBufferLength, aCacheDirectory)
+		&& Strcat16(aPathBuffer, aPathBufferLength, u"/")
+		&& Strcat16(aPathBuffer, aPathBufferLength, theFileName)
+		&& Strcat16(aPathBuffer, aPathBufferLength, SPACE_CACHE_EXTENSION);
+}
+
+
+void SetCacheDirectory(
+	ModelData		*md,
+	const Char16	*aCacheDirectory)	//	absolute path to an existing, writable directory
+{
+	//	An empty or overly long path disables the cache.
+	if ( ! Strcpy16(md->itsCacheDirectory, BUFFER_LENGTH(md->itsCacheDirectory), aCacheDirectory) )
+		md->itsCacheDirectory[0] = 0;
+}
+
+
+static bool LoadSpaceFromCache(
+	ModelData		*md,
+	const Char16	*aCachePathName,	//	empty string if cache is disabled
+	uint64_t		aCacheKey)
+{
+	size_t			theNumBytes		= 0;
+	const Byte		*theBytes		= NULL;
+	void			*theMapping		= NULL;
+	SpaceCacheInfo	theCacheInfo;
+	DirichletDomain	*theDirichletDomain	= NULL;
+	Honeycomb		*theHoneycomb		= NULL;
+	bool			theSuccessFlag		= false;
+
+	//	Map the cache file and rebuild the space directly from its bytes.
+	//	A missing, stale or unreadable cache file simply means
+	//	the caller must compute the space from scratch.
+
+	if (aCachePathName[0] == 0)
+		return false;
+
+	if (MapFileContents(aCachePathName, &theNumBytes, &theBytes, &theMapping) != NULL)
+		goto CleanUpLoadSpaceFromCache;
+
+	if (ReadSpaceCacheImage(theBytes, theNumBytes, &theCacheInfo, &theDirichletDomain, &theHoneycomb) != NULL)
+		goto CleanUpLoadSpaceFromCache;
+
+	//	The key guards against a hash collision in the file name
+	//	(unlikely!) and the space type guards against any other mix-up.
+	if (theCacheInfo.itsKey != aCacheKey
+	 || theCacheInfo.itsSpaceType != md->itsSpaceType)
+		goto CleanUpLoadSpaceFromCache;
+
+	md->itsDirichletDomain		= theDirichletDomain;
+	md->itsHoneycomb			= theHoneycomb;
+	md->itsDrawBackHemisphere	= theCacheInfo.itsDrawBackHemisphere;
+	md->itsThreeSphereFlag		= theCacheInfo.itsThreeSphereFlag;
+	theDirichletDomain			= NULL;
+	theHoneycomb				= NULL;
+
+	theSuccessFlag = true;
+
+CleanUpLoadSpaceFromCache:
+
+	FreeDirichletDomain(&theDirichletDomain);
+	FreeHoneycomb(&theHoneycomb);
+	UnmapFileContents(&theNumBytes, &theBytes, &theMapping);
+
+	return theSuccessFlag;
+}
+
+
+static void SaveSpaceToCache(
+	const Char16	*aCachePathName,	//	empty string if cache is disabled
+	SpaceCacheInfo	*aSpaceCacheInfo,
+	DirichletDomain	*aDirichletDomain,
+	Honeycomb		*aHoneycomb)
+{
+	size_t	theNumBytes	= 0;
+	Byte	*theBytes	= NULL;
+
+	//	The cache is merely an optimization,
+	//	so if anything goes wrong, silently skip it.
+	//	May be called on the loading thread.
+
+	if (aCachePathName[0] == 0)
+		return;
+
+	if (WriteSpaceCacheImage(aSpaceCacheInfo, aDirichletDomain, aHoneycomb, &theNumBytes, &theBytes) == NULL)
+		(void) WriteFileContents(aCachePathName, theNumBytes, theBytes);
+
+	FREE_MEMORY_SAFELY(theBytes);
+}
@@ -112,7 +112,7 @@ void DrawGalaxyVAO(
 
 		//	Each element of the tiling group defines
 		//	a placement of the Dirichlet domain in world space.
-		theDirichletPlacement = &aHoneycomb->itsVisibleCells[i]->itsMatrix;
+		theDirichletPlacement = aHoneycomb->itsVisibleCells[i]->itsMatrix;
 
 		//	Compose aGalaxyPlacement, theDirichletPlacement and aWorldPlacement,
 		//	and send the result to the shader.
@@ -817,21 +817,23 @@ static void DrawTheSceneExtrinsically(
 	
 	//	Set up a Honeycomb containing the identity matrix alone.
 	//	Omit fields related to depth sorting -- DrawDirichletVAO() will ignore them.
-	static Honeycell	theIdentityCell =
+	static Matrix		theIdentityMatrix =
 						{
 							{
-								{
-									{1.0, 0.0, 0.0, 0.0},
-									{0.0, 1.0, 0.0, 0.0},
-									{0.0, 0.0, 1.0, 0.0},
-									{0.0, 0.0, 0.0, 1.0}
-								},
-								ImagePositive
+								{1.0, 0.0, 0.0, 0.0},
+								{0.0, 1.0, 0.0, 0.0},
+								{0.0, 0.0, 1.0, 0.0},
+								{0.0, 0.0, 0.0, 1.0}
 							},
+							ImagePositive
+						};
+	static Honeycell	theIdentityCell =
+						{
 							{{0.0, 0.0, 0.0, 1.0}},	//	ignored (but nevertheless correct!)
-							NULL,					//	ignored
-							0,						//	ignored
-							0.0						//	ignored (but nevertheless correct!)
+							0.0,					//	ignored
+							0.0,					//	ignored (but nevertheless correct!)
+							&theIdentityMatrix,
+							0						//	ignored
 						},
 						*theSingletonArray[1] =
 						{
@@ -839,10 +841,19 @@ static void DrawTheSceneExtrinsically(
 						};
 	static Honeycomb	theSingletonHoneycomb =
 						{
-							0,		//	ignored
-							NULL,	//	ignored
+							0,			//	ignored
+							NULL,		//	ignored
+							NULL,		//	ignored
+							0,			//	ignored
+							NULL,		//	ignored
+							SpaceNone,	//	ignored
+							0,			//	ignored
+							NULL,		//	ignored
+							NULL,		//	ignored
 							1,
-							theSingletonArray
+							theSingletonArray,
+							0,			//	ignored
+							NULL		//	ignored
 						};
 	
 	//	This is just a quick hack for personal use.
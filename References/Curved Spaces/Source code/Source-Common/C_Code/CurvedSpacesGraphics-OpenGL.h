@@ -118,9 +118,12 @@ struct GraphicsDataGL
 			itsPreparedVAOs,
 			itsPreparedQueries;
 	
-	//	Whenever itsCurrentAperture changes,
-	//	we must recompute the Dirichlet VBO.
+	//	Whenever itsCurrentAperture, itsShowColorCoding or the greyscale
+	//	stereo setting changes, we must recompute the Dirichlet VBO
+	//	(but nothing else).
 	double	itsDirichletVBOAperture;
+	bool	itsDirichletVBOColorCoding,
+			itsDirichletVBOGreyscale;
 	
 	//	OpenGL shaders, textures, vertex buffers, etc.
 	GLuint	itsShaderPrograms[NumShaders],
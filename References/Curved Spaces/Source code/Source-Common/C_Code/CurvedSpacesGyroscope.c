@@ -302,7 +302,7 @@ void DrawGyroscopeVAO(
 	{
 		//	Each element of the tiling group defines
 		//	a placement of the Dirichlet domain in world space.
-		theDirichletPlacement = &aHoneycomb->itsVisibleCells[i]->itsMatrix;
+		theDirichletPlacement = aHoneycomb->itsVisibleCells[i]->itsMatrix;
 
 		//	Let front faces wind counterclockwise (resp. clockwise)
 		//	when the gyroscope's placement in eye space preserves (resp. reverses) parity.
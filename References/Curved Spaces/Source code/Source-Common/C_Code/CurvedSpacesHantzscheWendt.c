@@ -281,7 +281,7 @@ void DrawHantzscheWendtVAO(
 		{
 			//	Each element of the tiling group defines
 			//	a placement of the Dirichlet domain in world space.
-			theDirichletPlacement = &aHoneycomb->itsVisibleCells[j]->itsMatrix;
+			theDirichletPlacement = aHoneycomb->itsVisibleCells[j]->itsMatrix;
 
 			//	Let front faces wind counterclockwise (resp. clockwise)
 			//	when the Dirichlet domain's placement in eye space preserves (resp. reverses) parity.
@@ -97,6 +97,8 @@ void SetUpModelData(ModelData *md)
 
 	md->itsDirichletDomain		= NULL;
 	md->itsHoneycomb			= NULL;
+	md->itsSpaceLoader			= NULL;
+	md->itsCacheDirectory[0]	= 0;	//	The platform-dependent code may enable the cache.
 
 #if defined(START_STILL)
 	md->itsDesiredAperture		= 0.00;
@@ -177,6 +179,9 @@ void ShutDownModelData(ModelData *md)
 {
 	//	Free any allocated memory.
 	//	Leave other information untouched.
+	//	Wait for any loading thread to stop, so that it has freed
+	//	its own memory and temporary files before we return.
+	CancelSpaceLoader(&md->itsSpaceLoader, true);
 	FreeDirichletDomain(&md->itsDirichletDomain);
 	FreeHoneycomb(&md->itsHoneycomb);
 }
@@ -199,7 +204,9 @@ void ZeroGraphicsDataGL(GraphicsDataGL *gd)
 	//	Initialize itsDirichletVBOAperture to an invalid value.
 	//	This will trigger a single unnecessary reconstruction of the Dirichlet VBO,
 	//	but is otherwise safe and robust.
-	gd->itsDirichletVBOAperture = -1.0;
+	gd->itsDirichletVBOAperture		= -1.0;
+	gd->itsDirichletVBOColorCoding	= false;
+	gd->itsDirichletVBOGreyscale	= false;
 	
 	//	No shaders, textures, etc. are present.
 
@@ -313,9 +320,13 @@ ErrorText SetUpGraphicsAsNeeded(
 		gd->itsPreparedQueries = true;
 	}
 	
-	//	When the user resizes the aperture,
-	//	rebuild the Dirichlet domain's VBO with the new aperture size.
-	if (gd->itsDirichletVBOAperture != md->itsCurrentAperture)
+	//	When the user resizes the aperture or toggles the color coding,
+	//	rebuild the Dirichlet domain's VBO with the new settings.
+	//	The Dirichlet domain itself stays put, so only the VBO's
+	//	vertex data needs recomputing.
+	if (gd->itsDirichletVBOAperture    != md->itsCurrentAperture
+	 || gd->itsDirichletVBOColorCoding != md->itsShowColorCoding
+	 || gd->itsDirichletVBOGreyscale   != (md->itsStereoMode == StereoGreyscale))
 	{
 		//	It's fine to let MakeDirichletVBO() call glBufferData(),
 		//	which may be more efficient than calling glBufferSubData()
@@ -333,7 +344,9 @@ ErrorText SetUpGraphicsAsNeeded(
 											md->itsStereoMode == StereoGreyscale)) != NULL)
 			return theError;
 
-		gd->itsDirichletVBOAperture = md->itsCurrentAperture;
+		gd->itsDirichletVBOAperture		= md->itsCurrentAperture;
+		gd->itsDirichletVBOColorCoding	= md->itsShowColorCoding;
+		gd->itsDirichletVBOGreyscale	= (md->itsStereoMode == StereoGreyscale);
 	}
 
 	return NULL;
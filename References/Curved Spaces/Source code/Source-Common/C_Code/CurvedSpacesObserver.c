@@ -240,7 +240,7 @@ void DrawObserverVAO(
 	{
 		//	Each element of the tiling group defines
 		//	a placement of the Dirichlet domain in world space.
-		theDirichletPlacement = &aHoneycomb->itsVisibleCells[i]->itsMatrix;
+		theDirichletPlacement = aHoneycomb->itsVisibleCells[i]->itsMatrix;
 
 		//	Let front faces wind counterclockwise (resp. clockwise)
 		//	when the observer's placement in eye space preserves (resp. reverses) parity.
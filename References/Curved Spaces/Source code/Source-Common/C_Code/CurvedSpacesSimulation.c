@@ -76,6 +76,8 @@ bool SimulationWantsUpdates(
 			 || md->itsFogSaturation != (md->itsFogFlag ? 1.0 : 0.0)
 			 || md->itsCurrentAperture != md->itsDesiredAperture)
 		)
+	 ||
+		md->itsSpaceLoader != NULL	//	keep checking for deeper honeycombs
 	 ||
 		md->itsRedrawRequestFlag
 	);
@@ -95,6 +97,10 @@ void SimulationUpdate(
 	if (aFramePeriod > MAX_FRAME_PERIOD)
 		aFramePeriod = MAX_FRAME_PERIOD;
 
+	//	If a secondary thread is still tiling the space,
+	//	adopt whatever deeper honeycomb it may have ready.
+	AdoptLoadedSpace(md);
+
 	//	Update all types of motion, and anything else that's changing.
 	UpdateFog(md, aFramePeriod);
 	UpdateAperture(md, aFramePeriod);
@@ -306,6 +312,46 @@ static void UpdateUserPlacement(
 }
 
 
+const double *MetricCoefficients(
+	SpaceType	aSpaceType,
+	bool		aTimelikeFlag)	//	true for a matrix's last row, false for the others
+{
+	//	Return the coefficients of the inner product in which
+	//	the rows of an isometry in Isom(S³) = O(4), Isom(E³)
+	//	or Isom(H³) = O(3,1) are orthonormal, as {c₀, c₁, c₂, c₃}
+	//	with <u,v> = Σ cᵢ uᵢ vᵢ.  The first three rows take the spacelike
+	//	(or horizontal) metric and the last row takes the timelike
+	//	(or vertical) one.  Return NULL for an unknown space type.
+
+	static const double	theMetricChoices[3][2][4] =
+					{
+						//	spherical
+						{
+							{+1, +1, +1, +1},
+							{+1, +1, +1, +1}
+						},
+						//	flat
+						{
+							{+1, +1, +1,  0},	//	horizontal metric
+							{ 0,  0,  0, +1}	//	vertical metric
+						},
+						//	hyperbolic
+						{
+							{+1, +1, +1, -1},	//	for spacelike vectors
+							{-1, -1, -1, +1}	//	for timelike vectors
+						}
+					};
+
+	switch (aSpaceType)
+	{
+		case SpaceSpherical:	return theMetricChoices[0][aTimelikeFlag ? 1 : 0];
+		case SpaceFlat:			return theMetricChoices[1][aTimelikeFlag ? 1 : 0];
+		case SpaceHyperbolic:	return theMetricChoices[2][aTimelikeFlag ? 1 : 0];
+		default:				return NULL;
+	}
+}
+
+
 void FastGramSchmidt(
 	Matrix		*aMatrix,
 	SpaceType	aSpaceType)
@@ -325,49 +371,24 @@ void FastGramSchmidt(
 	//	because small first order changes orthogonal to a given vector affect
 	//	its length only to second order.
 
-	double			(*theMetricPair)[4],
-					*theMetric,
-					*theRow,
+	const double	*theMetric;
+	double			*theRow,
 					theInnerProduct,
 					theFactor;
 	unsigned int	i,
 					j,
 					k;
 
-	static double	theMetricChoices[3][2][4] =
-					{
-						//	spherical
-						{
-							{+1, +1, +1, +1},
-							{+1, +1, +1, +1}
-						},
-						//	flat
-						{
-							{+1, +1, +1,  0},	//	horizontal metric
-							{ 0,  0,  0, +1}	//	vertical metric
-						},
-						//	hyperbolic
-						{
-							{+1, +1, +1, -1},	//	for spacelike vectors
-							{-1, -1, -1, +1}	//	for timelike vectors
-						}
-					};
-
-	//	Select an appropriate pair of metric coefficient sets.
-	switch (aSpaceType)
-	{
-		case SpaceSpherical:	theMetricPair = theMetricChoices[0];	break;
-		case SpaceFlat:			theMetricPair = theMetricChoices[1];	break;
-		case SpaceHyperbolic:	theMetricPair = theMetricChoices[2];	break;
-		default:				return;	//	should never occur
-	}
+	//	Make sure we have an appropriate metric.
+	if (MetricCoefficients(aSpaceType, false) == NULL)
+		return;	//	should never occur
 
 	//	Normalize each row to unit length.
 	for (i = 0; i < 4; i++)
 	{
 		theRow = aMatrix->m[i];
 
-		theMetric = theMetricPair[i == 3 ? 1 : 0];
+		theMetric = MetricCoefficients(aSpaceType, i == 3);
 
 		theInnerProduct = 0.0;
 		for (j = 0; j < 4; j++)
@@ -381,7 +402,7 @@ void FastGramSchmidt(
 	//	Make the rows orthogonal.
 	for (i = 4; i-- > 0; )	//	leaves the last row untouched
 	{
-		theMetric = theMetricPair[i == 3 ? 1 : 0];
+		theMetric = MetricCoefficients(aSpaceType, i == 3);
 
 		for (j = i; j-- > 0; )
 		{
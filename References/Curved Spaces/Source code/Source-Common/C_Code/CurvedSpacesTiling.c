@@ -23,22 +23,43 @@
 //	yet still tight enough to distinguish different matrices.
 #define TILING_EPSILON		1e-5
 
-//	How accurately do we know our sort key?
-//	For sure large hyperbolic tilings will be the worst case.
-//	Happily, tests on a mirrored dodecahedron found sort key errors
-//	running from ~10⁻¹⁴ at a tiling radius of 4.0,
-//	to ~10⁻¹³ at a tiling radius of 6.0.
-//	Of course other hyperbolic manifolds, with less precise
-//	initial generators (and few zeros in the matrices!) will fare worse.
-#define SORT_KEY_EPSILON	1e-8
-
-//	The SORT_KEY_W_DEPENDENCE should be weak enough that it doesn't
-//	disturb the symmetrical distribution of values on flat and hyperbolic
-//	spaces, yet strong enough to reliably distinguish spherical points
-//	differing only in w.
-//	All these epsilons remind me why exact arithmetic is so appealing.  ☺
-//	Yet exact arithmetic is surely too slow for present purposes.  ☹
-#define SORT_KEY_W_DEPENDENCE	1e-4
+//	To recognize previously found Tiles quickly, we file each Tile
+//	in a hash table according to which cell of a fine grid
+//	its image of the origin (0,0,0,1) falls into.
+//	Distinct tiles' images of the origin sit far apart
+//	relative to HASH_CELL_SIZE, so a typical hash chain
+//	contains a single Tile.  A power of two keeps the quantization
+//	free of any roundoff error of its own.
+#define HASH_CELL_SIZE		(1.0 / 64.0)
+
+//	Start with a modest number of hash buckets (which must be a power of two),
+//	and double the number of buckets whenever the number of Tiles exceeds it.
+#define MIN_NUM_HASH_BUCKETS	1024
+
+//	Likewise start with a modest Tile array and double it as needed.
+#define MIN_TILE_ARRAY_SIZE		1024
+
+//	Allocate Tiles TILES_PER_CHUNK at a time,
+//	rather than calling GET_MEMORY() once per Tile.
+#define TILES_PER_CHUNK			4096
+
+//	We expand the tiling one batch of queued Tiles at a time,
+//	splitting each batch among several threads.  A batch
+//	contains at most MAX_BATCH_SIZE Tiles, which keeps the candidate
+//	buffer's size independent of the tiling's size.
+//	Thread start-up costs a few tens of microseconds,
+//	so give each thread at least MIN_TILES_PER_JOB Tiles to work on.
+#define MAX_BATCH_SIZE			2048
+#define MIN_TILES_PER_JOB		64
+
+//	CompleteFiniteTiling() gives up if a group seems
+//	to have more than MAX_FINITE_GROUP_ORDER elements.
+//	The groups of the spherical manifolds that Curved Spaces
+//	can reasonably display are far smaller.
+#define MAX_FINITE_GROUP_ORDER	100000
+
+//	An as-yet-unknown entry in CompleteFiniteTiling()'s Cayley table
+#define UNKNOWN_CAYLEY_ENTRY	0xFFFFFFFF
 
 //	For testing whether the antipodal matrix is present,
 //	any reasonable value for ANTIPODAL_EPSILON will do.
@@ -59,71 +80,255 @@ typedef struct Tile
 	//	How far does it translate the origin (0,0,0,1) ?
 	double		itsTranslationDistance;
 
-	//	Support for the binary tree used during construction
-	double		itsSortKey;
-	struct Tile	*itsLeftChild,
-				*itsRightChild;
+	//	Support for the hash table used during construction
+	struct Tile	*itsHashNext;
 
-	//	Support for the queue used during construction
-	struct Tile	*itsQueueNext;
+	//	Did we reject any of this Tile's neighbors
+	//	for lying beyond the tiling radius?
+	bool		itsFrontierFlag;
 
-} Tile;
+	//	Which Tile did the breadth-first search reach this one from,
+	//	and via which (extended) generator?  How many steps
+	//	lie between this Tile and the identity?
+	struct Tile	*itsParent;
+	unsigned int	itsGenerator,
+					itsDepth;
 
+	//	Until ExtendTiling() reports this Tile, itsIndex gives
+	//	the order in which it was found.  Once ExtendTiling()
+	//	has reported this Tile, itsIndex gives its position
+	//	in the reported order.
+	unsigned int	itsIndex;
 
-//	The TilingInProgress serves to group some variable together,
-//	more for conceptual clarity than any profound algorithm reason.
-typedef struct
-{
-	//	How many tiles do we have?
-	unsigned int	itsNumTiles;
-
-	//	Keep the Tiles on a binary tree during construction.
-	//	To keep the tree balanced, the sort key should not correlate
-	//	with the structure of the group.  When the construction
-	//	is complete, destroy the tree and set itsTree to NULL.
-	Tile			*itsTree;
+} Tile;
 
-	//	Keep Tiles waiting to be processed on a singly-linked list,
-	//	as well as on the binary tree.  When the construction
-	//	is complete, destroy the list and set itsQueueFirst and
-	//	itsQueueLast to NULL.
-	Tile			*itsQueueFirst,
-					*itsQueueLast;
 
-} TilingInProgress;
+//	A TileChunk is a large block of memory from which
+//	AllocateTile() doles out Tiles one after another.
+typedef struct TileChunk
+{
+	Tile				itsTiles[TILES_PER_CHUNK];
+	struct TileChunk	*itsNext;	//	next older chunk
+} TileChunk;
 
 
-static void					FreeTree(Tile **aTree);
-static double				MakeSortKey(Matrix *aMatrix);
-static ErrorText			AddToTiling(TilingInProgress *aTiling, Matrix *aMatrix, double aSortKey, double aTranslationDistance);
-static Tile					*GetTileFromQueue(TilingInProgress *aTiling);
+//	The TilingInProgress keeps everything we need to resume
+//	the construction later, out to a larger tiling radius.
+struct TilingInProgress
+{
+	//	The generators and their inverses
+	MatrixList		*itsGenerators;
+
+	//	Each product of a generator and a Tile carries the roundoff error
+	//	of both factors, plus a little more.  In the hyperbolic case
+	//	the matrix entries grow exponentially with the translation distance,
+	//	and so does the error, until deep in the tiling a Tile may drift
+	//	noticeably out of O(3,1).  If itsRenormalizeFlag is set,
+	//	we re-orthonormalize each candidate (relative to the metric
+	//	for itsSpaceType) before comparing it to the existing Tiles,
+	//	so the error no longer compounds from one generation to the next.
+	bool			itsRenormalizeFlag;
+	SpaceType		itsSpaceType;
+
+	//	Which of the caller's generators did each extended generator
+	//	come from, and was it that generator's inverse?
+	//	The TileWords that ExtendTiling() reports
+	//	refer to the caller's generators, not the extended ones.
+	unsigned short	*itsGeneratorSources;
+	bool			*itsGeneratorInverseFlags;
+
+	//	How far out have we tiled so far?
+	double			itsTilingRadius;
+
+	//	Keep pointers to all Tiles in an array, in the order
+	//	in which we found them.  The array has room for
+	//	itsTileArraySize pointers, of which the first itsNumTiles
+	//	are in use.
+	unsigned int	itsNumTiles,
+					itsTileArraySize;
+	Tile			**itsTiles;
+
+	//	The array doubles as a to-be-processed queue:
+	//	Tiles itsTiles[0] through itsTiles[itsNumProcessedTiles - 1]
+	//	have already been multiplied by all generators, while the
+	//	remaining Tiles are still waiting their turn.
+	unsigned int	itsNumProcessedTiles;
+
+	//	ExtendTiling() reports only Tiles that it hasn't
+	//	already reported on some previous call.
+	//	Those are the Tiles from itsTiles[itsNumReportedTiles] onwards.
+	unsigned int	itsNumReportedTiles;
+
+	//	The frontier contains the processed Tiles with at least one
+	//	neighbor that we rejected for lying beyond itsTilingRadius.
+	//	Those are the only Tiles we'll need to re-expand
+	//	when extending the tiling to a larger radius.
+	unsigned int	itsNumFrontierTiles,
+					itsFrontierArraySize;
+	Tile			**itsFrontier;
+
+	//	Keep the Tiles on a hash table as well, so we may quickly
+	//	check whether a candidate Tile is already present.
+	//	itsNumHashBuckets is always a power of two.
+	unsigned int	itsNumHashBuckets;
+	Tile			**itsHashBuckets;
+
+	//	Allocate the Tiles themselves from an arena
+	//	of TileChunks, newest first.  The first itsNumTilesInNewestChunk
+	//	Tiles in the newest TileChunk are in use.
+	//	Freeing the arena frees all the Tiles at once.
+	TileChunk		*itsChunks;
+	unsigned int	itsNumTilesInNewestChunk;
+
+	//	Keep a buffer where the ExpansionJobs may write their Candidates.
+	//	It has room for MAX_BATCH_SIZE × (number of generators) Candidates.
+	struct Candidate	*itsCandidates;
+
+	//	Keep track of how much memory the construction uses.
+	TilingStatistics	itsStatistics;
+
+	//	MatrixDeviation() costs more than the rest of AddToTiling()
+	//	put together, so measure each Tile's deviation only
+	//	if the caller plans to ask for statistics.
+	bool				itsDeviationFlag;
+};
+
+
+//	A Candidate is a product of a generator and a Tile
+//	that still needs to be checked against the Tiles that
+//	other threads found in the same batch.
+typedef struct Candidate
+{
+	Matrix			itsMatrix;
+	double			itsTranslationDistance;
+	Tile			*itsParent;
+	unsigned int	itsGenerator;
+} Candidate;
+
+//	An ExpansionJob tells one thread which Tiles to expand
+//	and where to write the resulting Candidates.
+typedef struct
+{
+	//	Input
+	TilingInProgress	*itsTiling;		//	read-only while jobs are running
+	Tile				**itsTiles;		//	Tiles to expand
+	unsigned int		itsNumTiles;
+	double				itsTilingRadius;
+
+	//	Output
+	Candidate			*itsCandidates;	//	room for itsNumTiles × (number of generators)
+	unsigned int		itsNumCandidates;
+
+} ExpansionJob;
+
+
+static ErrorText			ExpandBatch(TilingInProgress *aTiling, Tile **someTiles, unsigned int aNumTiles, double aTilingRadius);
+static void					ExpandTiles(void *anExpansionJob);
+static ErrorText			AddToFrontier(TilingInProgress *aTiling, Tile *aTile);
+static ErrorText			ResizeCayleyTable(unsigned int **aCayleyTable, unsigned int *aNumRows, unsigned int aMinNumRows, unsigned int aNumGenerators);
+static Tile					*AllocateTile(TilingInProgress *aTiling);
+static ErrorText			AddToTiling(TilingInProgress *aTiling, Matrix *aMatrix, double aTranslationDistance, Tile *aParent, unsigned int aGenerator);
+static ErrorText			ResizeHashTable(TilingInProgress *aTiling, unsigned int aNumHashBuckets);
+static unsigned int			HashCellIndex(double aCoordinate, double *aFractionalPart);
+static unsigned int			HashBucket(unsigned int aNumHashBuckets, const unsigned int aCellIndex[4]);
 static double				TranslationDistance(Matrix *aMatrix);
-static bool					TreeContainsMatrix(Tile *aTree, Matrix *aMatrix, double aSortKey);
-static void					CopyPointersToArray(Tile *aTree, Tile ***anArray);
+static double				RowThreeTranslationDistance(const double aRowThree[4]);
+static SpaceType			MatrixSpaceType(Matrix *aMatrix);
+static double				MatrixDeviation(Matrix *aMatrix, SpaceType aSpaceType);
+static Tile					*FindTile(TilingInProgress *aTiling, Matrix *aMatrix);
+static bool					TilingWasCancelled(const CancelTest *aCancelTest);
 static __cdecl signed int	CompareTranslationDistances(const void *p1, const void *p2);
 
 
 ErrorText ConstructHolonomyGroup(
-	MatrixList		*aGeneratorList,
-	double			aTilingRadius,
-	MatrixList		**aHolonomyGroup)			//	output
+	MatrixList			*aGeneratorList,
+	double				aTilingRadius,
+	bool				aRenormalizeFlag,
+	MatrixList			**aHolonomyGroup,	//	output
+	TileWord			**someWords,		//	optional output (may be NULL)
+	TilingStatistics	*aStatistics)		//	optional output (may be NULL)
 {
-	ErrorText			theErrorMessage				= NULL;
-	MatrixList			*theExtendedGeneratorList	= NULL;
-	TilingInProgress	theTilingInProgress;
-	Matrix				theIdentityMatrix,
-						theInverse;
-	Tile				*theTile;
-	Matrix				theCandidate;
-	double				theTranslationDistance,
-						theSortKey;
-	Tile				**theTileArray				= NULL,
-						**theWriteLocation;
-	unsigned int		i;
+	ErrorText			theErrorMessage	= NULL;
+	TilingInProgress	*theTiling		= NULL;
+
+	//	Construct the group in one go, with no intention
+	//	of extending it later.
 
 	if (*aHolonomyGroup != NULL)
 		return u"ConstructHolonomyGroup() received a non-NULL output location.";
 
+	theErrorMessage = BeginTiling(aGeneratorList, aRenormalizeFlag, aStatistics != NULL, &theTiling);
+	if (theErrorMessage != NULL)
+		goto CleanUpConstructHolonomyGroup;
+
+	theErrorMessage = ExtendTiling(theTiling, aTilingRadius, aHolonomyGroup, someWords, aStatistics, NULL);
+	if (theErrorMessage != NULL)
+		goto CleanUpConstructHolonomyGroup;
+
+CleanUpConstructHolonomyGroup:
+
+	FreeTiling(&theTiling);
+
+	return theErrorMessage;
+}
+
+
+ErrorText BeginTiling(
+	MatrixList			*aGeneratorList,
+	bool				aRenormalizeFlag,	//	re-orthonormalize each new group element?
+	bool				aDeviationFlag,		//	measure each new group element's numerical error?
+	TilingInProgress	**aTiling)			//	output
+{
+	ErrorText		theErrorMessage	= NULL;
+	Matrix			theIdentityMatrix,
+					theInverse;
+	unsigned int	theNumExtendedGenerators,
+					i;
+
+	//	Set up a tiling containing only the identity matrix.
+	//	To tile out to some positive radius, call ExtendTiling().
+
+	if (*aTiling != NULL)
+		return u"BeginTiling() received a non-NULL output location.";
+
+	//	A TileWord records a generator's index as an unsigned short.
+	if (aGeneratorList->itsNumMatrices > 0xFFFF)
+		return u"BeginTiling() received too many generators.";
+
+	*aTiling = (TilingInProgress *) GET_MEMORY(sizeof(TilingInProgress));
+	if (*aTiling == NULL)
+	{
+		theErrorMessage = u"Couldn't get memory for aTiling in BeginTiling().";
+		goto CleanUpBeginTiling;
+	}
+
+	//	For safe error handling, immediately set all pointers to NULL.
+	(*aTiling)->itsGenerators				= NULL;
+	(*aTiling)->itsRenormalizeFlag			= aRenormalizeFlag;
+	(*aTiling)->itsSpaceType				= SpaceNone;
+	(*aTiling)->itsGeneratorSources			= NULL;
+	(*aTiling)->itsGeneratorInverseFlags	= NULL;
+	(*aTiling)->itsTilingRadius				= 0.0;
+	(*aTiling)->itsNumTiles					= 0;
+	(*aTiling)->itsTileArraySize			= 0;
+	(*aTiling)->itsTiles					= NULL;
+	(*aTiling)->itsNumProcessedTiles		= 0;
+	(*aTiling)->itsNumReportedTiles			= 0;
+	(*aTiling)->itsNumFrontierTiles			= 0;
+	(*aTiling)->itsFrontierArraySize		= 0;
+	(*aTiling)->itsFrontier					= NULL;
+	(*aTiling)->itsNumHashBuckets			= 0;
+	(*aTiling)->itsHashBuckets				= NULL;
+	(*aTiling)->itsChunks					= NULL;
+	(*aTiling)->itsNumTilesInNewestChunk	= 0;
+	(*aTiling)->itsCandidates				= NULL;
+	(*aTiling)->itsStatistics.itsNumTiles		= 0;
+	(*aTiling)->itsStatistics.itsNumChunks		= 0;
+	(*aTiling)->itsStatistics.itsNumAllocations	= 1;	//	the TilingInProgress itself
+	(*aTiling)->itsStatistics.itsNumBytes		= sizeof(TilingInProgress);
+	(*aTiling)->itsStatistics.itsMaxDeviation	= 0.0;
+	(*aTiling)->itsDeviationFlag				= aDeviationFlag;
+
 	//	Extend the list of generators to include explicit inverses.
 	//
 	//	Warning:  Error checking here is minimal.
@@ -134,81 +339,177 @@ ErrorText ConstructHolonomyGroup(
 	//	that doesn't fix the origin.
 
 	//		Allow space for twice as many matrices as we were given.
-	theExtendedGeneratorList = AllocateMatrixList( 2 * aGeneratorList->itsNumMatrices );
-	if (theExtendedGeneratorList == NULL)
+	(*aTiling)->itsGenerators = AllocateMatrixList( 2 * aGeneratorList->itsNumMatrices );
+	if ((*aTiling)->itsGenerators == NULL)
 	{
-		theErrorMessage = u"Couldn't get memory for theExtendedGeneratorList in ConstructHolonomyGroup().";
-		goto CleanUpConstructHolonomyGroup;
+		theErrorMessage = u"Couldn't get memory for the extended generator list in BeginTiling().";
+		goto CleanUpBeginTiling;
+	}
+	(*aTiling)->itsGeneratorSources			= (unsigned short *) GET_MEMORY(2 * aGeneratorList->itsNumMatrices * sizeof(unsigned short));
+	(*aTiling)->itsGeneratorInverseFlags	= (bool *) GET_MEMORY(2 * aGeneratorList->itsNumMatrices * sizeof(bool));
+	if ((*aTiling)->itsGeneratorSources == NULL
+	 || (*aTiling)->itsGeneratorInverseFlags == NULL)
+	{
+		theErrorMessage = u"Couldn't get memory for the generator sources in BeginTiling().";
+		goto CleanUpBeginTiling;
 	}
+	(*aTiling)->itsStatistics.itsNumAllocations += 2;
+	(*aTiling)->itsStatistics.itsNumBytes += 2 * aGeneratorList->itsNumMatrices * (sizeof(unsigned short) + sizeof(bool));
 
 	//		Copy the generators and their inverses (when distinct)
 	//		and count them as we go along.
-	theExtendedGeneratorList->itsNumMatrices = 0;
+	(*aTiling)->itsGenerators->itsNumMatrices = 0;
 	for (i = 0; i < aGeneratorList->itsNumMatrices; i++)
 	{
 		//	Always add the generator itself.
-		theExtendedGeneratorList->itsMatrices[theExtendedGeneratorList->itsNumMatrices++]
-			= aGeneratorList->itsMatrices[i];
+		theNumExtendedGenerators = (*aTiling)->itsGenerators->itsNumMatrices++;
+		(*aTiling)->itsGenerators->itsMatrices[theNumExtendedGenerators]	= aGeneratorList->itsMatrices[i];
+		(*aTiling)->itsGeneratorSources[theNumExtendedGenerators]			= (unsigned short) i;
+		(*aTiling)->itsGeneratorInverseFlags[theNumExtendedGenerators]		= false;
 
 		//	Add the generator's inverse iff it's distinct.
 		MatrixGeometricInverse(&aGeneratorList->itsMatrices[i], &theInverse);
 		if ( ! MatrixEquality(&aGeneratorList->itsMatrices[i], &theInverse, GENERATOR_EPSILON) )
-			theExtendedGeneratorList->itsMatrices[theExtendedGeneratorList->itsNumMatrices++]
-				= theInverse;
+		{
+			theNumExtendedGenerators = (*aTiling)->itsGenerators->itsNumMatrices++;
+			(*aTiling)->itsGenerators->itsMatrices[theNumExtendedGenerators]	= theInverse;
+			(*aTiling)->itsGeneratorSources[theNumExtendedGenerators]			= (unsigned short) i;
+			(*aTiling)->itsGeneratorInverseFlags[theNumExtendedGenerators]		= true;
+		}
 	}
 
-	//	Initialize theTilingInProgress to an empty tiling.
-	theTilingInProgress.itsNumTiles		= 0;
-	theTilingInProgress.itsTree			= NULL;
-	theTilingInProgress.itsQueueFirst	= NULL;
-	theTilingInProgress.itsQueueLast	= NULL;
+	//	Note the geometry, for use in renormalizing the candidates
+	//	and in measuring their deviation from O(4), Isom(E³) or O(3,1).
+	//	If there are no generators, the space is a 3-sphere
+	//	and the geometry is irrelevant.
+	if ((*aTiling)->itsGenerators->itsNumMatrices > 0)
+		(*aTiling)->itsSpaceType = MatrixSpaceType(&(*aTiling)->itsGenerators->itsMatrices[0]);
+
+	//	Set up the buffer for the ExpansionJobs' output.
+	(*aTiling)->itsCandidates = (Candidate *) GET_MEMORY(MAX_BATCH_SIZE * (*aTiling)->itsGenerators->itsNumMatrices * sizeof(Candidate));
+	if ((*aTiling)->itsCandidates == NULL)
+	{
+		theErrorMessage = u"Couldn't get memory for the Candidates in BeginTiling().";
+		goto CleanUpBeginTiling;
+	}
+	(*aTiling)->itsStatistics.itsNumAllocations++;
+	(*aTiling)->itsStatistics.itsNumBytes += MAX_BATCH_SIZE * (*aTiling)->itsGenerators->itsNumMatrices * sizeof(Candidate);
+
+	//	Set up an empty hash table.
+	theErrorMessage = ResizeHashTable(*aTiling, MIN_NUM_HASH_BUCKETS);
+	if (theErrorMessage != NULL)
+		goto CleanUpBeginTiling;
 
 	//	Add the identity matrix to the tiling.
 	MatrixIdentity(&theIdentityMatrix);
-	theErrorMessage = AddToTiling(	&theTilingInProgress,
-									&theIdentityMatrix,
-									MakeSortKey(&theIdentityMatrix),
-									0.0);
+	theErrorMessage = AddToTiling(*aTiling, &theIdentityMatrix, 0.0, NULL, 0);
 	if (theErrorMessage != NULL)
-		goto CleanUpConstructHolonomyGroup;
+		goto CleanUpBeginTiling;
 
-	//	Process the queue.
-	while ((theTile = GetTileFromQueue(&theTilingInProgress)) != NULL)
-	{
-		//	For each generator...
-		for (i = 0; i < theExtendedGeneratorList->itsNumMatrices; i++)
-		{
-			//	...pre-multiplying (not post-multiplying!) a matrix
-			//	by a generator yields a neighbor of the given tile.
-			MatrixProduct(	&theExtendedGeneratorList->itsMatrices[i],
-							&theTile->itsMatrix,
-							&theCandidate);
+CleanUpBeginTiling:
 
-			//	Note the candidate's translation distance.
-			theTranslationDistance = TranslationDistance(&theCandidate);
+	if (theErrorMessage != NULL)
+		FreeTiling(aTiling);
 
-			//	Reject candidates that translate too far.
-			if (theTranslationDistance > aTilingRadius)
-				continue;
+	return theErrorMessage;
+}
 
-			//	Note the candidate's sort key.
-			theSortKey = MakeSortKey(&theCandidate);
 
-			//	Reject candidates already found earlier.
-			if (TreeContainsMatrix(theTilingInProgress.itsTree, &theCandidate, theSortKey))
-				continue;
+ErrorText ExtendTiling(
+	TilingInProgress	*aTiling,
+	double				aTilingRadius,
+	MatrixList			**someNewElements,	//	output
+	TileWord			**someNewWords,		//	optional output (may be NULL)
+	TilingStatistics	*aStatistics,		//	optional output (may be NULL)
+	const CancelTest	*aCancelTest)		//	optional input (may be NULL)
+{
+	ErrorText		theErrorMessage		= NULL;
+	Tile			**theOldFrontier	= NULL,
+					*theTile;
+	unsigned int	theNumOldFrontierTiles,
+					theBatchSize,
+					theNumWords,
+					i;
+
+	//	Extend aTiling out to aTilingRadius, and report
+	//	all group elements not reported on previous calls.
+	//
+	//	On the first call, the new elements will be the whole group
+	//	(out to aTilingRadius), including the identity.
+	//	On subsequent calls, the new elements will be only
+	//	those group elements that lie beyond the previous radius,
+	//	plus possibly a few at smaller radii that can be reached only
+	//	by passing through group elements that lie beyond the previous radius.
+	//
+	//	If aCancelTest is non-NULL, poll it before each batch of Tiles,
+	//	and give up as soon as it requests cancellation.
+	//	A cancelled tiling is fit only for FreeTiling().
+
+	if (*someNewElements != NULL
+	 || (someNewWords != NULL && *someNewWords != NULL))
+		return u"ExtendTiling() received a non-NULL output location.";
+
+	if (aTilingRadius > aTiling->itsTilingRadius)
+		aTiling->itsTilingRadius = aTilingRadius;
+
+	//	Re-expand the frontier Tiles, now that the larger radius
+	//	may admit some neighbors that the smaller radius excluded.
+	//	The present frontier will be replaced by a new one,
+	//	so keep the old one to ourselves while we work through it.
+	theOldFrontier				= aTiling->itsFrontier;
+	theNumOldFrontierTiles		= aTiling->itsNumFrontierTiles;
+	aTiling->itsFrontier			= NULL;
+	aTiling->itsNumFrontierTiles	= 0;
+	aTiling->itsFrontierArraySize	= 0;
+
+	for (i = 0; i < theNumOldFrontierTiles; i += theBatchSize)
+	{
+		theBatchSize = theNumOldFrontierTiles - i;
+		if (theBatchSize > MAX_BATCH_SIZE)
+			theBatchSize = MAX_BATCH_SIZE;
 
-			//	Add the candidate to the tiling.
-			theErrorMessage = AddToTiling(	&theTilingInProgress,
-											&theCandidate,
-											theSortKey,
-											theTranslationDistance);
-			if (theErrorMessage != NULL)
-				goto CleanUpConstructHolonomyGroup;
+		if (TilingWasCancelled(aCancelTest))
+		{
+			theErrorMessage = u"ExtendTiling() was cancelled.";
+			goto CleanUpExtendTiling;
+		}
+
+		theErrorMessage = ExpandBatch(aTiling, theOldFrontier + i, theBatchSize, aTiling->itsTilingRadius);
+		if (theErrorMessage != NULL)
+			goto CleanUpExtendTiling;
+	}
+
+	//	Process the queue, one batch of Tiles at a time.
+	//
+	//	The Tiles waiting in the queue are exactly the Tiles found
+	//	while processing the previous batch.  So as long as the tiling
+	//	grows by fewer than MAX_BATCH_SIZE Tiles per generation,
+	//	each batch is precisely one level of a breadth-first search
+	//	(all group elements of the same word length, more or less).
+	while (aTiling->itsNumProcessedTiles < aTiling->itsNumTiles)
+	{
+		//	Take the whole queue, up to MAX_BATCH_SIZE Tiles.
+		theBatchSize = aTiling->itsNumTiles - aTiling->itsNumProcessedTiles;
+		if (theBatchSize > MAX_BATCH_SIZE)
+			theBatchSize = MAX_BATCH_SIZE;
+
+		if (TilingWasCancelled(aCancelTest))
+		{
+			theErrorMessage = u"ExtendTiling() was cancelled.";
+			goto CleanUpExtendTiling;
 		}
+
+		//	ExpandBatch() may enlarge the Tile array, but only after
+		//	it's finished reading the Tiles to be expanded.
+		theErrorMessage = ExpandBatch(	aTiling,
+										aTiling->itsTiles + aTiling->itsNumProcessedTiles,
+										theBatchSize,
+										aTiling->itsTilingRadius);
+		if (theErrorMessage != NULL)
+			goto CleanUpExtendTiling;
 	}
 
-	//	Sort the Tiles.
+	//	Sort the new Tiles.
 	//
 	//	Note:  We'll sort the tiles again at render time,
 	//	but I'm leaving this sort in place here as well,
@@ -216,278 +517,926 @@ ErrorText ConstructHolonomyGroup(
 	//	In effect, this sort sorts relative to the original
 	//	distances within the tiling, while the render-time sort
 	//	sorts relative to the distance to the observer.
+	//
+	//	The queue is now empty, so we may reorder the Tiles freely.
+	//	The hash chains and the frontier point to Tiles,
+	//	not to array locations, so they too remain intact.
+	qsort(	aTiling->itsTiles + aTiling->itsNumReportedTiles,
+			aTiling->itsNumTiles - aTiling->itsNumReportedTiles,
+			sizeof(Tile *),
+			CompareTranslationDistances);
 
-	//		Allocate an array to hold pointers to the Tiles.
-	theTileArray = (Tile **) GET_MEMORY(theTilingInProgress.itsNumTiles * sizeof(Tile *));
-	if (theTileArray == NULL)
+	//	Copy the new matrices to someNewElements (our final output variable!).
+	*someNewElements = AllocateMatrixList(aTiling->itsNumTiles - aTiling->itsNumReportedTiles);
+	if (*someNewElements == NULL)
 	{
-		theErrorMessage = u"Can't get memory to sort Tiles in ConstructHolonomyGroup().";
-		goto CleanUpConstructHolonomyGroup;
+		theErrorMessage = u"Couldn't get memory for someNewElements in ExtendTiling().";
+		goto CleanUpExtendTiling;
+	}
+	for (i = 0; i < (*someNewElements)->itsNumMatrices; i++)
+	{
+		theTile				= aTiling->itsTiles[aTiling->itsNumReportedTiles + i];
+		theTile->itsIndex	= aTiling->itsNumReportedTiles + i;
+		(*someNewElements)->itsMatrices[i] = theTile->itsMatrix;
 	}
 
-	//		Copy the pointers from the tree structure recursively,
-	//		advancing the destination pointer theTile as we go.
-	//		Afterwards, make sure we wrote exactly the right number of tiles.
-	theWriteLocation = theTileArray;
-	CopyPointersToArray(theTilingInProgress.itsTree, &theWriteLocation);
-	if (theWriteLocation != theTileArray + theTilingInProgress.itsNumTiles)
+	//	Report the words if the caller wants them.
+	//	Every new Tile's parent is either an old Tile
+	//	or a new Tile, so by now all parents have their itsIndex.
+	if (someNewWords != NULL)
 	{
-		theErrorMessage = u"Grave error while copying Tile addresses in ConstructHolonomyGroup().";
-		goto CleanUpConstructHolonomyGroup;
+		//	Allocate at least one TileWord, so that GET_MEMORY()
+		//	won't return NULL when there are no new elements.
+		theNumWords = (*someNewElements)->itsNumMatrices;
+		*someNewWords = (TileWord *) GET_MEMORY((theNumWords > 0 ? theNumWords : 1) * sizeof(TileWord));
+		if (*someNewWords == NULL)
+		{
+			theErrorMessage = u"Couldn't get memory for someNewWords in ExtendTiling().";
+			goto CleanUpExtendTiling;
+		}
+		for (i = 0; i < theNumWords; i++)
+		{
+			theTile = aTiling->itsTiles[aTiling->itsNumReportedTiles + i];
+
+			if (theTile->itsParent != NULL)
+			{
+				(*someNewWords)[i].itsParent		= theTile->itsParent->itsIndex;
+				(*someNewWords)[i].itsGenerator		= aTiling->itsGeneratorSources[theTile->itsGenerator];
+				(*someNewWords)[i].itsInverseFlag	= aTiling->itsGeneratorInverseFlags[theTile->itsGenerator];
+			}
+			else	//	the identity
+			{
+				(*someNewWords)[i].itsParent		= TILE_WORD_NO_PARENT;
+				(*someNewWords)[i].itsGenerator		= 0;
+				(*someNewWords)[i].itsInverseFlag	= false;
+			}
+			(*someNewWords)[i].itsDepth = theTile->itsDepth;
+		}
 	}
 
-	//		Call the standard library's QuickSort implementation
-	//		to sort the pointers.
-	qsort(	theTileArray,
-			theTilingInProgress.itsNumTiles,
-			sizeof(Tile *),
-			CompareTranslationDistances);
+	aTiling->itsNumReportedTiles = aTiling->itsNumTiles;
 
-	//	Copy the matrices to aHolonomyGroup (our final output variable!).
-	*aHolonomyGroup = AllocateMatrixList(theTilingInProgress.itsNumTiles);
-	if (*aHolonomyGroup == NULL)
+	//	Report statistics if the caller wants them.
+	if (aStatistics != NULL)
 	{
-		theErrorMessage = u"Couldn't get memory for aHolonomyGroup in ConstructHolonomyGroup().";
-		goto CleanUpConstructHolonomyGroup;
+		*aStatistics				= aTiling->itsStatistics;
+		aStatistics->itsNumTiles	= aTiling->itsNumTiles;
 	}
-	for (i = 0; i < theTilingInProgress.itsNumTiles; i++)
-		(*aHolonomyGroup)->itsMatrices[i] = theTileArray[i]->itsMatrix;
 
-CleanUpConstructHolonomyGroup:
+CleanUpExtendTiling:
 
-	//	As the code is now written, *aHolonomyGroup will be NULL
+	//	As the code is now written, *someNewElements will be NULL
 	//	until the last moment.  But best to leave this check in place
 	//	in case I modify the code in the future.
 	if (theErrorMessage != NULL)
-		FreeMatrixList(aHolonomyGroup);
-
-	//	The Tiles get stored on three independent data structures:
-	//	the tree, the queue and the array.  Let's free the Tiles
-	//	as part of the tree, because each Tile goes onto the tree
-	//	immediately upon its creation and remains there thereafter.
-	//	(By contrast, Tiles get taken off the queue, and the array
-	//	doesn't even exist until late in the algorithm.)
-	FreeTree(&theTilingInProgress.itsTree);
-	theTilingInProgress.itsQueueFirst	= NULL;
-	theTilingInProgress.itsQueueLast	= NULL;
-	FREE_MEMORY_SAFELY(theTileArray);
-
-	//	Free the extended generator list.
-	FreeMatrixList(&theExtendedGeneratorList);
+	{
+		FreeMatrixList(someNewElements);
+		if (someNewWords != NULL)
+			FREE_MEMORY_SAFELY(*someNewWords);
+	}
+
+	//	Every Tile that was on the old frontier has either
+	//	found its way onto the new frontier or is no longer needed there.
+	FREE_MEMORY_SAFELY(theOldFrontier);
 
 	return theErrorMessage;
 }
 
 
-static void FreeTree(Tile **aTree)
+ErrorText CompleteFiniteTiling(TilingInProgress *aTiling)
 {
-	if (*aTree != NULL)
+	ErrorText		theErrorMessage		= NULL;
+	unsigned int	theNumGenerators,
+					*theInverses		= NULL,
+					*theCayleyTable		= NULL,
+					theNumRows			= 0,
+					theTileIndex,
+					theImageIndex,
+					i,
+					j;
+	bool			*theImageFlags		= NULL;
+	Matrix			theProduct;
+	Tile			*theImage;
+
+	//	When the group is finite, as it is for every spherical space,
+	//	enumerate all its elements, with no reference to any tiling radius,
+	//	in the style of a Todd-Coxeter coset enumeration
+	//	relative to the trivial subgroup.  That is, fill in
+	//	the group's Cayley table, in which the entry for Tile i
+	//	and generator j gives the index of the product (generator j) × (Tile i).
+	//	Whenever we learn that g·a = b, we immediately deduce
+	//	that g⁻¹·b = a, with no need to compute or compare any matrices.
+	//	That halves the number of floating-point comparisons.
+	//
+	//	When the table is complete, we check that each generator's column
+	//	is a permutation of the elements.  A finite set of matrices
+	//	containing the identity and permuted by every generator
+	//	is precisely the group the generators generate,
+	//	so the element count is guaranteed correct, not merely plausible.
+	//	Distinct elements of a finite subgroup of O(4) sit far apart,
+	//	compared to TILING_EPSILON, so a mistaken match would show up
+	//	as a column that fails to be a permutation.
+	//
+	//	Call CompleteFiniteTiling() right after BeginTiling().
+	//	The next call to ExtendTiling() will report the whole group,
+	//	sorted by translation distance, just as if it had tiled
+	//	out to a radius of π.
+
+	if (aTiling->itsNumTiles != 1
+	 || aTiling->itsNumProcessedTiles != 0)
+		return u"CompleteFiniteTiling() expects a freshly begun tiling.";
+
+	theNumGenerators = aTiling->itsGenerators->itsNumMatrices;
+
+	//	Note each extended generator's inverse.
+	//	BeginTiling() places each generator's inverse (when distinct)
+	//	immediately after the generator itself.
+	theInverses = (unsigned int *) GET_MEMORY((theNumGenerators > 0 ? theNumGenerators : 1) * sizeof(unsigned int));
+	if (theInverses == NULL)
+	{
+		theErrorMessage = u"Couldn't get memory for theInverses in CompleteFiniteTiling().";
+		goto CleanUpCompleteFiniteTiling;
+	}
+	for (j = 0; j < theNumGenerators; j++)
+	{
+		if (aTiling->itsGeneratorInverseFlags[j])
+			theInverses[j] = j - 1;
+		else
+		if (j + 1 < theNumGenerators && aTiling->itsGeneratorInverseFlags[j + 1])
+			theInverses[j] = j + 1;
+		else
+			theInverses[j] = j;	//	the generator is its own inverse
+	}
+
+	theErrorMessage = ResizeCayleyTable(&theCayleyTable, &theNumRows, MIN_TILE_ARRAY_SIZE, theNumGenerators);
+	if (theErrorMessage != NULL)
+		goto CleanUpCompleteFiniteTiling;
+
+	//	Fill in the Cayley table one row at a time.  Each new element
+	//	gets appended to the Tile array, so this loop ends
+	//	only when every element has a complete row.
+	for (theTileIndex = 0; theTileIndex < aTiling->itsNumTiles; theTileIndex++)
+	{
+		for (j = 0; j < theNumGenerators; j++)
+		{
+			if (theCayleyTable[theTileIndex * theNumGenerators + j] != UNKNOWN_CAYLEY_ENTRY)
+				continue;
+
+			MatrixProduct(	&aTiling->itsGenerators->itsMatrices[j],
+							&aTiling->itsTiles[theTileIndex]->itsMatrix,
+							&theProduct);
+			if (aTiling->itsRenormalizeFlag)
+				FastGramSchmidt(&theProduct, aTiling->itsSpaceType);
+
+			theImage = FindTile(aTiling, &theProduct);
+			if (theImage == NULL)
+			{
+				if (aTiling->itsNumTiles >= MAX_FINITE_GROUP_ORDER)
+				{
+					theErrorMessage = u"The group seems to be infinite, or at least too large to enumerate.";
+					goto CleanUpCompleteFiniteTiling;
+				}
+
+				theErrorMessage = AddToTiling(	aTiling,
+												&theProduct,
+												TranslationDistance(&theProduct),
+												aTiling->itsTiles[theTileIndex],
+												j);
+				if (theErrorMessage != NULL)
+					goto CleanUpCompleteFiniteTiling;
+
+				theImage = aTiling->itsTiles[aTiling->itsNumTiles - 1];
+
+				if (aTiling->itsNumTiles > theNumRows)
+				{
+					theErrorMessage = ResizeCayleyTable(&theCayleyTable, &theNumRows, 2 * theNumRows, theNumGenerators);
+					if (theErrorMessage != NULL)
+						goto CleanUpCompleteFiniteTiling;
+				}
+			}
+			theImageIndex = theImage->itsIndex;
+
+			//	Record g·a = b and deduce g⁻¹·b = a.
+			//	If the deduction contradicts an earlier entry,
+			//	the numerical matching has gone wrong.
+			theCayleyTable[theTileIndex * theNumGenerators + j] = theImageIndex;
+			if (theCayleyTable[theImageIndex * theNumGenerators + theInverses[j]] == UNKNOWN_CAYLEY_ENTRY)
+				theCayleyTable[theImageIndex * theNumGenerators + theInverses[j]] = theTileIndex;
+			else
+			if (theCayleyTable[theImageIndex * theNumGenerators + theInverses[j]] != theTileIndex)
+			{
+				theErrorMessage = u"The group's Cayley table is inconsistent.";
+				goto CleanUpCompleteFiniteTiling;
+			}
+		}
+	}
+
+	//	Check that each generator permutes the elements.
+	theImageFlags = (bool *) GET_MEMORY(aTiling->itsNumTiles * sizeof(bool));
+	if (theImageFlags == NULL)
 	{
-		FreeTree(&(*aTree)->itsLeftChild );
-		FreeTree(&(*aTree)->itsRightChild);
-		FREE_MEMORY_SAFELY(*aTree);
+		theErrorMessage = u"Couldn't get memory for theImageFlags in CompleteFiniteTiling().";
+		goto CleanUpCompleteFiniteTiling;
 	}
+	for (j = 0; j < theNumGenerators; j++)
+	{
+		for (i = 0; i < aTiling->itsNumTiles; i++)
+			theImageFlags[i] = false;
+
+		for (i = 0; i < aTiling->itsNumTiles; i++)
+		{
+			theImageIndex = theCayleyTable[i * theNumGenerators + j];
+			if (theImageFlags[theImageIndex])
+			{
+				theErrorMessage = u"A generator fails to permute the group's elements.";
+				goto CleanUpCompleteFiniteTiling;
+			}
+			theImageFlags[theImageIndex] = true;
+		}
+	}
+
+	//	Every Tile has now been multiplied by every generator,
+	//	and no neighbor was rejected, so the frontier stays empty
+	//	and the queue is empty.
+	aTiling->itsNumProcessedTiles	= aTiling->itsNumTiles;
+	if (aTiling->itsTilingRadius < PI)
+		aTiling->itsTilingRadius	= PI;
+
+CleanUpCompleteFiniteTiling:
+
+	FREE_MEMORY_SAFELY(theInverses);
+	FREE_MEMORY_SAFELY(theCayleyTable);
+	FREE_MEMORY_SAFELY(theImageFlags);
+
+	return theErrorMessage;
 }
 
 
-static double MakeSortKey(Matrix *aMatrix)
+void FreeTiling(TilingInProgress **aTiling)
 {
-	//	To store the tiles efficiently on a binary tree,
-	//	we need a sort key that is likely to take distinct values
-	//	for distinct matrices.  I don't see any way to achieve
-	//	this goal with complete rigor (one can't map R³ into R
-	//	injectively), but we should obtain fairly good results
-	//	by taking the image of the origin (0,0,0,1) and projecting
-	//	it onto an arbitrarily chosen axis.  If the chosen axis
-	//	doesn't align with the group in any way, the sort keys
-	//	should all be distinct.
-	//
-	//	A further benefit of this scheme is that the binary tree's
-	//	root node, which will contain the identity matrix, will get
-	//	a value of zero, exactly in the middle of the distribution!
-	//	From there, one expects the remaining nodes to fill out
-	//	a more-or-less balanced tree.
-	//
-	//	Uh-oh.  I forgot that in the spherical case different group
-	//	elements will sit "one above the other", meaning their images
-	//	of the origin differ only in the sign of the w-cooordinate.
-	//	So let's throw in a weak dependence on w to resolve such
-	//	degeneracies without making the sort key distribution
-	//	too asymetrical in the flat and hyperbolic cases.
-	//
-	//	Of course, if one were using exact arithmetic then more robust
-	//	schemes would be possible.
-
-	static const double	theArbitraryAxis[4] =
-						{
-							0.16790445172382044311,
-							0.31996944449851782048,
-							0.93243104285444785608,
-							SORT_KEY_W_DEPENDENCE
-						};
-
-	return theArbitraryAxis[0] * aMatrix->m[3][0]
-		 + theArbitraryAxis[1] * aMatrix->m[3][1]
-		 + theArbitraryAxis[2] * aMatrix->m[3][2]
-		 + theArbitraryAxis[3] * aMatrix->m[3][3];
+	TileChunk	*theDeadChunk;
+
+	if (aTiling != NULL
+	 && *aTiling != NULL)
+	{
+		//	Free the Tiles one TileChunk at a time.
+		while ((*aTiling)->itsChunks != NULL)
+		{
+			theDeadChunk			= (*aTiling)->itsChunks;
+			(*aTiling)->itsChunks	= theDeadChunk->itsNext;
+			FREE_MEMORY(theDeadChunk);
+		}
+
+		FREE_MEMORY_SAFELY((*aTiling)->itsTiles);
+		FREE_MEMORY_SAFELY((*aTiling)->itsFrontier);
+		FREE_MEMORY_SAFELY((*aTiling)->itsHashBuckets);
+		FREE_MEMORY_SAFELY((*aTiling)->itsCandidates);
+		FREE_MEMORY_SAFELY((*aTiling)->itsGeneratorSources);
+		FREE_MEMORY_SAFELY((*aTiling)->itsGeneratorInverseFlags);
+		FreeMatrixList(&(*aTiling)->itsGenerators);
+
+		FREE_MEMORY_SAFELY(*aTiling);
+	}
+}
+
+
+static ErrorText ExpandBatch(
+	TilingInProgress	*aTiling,
+	Tile				**someTiles,	//	Tiles to expand
+	unsigned int		aNumTiles,		//	at most MAX_BATCH_SIZE
+	double				aTilingRadius)
+{
+	ErrorText		theErrorMessage	= NULL;
+	unsigned int	theNumProcessors,
+					theNumJobs,
+					theFirstTileInJob,
+					theEndOfJob;
+	ExpansionJob	theJobs[MAX_PARALLEL_JOBS];
+	void			*theJobPointers[MAX_PARALLEL_JOBS];
+	Candidate		*theCandidate;
+	bool			theBatchIsQueue;
+	unsigned int	i,
+					j;
+
+	//	Several threads expand each batch, but only the present thread
+	//	modifies aTiling.  While the jobs are running,
+	//	the Tile array and the hash table are strictly read-only,
+	//	so the jobs may consult them without any locking.
+	//	Each job discards candidates that translate too far
+	//	or were found in some earlier batch, and records
+	//	the remaining candidates in its own section of itsCandidates.
+	//	The present thread then merges the jobs' candidates into
+	//	the tiling, one job after another and in the order each job
+	//	found them.  That's exactly the order in which a one-Tile-at-a-time
+	//	search would have found them, so the resulting tiling
+	//	doesn't depend on the number of threads or their timing.
+
+	theNumProcessors = GetNumProcessors();
+	if (theNumProcessors > MAX_PARALLEL_JOBS)
+		theNumProcessors = MAX_PARALLEL_JOBS;
+
+	//	Split the batch as evenly as possible among the jobs.
+	theNumJobs = aNumTiles / MIN_TILES_PER_JOB;
+	if (theNumJobs > theNumProcessors)
+		theNumJobs = theNumProcessors;
+	if (theNumJobs < 1)
+		theNumJobs = 1;
+
+	for (i = 0; i < theNumJobs; i++)
+	{
+		theFirstTileInJob	= ( i      * aNumTiles) / theNumJobs;
+		theEndOfJob			= ((i + 1) * aNumTiles) / theNumJobs;
+
+		theJobs[i].itsTiling		= aTiling;
+		theJobs[i].itsTiles			= someTiles + theFirstTileInJob;
+		theJobs[i].itsNumTiles		= theEndOfJob - theFirstTileInJob;
+		theJobs[i].itsTilingRadius	= aTilingRadius;
+		theJobs[i].itsCandidates	= aTiling->itsCandidates + theFirstTileInJob * aTiling->itsGenerators->itsNumMatrices;
+		theJobs[i].itsNumCandidates	= 0;
+
+		theJobPointers[i] = &theJobs[i];
+	}
+
+	RunJobsInParallel(theNumJobs, ExpandTiles, theJobPointers);
+
+	//	Record which Tiles lie on the new frontier.
+	//	Do this before merging the candidates, because
+	//	someTiles may point into the Tile array, which
+	//	AddToTiling() may move.
+	for (i = 0; i < aNumTiles; i++)
+	{
+		if (someTiles[i]->itsFrontierFlag)
+		{
+			theErrorMessage = AddToFrontier(aTiling, someTiles[i]);
+			if (theErrorMessage != NULL)
+				return theErrorMessage;
+		}
+	}
+
+	//	If we've just expanded the Tiles at the front of the queue,
+	//	remove them from the queue.
+	theBatchIsQueue = (someTiles == aTiling->itsTiles + aTiling->itsNumProcessedTiles);
+	if (theBatchIsQueue)
+		aTiling->itsNumProcessedTiles += aNumTiles;
+
+	//	Merge the candidates into the tiling.  Two different jobs
+	//	(or even a single job) may have found the same new group element,
+	//	so we must check each candidate against the tiling yet again.
+	for (i = 0; i < theNumJobs; i++)
+	{
+		for (j = 0; j < theJobs[i].itsNumCandidates; j++)
+		{
+			theCandidate = &theJobs[i].itsCandidates[j];
+
+			if (FindTile(aTiling, &theCandidate->itsMatrix) != NULL)
+				continue;
+
+			theErrorMessage = AddToTiling(	aTiling,
+											&theCandidate->itsMatrix,
+											theCandidate->itsTranslationDistance,
+											theCandidate->itsParent,
+											theCandidate->itsGenerator);
+			if (theErrorMessage != NULL)
+				return theErrorMessage;
+		}
+	}
+
+	return NULL;
+}
+
+
+static void ExpandTiles(void *anExpansionJob)
+{
+	ExpansionJob	*theJob;
+	Matrix			*theGenerators;
+	unsigned int	theNumGenerators,
+					theFirstCandidate,
+					i,
+					j,
+					k;
+	Tile			*theTile;
+	Candidate		*theCandidate;
+	double			theRowThree[4];
+
+	//	This function may run on a secondary thread,
+	//	so it must not modify the tiling or allocate memory.
+	//	It may, however, modify the Tiles it's been asked to expand,
+	//	because no other thread will touch them.
+
+	theJob				= (ExpansionJob *) anExpansionJob;
+	theGenerators		= theJob->itsTiling->itsGenerators->itsMatrices;
+	theNumGenerators	= theJob->itsTiling->itsGenerators->itsNumMatrices;
+
+	theJob->itsNumCandidates = 0;
+
+	//	For each Tile...
+	for (i = 0; i < theJob->itsNumTiles; i++)
+	{
+		theTile = theJob->itsTiles[i];
+		theTile->itsFrontierFlag = false;
+
+		//	Most candidates translate too far and get rejected,
+		//	but a candidate's translation distance depends only
+		//	on its image of the origin, that is, on row 3 of
+		//	the product (generator) × (Tile).  So compute row 3 alone
+		//	for all generators, in one tight loop, and only then
+		//	compute the full products for the candidates that survive.
+		//
+		//	The candidate buffer has room for theNumGenerators Candidates
+		//	from theFirstCandidate onwards, so use their itsTranslationDistance
+		//	fields as scratch space.  The second loop below writes the k-th
+		//	surviving candidate into the slot that held the k-th distance,
+		//	with k ≤ j, so it never overwrites a distance it has yet to read.
+		theFirstCandidate = theJob->itsNumCandidates;
+
+		//	...pre-multiplying (not post-multiplying!) a matrix
+		//	by a generator yields a neighbor of the given tile.
+		//	Sum the terms in the same order that MatrixProduct() does,
+		//	so a candidate's translation distance comes out the same
+		//	whichever way we compute it.
+		for (j = 0; j < theNumGenerators; j++)
+		{
+			for (k = 0; k < 4; k++)
+			{
+				theRowThree[k]	= 0.0;
+				theRowThree[k]	+= theGenerators[j].m[3][0] * theTile->itsMatrix.m[0][k];
+				theRowThree[k]	+= theGenerators[j].m[3][1] * theTile->itsMatrix.m[1][k];
+				theRowThree[k]	+= theGenerators[j].m[3][2] * theTile->itsMatrix.m[2][k];
+				theRowThree[k]	+= theGenerators[j].m[3][3] * theTile->itsMatrix.m[3][k];
+			}
+
+			theJob->itsCandidates[theFirstCandidate + j].itsTranslationDistance
+				= RowThreeTranslationDistance(theRowThree);
+		}
+
+		//	...and each generator...
+		for (j = 0; j < theNumGenerators; j++)
+		{
+			//	Reject candidates that translate too far,
+			//	but remember that theTile will need re-expanding
+			//	if the tiling is ever extended.
+			if (theJob->itsCandidates[theFirstCandidate + j].itsTranslationDistance > theJob->itsTilingRadius)
+			{
+				theTile->itsFrontierFlag = true;
+				continue;
+			}
+
+			//	Form the full product.
+			theCandidate = &theJob->itsCandidates[theJob->itsNumCandidates];
+			MatrixProduct(	&theGenerators[j],
+							&theTile->itsMatrix,
+							&theCandidate->itsMatrix);
+
+			//	Remove the product's roundoff error, if requested,
+			//	before it has a chance to propagate.
+			//	Renormalizing moves the image of the origin slightly,
+			//	so check the translation distance once more.
+			if (theJob->itsTiling->itsRenormalizeFlag)
+			{
+				FastGramSchmidt(&theCandidate->itsMatrix, theJob->itsTiling->itsSpaceType);
+				if (TranslationDistance(&theCandidate->itsMatrix) > theJob->itsTilingRadius)
+				{
+					theTile->itsFrontierFlag = true;
+					continue;
+				}
+			}
+
+			//	Note the candidate's translation distance and origin.
+			theCandidate->itsTranslationDistance	= TranslationDistance(&theCandidate->itsMatrix);
+			theCandidate->itsParent					= theTile;
+			theCandidate->itsGenerator				= j;
+
+			//	Reject candidates found in earlier batches.
+			if (FindTile(theJob->itsTiling, &theCandidate->itsMatrix) != NULL)
+				continue;
+
+			//	Keep this candidate.
+			theJob->itsNumCandidates++;
+		}
+	}
+}
+
+
+static ErrorText AddToFrontier(
+	TilingInProgress	*aTiling,
+	Tile				*aTile)
+{
+	Tile			**theLargerArray;
+	unsigned int	theNewArraySize;
+
+	//	Make sure the frontier array has room for one more pointer.
+	if (aTiling->itsNumFrontierTiles == aTiling->itsFrontierArraySize)
+	{
+		theNewArraySize = (aTiling->itsFrontierArraySize > 0) ?
+							2 * aTiling->itsFrontierArraySize :
+							MIN_TILE_ARRAY_SIZE;
+
+		if (aTiling->itsFrontier == NULL)
+			theLargerArray = (Tile **) GET_MEMORY(theNewArraySize * sizeof(Tile *));
+		else
+			theLargerArray = (Tile **) RESIZE_MEMORY(aTiling->itsFrontier, theNewArraySize * sizeof(Tile *));
+		if (theLargerArray == NULL)
+			return u"Couldn't enlarge the frontier in AddToFrontier().";
+
+		aTiling->itsStatistics.itsNumAllocations++;
+		aTiling->itsStatistics.itsNumBytes += (theNewArraySize - aTiling->itsFrontierArraySize) * sizeof(Tile *);
+
+		aTiling->itsFrontier			= theLargerArray;
+		aTiling->itsFrontierArraySize	= theNewArraySize;
+	}
+
+	aTiling->itsFrontier[aTiling->itsNumFrontierTiles++] = aTile;
+
+	return NULL;
 }
 
 
 static ErrorText AddToTiling(
 	TilingInProgress	*aTiling,
 	Matrix				*aMatrix,
-	double				aSortKey,
-	double				aTranslationDistance)
+	double				aTranslationDistance,
+	Tile				*aParent,		//	NULL for the identity
+	unsigned int		aGenerator)		//	index into itsGenerators
 {
-	Tile	*theNewTile,
-			**theNewLocation;
+	ErrorText		theErrorMessage;
+	Tile			*theNewTile,
+					**theLargerArray;
+	unsigned int	theNewArraySize,
+					theCellIndex[4],
+					theBucket,
+					i;
+	double			theUnusedFractionalPart,
+					theDeviation;
+
+	//	Make sure the Tile array has room for one more pointer.
+	if (aTiling->itsNumTiles == aTiling->itsTileArraySize)
+	{
+		theNewArraySize = (aTiling->itsTileArraySize > 0) ?
+							2 * aTiling->itsTileArraySize :
+							MIN_TILE_ARRAY_SIZE;
+
+		if (aTiling->itsTiles == NULL)
+			theLargerArray = (Tile **) GET_MEMORY(theNewArraySize * sizeof(Tile *));
+		else
+			theLargerArray = (Tile **) RESIZE_MEMORY(aTiling->itsTiles, theNewArraySize * sizeof(Tile *));
+		if (theLargerArray == NULL)
+			return u"Couldn't enlarge the Tile array in AddToTiling().";
+
+		aTiling->itsStatistics.itsNumAllocations++;
+		aTiling->itsStatistics.itsNumBytes += (theNewArraySize - aTiling->itsTileArraySize) * sizeof(Tile *);
+
+		aTiling->itsTiles			= theLargerArray;
+		aTiling->itsTileArraySize	= theNewArraySize;
+	}
+
+	//	Keep the hash chains short.
+	if (aTiling->itsNumTiles >= aTiling->itsNumHashBuckets)
+	{
+		theErrorMessage = ResizeHashTable(aTiling, 2 * aTiling->itsNumHashBuckets);
+		if (theErrorMessage != NULL)
+			return theErrorMessage;
+	}
 
 	//	Allocate a Tile.
-	theNewTile = (Tile *) GET_MEMORY(sizeof(Tile));
+	theNewTile = AllocateTile(aTiling);
 	if (theNewTile == NULL)
 		return u"Out of memory in AddToTiling().";
 
 	//	Copy the basic data.
 	theNewTile->itsMatrix				= *aMatrix;
-	theNewTile->itsSortKey				= aSortKey;
 	theNewTile->itsTranslationDistance	= aTranslationDistance;
+	theNewTile->itsFrontierFlag			= false;
+	theNewTile->itsParent				= aParent;
+	theNewTile->itsGenerator			= aGenerator;
+	theNewTile->itsDepth				= (aParent != NULL) ? aParent->itsDepth + 1 : 0;
+	theNewTile->itsIndex				= aTiling->itsNumTiles;	//	for now, the order of discovery
+
+	//	Keep track of the largest numerical error,
+	//	if anyone has asked for it.
+	if (aTiling->itsDeviationFlag)
+	{
+		theDeviation = MatrixDeviation(aMatrix, aTiling->itsSpaceType);
+		if (theDeviation > aTiling->itsStatistics.itsMaxDeviation)
+			aTiling->itsStatistics.itsMaxDeviation = theDeviation;
+	}
 
-	//	Add theNewTile to the tree.
+	//	Add theNewTile to the hash table.
+	for (i = 0; i < 4; i++)
+		theCellIndex[i] = HashCellIndex(aMatrix->m[3][i], &theUnusedFractionalPart);
+	theBucket = HashBucket(aTiling->itsNumHashBuckets, theCellIndex);
+	theNewTile->itsHashNext				= aTiling->itsHashBuckets[theBucket];
+	aTiling->itsHashBuckets[theBucket]	= theNewTile;
 
-	theNewTile->itsLeftChild	= NULL;
-	theNewTile->itsRightChild	= NULL;
+	//	Put theNewTile at the end of the array,
+	//	which also puts it at the end of the to-be-processed queue.
+	aTiling->itsTiles[aTiling->itsNumTiles++] = theNewTile;
 
-	theNewLocation = &aTiling->itsTree;
-	while (*theNewLocation != NULL)
-	{
-		if (aSortKey < (*theNewLocation)->itsSortKey)
-			theNewLocation = &(*theNewLocation)->itsLeftChild;
-		else
-			theNewLocation = &(*theNewLocation)->itsRightChild;
-	}
-	*theNewLocation = theNewTile;
+	return NULL;
+}
 
-	//	Put theNewTile onto the end of the to-be-processed queue.
-	if (aTiling->itsQueueLast != NULL)
-	{
-		aTiling->itsQueueLast->itsQueueNext = theNewTile;
-	}
+
+static ErrorText ResizeCayleyTable(
+	unsigned int	**aCayleyTable,
+	unsigned int	*aNumRows,
+	unsigned int	aMinNumRows,
+	unsigned int	aNumGenerators)
+{
+	unsigned int	*theLargerTable,
+					theNumRows,
+					i;
+
+	theNumRows = (*aNumRows > 0) ? *aNumRows : 1;
+	while (theNumRows < aMinNumRows)
+		theNumRows *= 2;
+
+	if (*aCayleyTable == NULL)
+		theLargerTable = (unsigned int *) GET_MEMORY(theNumRows * (aNumGenerators > 0 ? aNumGenerators : 1) * sizeof(unsigned int));
 	else
-	{
-		aTiling->itsQueueFirst = theNewTile;
-	}
-	theNewTile->itsQueueNext	= NULL;
-	aTiling->itsQueueLast		= theNewTile;
+		theLargerTable = (unsigned int *) RESIZE_MEMORY(*aCayleyTable, theNumRows * (aNumGenerators > 0 ? aNumGenerators : 1) * sizeof(unsigned int));
+	if (theLargerTable == NULL)
+		return u"Couldn't enlarge the Cayley table in ResizeCayleyTable().";
 
-	//	Update the tile count.
-	aTiling->itsNumTiles++;
+	for (i = *aNumRows * aNumGenerators; i < theNumRows * aNumGenerators; i++)
+		theLargerTable[i] = UNKNOWN_CAYLEY_ENTRY;
+
+	*aCayleyTable	= theLargerTable;
+	*aNumRows		= theNumRows;
 
 	return NULL;
 }
 
 
-static Tile *GetTileFromQueue(TilingInProgress *aTiling)
+static Tile *AllocateTile(TilingInProgress *aTiling)
 {
-	//	Remove the first Tile from the to-be-processed queue,
-	//	but do *not* remove it from the permanent data structure.
+	TileChunk	*theNewChunk;
+
+	//	Start a new TileChunk if the newest one is full
+	//	(or if there isn't any TileChunk yet).
+	if (aTiling->itsChunks == NULL
+	 || aTiling->itsNumTilesInNewestChunk == TILES_PER_CHUNK)
+	{
+		theNewChunk = (TileChunk *) GET_MEMORY(sizeof(TileChunk));
+		if (theNewChunk == NULL)
+			return NULL;
+
+		theNewChunk->itsNext				= aTiling->itsChunks;
+		aTiling->itsChunks					= theNewChunk;
+		aTiling->itsNumTilesInNewestChunk	= 0;
 
-	Tile	*theTile;
+		aTiling->itsStatistics.itsNumChunks++;
+		aTiling->itsStatistics.itsNumAllocations++;
+		aTiling->itsStatistics.itsNumBytes += sizeof(TileChunk);
+	}
+
+	return &aTiling->itsChunks->itsTiles[aTiling->itsNumTilesInNewestChunk++];
+}
 
-	theTile = aTiling->itsQueueFirst;
 
-	if (theTile != NULL)
+static ErrorText ResizeHashTable(
+	TilingInProgress	*aTiling,
+	unsigned int		aNumHashBuckets)	//	must be a power of two
+{
+	Tile			**theNewBuckets;
+	unsigned int	theCellIndex[4],
+					theBucket,
+					i,
+					j;
+	double			theUnusedFractionalPart;
+
+	theNewBuckets = (Tile **) GET_MEMORY(aNumHashBuckets * sizeof(Tile *));
+	if (theNewBuckets == NULL)
+		return u"Couldn't get memory for hash buckets in ResizeHashTable().";
+	for (i = 0; i < aNumHashBuckets; i++)
+		theNewBuckets[i] = NULL;
+
+	//	Re-file the existing Tiles.  The Tile array provides
+	//	a convenient list of them all.
+	for (i = 0; i < aTiling->itsNumTiles; i++)
 	{
-		aTiling->itsQueueFirst = theTile->itsQueueNext;
-		if (aTiling->itsQueueFirst == NULL)
-			aTiling->itsQueueLast = NULL;
-		theTile->itsQueueNext = NULL;
+		for (j = 0; j < 4; j++)
+			theCellIndex[j] = HashCellIndex(aTiling->itsTiles[i]->itsMatrix.m[3][j], &theUnusedFractionalPart);
+		theBucket = HashBucket(aNumHashBuckets, theCellIndex);
+		aTiling->itsTiles[i]->itsHashNext	= theNewBuckets[theBucket];
+		theNewBuckets[theBucket]			= aTiling->itsTiles[i];
 	}
 
-	return theTile;
+	FREE_MEMORY_SAFELY(aTiling->itsHashBuckets);
+	aTiling->itsStatistics.itsNumAllocations++;
+	aTiling->itsStatistics.itsNumBytes += (aNumHashBuckets - aTiling->itsNumHashBuckets) * sizeof(Tile *);
+	aTiling->itsHashBuckets		= theNewBuckets;
+	aTiling->itsNumHashBuckets	= aNumHashBuckets;
+
+	return NULL;
+}
+
+
+static unsigned int HashCellIndex(
+	double	aCoordinate,
+	double	*aFractionalPart)	//	output, in the range [0,1)
+{
+	double	theScaledCoordinate,
+			theCell;
+
+	//	Which grid cell does aCoordinate fall into,
+	//	and how far along that cell does it sit?
+	theScaledCoordinate	= aCoordinate / HASH_CELL_SIZE;
+	theCell				= floor(theScaledCoordinate);
+	*aFractionalPart	= theScaledCoordinate - theCell;
+
+	//	Casting a negative cell number to an unsigned int
+	//	would be undefined, so go via a signed int.
+	//	Two's complement wraparound is harmless here,
+	//	because we want only a hash value, not a faithful index.
+	return (unsigned int)(signed int)theCell;
+}
+
+
+static unsigned int HashBucket(
+	unsigned int		aNumHashBuckets,	//	must be a power of two
+	const unsigned int	aCellIndex[4])
+{
+	unsigned int	theHash;
+
+	//	Mix the four cell indices using large odd multipliers,
+	//	then fold the high-order bits down into the low-order ones
+	//	before discarding all but the low-order bits.
+	theHash = (aCellIndex[0] * 73856093u)
+			^ (aCellIndex[1] * 19349663u)
+			^ (aCellIndex[2] * 83492791u)
+			^ (aCellIndex[3] * 2654435761u);
+	theHash ^= theHash >> 16;
+
+	return theHash & (aNumHashBuckets - 1);
 }
 
 
 static double TranslationDistance(Matrix *aMatrix)
+{
+	//	How far does aMatrix translate the origin?
+	//	The answer depends only on the image of the origin,
+	//	which is row 3.
+	return RowThreeTranslationDistance(aMatrix->m[3]);
+}
+
+
+static double RowThreeTranslationDistance(const double aRowThree[4])
 {
 	//	Spherical case O(4)
-	if (aMatrix->m[3][3] <  1.0)
-		return SafeAcos(aMatrix->m[3][3]);
+	if (aRowThree[3] <  1.0)
+		return SafeAcos(aRowThree[3]);
 
 	//	Flat case Isom(E³)
 	//	(Would also work for elements of O(4) and O(3,1) that fix the origin,
 	//	even though Curved Spaces allows no such elements except the identity.)
-	if (aMatrix->m[3][3] == 1.0)
-		return sqrt(aMatrix->m[3][0] * aMatrix->m[3][0]
-				  + aMatrix->m[3][1] * aMatrix->m[3][1]
-				  + aMatrix->m[3][2] * aMatrix->m[3][2]);
+	if (aRowThree[3] == 1.0)
+		return sqrt(aRowThree[0] * aRowThree[0]
+				  + aRowThree[1] * aRowThree[1]
+				  + aRowThree[2] * aRowThree[2]);
 
 	//	Hyperbolic case O(3,1)
-	if (aMatrix->m[3][3] >  1.0)
-		return SafeAcosh(aMatrix->m[3][3]);
+	if (aRowThree[3] >  1.0)
+		return SafeAcosh(aRowThree[3]);
 
 	return 0.0;	//	suppress compiler warnings
 }
 
 
-static bool TreeContainsMatrix(
-	Tile	*aTree,
-	Matrix	*aMatrix,
-	double	aSortKey)
+static SpaceType MatrixSpaceType(Matrix *aMatrix)
 {
-	Tile	*theTile;
+	//	Infer the geometry from the matrix's image of the origin,
+	//	following the same convention as TranslationDistance().
+	//	Assumes aMatrix doesn't fix the origin.
+
+	if (aMatrix->m[3][3] <  1.0)
+		return SpaceSpherical;
+
+	if (aMatrix->m[3][3] == 1.0)
+		return SpaceFlat;
+
+	return SpaceHyperbolic;
+}
 
-	//	Does the given matrix already appear on the tree?
-	//	This seemingly simple tree search is complicated by the fact
-	//	that we know the sort key values only up to some numerical error,
-	//	which may be substantial in the hyperbolic case.
 
-	theTile = aTree;
-	while (theTile != NULL)
+static double MatrixDeviation(
+	Matrix		*aMatrix,
+	SpaceType	aSpaceType)
+{
+	const double	*theMetric;
+	double			theInnerProduct,
+					theError,
+					theMaxError;
+	unsigned int	i,
+					j,
+					k;
+
+	//	How far do aMatrix's rows depart from being orthonormal?
+	//	Measure each row against the rows above it using the same
+	//	MetricCoefficients() that FastGramSchmidt() uses, so that
+	//	a row's inner product with itself should be +1
+	//	and with any other row should be 0.
+	//	In the hyperbolic case the error is an absolute error,
+	//	so it grows roughly as cosh²(translation distance)
+	//	for a fixed relative error in the entries.
+
+	if (MetricCoefficients(aSpaceType, false) == NULL)
+		return 0.0;
+
+	theMaxError = 0.0;
+
+	for (i = 0; i < 4; i++)
 	{
-		if (aSortKey < theTile->itsSortKey - SORT_KEY_EPSILON)
-			theTile = theTile->itsLeftChild;
-		else
-		if (aSortKey > theTile->itsSortKey + SORT_KEY_EPSILON)
-			theTile = theTile->itsRightChild;
-		else
+		theMetric = MetricCoefficients(aSpaceType, i == 3);
+
+		for (j = 0; j <= i; j++)
 		{
-			//	The sort keys match to within SORT_KEY_EPSILON.
-
-			//	If we've found the desired matrix, we're done.
-			if (MatrixEquality(	&theTile->itsMatrix,
-								aMatrix,
-								TILING_EPSILON))
-				return true;
-
-			//	Otherwise the desired matrix could be on the left subtree,
-			//	on the right subtree, or not on the tree at all.
-			//	In practice the algorithm never reaches this point
-			//	(at least not for the Poincaré dodecahedral space,
-			//	the cubic 3-torus or a radius=6 hyperbolic tiling
-			//	by mirrored dodecahedra), but it's good to have
-			//	this code in place in case it's ever needed.
-			//	One wouldn't want to call it often, though, because
-			//	the forking could easily slow an otherwise fast search
-			//	to a near halt.
-			return TreeContainsMatrix(theTile->itsLeftChild,  aMatrix, aSortKey)
-				|| TreeContainsMatrix(theTile->itsRightChild, aMatrix, aSortKey);
+			theInnerProduct = 0.0;
+			for (k = 0; k < 4; k++)
+				theInnerProduct += theMetric[k] * aMatrix->m[i][k] * aMatrix->m[j][k];
+
+			theError = fabs(theInnerProduct - (i == j ? 1.0 : 0.0));
+			if (theError > theMaxError)
+				theMaxError = theError;
 		}
 	}
 
-	return false;
+	return theMaxError;
 }
 
 
-static void CopyPointersToArray(
-	Tile	*aTree,		//	read from here
-	Tile	***anArray)	//	write to here
+static Tile *FindTile(
+	TilingInProgress	*aTiling,
+	Matrix				*aMatrix)
 {
-	if (aTree != NULL)
+	unsigned int	theCellIndex[4],
+					theNeighborIndex[4],
+					theProbeIndex[4],
+					theNeighborMask,
+					theProbe,
+					i;
+	double			theFractionalPart;
+	Tile			*theTile;
+
+	//	Does the given matrix already appear in the tiling?
+	//	If so, return the Tile, otherwise return NULL.
+	//	This seemingly simple hash table lookup is complicated by the fact
+	//	that we know the matrix entries only up to some numerical error,
+	//	which may be substantial in the hyperbolic case.  If a coordinate
+	//	of aMatrix's image of the origin sits within TILING_EPSILON
+	//	of a cell boundary, a previously found copy of the same matrix
+	//	may have been filed in the adjacent cell, so we must
+	//	look there too.  In practice a candidate almost never sits
+	//	so close to a boundary, and we search a single bucket.
+	//	But it's good to have this code in place in case it's ever needed.
+	//	In the worst case all four coordinates sit near boundaries,
+	//	and we must search 2⁴ = 16 buckets.
+
+	theNeighborMask = 0;
+	for (i = 0; i < 4; i++)
+	{
+		theCellIndex[i]		= HashCellIndex(aMatrix->m[3][i], &theFractionalPart);
+		theNeighborIndex[i]	= theCellIndex[i];
+
+		if (theFractionalPart < TILING_EPSILON / HASH_CELL_SIZE)
+		{
+			theNeighborIndex[i]	= theCellIndex[i] - 1;
+			theNeighborMask		|= (1 << i);
+		}
+		else
+		if (theFractionalPart > 1.0 - TILING_EPSILON / HASH_CELL_SIZE)
+		{
+			theNeighborIndex[i]	= theCellIndex[i] + 1;
+			theNeighborMask		|= (1 << i);
+		}
+	}
+
+	//	Examine each combination of cells, skipping combinations
+	//	that would call for a neighboring cell in a coordinate
+	//	that doesn't need one.
+	for (theProbe = 0; theProbe < 16; theProbe++)
 	{
-		*(*anArray)++ = aTree;
-		CopyPointersToArray(aTree->itsLeftChild,  anArray);
-		CopyPointersToArray(aTree->itsRightChild, anArray);
+		if ((theProbe & ~theNeighborMask) != 0)
+			continue;
+
+		for (i = 0; i < 4; i++)
+			theProbeIndex[i] = (theProbe & (1 << i)) ? theNeighborIndex[i] : theCellIndex[i];
+
+		for (	theTile = aTiling->itsHashBuckets[HashBucket(aTiling->itsNumHashBuckets, theProbeIndex)];
+				theTile != NULL;
+				theTile = theTile->itsHashNext)
+		{
+			if (MatrixEquality(&theTile->itsMatrix, aMatrix, TILING_EPSILON))
+				return theTile;
+		}
 	}
+
+	return NULL;
+}
+
+
+static bool TilingWasCancelled(const CancelTest *aCancelTest)	//	may be NULL
+{
+	return aCancelTest != NULL
+		&& (*aCancelTest->itsTestFunction)(aCancelTest->itsTestData);
 }
 
 